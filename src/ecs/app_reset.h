@@ -9,6 +9,7 @@ namespace ecs {
 inline void reset_layout_defaults(LayoutComponent& layout) {
     layout.sidebarVisible = true;
     layout.commandLogVisible = false;
+    layout.profilerVisible = false;
     layout.sidebarMode = LayoutComponent::SidebarMode::Changes;
     layout.fileViewMode = LayoutComponent::FileViewMode::Flat;
     layout.diffViewMode = LayoutComponent::DiffViewMode::Inline;
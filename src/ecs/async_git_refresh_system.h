@@ -1,138 +1,386 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
-#include <future>
+#include <functional>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
+
+#include <afterhours/src/logging.h>
 
 #include "../../vendor/afterhours/src/core/system.h"
 #include "../git/git_parser.h"
 #include "../git/git_runner.h"
+#include "../git/log_update.h"
+#include "../git/status_delta.h"
+#include "../util/background_task.h"
+#include "../util/frame_stats.h"
+#include "completion_system.h"
 #include "components.h"
+#include "repo_index.h"
 
 namespace ecs {
 
+// Kicks off the git queries behind a refresh on worker threads.  Each
+// worker runs git *and* parses its output (plus the selection indexes), then
+// posts the result to the completion queue; CompletionDispatchSystem hands
+// it back here to be move-assigned into RepoComponent on the UI thread.
 struct AsyncGitDataRefreshSystem : afterhours::System<RepoComponent> {
 
+    // Applying results is just moves; warn if it ever costs real time.
+    static constexpr double APPLY_WARN_MS = 2.0;
+
+    // Commits per full log load, and the most an incremental refresh will
+    // prepend before falling back to a full reload.
+    static constexpr int LOG_PAGE = 100;
+    static constexpr size_t MAX_PREPEND = 100;
+
     void for_each_with(afterhours::Entity& entity,
                        RepoComponent& repo, float) override {
+        if (repo.commitLogPageRequested) {
+            repo.commitLogPageRequested = false;
+            if (!repo.commitLogPageLoading && !repo.commitLog.empty() &&
+                !repo.commitLogFrontier.empty()) {
+                launch_page(entity.id, repo);
+            }
+        }
 
-        auto id = entity.id;
+        if (!repo.refreshRequested || repo.isRefreshing) return;
 
-        // Phase 1: kick off async operations for any tab that requests refresh
-        if (repo.refreshRequested && !repo.isRefreshing) {
-            if (repo.repoPath.empty()) {
-                repo.refreshRequested = false;
-                return;
-            }
+        repo.refreshRequested = false;
+        if (repo.repoPath.empty()) return;
 
-            repo.refreshRequested = false;
-            repo.isRefreshing = true;
+        repo.isRefreshing = true;
+        unsigned generation = ++repo.refreshGeneration;
+        repo.refreshOpsPending = 4;
+
+        const auto id = entity.id;
+        const std::string& path = repo.repoPath;
+        launch(id, generation, path, load_status, apply_status);
+        std::string logBase =
+            repo.commitLog.empty() ? std::string() : repo.commitLog.front().hash;
+        int logLoaded = repo.commitLogLoaded;
+        size_t logRefs = repo.commitLogRefs;
+        launch(id, generation, path,
+               [logBase, logLoaded, logRefs](const std::string& p) {
+                   return load_log(p, logBase, logLoaded, logRefs);
+               },
+               apply_log);
+        launch(id, generation, path, load_branches, apply_branches);
+        launch(id, generation, path, load_head, apply_head);
+    }
+
+private:
+    // Run load(path) on a worker and post apply(repo, result) back.  Results
+    // from a superseded refresh (generation changed) are dropped; a failed
+    // load (nullopt) keeps the previous data but still counts as finished.
+    template <typename Load, typename Apply>
+    static void launch(afterhours::EntityID owner, unsigned generation,
+                       std::string path, Load load, Apply apply) {
+        run_in_background([owner, generation, path = std::move(path), load,
+                           apply]() {
+            auto parsed = load(path);
+            post_completion(owner, [generation, apply,
+                                    parsed = std::move(parsed)](
+                                       afterhours::Entity& entity) mutable {
+                if (!entity.has<RepoComponent>()) return;
+                auto& repo = entity.get<RepoComponent>();
+                if (repo.refreshGeneration != generation) return;
+
+                auto applyStart = std::chrono::steady_clock::now();
+                if (parsed) apply(repo, std::move(*parsed));
+                double applyMs = ms_since(applyStart);
+                if (applyMs > APPLY_WARN_MS) {
+                    log_warn("async refresh: applying results took {:.2f} ms",
+                             applyMs);
+                }
+
+                if (--repo.refreshOpsPending <= 0) {
+                    repo.isRefreshing = false;
+                    repo.hasLoadedOnce = true;
+                }
+            });
+        });
+    }
+
+    // Load the next page of history from the frontier in the background
+    // and append it.  Pages aren't tied to a refresh generation; instead a
+    // page is dropped if the log's last commit changed (a full reload) while
+    // it loaded.  The sidebar asks again if it still needs more.
+    static void launch_page(afterhours::EntityID owner, RepoComponent& repo) {
+        repo.commitLogPageLoading = true;
+        run_in_background([owner, path = repo.repoPath,
+                           starts = repo.commitLogFrontier,
+                           after = repo.commitLog.back().hash]() {
+            std::optional<std::vector<CommitEntry>> page;
+            auto result = git::git_log_from(path, starts, LOG_PAGE);
+            if (result.success()) page = git::parse_log(result.stdout_str());
+            post_completion(owner, [after, page = std::move(page)](
+                                       afterhours::Entity& entity) mutable {
+                if (!entity.has<RepoComponent>()) return;
+                auto& repo = entity.get<RepoComponent>();
+                repo.commitLogPageLoading = false;
+                if (!page) {
+                    // Stop rather than retry every frame; a refresh resets it
+                    log_warn("commit log: loading the next page failed");
+                    repo.commitLogHasMore = false;
+                    return;
+                }
+                if (repo.commitLog.empty() || repo.commitLog.back().hash != after) {
+                    return;
+                }
+                size_t added = git::append_page(repo.commitLog, repo.commitIndex,
+                                                repo.commitLogFrontier, std::move(*page));
+                repo.commitLogLoaded = static_cast<int>(repo.commitLog.size());
+                repo.commitLogHasMore = added > 0 && !repo.commitLogFrontier.empty();
+            });
+        });
+    }
+
+    // Either a full log (index built on the worker) or, when `incremental`,
+    // the commits added on top of `baseHash` plus, if the refs changed, the
+    // current ref tips.  Applying either costs O(commits + tips here), never
+    // O(commits loaded).
+    struct ParsedLog {
+        CommitLog log;                    // Full load
+        std::vector<CommitEntry> commits; // Incremental: newest first
+        CommitIndex index;
+        std::vector<std::string> frontier;  // Full load: pagination cursor
+        size_t refs = 0;                    // ref_fingerprint() taken first
+
+        bool incremental = false;
+        std::string baseHash;
+        bool tipsLoaded = false;
+        std::vector<CommitEntry> tips;
+    };
+
+    // Status plus `git diff --numstat` summaries.  Line counts are filled
+    // into the FileStatus entries here; hunks are loaded per file on demand
+    // (WorkingDiffLoaderSystem), so a refresh costs the same however large
+    // the diff is.
+    struct ParsedStatus {
+        git::StatusResult status;
+        bool haveSummary = false;
+        std::vector<FileDiff> unstaged;
+        std::unordered_map<std::string, size_t> index;
+    };
+
+    // Worker-side loaders: run git, parse, and return nullopt on failure
+    // so the previous data is kept.
+    static std::optional<ParsedStatus> load_status(const std::string& path) {
+        auto result = git::git_status(path);
+        if (!result.success()) return std::nullopt;
+        ParsedStatus parsed;
+        parsed.status = git::parse_status(result.stdout_str());
+        git::stamp_worktree(path, parsed.status.stagedFiles);
+        git::stamp_worktree(path, parsed.status.unstagedFiles);
+
+        auto unstaged = git::git_diff_numstat(path);
+        if (unstaged.success()) {
+            parsed.unstaged = git::parse_numstat(unstaged.stdout_str());
+            parsed.index = build_diff_index(path, parsed.unstaged);
+            parsed.haveSummary = true;
+            fill_line_counts(parsed.status.unstagedFiles, parsed.unstaged);
+        }
+        auto staged = git::git_diff_numstat(path, /*staged=*/true);
+        if (staged.success()) {
+            fill_line_counts(parsed.status.stagedFiles,
+                             git::parse_numstat(staged.stdout_str()));
+        }
+        return parsed;
+    }
 
-            const std::string path = repo.repoPath;
-            auto& pf = pending_[id];
-            pf.status   = git::git_status_async(path);
-            pf.log      = git::git_log_async(path, 100, 0);
-            pf.diff     = git::git_diff_async(path);
-            pf.branches = git::git_branch_list_async(path);
-            pf.head     = git::git_rev_parse_head_async(path);
+    static void fill_line_counts(std::vector<FileStatus>& files,
+                                 const std::vector<FileDiff>& stats) {
+        std::unordered_map<std::string_view, const FileDiff*> byPath;
+        byPath.reserve(stats.size());
+        for (const auto& d : stats) byPath.emplace(d.filePath, &d);
+        for (auto& f : files) {
+            auto it = byPath.find(f.path);
+            if (it == byPath.end()) continue;
+            f.additions = it->second->additions;
+            f.deletions = it->second->deletions;
         }
+    }
 
-        if (!repo.isRefreshing) return;
+    // Hash of the ref list and HEAD, or 0 if git fails.  Taken before the
+    // decorations it vouches for are read, so a ref moving in between
+    // shows up as a change next time.
+    static size_t ref_fingerprint(const std::string& path, const std::string& head) {
+        auto result = git::git_ref_list(path);
+        if (!result.success()) return 0;
+        std::string refs = result.stdout_str();
+        refs += head;
+        return std::hash<std::string>{}(refs);
+    }
 
-        auto it = pending_.find(id);
-        if (it == pending_.end()) {
-            repo.isRefreshing = false;
-            return;
+    // Incremental when possible; a full reload keeps as many commits as
+    // were loaded before so paged-in history survives.  `refs` is the
+    // fingerprint the loaded decorations match.
+    static std::optional<ParsedLog> load_log(const std::string& path,
+                                             const std::string& baseHash,
+                                             int loaded, size_t refs) {
+        if (!baseHash.empty()) {
+            if (auto parsed = load_log_since(path, baseHash, refs)) return parsed;
         }
-        auto& pf = it->second;
-
-        // Phase 2: poll each future (non-blocking)
-        using namespace std::chrono_literals;
-
-        if (pf.status &&
-            pf.status->wait_for(0s) == std::future_status::ready) {
-            auto result = pf.status->get();
-            pf.status.reset();
-            if (result.success()) {
-                auto parsed = git::parse_status(result.stdout_str());
-                repo.currentBranch  = parsed.branchName;
-                repo.isDetachedHead = parsed.isDetachedHead;
-                repo.aheadCount     = parsed.aheadCount;
-                repo.behindCount    = parsed.behindCount;
-                repo.stagedFiles    = std::move(parsed.stagedFiles);
-                repo.unstagedFiles  = std::move(parsed.unstagedFiles);
-                repo.untrackedFiles = std::move(parsed.untrackedFiles);
-                repo.isDirty = !repo.stagedFiles.empty() ||
-                               !repo.unstagedFiles.empty() ||
-                               !repo.untrackedFiles.empty();
+        auto head = load_head(path);
+        size_t fingerprint = head ? ref_fingerprint(path, *head) : 0;
+        int count = std::max(LOG_PAGE, loaded);
+        auto result = git::git_log(path, count, 0);
+        if (!result.success()) return std::nullopt;
+        ParsedLog parsed;
+        parsed.refs = fingerprint;
+        parsed.log = git::make_commit_log(git::parse_log(result.stdout_str()));
+        parsed.index = build_commit_index(parsed.log);
+        parsed.frontier = git::log_frontier(parsed.log, parsed.index);
+        return parsed;
+    }
+
+    // Commits added since `baseHash` (the top of the loaded log), or
+    // nullopt if the log must be reloaded: HEAD was rewritten (reset,
+    // rebase, amend, checkout), too many commits arrived, or the new range
+    // contains a merge.  With HEAD and the refs unchanged that costs a
+    // rev-parse and a for-each-ref; ref tips are only read when the refs
+    // fingerprint differs from `refs`.
+    static std::optional<ParsedLog> load_log_since(const std::string& path,
+                                                   const std::string& baseHash,
+                                                   size_t refs) {
+        auto head = load_head(path);
+        if (!head) return std::nullopt;
+
+        ParsedLog parsed;
+        parsed.incremental = true;
+        parsed.baseHash = baseHash;
+        if (*head != baseHash) {
+            if (git::git_is_ancestor(path, baseHash, *head).exit_code() != 0) {
+                return std::nullopt;
+            }
+            auto range = git::git_log_range(path, baseHash + ".." + *head,
+                                            static_cast<int>(MAX_PREPEND) + 1);
+            if (!range.success()) return std::nullopt;
+            parsed.commits = git::parse_log(range.stdout_str());
+            if (parsed.commits.size() > MAX_PREPEND ||
+                git::has_merge_commit(parsed.commits)) {
+                return std::nullopt;
             }
         }
 
-        if (pf.log &&
-            pf.log->wait_for(0s) == std::future_status::ready) {
-            auto result = pf.log->get();
-            pf.log.reset();
-            if (result.success()) {
-                repo.commitLog = git::parse_log(result.stdout_str());
-                repo.commitLogLoaded =
-                    static_cast<int>(repo.commitLog.size());
-                repo.commitLogHasMore = (repo.commitLogLoaded >= 100);
-            }
+        parsed.refs = ref_fingerprint(path, *head);
+        if (parsed.refs != 0 && parsed.refs == refs) return parsed;
+        auto tips = git::git_log_ref_tips(path);
+        if (tips.success()) {
+            parsed.tips = git::parse_log(tips.stdout_str());
+            parsed.tipsLoaded = true;
         }
+        return parsed;
+    }
 
-        if (pf.diff &&
-            pf.diff->wait_for(0s) == std::future_status::ready) {
-            auto result = pf.diff->get();
-            pf.diff.reset();
-            if (result.success()) {
-                repo.currentDiff = git::parse_diff(result.stdout_str());
-            }
+    static std::optional<std::vector<BranchInfo>> load_branches(
+        const std::string& path) {
+        auto result = git::git_branch_list(path);
+        if (!result.success()) return std::nullopt;
+        return git::parse_branch_list(result.stdout_str());
+    }
+
+    static std::optional<std::string> load_head(const std::string& path) {
+        auto result = git::git_rev_parse_head(path);
+        if (!result.success()) return std::nullopt;
+        std::string head = result.stdout_str();
+        while (!head.empty() && (head.back() == '\n' || head.back() == '\r')) {
+            head.pop_back();
         }
+        return head;
+    }
 
-        if (pf.branches &&
-            pf.branches->wait_for(0s) == std::future_status::ready) {
-            auto result = pf.branches->get();
-            pf.branches.reset();
-            if (result.success()) {
-                repo.branches =
-                    git::parse_branch_list(result.stdout_str());
-            }
+    // UI-thread side: move parsed results into the component.
+    static void apply_status(RepoComponent& repo, ParsedStatus&& result) {
+        auto& parsed = result.status;
+        repo.currentBranch  = std::move(parsed.branchName);
+        repo.isDetachedHead = parsed.isDetachedHead;
+        repo.aheadCount     = parsed.aheadCount;
+        repo.behindCount    = parsed.behindCount;
+        // Keyed by path: unchanged entries are left alone, and only the
+        // paths that changed drop their cached hunks
+        StatusChangeSet staged, unstaged, untracked;
+        git::apply_status_delta(repo.stagedFiles, std::move(parsed.stagedFiles),
+                                staged);
+        git::apply_status_delta(repo.unstagedFiles,
+                                std::move(parsed.unstagedFiles), unstaged);
+        git::apply_status_delta(repo.untrackedFiles,
+                                std::move(parsed.untrackedFiles), untracked);
+        repo.isDirty = !repo.stagedFiles.empty() ||
+                       !repo.unstagedFiles.empty() ||
+                       !repo.untrackedFiles.empty();
+        if (result.haveSummary) {
+            repo.currentDiff = std::move(result.unstaged);
+            repo.diffIndexByPath = std::move(result.index);
+            repo.diffVersion++;
         }
 
-        if (pf.head &&
-            pf.head->wait_for(0s) == std::future_status::ready) {
-            auto result = pf.head->get();
-            pf.head.reset();
-            if (result.success()) {
-                repo.headCommitHash = result.stdout_str();
-                while (!repo.headCommitHash.empty() &&
-                       (repo.headCommitHash.back() == '\n' ||
-                        repo.headCommitHash.back() == '\r')) {
-                    repo.headCommitHash.pop_back();
-                }
+        for (const auto* changes : {&staged, &unstaged, &untracked}) {
+            for (const auto& path : git::affected_paths(*changes)) {
+                repo.invalidate_file_diff(path);
             }
         }
+        // Untracked files carry no content stamp; their synthesized diffs
+        // are cheap to re-read, so drop them on every refresh
+        for (const auto& path : repo.untrackedFiles) {
+            repo.invalidate_file_diff(path);
+        }
+        if (!staged.empty() || !unstaged.empty() || !untracked.empty()) {
+            repo.statusChangesFrom = repo.statusVersion++;
+            repo.stagedChanges = std::move(staged);
+            repo.unstagedChanges = std::move(unstaged);
+            repo.untrackedChanges = std::move(untracked);
+        }
+    }
+
+    static void apply_log(RepoComponent& repo, ParsedLog&& parsed) {
+        if (!parsed.incremental) {
+            repo.commitLog = std::move(parsed.log);
+            repo.commitIndex = std::move(parsed.index);
+            repo.commitLogFrontier = std::move(parsed.frontier);
+            repo.commitLogLoaded = static_cast<int>(repo.commitLog.size());
+            repo.commitLogHasMore = !repo.commitLogFrontier.empty();
+            repo.commitLogPrepended = 0;
+            repo.commitLogRefs = parsed.refs;
+            return;
+        }
+
+        // The log was replaced while the worker ran: compute the delta again
+        if (repo.commitLog.empty() || repo.commitLog.front().hash != parsed.baseHash) {
+            repo.refreshRequested = true;
+            return;
+        }
 
-        // Phase 3: check if all operations completed
-        if (!pf.status && !pf.log && !pf.diff &&
-            !pf.branches && !pf.head) {
-            repo.isRefreshing = false;
-            repo.hasLoadedOnce = true;
-            pending_.erase(it);
+        // O(added): the deque takes them in front and the index shifts its
+        // base instead of renumbering the rows already loaded
+        int added = static_cast<int>(parsed.commits.size());
+        if (added > 0) {
+            git::prepend_commits(repo.commitLog, repo.commitIndex,
+                                 std::move(parsed.commits));
+            repo.commitLogLoaded += added;
+            repo.commitLogPrepended += added;
         }
+        // O(tips + rows decorated before)
+        if (parsed.tipsLoaded) {
+            git::apply_ref_tips(repo.commitLog, repo.commitIndex, parsed.tips);
+            repo.commitLogRefs = parsed.refs;
+        }
+        repo.commitLogHasMore = !repo.commitLogFrontier.empty();
     }
 
-private:
-    struct PendingFutures {
-        std::optional<std::future<git::GitResult>> status;
-        std::optional<std::future<git::GitResult>> log;
-        std::optional<std::future<git::GitResult>> diff;
-        std::optional<std::future<git::GitResult>> branches;
-        std::optional<std::future<git::GitResult>> head;
-    };
+    static void apply_branches(RepoComponent& repo,
+                               std::vector<BranchInfo>&& parsed) {
+        repo.branches = std::move(parsed);
+    }
 
-    std::unordered_map<afterhours::EntityID, PendingFutures> pending_;
+    static void apply_head(RepoComponent& repo, std::string&& parsed) {
+        repo.headCommitHash = std::move(parsed);
+    }
 };
 
 }  // namespace ecs
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../ui/commit_detail.h"
+#include "../util/background_task.h"
+#include "completion_system.h"
+#include "components.h"
+#include "query_helpers.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+// Loads commit details (git show + parse + display model) on worker threads
+// so selecting a commit never blocks the UI.  Results land in the shared
+// CommitDetailStore, so revisiting a commit -- from any tab on the same
+// repo -- is a cache hit.  Once the selected commit is in, the commits
+// directly above and below it are prefetched.  A load that fails isn't
+// cached: the tab shows git's error, and selecting the commit again
+// retries.
+struct CommitDetailLoaderSystem
+    : afterhours::System<RepoComponent, CommitDetailCache> {
+
+    // Upper bound on concurrent prefetch workers (selection loads always start).
+    static constexpr size_t MAX_IN_FLIGHT = 4;
+
+    void for_each_with(afterhours::Entity& tab, RepoComponent& repo,
+                       CommitDetailCache& cache, float) override {
+        auto* storeEnt = find_singleton_entity<CommitDetailStore>();
+        if (!storeEnt) return;
+        auto& store = storeEnt->get<CommitDetailStore>();
+
+        const std::string& selected = repo.selectedCommitHash;
+        if (selected.empty() || repo.repoPath.empty()) return;
+
+        if (cache.cachedCommitHash != selected ||
+            (!cache.detail && cache.error.empty())) {
+            // Don't leave the previous commit's body/diff on screen
+            cache.detail.reset();
+            cache.error.clear();
+            cache.cachedCommitHash.clear();
+
+            auto key = CommitDetailStore::key(repo.repoPath, selected);
+            if (store.loading.contains(key)) return;
+
+            // A load we started for this selection isn't a cache hit.  The
+            // tab's slot is dropped as soon as the selection moves on, so an
+            // abandoned load doesn't swallow the hit of a later revisit.
+            auto awaited = awaited_.find(tab.id);
+            bool ours = awaited != awaited_.end() && awaited->second == key;
+            if (awaited != awaited_.end()) awaited_.erase(awaited);
+            // Our load failed: show why until the selection changes.  A
+            // failure we didn't wait for (a prefetch, or an earlier
+            // selection) is retried instead.
+            if (auto failed = store.failed.find(key); failed != store.failed.end()) {
+                if (ours) {
+                    cache.error = std::move(failed->second);
+                    cache.cachedCommitHash = selected;
+                }
+                store.failed.erase(failed);
+                if (ours) return;
+            }
+            const std::shared_ptr<const CommitDetail>* found =
+                ours ? store.cache.touch(key) : store.cache.get(key);
+            if (!found) {
+                start(*storeEnt, key, repo.repoPath, selected);
+                awaited_[tab.id] = key;
+                return;
+            }
+            cache.detail = *found;
+            cache.cachedCommitHash = selected;
+        }
+
+        prefetch_neighbors(*storeEnt, repo);
+    }
+
+   private:
+    // Per tab: the key its selection is waiting on (started on a miss).
+    std::unordered_map<afterhours::EntityID, std::string> awaited_;
+
+    // Load on a worker; the completion queue delivers the result to the
+    // store entity, so tabs on the same repo share one load per key.
+    static void start(afterhours::Entity& storeEnt, const std::string& key,
+                      const std::string& repoPath, const std::string& hash) {
+        storeEnt.get<CommitDetailStore>().loading.insert(key);
+        run_in_background([storeId = storeEnt.id, key, repoPath, hash]() {
+            std::string error;
+            std::shared_ptr<const CommitDetail> detail;
+            size_t bytes = 0;
+            if (auto loaded = commit_detail_view::load_commit_detail(repoPath, hash,
+                                                                     error)) {
+                detail = std::make_shared<const CommitDetail>(std::move(*loaded));
+                bytes = commit_detail_view::approx_bytes(*detail);
+            }
+            post_completion(storeId, [key, detail, bytes, error = std::move(error)](
+                                         afterhours::Entity& e) mutable {
+                if (!e.has<CommitDetailStore>()) return;
+                auto& store = e.get<CommitDetailStore>();
+                store.loading.erase(key);
+                if (!detail) {
+                    store.failed[key] = std::move(error);
+                    return;
+                }
+                store.failed.erase(key);
+                store.cache.put(key, detail, bytes);
+            });
+        });
+    }
+
+    void prefetch_neighbors(afterhours::Entity& storeEnt,
+                            const RepoComponent& repo) {
+        const auto& store = storeEnt.get<CommitDetailStore>();
+        const auto& log = repo.commitLog;
+        int found = find_commit_index(repo, repo.selectedCommitHash);
+        if (found < 0) return;
+        size_t idx = static_cast<size_t>(found);
+
+        for (size_t n : {idx + 1, idx - 1}) {
+            if (n >= log.size()) continue;  // idx - 1 wraps when idx == 0
+            if (store.loading.size() >= MAX_IN_FLIGHT) return;
+            auto key = CommitDetailStore::key(repo.repoPath, log[n].hash);
+            if (store.cache.contains(key) || store.loading.contains(key) ||
+                store.failed.contains(key)) {
+                continue;
+            }
+            start(storeEnt, key, repo.repoPath, log[n].hash);
+        }
+    }
+};
+
+} // namespace ecs
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "components.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+// Keeps CommitGraphCache in step with the commit log.  A page appended
+// below the rows already laid out only lays out the new rows, and a
+// fast-forward refresh's commits (a linear run down into the old first
+// row; see AsyncGitDataRefreshSystem::load_log_since) go in front in
+// O(commits prepended).  Anything else (a reload, another repo) starts
+// over, which is linear in the rows loaded so far.
+struct CommitGraphSystem : afterhours::System<RepoComponent, CommitGraphCache> {
+    void for_each_with(afterhours::Entity&, RepoComponent& repo,
+                       CommitGraphCache& cache, float) override {
+        const auto& log = repo.commitLog;
+        size_t built = cache.graph.size();
+        if (built > 0 && !log.empty() && log.front().hash != cache.firstHash) {
+            prepend(repo, cache);
+            built = cache.graph.size();
+        }
+        bool extends = built > 0 && log.size() >= built &&
+                       log.front().hash == cache.firstHash &&
+                       log[built - 1].hash == cache.lastHash;
+        if (!extends && built > 0) {
+            cache.graph.clear();
+            built = 0;
+        }
+        if (built == log.size()) return;
+
+        for (size_t i = built; i < log.size(); ++i) {
+            cache.graph.add(log[i].hash, log[i].parentHashes);
+        }
+        cache.firstHash = log.front().hash;
+        cache.lastHash = log.back().hash;
+    }
+
+private:
+    // Lay out commits put in front of the old first row, if they are a
+    // linear run into it; otherwise leave the graph for a rebuild.
+    static void prepend(const RepoComponent& repo, CommitGraphCache& cache) {
+        const auto& log = repo.commitLog;
+        int found = find_commit_index(repo, cache.firstHash);
+        if (found <= 0) return;
+        auto count = static_cast<size_t>(found);
+        if (log.size() < count + cache.graph.size() ||
+            log[count + cache.graph.size() - 1].hash != cache.lastHash) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (log[i].parentHashes != log[i + 1].hash) return;
+        }
+        cache.graph.prepend_linear(static_cast<uint32_t>(count));
+        cache.firstHash = log.front().hash;
+    }
+};
+
+} // namespace ecs
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../../vendor/afterhours/src/plugins/files.h"
+#include "../git/git_parser.h"
+#include "../git/git_runner.h"
+#include "../util/background_task.h"
+#include "../util/commit_search_index.h"
+#include "completion_system.h"
+#include "components.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+namespace commit_search_detail {
+
+// <config>/commit_index/<hash of the repo path>.idx, or "" before the
+// files plugin is up (the index then lives for the session only).
+inline std::filesystem::path cache_path(const std::string& repoPath) {
+    auto configDir = afterhours::files::get_config_path();
+    if (configDir.empty()) return {};
+    uint64_t h = 1469598103934665603ull;  // FNV-1a
+    for (unsigned char c : repoPath) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.idx", static_cast<unsigned long long>(h));
+    return configDir / "commit_index" / name;
+}
+
+// Stream `range` into `index`; false if git fails.
+inline bool ingest_range(const std::string& repoPath, const std::string& range,
+                         CommitSearchIndex& index) {
+    CommitSearchIndex::Ingest ingest(index);
+    auto result = git::git_log_search_stream(repoPath, range, [&](std::string_view chunk) {
+        ingest.feed(chunk);
+        return true;
+    });
+    ingest.finish();
+    return result.success();
+}
+
+// Index of `head`'s history: the saved one if it covers `head`, caught
+// up if `head` descends from what it covers, otherwise built from
+// scratch.  Saved back whenever it changed.  Null if git fails.
+inline std::shared_ptr<CommitSearchIndex> load_index(const std::string& repoPath,
+                                                     const std::string& head) {
+    auto path = cache_path(repoPath);
+    auto index = std::make_shared<CommitSearchIndex>();
+    std::string tip;
+    if (!path.empty()) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in || !CommitSearchIndex::read(in, *index, tip)) tip.clear();
+    }
+    if (tip == head && !tip.empty()) return index;
+
+    bool caughtUp = !tip.empty() &&
+                    git::git_is_ancestor(repoPath, tip, head).exit_code() == 0 &&
+                    ingest_range(repoPath, tip + ".." + head, *index);
+    if (!caughtUp) {
+        *index = CommitSearchIndex{};
+        if (!ingest_range(repoPath, head, *index)) return nullptr;
+    }
+    index->seal();
+
+    if (!path.empty()) {
+        // Write-then-rename so a crash never leaves half a file behind
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        auto tmp = path;
+        tmp += ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (out && index->write(out, head)) {
+            out.close();
+            std::filesystem::rename(tmp, path, ec);
+        } else {
+            std::filesystem::remove(tmp, ec);
+        }
+    }
+    return index;
+}
+
+// A result row: the loaded log entry if there is one (so badges show),
+// otherwise what the index holds.
+inline CommitEntry make_entry(const RepoComponent& repo, const CommitSearchIndex& index,
+                              CommitSearchIndex::CommitId id) {
+    std::string hash = index.hash(id);
+    int found = find_commit_index(repo, hash);
+    if (found >= 0) return repo.commitLog[static_cast<size_t>(found)];
+
+    CommitEntry entry;
+    entry.shortHash = hash.substr(0, 7);
+    entry.hash = std::move(hash);
+    entry.subject = index.subject(id);
+    std::string_view author = index.author(id);
+    entry.author = author.substr(0, author.find(" <"));
+    entry.authorTime = static_cast<std::time_t>(index.author_time(id));
+    return entry;
+}
+
+// "-S text" / "-G regex" (or "-Stext") asks for a content search; false
+// for anything else.  `pattern` may come back empty.
+inline bool parse_pickaxe(std::string_view query, bool& regex, std::string& pattern) {
+    size_t start = query.find_first_not_of(' ');
+    if (start == std::string_view::npos) return false;
+    query.remove_prefix(start);
+    if (query.size() < 2 || query[0] != '-' || (query[1] != 'S' && query[1] != 'G')) {
+        return false;
+    }
+    regex = query[1] == 'G';
+    query.remove_prefix(2);
+    size_t p = query.find_first_not_of(' ');
+    pattern = p == std::string_view::npos ? std::string{} : std::string(query.substr(p));
+    return true;
+}
+
+} // namespace commit_search_detail
+
+// Keeps each tab's CommitSearchState index current and answers its query.
+// Nothing is loaded until a query is typed.  When HEAD fast-forwards,
+// the new commits are streamed and indexed on a worker and appended here
+// (the saved copy catches up on the next load); a longer catch-up or any
+// other move reloads on a worker.
+//
+// Content searches run `git log -S/-G` once typing pauses; matches are
+// posted back in batches, and a new query cancels the old process.
+struct CommitSearchSystem : afterhours::System<RepoComponent, CommitSearchState> {
+    // Quiet time after the last keystroke before a content search starts
+    static constexpr auto PICKAXE_DEBOUNCE = std::chrono::milliseconds(250);
+    // Matches are handed to the UI at most this often
+    static constexpr auto PICKAXE_BATCH_INTERVAL = std::chrono::milliseconds(100);
+    // Fast-forwards past this many commits reload the index instead
+    static constexpr size_t MAX_CATCH_UP = 1000;
+
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       CommitSearchState& state, float) override {
+        bool regex = false;
+        std::string pattern;
+        if (commit_search_detail::parse_pickaxe(state.query, regex, pattern)) {
+            update_pickaxe(entity, repo, state, regex, pattern);
+            return;
+        }
+        if (!state.pickaxeQuery.empty()) {
+            stop_pickaxe(state);
+            state.pickaxeQuery.clear();
+            state.resultsValid = false;
+        }
+
+        if (!state.active() && !state.index) return;
+        refresh(entity, repo, state);
+        if (state.active()) update_results(repo, state);
+    }
+
+   private:
+    static void stop_pickaxe(CommitSearchState& state) {
+        if (state.pickaxeCancel) *state.pickaxeCancel = true;
+        state.pickaxeCancel.reset();
+        state.pickaxeTicket = 0;
+        state.pickaxeDueAt = {};
+    }
+
+    static void update_pickaxe(afterhours::Entity& entity, const RepoComponent& repo,
+                               CommitSearchState& state, bool regex,
+                               const std::string& pattern) {
+        auto now = std::chrono::steady_clock::now();
+        if (state.pickaxeQuery != state.query) {
+            stop_pickaxe(state);
+            state.pickaxeQuery = state.query;
+            state.pickaxePattern = pattern;
+            state.results.clear();
+            state.resultsValid = false;
+            state.pickaxeCapped = false;
+            state.pickaxeError.clear();
+            if (!pattern.empty()) state.pickaxeDueAt = now + PICKAXE_DEBOUNCE;
+            return;
+        }
+        if (state.pickaxeDueAt == std::chrono::steady_clock::time_point{} ||
+            now < state.pickaxeDueAt || repo.repoPath.empty()) {
+            return;
+        }
+        state.pickaxeDueAt = {};
+        start_pickaxe(entity, repo.repoPath, state, regex, pattern);
+    }
+
+    static void start_pickaxe(afterhours::Entity& entity, const std::string& repoPath,
+                              CommitSearchState& state, bool regex,
+                              const std::string& pattern) {
+        uint64_t ticket = state.nextPickaxeTicket++;
+        auto cancel = std::make_shared<std::atomic<bool>>(false);
+        state.pickaxeTicket = ticket;
+        state.pickaxeCancel = cancel;
+
+        run_in_background([id = entity.id, repoPath, pattern, regex, ticket, cancel]() {
+            constexpr size_t MAX = CommitSearchState::MAX_PICKAXE_RESULTS;
+            std::string pending;  // Partial line
+            std::vector<CommitEntry> batch;
+            size_t found = 0;
+            auto lastPost = std::chrono::steady_clock::now();
+
+            auto post = [&](bool done, std::string error) {
+                post_completion(id, [commits = std::move(batch), ticket, done,
+                                     capped = found >= MAX,
+                                     error = std::move(error)](afterhours::Entity& e) mutable {
+                    if (!e.has<CommitSearchState>()) return;
+                    auto& s = e.get<CommitSearchState>();
+                    if (s.pickaxeTicket != ticket) return;
+                    s.results.insert(s.results.end(), std::make_move_iterator(commits.begin()),
+                                     std::make_move_iterator(commits.end()));
+                    if (!done) return;
+                    s.pickaxeTicket = 0;
+                    s.pickaxeCancel.reset();
+                    s.pickaxeCapped = capped;
+                    s.pickaxeError = std::move(error);
+                });
+                batch = {};
+                lastPost = std::chrono::steady_clock::now();
+            };
+            auto take = [&](std::string_view lines) {
+                for (auto& c : git::parse_log(std::string(lines))) {
+                    if (found == MAX) break;
+                    batch.push_back(std::move(c));
+                    ++found;
+                }
+            };
+
+            auto result = git::git_log_pickaxe_stream(
+                repoPath, pattern, regex,
+                [&](std::string_view chunk) {
+                    pending.append(chunk);
+                    size_t end = pending.rfind('\n');
+                    if (end == std::string::npos) return true;
+                    take(std::string_view(pending).substr(0, end + 1));
+                    pending.erase(0, end + 1);
+                    if (found >= MAX) return false;
+                    if (!batch.empty() &&
+                        std::chrono::steady_clock::now() - lastPost >= PICKAXE_BATCH_INTERVAL) {
+                        post(false, {});
+                    }
+                    return true;
+                },
+                cancel.get());
+            if (cancel->load()) return;  // Superseded; nobody is waiting
+            if (found < MAX && !pending.empty()) take(pending);
+
+            std::string error;
+            if (!result.success() && found < MAX) {
+                error = result.stderr_str();
+                error = error.substr(0, error.find('\n'));
+                if (error.empty()) error = "git log failed";
+            }
+            post(true, std::move(error));
+        });
+    }
+
+    static void refresh(afterhours::Entity& entity, const RepoComponent& repo,
+                        CommitSearchState& state) {
+        const std::string& head = repo.headCommitHash;
+        if (repo.repoPath.empty() || head.empty() || state.loadTicket != 0) return;
+
+        if (state.repoPath != repo.repoPath) {
+            state.index.reset();
+            state.indexedHead.clear();
+            state.failed = false;
+            ++state.indexVersion;
+        } else if (state.index && state.indexedHead == head) {
+            return;
+        } else if (state.failed && state.headHash == head) {
+            return;  // Retried when HEAD moves
+        }
+
+        uint64_t ticket = state.nextLoadTicket++;
+        state.loadTicket = ticket;
+        state.repoPath = repo.repoPath;
+        state.headHash = head;
+        std::string base = state.index ? state.indexedHead : std::string{};
+
+        run_in_background([id = entity.id, repoPath = repo.repoPath, head, base, ticket]() {
+            // Fast-forward: only the new commits' records come back.  They
+            // are indexed here into a batch the UI thread merely appends;
+            // a long catch-up goes through load_index() instead.
+            if (!base.empty() &&
+                git::git_is_ancestor(repoPath, base, head).exit_code() == 0) {
+                auto batch = std::make_shared<CommitSearchIndex>();
+                CommitSearchIndex::Ingest ingest(*batch);
+                auto result = git::git_log_search_stream(
+                    repoPath, base + ".." + head, [&](std::string_view chunk) {
+                        ingest.feed(chunk);
+                        return ingest.added() <= MAX_CATCH_UP;
+                    });
+                ingest.finish();
+                if (result.success() && ingest.added() <= MAX_CATCH_UP) {
+                    post_completion(id, [batch, head, ticket](afterhours::Entity& e) {
+                        if (!e.has<CommitSearchState>()) return;
+                        auto& s = e.get<CommitSearchState>();
+                        if (s.loadTicket != ticket || !s.index) return;
+                        s.loadTicket = 0;
+                        if (!s.index->append(*batch)) {
+                            s.index.reset();  // Hash format changed; reload
+                            s.indexedHead.clear();
+                            ++s.indexVersion;
+                            return;
+                        }
+                        s.index->seal();
+                        s.indexedHead = head;
+                        ++s.indexVersion;
+                    });
+                    return;
+                }
+            }
+
+            auto index = commit_search_detail::load_index(repoPath, head);
+            post_completion(id, [index, head, ticket](afterhours::Entity& e) {
+                if (!e.has<CommitSearchState>()) return;
+                auto& s = e.get<CommitSearchState>();
+                if (s.loadTicket != ticket) return;
+                s.loadTicket = 0;
+                s.failed = index == nullptr;
+                if (index) {
+                    s.index = index;
+                    s.indexedHead = head;
+                }
+                ++s.indexVersion;
+            });
+        });
+    }
+
+    static void update_results(const RepoComponent& repo, CommitSearchState& state) {
+        if (state.resultsValid && state.resultsQuery == state.query &&
+            state.resultsVersion == state.indexVersion) {
+            return;
+        }
+        state.results.clear();
+        if (state.index) {
+            auto query = CommitSearchIndex::parse_query(state.query);
+            if (!query.empty()) {
+                for (auto id : state.index->search(query, CommitSearchState::MAX_RESULTS)) {
+                    state.results.push_back(
+                        commit_search_detail::make_entry(repo, *state.index, id));
+                }
+            }
+        }
+        state.resultsQuery = state.query;
+        state.resultsVersion = state.indexVersion;
+        state.resultsValid = true;
+    }
+};
+
+} // namespace ecs
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <functional>
+
+#include "../../vendor/afterhours/src/core/entity_helper.h"
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../util/completion_queue.h"
+#include "../util/frame_scheduler.h"
+
+namespace ecs {
+
+// A finished piece of background work, addressed to the entity that asked
+// for it.  `apply` runs on the UI thread with that entity; if the entity is
+// gone by then (e.g. its tab was closed) the completion is dropped.
+struct Completion {
+    afterhours::EntityID owner{0};
+    std::function<void(afterhours::Entity&)> apply;
+};
+
+// Process-wide queue: workers can't see the ECS, so they post here.
+// Leaked so workers still running at exit can post safely.
+inline MpscQueue<Completion>& completion_queue() {
+    static auto* queue = new MpscQueue<Completion>();
+    return *queue;
+}
+
+// Safe to call from any thread.  Wakes the frame loop if it is idling.
+inline void post_completion(afterhours::EntityID owner,
+                            std::function<void(afterhours::Entity&)> apply) {
+    completion_queue().push(Completion{owner, std::move(apply)});
+    frame_wake().notify();
+}
+
+// Drains the completion queue once per frame and hands each result to its
+// owning entity.  Frames with nothing finished cost one atomic exchange,
+// however many operations are still running.
+struct CompletionDispatchSystem : afterhours::System<> {
+    void once(float) override {
+        completion_queue().drain([](Completion& done) {
+            auto opt = afterhours::EntityHelper::getEntityForID(done.owner);
+            if (!opt.valid()) return;
+            done.apply(opt.asE());
+        });
+    }
+};
+
+}  // namespace ecs
@@ -1,13 +1,26 @@
 #pragma once
 
-#include <future>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../../vendor/afterhours/src/core/base_component.h"
 #include "../../vendor/afterhours/src/core/entity_helper.h"
-
-namespace git { struct GitResult; }
+#include "../ui/diff_display.h"
+#include "../util/command_log_buffer.h"
+#include "../util/commit_graph.h"
+#include "../util/commit_search_index.h"
+#include "../util/file_finder.h"
+#include "../util/file_tree.h"
+#include "../util/git_helpers.h"
+#include "../util/lru_cache.h"
+#include "../util/repo_file_index.h"
 
 namespace ecs {
 
@@ -20,6 +33,20 @@ struct FileStatus {
     std::string origPath;      // For renames
     int additions = 0;
     int deletions = 0;
+    std::string indexHash;     // Index blob (porcelain v2 hI); empty if unknown
+    int64_t worktreeStamp = 0; // Worktree mtime/size fingerprint; 0 if missing
+};
+
+// Paths whose status entries appeared, disappeared or changed in one
+// refresh (git/status_delta.h).
+struct StatusChangeSet {
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    std::vector<std::string> changed;
+
+    bool empty() const {
+        return added.empty() && removed.empty() && changed.empty();
+    }
 };
 
 struct CommitEntry {
@@ -30,6 +57,44 @@ struct CommitEntry {
     std::string authorDate;    // ISO 8601 format
     std::string decorations;   // Branch/tag labels from %D
     std::string parentHashes;  // Space-separated parent hashes from %P
+
+    // Derived once by git::parse_log so row rendering never re-parses.
+    std::time_t authorTime = 0;                     // authorDate as epoch seconds
+    std::vector<git_helpers::Decoration> badges;    // Typed decorations
+    int bestBadge = -1;                             // Index into badges, or -1
+};
+
+// Loaded history, newest first.  A deque so a refresh can put new commits
+// in front without moving the ones already loaded.
+using CommitLog = std::deque<CommitEntry>;
+
+// Lookups over a CommitLog (see repo_index.h): hash -> row, and which rows
+// carry decorations, so a ref tip update touches only those.  Rows are
+// stored as keys offset by `base` (unsigned, so it wraps): putting commits
+// in front lowers the base instead of renumbering every entry.
+struct CommitIndex {
+    std::unordered_map<std::string, size_t> keys;  // Hash -> row + base
+    std::vector<size_t> decorated;                 // Keys, in no order
+    size_t base = 0;
+
+    size_t key(size_t row) const { return row + base; }
+    size_t row_of_key(size_t key) const { return key - base; }
+    // Row of `hash`, or SIZE_MAX if it isn't indexed.
+    size_t row(const std::string& hash) const {
+        auto it = keys.find(hash);
+        return it == keys.end() ? SIZE_MAX : it->second - base;
+    }
+    bool contains(const std::string& hash) const { return keys.contains(hash); }
+    size_t size() const { return keys.size(); }
+
+    // Index `commit` at `row`; false if its hash already is.
+    bool add(const CommitEntry& commit, size_t row) {
+        if (!keys.emplace(commit.hash, key(row)).second) return false;
+        if (!commit.decorations.empty()) decorated.push_back(key(row));
+        return true;
+    }
+    // `count` rows are going in front: every indexed row moves down.
+    void shift(size_t count) { base -= count; }
 };
 
 struct DiffHunk {
@@ -48,6 +113,8 @@ struct FileDiff {
     bool isDeleted = false;
     bool isRenamed = false;
     bool isBinary = false;
+    std::string oldBlob;       // From the "index" line; empty if none / all-zero
+    std::string newBlob;
     std::vector<DiffHunk> hunks;
 };
 
@@ -74,31 +141,321 @@ struct RepoComponent : public afterhours::BaseComponent {
     std::vector<FileStatus> stagedFiles;
     std::vector<FileStatus> unstagedFiles;
     std::vector<std::string> untrackedFiles;
-    std::vector<CommitEntry> commitLog;
+    CommitLog commitLog;
     int commitLogLoaded = 0;
     bool commitLogHasMore = true;
+    // Rows an incremental refresh put in front of the loaded log; the
+    // sidebar shifts its scroll offset by this much and resets it.
+    int commitLogPrepended = 0;
+    // Pagination cursor (see git/log_update.h): empty once the root
+    // commits are loaded.  The sidebar sets commitLogPageRequested as the
+    // user scrolls near the end; AsyncGitDataRefreshSystem loads the page.
+    std::vector<std::string> commitLogFrontier;
+    bool commitLogPageRequested = false;
+    bool commitLogPageLoading = false;
+    // Fingerprint of the refs and HEAD the log's decorations reflect; a
+    // refresh only re-reads ref tips when it changes.  0 if unknown.
+    size_t commitLogRefs = 0;
 
     // Branch data (T031)
     std::vector<BranchInfo> branches;
 
     std::string selectedFilePath;
     std::string selectedCommitHash;
+    // Unstaged changes from `git diff --numstat`: paths and line counts
+    // only, no hunks.
     std::vector<FileDiff> currentDiff;
+    unsigned diffVersion = 0;  // Bumped whenever currentDiff is replaced
+
+    // What the last status refresh changed in each list; entries not
+    // listed kept their values.  statusVersion is bumped on every change;
+    // the change sets describe the step from statusChangesFrom to
+    // statusVersion (replacing the lists wholesale sets both equal, so
+    // consumers know to rebuild).
+    StatusChangeSet stagedChanges;
+    StatusChangeSet unstagedChanges;
+    StatusChangeSet untrackedChanges;
+    unsigned statusVersion = 0;
+    unsigned statusChangesFrom = 0;
+
+    // Hunks for single files, keyed by repo-relative path and loaded on
+    // demand by WorkingDiffLoaderSystem for the selected file and its
+    // neighbours.  A status refresh drops just the changed paths.
+    // A null entry means "no diff".
+    static constexpr size_t FILE_DIFF_BUDGET_BYTES = 16u * 1024u * 1024u;
+    LruCache<std::string, std::shared_ptr<const FileDiff>> fileDiffCache{
+        FILE_DIFF_BUDGET_BYTES};
+    // Loads in flight, path -> ticket.  Invalidating a path drops its
+    // ticket so a load that started before the change is discarded.
+    std::unordered_map<std::string, uint64_t> fileDiffLoading;
+    uint64_t nextFileDiffTicket = 1;
+
+    void invalidate_file_diff(const std::string& path) {
+        fileDiffCache.erase(path);
+        fileDiffLoading.erase(path);
+    }
+
+    // Selection lookups (see repo_index.h); kept in step with the data above.
+    CommitIndex commitIndex;
+    std::unordered_map<std::string, size_t> diffIndexByPath;
 
     std::string cachedFilePath;
 
     bool refreshRequested = false;
     bool isRefreshing = false;
+    unsigned refreshGeneration = 0;  // Results from older refreshes are dropped
+    int refreshOpsPending = 0;       // Outstanding parts of the current refresh
     bool hasLoadedOnce = false;
     unsigned repoVersion = 0;
 };
 
+// Everything the commit detail view needs for one commit beyond its log
+// entry.  Built off the UI thread by CommitDetailLoaderSystem and shared
+// (immutable) between CommitDetailStore and every tab showing it.
+struct CommitDetail {
+    std::string hash;
+    std::vector<FileDiff> diff;
+    std::string body;
+    std::string authorEmail;
+    std::string parents;
+    ui::DiffDisplayModel model;
+};
+
 struct CommitDetailCache : public afterhours::BaseComponent {
-    std::string cachedCommitHash;
-    std::vector<FileDiff> commitDetailDiff;
-    std::string commitDetailBody;
-    std::string commitDetailAuthorEmail;
-    std::string commitDetailParents;
+    std::string cachedCommitHash;   // Commit `detail` (or `error`) describes
+    std::string shownCommitHash;    // Commit the view last rendered
+    std::shared_ptr<const CommitDetail> detail;
+    std::string error;              // Loading it failed; retried on reselect
+    std::string dateLabel;                 // "<iso date> (3d ago)"
+    std::time_t dateLabelValidUntil = 0;   // Rebuild dateLabel at/after this
+    // Side-by-side rows for `detail`, built on first use in the split view
+    std::string splitModelHash;
+    ui::DiffDisplayModel splitModel;
+};
+
+// Recently viewed commit details, shared across tabs and keyed by repo
+// path + hash.  Lives on the editor entity; bounded by approximate parsed
+// size so large commits push out older ones.
+struct CommitDetailStore : public afterhours::BaseComponent {
+    static constexpr size_t DEFAULT_BUDGET_BYTES = 64u * 1024u * 1024u;
+
+    LruCache<std::string, std::shared_ptr<const CommitDetail>> cache{
+        DEFAULT_BUDGET_BYTES};
+    std::unordered_set<std::string> loading;  // Keys with a load in flight
+    // Keys whose last load failed, with git's error.  Never cached: the
+    // next selection of the commit loads it again.
+    std::unordered_map<std::string, std::string> failed;
+
+    static std::string key(const std::string& repoPath,
+                           const std::string& hash) {
+        return repoPath + '\n' + hash;
+    }
+};
+
+// Display model for the selected working-tree file, rebuilt only when the
+// selection or its fileDiffCache entry changes (checked when
+// RepoComponent::diffVersion moves).
+struct DiffViewCache : public afterhours::BaseComponent {
+    std::string filePath;
+    unsigned diffVersion = 0;
+    bool valid = false;
+    bool loading = false;  // Selected file's hunks not loaded yet
+    std::shared_ptr<const FileDiff> source;  // fileDiffCache entry shown
+    std::vector<FileDiff> diffs;
+    ui::DiffDisplayModel model;
+    // Side-by-side rows for the same diffs, built the first time the split
+    // view shows them and dropped whenever `model` is rebuilt.
+    ui::DiffDisplayModel splitModel;
+    bool splitValid = false;
+};
+
+// Intra-line highlights for the diff on screen, computed off the UI
+// thread by WordDiffSystem.  Entries are keyed by the immutable diff they
+// were computed from (a fileDiffCache entry or a CommitDetail) and hold on
+// to it, so a refresh that replaces the diff misses and a key can't be
+// reused while cached.
+struct WordDiffCache : public afterhours::BaseComponent {
+    static constexpr size_t BUDGET_BYTES = 8u * 1024u * 1024u;
+
+    struct Entry {
+        std::shared_ptr<const void> source;
+        std::shared_ptr<const ui::DiffWordHighlights> highlights;
+    };
+
+    LruCache<const void*, Entry> cache{BUDGET_BYTES};
+    std::shared_ptr<const void> pending;  // Diff being computed, if any
+    std::shared_ptr<const void> shownSource;  // Held so its address stays unique
+    std::shared_ptr<const ui::DiffWordHighlights> shown;
+
+    // Highlights for `source` if they are ready; the renderer never waits.
+    const ui::DiffWordHighlights* ready_for(const void* source) const {
+        return source && source == shownSource.get() ? shown.get() : nullptr;
+    }
+};
+
+// Syntax colors for the diff on screen, highlighted off the UI thread by
+// SyntaxHighlightSystem.  `images` keeps highlighted pre/post-images by
+// blob id, so a blob several diffs share (a file touched by neighbouring
+// commits, the index side of a working-tree diff) is highlighted once.
+struct SyntaxCache : public afterhours::BaseComponent {
+    static constexpr size_t BUDGET_BYTES = 16u * 1024u * 1024u;
+
+    LruCache<std::string, std::shared_ptr<const syntax::Highlighted>> images{BUDGET_BYTES};
+    std::shared_ptr<const void> pending;      // Diff being highlighted, if any
+    std::shared_ptr<const void> shownSource;  // Held so its address stays unique
+    std::shared_ptr<const ui::DiffSyntax> shown;
+
+    // Colors for `source` if they are ready; the renderer never waits.
+    const ui::DiffSyntax* ready_for(const void* source) const {
+        return source && source == shownSource.get() ? shown.get() : nullptr;
+    }
+};
+
+// Sidebar Tree view model, one tree per status list.  Built when the Tree
+// view is first shown, then kept current from RepoComponent's status
+// change sets rather than rebuilt each frame.
+struct FileTreeCache : public afterhours::BaseComponent {
+    FileTree staged;
+    FileTree unstaged;
+    FileTree untracked;
+
+    // A tree's visible rows in display order, re-flattened when its
+    // version() moves, so a frame only builds the rows in view.
+    struct Rows {
+        std::vector<FileTree::NodeId> ids;
+        uint64_t version = UINT64_MAX;
+    };
+    Rows stagedRows, unstagedRows, untrackedRows;
+
+    std::string repoPath;
+    unsigned statusVersion = 0;
+    bool valid = false;
+};
+
+// Sidebar "All" view: every tracked file, streamed from `git ls-files -z`
+// by RepoFileIndexSystem while the view is shown, and reloaded when HEAD
+// moves or the staged set gains or loses paths.  The change overlay maps
+// RepoComponent's staged/unstaged entries onto it.
+struct RepoFileIndexCache : public afterhours::BaseComponent {
+    std::shared_ptr<const RepoFileIndex> index;
+    bool failed = false;         // Last load couldn't list the files
+    std::string repoPath;        // What `index` was loaded for
+    std::string headHash;
+    unsigned statusVersion = 0;
+    bool wanted = false;         // Set each frame the view is on screen
+    uint64_t loadTicket = 0;     // Load in flight; 0 when idle
+    uint64_t nextLoadTicket = 1;
+    std::unordered_set<RepoFileIndex::NodeId> expanded;
+    std::string reveal;          // Path to expand down to once loaded
+
+    // The rows `index` shows with `expanded` open, in display order, so a
+    // frame only builds the ones in view.  Cleared (rowsValid = false)
+    // whenever either changes.
+    std::vector<RepoFileIndex::NodeId> rows;
+    bool rowsValid = false;
+
+    // Status letter per changed path, and changed-file counts per
+    // directory ("" is the root).
+    std::unordered_map<std::string, char> changedFiles;
+    std::unordered_map<std::string, uint32_t> changedDirs;
+    std::string overlayRepoPath;
+    unsigned overlayVersion = 0;
+    bool overlayValid = false;
+};
+
+// Quick-open panel ("Go to File", Cmd+P).  The finder holds tracked files,
+// streamed from `git ls-files -z` the first time the panel opens, plus
+// untracked ones; FileFinderIndexSystem then keeps it current from status
+// deltas and reloads it when HEAD moves.
+struct FileFinderCache : public afterhours::BaseComponent {
+    static constexpr size_t MAX_RESULTS = 50;
+
+    std::shared_ptr<FileFinder> finder;
+    bool failed = false;
+    std::string repoPath;         // What `finder` was loaded for
+    std::string headHash;
+    unsigned statusVersion = 0;   // Status deltas applied up to here
+    uint64_t loadTicket = 0;      // Load in flight; 0 when idle
+    uint64_t nextLoadTicket = 1;
+    unsigned finderVersion = 0;   // Bumped whenever `finder` changes
+
+    bool open = false;
+    bool focusPending = false;    // Focus the query input next frame
+    bool submitRequested = false; // Enter pressed in the query input
+    std::string query;
+    std::vector<std::string> results;
+    std::string resultsQuery;     // Query and finder version `results` is for
+    unsigned resultsVersion = 0;
+    bool resultsValid = false;
+    int selected = 0;
+    uint64_t searchTicket = 0;    // Search in flight; 0 when idle
+    uint64_t nextSearchTicket = 1;
+    std::shared_ptr<std::atomic<bool>> searchCancel;
+    int searchWorkers = 0;        // Workers still reading `finder`, cancelled or not
+    std::string searchQuery;      // Query and finder version in flight
+    unsigned searchVersion = 0;
+
+    void show() {
+        open = true;
+        focusPending = true;
+        query.clear();
+        resultsValid = false;
+        selected = 0;
+    }
+};
+
+// Lane layout for the commit log's graph column.  CommitGraphSystem
+// extends it as pages are appended or a fast-forward prepends commits,
+// and rebuilds it when the log is replaced; `window` is the sidebar's
+// per-frame scratch for the visible rows.
+struct CommitGraphCache : public afterhours::BaseComponent {
+    CommitGraph graph;
+    std::string firstHash;  // commitLog[0] and the last row laid out, to
+    std::string lastHash;   // tell an append from a replacement
+    CommitGraph::Window window;
+};
+
+// Commit search box above the commit log.  The index covers HEAD's
+// history; it is loaded (or built) on a worker the first time a query is
+// typed, persisted per repository, and caught up when HEAD moves.
+//
+// A query starting with "-S " or "-G " searches content instead: `git log
+// -S/-G` runs on a worker and its matches are appended to `results` as
+// they stream in.  Changing the query cancels the run.
+struct CommitSearchState : public afterhours::BaseComponent {
+    static constexpr size_t MAX_RESULTS = 500;
+    static constexpr size_t MAX_PICKAXE_RESULTS = 200;
+
+    std::string query;
+    std::shared_ptr<CommitSearchIndex> index;
+    bool failed = false;
+    std::string repoPath;          // What `index` was loaded for
+    std::string indexedHead;       // Commit `index` covers up to
+    std::string headHash;          // HEAD when the last load started
+    uint64_t loadTicket = 0;       // Load in flight; 0 when idle
+    uint64_t nextLoadTicket = 1;
+    unsigned indexVersion = 0;     // Bumped whenever `index` changes
+
+    std::vector<CommitEntry> results;
+    std::string resultsQuery;      // Query and index version `results` is for
+    unsigned resultsVersion = 0;
+    bool resultsValid = false;
+
+    std::string pickaxeQuery;      // Content search `results` belong to, or ""
+    std::string pickaxePattern;    // Its -S/-G argument; "" until typed
+    std::chrono::steady_clock::time_point pickaxeDueAt;  // Debounced start, or {}
+    uint64_t pickaxeTicket = 0;    // Run in flight; 0 when idle
+    uint64_t nextPickaxeTicket = 1;
+    std::shared_ptr<std::atomic<bool>> pickaxeCancel;
+    bool pickaxeCapped = false;    // Stopped at MAX_PICKAXE_RESULTS
+    std::string pickaxeError;      // git's complaint, e.g. a bad -G regex
+
+    bool pickaxe_searching() const {
+        return pickaxeTicket != 0 ||
+               pickaxeDueAt != std::chrono::steady_clock::time_point{};
+    }
+
+    bool active() const { return query.find_first_not_of(' ') != std::string::npos; }
 };
 
 struct BranchDialogState : public afterhours::BaseComponent {
@@ -126,6 +483,7 @@ struct LayoutComponent : public afterhours::BaseComponent {
 
     bool sidebarVisible = true;
     bool commandLogVisible = false;
+    bool profilerVisible = false;  // Frame profiler overlay
 
     float commandLogHeight = 200.0f;
 
@@ -168,15 +526,10 @@ struct MenuComponent : public afterhours::BaseComponent {
     std::string pendingToast;
 };
 
+// Executed git commands.  The buffer is shared with the git log callback,
+// which records from worker threads.
 struct CommandLogComponent : public afterhours::BaseComponent {
-    struct Entry {
-        std::string command;
-        std::string output;
-        std::string error;
-        bool success = false;
-        double timestamp = 0.0;
-    };
-    std::vector<Entry> entries;
+    std::shared_ptr<CommandLogBuffer> log = std::make_shared<CommandLogBuffer>();
 };
 
 // ---- Tab Components ----
@@ -196,17 +549,11 @@ struct TabStripComponent : public afterhours::BaseComponent {
     std::vector<afterhours::EntityID> tabOrder;
 };
 
-// Tracks in-flight network git operations (push/pull/fetch) so the UI
-// thread is never blocked.  Fire-and-forget: the polling system handles
-// completion, toast notifications, and refresh triggers.
-struct PendingNetworkOp {
-    std::string label;
-    std::future<git::GitResult> future;
-    afterhours::EntityID tabId{0};
-};
-
+// Counts in-flight network git operations (push/pull/fetch) so the UI
+// thread is never blocked.  Fire-and-forget: each op posts its result to
+// the completion queue, which shows a toast and triggers a refresh.
 struct NetworkOpsComponent : public afterhours::BaseComponent {
-    std::vector<PendingNetworkOp> pending;
+    int inFlight = 0;
 };
 
 } // namespace ecs
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <unistd.h>
 
@@ -15,9 +16,12 @@
 #include "app_reset.h"
 #include "components.h"
 #include "query_helpers.h"
+#include "repo_index.h"
 #include "tab_bar_system.h"
 #include "../git/git_parser.h"
 #include "../git/git_runner.h"
+#include "../git/log_update.h"
+#include "../ui/commit_detail.h"
 #include "../util/process.h"
 
 struct SkipResizeCommand : afterhours::System<afterhours::testing::PendingE2ECommand> {
@@ -113,14 +117,20 @@ struct HandleMakeTestRepo : afterhours::System<afterhours::testing::PendingE2ECo
             repo.selectedFilePath.clear();
             repo.cachedFilePath.clear();
             repo.selectedCommitHash.clear();
+            // Hunk cache is keyed by path alone
+            repo.fileDiffCache.clear();
+            repo.fileDiffLoading.clear();
 
             auto* detailCache = ecs::find_singleton<ecs::CommitDetailCache, ecs::ActiveTab>();
             if (detailCache) {
                 detailCache->cachedCommitHash.clear();
-                detailCache->commitDetailDiff.clear();
-                detailCache->commitDetailBody.clear();
-                detailCache->commitDetailAuthorEmail.clear();
-                detailCache->commitDetailParents.clear();
+                detailCache->detail.reset();
+                detailCache->error.clear();
+            }
+
+            auto* diffView = ecs::find_singleton<ecs::DiffViewCache, ecs::ActiveTab>();
+            if (diffView) {
+                diffView->valid = false;
             }
 
             auto* branchDialog = ecs::find_singleton<ecs::BranchDialogState, ecs::ActiveTab>();
@@ -163,18 +173,42 @@ struct HandleMakeTestRepo : afterhours::System<afterhours::testing::PendingE2ECo
                 repo.isDirty = !repo.stagedFiles.empty() ||
                                !repo.unstagedFiles.empty() ||
                                !repo.untrackedFiles.empty();
+                // Replaced wholesale: no delta to apply
+                repo.statusChangesFrom = ++repo.statusVersion;
+                repo.stagedChanges = {};
+                repo.unstagedChanges = {};
+                repo.untrackedChanges = {};
             }
 
             auto logResult = git::git_log(repoPath, 100, 0);
             if (logResult.success()) {
-                repo.commitLog = git::parse_log(logResult.stdout_str());
+                repo.commitLog =
+                    git::make_commit_log(git::parse_log(logResult.stdout_str()));
+                ecs::rebuild_commit_index(repo);
+                repo.commitLogFrontier =
+                    git::log_frontier(repo.commitLog, repo.commitIndex);
                 repo.commitLogLoaded = static_cast<int>(repo.commitLog.size());
-                repo.commitLogHasMore = (repo.commitLogLoaded >= 100);
+                repo.commitLogHasMore = !repo.commitLogFrontier.empty();
+                repo.commitLogRefs = 0;  // Re-read tips on the next refresh
             }
 
+            auto numstatResult = git::git_diff_numstat(repoPath);
+            if (numstatResult.success()) {
+                repo.currentDiff = git::parse_numstat(numstatResult.stdout_str());
+                ecs::rebuild_diff_index(repo);
+                repo.diffVersion++;
+            }
+            // Seed the per-file hunk cache so screenshots never catch the
+            // loading state for tracked files.
             auto diffResult = git::git_diff(repoPath);
             if (diffResult.success()) {
-                repo.currentDiff = git::parse_diff(diffResult.stdout_str());
+                for (auto& d : git::parse_diff(diffResult.stdout_str())) {
+                    std::string key(ecs::normalize_repo_path(repoPath, d.filePath));
+                    size_t bytes = key.size() + ecs::commit_detail_view::approx_bytes(d);
+                    repo.fileDiffCache.put(
+                        key, std::make_shared<const ecs::FileDiff>(std::move(d)),
+                        bytes);
+                }
             }
 
             auto branchResult = git::git_branch_list(repoPath);
@@ -194,6 +228,9 @@ struct HandleMakeTestRepo : afterhours::System<afterhours::testing::PendingE2ECo
 
             repo.isRefreshing = false;
             repo.refreshRequested = false;
+            // Drop results still in flight from a refresh of the old repo
+            repo.refreshGeneration++;
+            repo.refreshOpsPending = 0;
             repo.hasLoadedOnce = true;
             repo.repoVersion++;
         } else {
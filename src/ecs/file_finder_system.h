@@ -0,0 +1,382 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../git/git_runner.h"
+#include "../util/background_task.h"
+#include "../util/file_finder.h"
+#include "completion_system.h"
+#include "ui_imports.h"
+
+#include "../../vendor/afterhours/src/plugins/modal.h"
+#include "../../vendor/afterhours/src/plugins/ui/text_input/text_input.h"
+
+namespace ecs {
+
+namespace file_finder_detail {
+
+// Tracked files from the streamed `git ls-files -z`, plus `untracked`.
+// Null if git fails.
+inline std::shared_ptr<FileFinder> load_finder(
+    const std::string& repoPath, const std::vector<std::string>& untracked) {
+    auto finder = std::make_shared<FileFinder>();
+    std::string partial;  // Path split across chunks
+    auto result = git::git_ls_files_stream(repoPath, [&](std::string_view chunk) {
+        while (!chunk.empty()) {
+            size_t nul = chunk.find('\0');
+            if (nul == std::string_view::npos) {
+                partial.append(chunk);
+                break;
+            }
+            if (partial.empty()) {
+                finder->add(chunk.substr(0, nul));
+            } else {
+                partial.append(chunk.substr(0, nul));
+                finder->add(partial);
+                partial.clear();
+            }
+            chunk.remove_prefix(nul + 1);
+        }
+        return true;
+    });
+    if (!result.success()) return nullptr;
+    if (!partial.empty()) finder->add(partial);
+    for (const auto& p : untracked) finder->add(p);
+    finder->reorder();
+    return finder;
+}
+
+// Apply the last status refresh.  Untracked paths follow the untracked
+// list, except that one leaving it to be staged stays; staged additions,
+// renames and deletions change which tracked paths exist.  Anything
+// subtler (checkouts, resets) moves HEAD and reloads the finder instead.
+inline void apply_status_changes(FileFinder& finder, const RepoComponent& repo) {
+    std::unordered_map<std::string_view, const FileStatus*> staged;
+    if (!repo.stagedChanges.empty() || !repo.untrackedChanges.removed.empty()) {
+        staged.reserve(repo.stagedFiles.size());
+        for (const auto& f : repo.stagedFiles) staged.emplace(f.path, &f);
+    }
+
+    for (const auto& p : repo.untrackedChanges.added) finder.add(p);
+    for (const auto& p : repo.untrackedChanges.removed) {
+        if (!staged.contains(p)) finder.remove(p);
+    }
+
+    auto stagedEntry = [&](const std::string& p) {
+        auto it = staged.find(p);
+        if (it == staged.end()) return;
+        const FileStatus& f = *it->second;
+        if (f.indexStatus == 'D') {
+            finder.remove(f.path);
+            return;
+        }
+        finder.add(f.path);
+        if (f.indexStatus == 'R' && !f.origPath.empty()) finder.remove(f.origPath);
+    };
+    for (const auto& p : repo.stagedChanges.added) stagedEntry(p);
+    for (const auto& p : repo.stagedChanges.changed) stagedEntry(p);
+    // Unstaging a deletion puts the path back in the index
+    for (const auto& p : repo.stagedChanges.removed) {
+        for (const auto& f : repo.unstagedFiles) {
+            if (f.path == p) {
+                finder.add(p);
+                break;
+            }
+        }
+    }
+}
+
+inline bool is_changed(const RepoComponent& repo, const std::string& path) {
+    for (const auto& f : repo.stagedFiles) if (f.path == path) return true;
+    for (const auto& f : repo.unstagedFiles) if (f.path == path) return true;
+    for (const auto& p : repo.untrackedFiles) if (p == path) return true;
+    return false;
+}
+
+} // namespace file_finder_detail
+
+// Keeps each tab's FileFinderCache current.  Nothing is indexed until the
+// panel is first opened; after that, status refreshes are applied as
+// deltas and a HEAD move (or a missed refresh) reloads on a worker.
+struct FileFinderIndexSystem
+    : afterhours::System<RepoComponent, FileFinderCache> {
+
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       FileFinderCache& cache, float) override {
+        if (!cache.open && !cache.finder) return;
+        if (repo.repoPath.empty() || cache.loadTicket != 0) return;
+
+        bool sameCommit = cache.repoPath == repo.repoPath &&
+                          cache.headHash == repo.headCommitHash;
+        if (sameCommit && cache.finder) {
+            if (cache.statusVersion == repo.statusVersion) return;
+            if (cache.statusVersion == repo.statusChangesFrom) {
+                // Search workers may be reading the finder, even cancelled
+                // ones; deltas wait for them (results are re-run anyway)
+                if (cache.searchWorkers != 0) return;
+                file_finder_detail::apply_status_changes(*cache.finder, repo);
+                cache.statusVersion = repo.statusVersion;
+                ++cache.finderVersion;
+                return;
+            }
+        }
+        if (sameCommit && cache.failed) return;  // Retried when HEAD moves
+        start(entity, repo, cache);
+    }
+
+   private:
+    static void start(afterhours::Entity& entity, const RepoComponent& repo,
+                      FileFinderCache& cache) {
+        uint64_t ticket = cache.nextLoadTicket++;
+        cache.loadTicket = ticket;
+        if (cache.repoPath != repo.repoPath) {
+            cache.finder.reset();
+            ++cache.finderVersion;
+        }
+        cache.repoPath = repo.repoPath;
+        cache.headHash = repo.headCommitHash;
+        cache.statusVersion = repo.statusVersion;
+
+        run_in_background([id = entity.id, repoPath = repo.repoPath,
+                           untracked = repo.untrackedFiles, ticket]() {
+            auto finder = file_finder_detail::load_finder(repoPath, untracked);
+            post_completion(id, [finder, ticket](afterhours::Entity& e) {
+                if (!e.has<FileFinderCache>()) return;
+                auto& cache = e.get<FileFinderCache>();
+                if (cache.loadTicket != ticket) return;
+                cache.loadTicket = 0;
+                cache.failed = finder == nullptr;
+                if (finder) cache.finder = finder;
+                ++cache.finderVersion;
+            });
+        });
+    }
+};
+
+// The quick-open panel itself: Cmd+P toggles it, typing re-runs the
+// search, Up/Down/Enter or a click open a file.  Changed files are
+// selected (showing their diff); other files are revealed in the
+// sidebar's All view.
+struct FileFinderPanelSystem : afterhours::System<UIContext<InputAction>> {
+    void for_each_with(Entity& /*ctxEntity*/, UIContext<InputAction>& ctx,
+                       float) override {
+        auto* tab = find_singleton_entity<FileFinderCache, ActiveTab>();
+        auto* repo = find_singleton<RepoComponent, ActiveTab>();
+        if (!tab || !repo) return;
+        auto* cache = &tab->get<FileFinderCache>();
+
+        bool cmdDown = afterhours::graphics::is_key_down(343); // LEFT_SUPER
+        if (cmdDown && afterhours::graphics::is_key_pressed(80)) { // P
+            if (cache->open) {
+                cache->open = false;
+            } else {
+                cache->show();
+            }
+        }
+        if (!cache->open) return;
+        render_panel(ctx, *tab, *cache, *repo);
+    }
+
+   private:
+    static void set_results(FileFinderCache& cache, std::vector<std::string> results,
+                            std::string query, unsigned version) {
+        if (cache.resultsQuery != query) cache.selected = 0;
+        cache.results = std::move(results);
+        cache.selected = std::min(cache.selected,
+                                  std::max(0, static_cast<int>(cache.results.size()) - 1));
+        cache.resultsQuery = std::move(query);
+        cache.resultsVersion = version;
+        cache.resultsValid = true;
+    }
+
+    static void stop_search(FileFinderCache& cache) {
+        if (cache.searchCancel) *cache.searchCancel = true;
+        cache.searchCancel.reset();
+        cache.searchTicket = 0;
+    }
+
+    // Searches run on a worker for the latest query: a keystroke cancels
+    // the search still running for the previous one.  The last results
+    // stay up until the new ones land.  Every worker posts back, cancelled
+    // or not, so searchWorkers tells when the finder is free to change.
+    static void update_results(afterhours::Entity& tab, FileFinderCache& cache) {
+        if (cache.resultsValid && cache.resultsQuery == cache.query &&
+            cache.resultsVersion == cache.finderVersion) {
+            return;
+        }
+        if (cache.searchTicket != 0 && cache.searchQuery == cache.query &&
+            cache.searchVersion == cache.finderVersion) {
+            return;
+        }
+        stop_search(cache);
+        if (!cache.finder || cache.query.empty()) {
+            set_results(cache, {}, cache.query, cache.finderVersion);
+            return;
+        }
+
+        uint64_t ticket = cache.nextSearchTicket++;
+        auto cancel = std::make_shared<std::atomic<bool>>(false);
+        cache.searchTicket = ticket;
+        cache.searchCancel = cancel;
+        cache.searchQuery = cache.query;
+        cache.searchVersion = cache.finderVersion;
+        ++cache.searchWorkers;
+
+        run_in_background([id = tab.id, finder = cache.finder, query = cache.query,
+                           version = cache.finderVersion, ticket, cancel]() {
+            std::vector<std::string> results;
+            for (const auto& m : finder->search(query, FileFinderCache::MAX_RESULTS,
+                                                cancel.get())) {
+                results.emplace_back(finder->path(m.id));
+            }
+            post_completion(id, [results = std::move(results), query, version,
+                                 ticket](afterhours::Entity& e) mutable {
+                if (!e.has<FileFinderCache>()) return;
+                auto& c = e.get<FileFinderCache>();
+                --c.searchWorkers;
+                if (c.searchTicket != ticket) return;  // Cancelled or superseded
+                c.searchTicket = 0;
+                c.searchCancel.reset();
+                set_results(c, std::move(results), std::move(query), version);
+            });
+        });
+    }
+
+    static void open_path(FileFinderCache& cache, RepoComponent& repo,
+                          const std::string& path) {
+        cache.open = false;
+        if (file_finder_detail::is_changed(repo, path)) {
+            repo.selectedFilePath = path;
+            repo.selectedCommitHash.clear();
+            return;
+        }
+        auto* layout = find_singleton<LayoutComponent>();
+        auto* index = find_singleton<RepoFileIndexCache, ActiveTab>();
+        if (!layout || !index) return;
+        layout->fileViewMode = LayoutComponent::FileViewMode::All;
+        index->reveal = path;
+    }
+
+    void render_panel(UIContext<InputAction>& ctx, afterhours::Entity& tab,
+                      FileFinderCache& cache, RepoComponent& repo) {
+        using namespace afterhours;
+        using afterhours::ui::h720;
+
+        constexpr int MODAL_ID = 8400;
+        constexpr int CONTENT_LAYER = 1001;
+
+        Entity& uiRoot = ui_imm::getUIRootEntity();
+        auto modalResult = afterhours::modal::detail::modal_impl(
+            ctx, mk(uiRoot, MODAL_ID), cache.open,
+            ModalConfig{}
+                .with_size(w1280(560), h720(420))
+                .with_title("Go to File")
+                .with_show_close_button(false));
+        if (!modalResult) return;
+        auto& modalEnt = modalResult.ent();
+
+        auto input = afterhours::text_input::text_input(ctx, mk(modalEnt, 1),
+            cache.query,
+            ComponentConfig{}
+                .with_size(ComponentSize{percent(1.0f), h720(32)})
+                .with_padding(Padding{
+                    .top = h720(0), .right = w1280(16),
+                    .bottom = h720(0), .left = w1280(16)})
+                .with_custom_background(theme::INPUT_BG)
+                .with_render_layer(CONTENT_LAYER)
+                .with_debug_name("file_finder_input"));
+        input.ent().addComponentIfMissing<afterhours::text_input::HasTextInputListener>(
+            nullptr,
+            [](Entity&) {
+                auto* f = find_singleton<FileFinderCache, ActiveTab>();
+                if (f) f->submitRequested = true;
+            });
+        if (cache.focusPending) {
+            ctx.focus_id = input.ent().id;
+            cache.focusPending = false;
+        }
+
+        update_results(tab, cache);
+        int count = static_cast<int>(cache.results.size());
+        if (afterhours::graphics::is_key_pressed(264) && count > 0) { // DOWN
+            cache.selected = std::min(cache.selected + 1, count - 1);
+        }
+        if (afterhours::graphics::is_key_pressed(265)) { // UP
+            cache.selected = std::max(cache.selected - 1, 0);
+        }
+        if (afterhours::graphics::is_key_pressed(256)) { // ESCAPE
+            cache.open = false;
+            return;
+        }
+
+        std::string status;
+        if (!cache.finder) {
+            status = cache.failed ? "Couldn't list repository files"
+                                  : "Indexing files\xe2\x80\xa6";
+        } else if (cache.query.empty()) {
+            status = std::to_string(cache.finder->size()) + " files";
+        } else if (count == 0) {
+            status = cache.searchTicket != 0 ? "Searching\xe2\x80\xa6"
+                                             : "No matching files";
+        }
+        if (!status.empty()) {
+            div(ctx, mk(modalEnt, 2),
+                preset::MetaText(status)
+                    .with_size(ComponentSize{percent(1.0f), h720(24)})
+                    .with_padding(Padding{
+                        .top = h720(6), .right = w1280(16),
+                        .bottom = h720(0), .left = w1280(16)})
+                    .with_custom_text_color(theme::TEXT_SECONDARY)
+                    .with_render_layer(CONTENT_LAYER)
+                    .with_debug_name("file_finder_status"));
+        }
+
+        auto list = div(ctx, mk(modalEnt, 3),
+            preset::ScrollPanel()
+                .with_size(ComponentSize{percent(1.0f), h720(320)})
+                .with_render_layer(CONTENT_LAYER)
+                .with_debug_name("file_finder_results"));
+
+        int picked = cache.submitRequested && count > 0 ? cache.selected : -1;
+        cache.submitRequested = false;
+        for (int i = 0; i < count; ++i) {
+            const std::string& path = cache.results[i];
+            size_t slash = path.rfind('/');
+            std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+            std::string dir = slash == std::string::npos ? "" : path.substr(0, slash);
+
+            auto row = div(ctx, mk(list.ent(), i),
+                preset::SelectableRow(i == cache.selected)
+                    .with_render_layer(CONTENT_LAYER)
+                    .with_debug_name("file_finder_row"));
+            row.ent().addComponentIfMissing<HasClickListener>([](Entity&){});
+
+            div(ctx, mk(row.ent(), 1),
+                preset::BodyText(name)
+                    .with_size(ComponentSize{children(), children()})
+                    .with_custom_text_color(i == cache.selected
+                                                ? afterhours::Color{255, 255, 255, 255}
+                                                : theme::TEXT_PRIMARY)
+                    .with_render_layer(CONTENT_LAYER)
+                    .with_debug_name("file_finder_name"));
+            div(ctx, mk(row.ent(), 2),
+                preset::MetaText(dir)
+                    .with_size(ComponentSize{expand(), children()})
+                    .with_custom_text_color(theme::TEXT_SECONDARY)
+                    .with_text_overflow(afterhours::ui::TextOverflow::Ellipsis)
+                    .with_render_layer(CONTENT_LAYER)
+                    .with_debug_name("file_finder_dir"));
+
+            if (row.ent().get<HasClickListener>().down) picked = i;
+        }
+
+        if (picked >= 0) open_path(cache, repo, cache.results[picked]);
+    }
+};
+
+} // namespace ecs
@@ -7,6 +7,7 @@
 #include "../ui/command_log.h"
 #include "../ui/commit_detail.h"
 #include "../ui/diff_renderer.h"
+#include "repo_index.h"
 #include "ui_imports.h"
 
 namespace ecs {
@@ -57,28 +58,31 @@ struct MainContentSystem : afterhours::System<UIContext<InputAction>> {
                 repo.cachedFilePath = repo.selectedFilePath;
             }
 
-            std::vector<FileDiff> selectedDiffs;
-            for (auto& d : repo.currentDiff) {
-                if (d.filePath == repo.selectedFilePath ||
-                    d.filePath.ends_with("/" + repo.selectedFilePath) ||
-                    repo.selectedFilePath.ends_with("/" + d.filePath) ||
-                    repo.selectedFilePath.ends_with(d.filePath)) {
-                    selectedDiffs.push_back(d);
-                    break;
-                }
+            auto* diffView = find_singleton<DiffViewCache, ActiveTab>();
+            if (diffView && (!diffView->valid ||
+                             diffView->filePath != repo.selectedFilePath ||
+                             diffView->diffVersion != repo.diffVersion)) {
+                sync_diff_view(repo, *diffView);
             }
-
-            if (selectedDiffs.empty()) {
-                auto synth = build_new_file_diff(repo.repoPath,
-                                                  repo.selectedFilePath);
-                if (synth.has_value()) {
-                    selectedDiffs.push_back(std::move(*synth));
+            bool diffLoading = diffView && diffView->loading;
+
+            if (diffView && !diffView->diffs.empty()) {
+                bool split = layout.diffViewMode ==
+                             LayoutComponent::DiffViewMode::SideBySide;
+                if (split && !diffView->splitValid) {
+                    diffView->splitModel = ui::build_split_diff_display(diffView->diffs);
+                    diffView->splitValid = true;
                 }
-            }
-
-            if (!selectedDiffs.empty()) {
-                ui::render_inline_diff(ctx, mainBg.ent(), selectedDiffs,
-                                       0, 0, false, fileJustChanged);
+                auto* words = find_singleton<WordDiffCache, ActiveTab>();
+                auto* syntax = find_singleton<SyntaxCache, ActiveTab>();
+                const void* source = diffView->source.get();
+                ui::render_inline_diff(ctx, mainBg.ent(), diffView->diffs,
+                                       split ? diffView->splitModel : diffView->model,
+                                       layout.mainContent.width, 0, false,
+                                       fileJustChanged,
+                                       ui::DiffOverlays{
+                                           words ? words->ready_for(source) : nullptr,
+                                           syntax ? syntax->ready_for(source) : nullptr});
             } else {
                 auto noDiffContainer = div(ctx, mk(mainBg.ent(), 3040),
                     ComponentConfig{}
@@ -91,7 +95,9 @@ struct MainContentSystem : afterhours::System<UIContext<InputAction>> {
                         .with_debug_name("no_diff_container"));
                 div(ctx, mk(noDiffContainer.ent(), 3041),
                     ComponentConfig{}
-                        .with_label("No diff available for this file")
+                        .with_label(diffLoading
+                                        ? "Loading diff\xe2\x80\xa6"
+                                        : "No diff available for this file")
                         .with_size(ComponentSize{children(), children()})
                         .with_custom_text_color(theme::TEXT_SECONDARY)
                         .with_font_size(afterhours::ui::FontSize::Large)
@@ -102,7 +108,9 @@ struct MainContentSystem : afterhours::System<UIContext<InputAction>> {
         } else if (hasSelectedCommit) {
             auto* detailCache = find_singleton<CommitDetailCache, ActiveTab>();
             if (detailCache) {
-                render_commit_detail(ctx, mainBg.ent(), repo, *detailCache, layout);
+                render_commit_detail(ctx, mainBg.ent(), repo, *detailCache, layout,
+                                     find_singleton<WordDiffCache, ActiveTab>(),
+                                     find_singleton<SyntaxCache, ActiveTab>());
             }
         } else {
             auto emptyContainer = div(ctx, mk(mainBg.ent(), 3060),
@@ -224,6 +232,46 @@ struct MainContentSystem : afterhours::System<UIContext<InputAction>> {
         }
     }
 
+    // Build the display model once the selected file's hunks are in
+    // fileDiffCache (WorkingDiffLoaderSystem fills it off-thread).  A new
+    // selection shows a loading state until then; a refresh of the same
+    // file keeps the previous hunks on screen until the new ones arrive.
+    void sync_diff_view(RepoComponent& repo, DiffViewCache& view) {
+        std::string key(
+            normalize_repo_path(repo.repoPath, repo.selectedFilePath));
+        const auto* found = repo.fileDiffCache.touch(key);
+        bool samePath = view.filePath == repo.selectedFilePath;
+        if (!found) {
+            if (!samePath || !view.valid) {
+                view.filePath = repo.selectedFilePath;
+                view.valid = false;
+                view.loading = true;
+                view.source.reset();
+                view.diffs.clear();
+                view.model = ui::DiffDisplayModel{};
+                view.splitModel = ui::DiffDisplayModel{};
+                view.splitValid = false;
+            }
+            return;
+        }
+
+        // A refresh that didn't touch this file left its entry in place
+        bool unchanged = samePath && view.valid && view.source == *found;
+        view.filePath = repo.selectedFilePath;
+        view.diffVersion = repo.diffVersion;
+        view.valid = true;
+        view.loading = false;
+        if (unchanged) return;
+
+        view.source = *found;
+        view.diffs.clear();
+        if (*found) view.diffs.push_back(**found);
+        view.model = view.diffs.empty() ? ui::DiffDisplayModel{}
+                                        : ui::build_diff_display(view.diffs);
+        view.splitModel = ui::DiffDisplayModel{};
+        view.splitValid = false;
+    }
+
     void render_sidebar_divider(UIContext<InputAction>& ctx, Entity& uiRoot,
                                  LayoutComponent& layout) {
         float dividerH = layout.mainContent.height;
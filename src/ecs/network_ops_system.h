@@ -1,12 +1,15 @@
 #pragma once
 
-#include <chrono>
+#include <string>
+#include <vector>
 
 #include <afterhours/src/logging.h>
 
+#include "completion_system.h"
 #include "components.h"
 #include "query_helpers.h"
 #include "../git/git_runner.h"
+#include "../util/background_task.h"
 
 namespace ecs {
 
@@ -27,62 +30,58 @@ inline bool toast_on_git_failure(const git::GitResult& result,
     return true;
 }
 
-// Enqueue a network git operation to run on a background thread.
-// The NetworkOpsPollingSystem will poll the future, show a toast on
-// completion/failure, and trigger a repo refresh.
-inline void enqueue_network_op(const std::string& label,
-                               std::future<git::GitResult> fut) {
-    auto* ops = find_singleton<NetworkOpsComponent>();
-    if (!ops) return;
-
-    auto* ent = find_singleton_entity<RepoComponent, ActiveTab>();
-    afterhours::EntityID tabId = ent ? ent->id : 0;
-
-    ops->pending.push_back({label, std::move(fut), tabId});
-}
+// UI thread: consume a finished op, queue a toast via
+// MenuComponent::pendingToast, and refresh the originating tab.
+inline void finish_network_op(NetworkOpsComponent& ops,
+                              const std::string& label,
+                              afterhours::EntityID tabId,
+                              const git::GitResult& result) {
+    ops.inFlight--;
 
-// Polls in-flight network operations each frame.  When a future becomes
-// ready, consumes the result, queues a toast via MenuComponent::pendingToast,
-// and triggers refresh on the originating tab's RepoComponent.
-struct NetworkOpsPollingSystem : afterhours::System<NetworkOpsComponent> {
-    void for_each_with(afterhours::Entity&, NetworkOpsComponent& ops,
-                       float) override {
-        using namespace std::chrono_literals;
+    std::string toastMsg;
+    if (result.success()) {
+        toastMsg = label + " succeeded";
+    } else {
+        toastMsg = label + " failed";
+        auto& err = result.stderr_str();
+        if (!err.empty()) {
+            auto firstLine = err.substr(0, err.find('\n'));
+            if (!firstLine.empty()) {
+                toastMsg += ": " + firstLine;
+            }
+        }
+    }
 
-        for (auto it = ops.pending.begin(); it != ops.pending.end(); ) {
-            if (it->future.wait_for(0s) == std::future_status::ready) {
-                auto result = it->future.get();
-                std::string label = it->label;
-                afterhours::EntityID tabId = it->tabId;
+    auto* menu = find_singleton<MenuComponent>();
+    if (menu) menu->pendingToast = toastMsg;
 
-                std::string toastMsg;
-                if (result.success()) {
-                    toastMsg = label + " succeeded";
-                } else {
-                    toastMsg = label + " failed";
-                    auto& err = result.stderr_str();
-                    if (!err.empty()) {
-                        auto firstLine = err.substr(0, err.find('\n'));
-                        if (!firstLine.empty()) {
-                            toastMsg += ": " + firstLine;
-                        }
-                    }
-                }
+    auto opt = afterhours::EntityHelper::getEntityForID(tabId);
+    if (opt.valid() && opt->has<RepoComponent>()) {
+        opt->get<RepoComponent>().refreshRequested = true;
+    }
+}
 
-                auto* menu = find_singleton<MenuComponent>();
-                if (menu) menu->pendingToast = toastMsg;
+// Run a network git operation (push/pull/fetch) on a background thread.
+// The result comes back through the completion queue: finish_network_op()
+// shows a toast and triggers a refresh on the originating tab.
+inline void enqueue_network_op(const std::string& label,
+                               const std::string& repoPath,
+                               std::vector<std::string> args) {
+    auto* opsEnt = find_singleton_entity<NetworkOpsComponent>();
+    if (!opsEnt) return;
+    opsEnt->get<NetworkOpsComponent>().inFlight++;
 
-                auto opt = afterhours::EntityHelper::getEntityForID(tabId);
-                if (opt.valid() && opt->has<RepoComponent>()) {
-                    opt->get<RepoComponent>().refreshRequested = true;
-                }
+    auto* ent = find_singleton_entity<RepoComponent, ActiveTab>();
+    afterhours::EntityID tabId = ent ? ent->id : 0;
+    afterhours::EntityID opsId = opsEnt->id;
 
-                it = ops.pending.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-};
+    run_in_background([label, repoPath, args = std::move(args), tabId, opsId]() {
+        auto result = git::git_run(repoPath, args);
+        post_completion(opsId, [label, tabId, result](afterhours::Entity& e) {
+            if (!e.has<NetworkOpsComponent>()) return;
+            finish_network_op(e.get<NetworkOpsComponent>(), label, tabId, result);
+        });
+    });
+}
 
 }  // namespace ecs
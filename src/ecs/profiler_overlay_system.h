@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <afterhours/src/logging.h>
+
+#include "../util/frame_profiler.h"
+#include "ui_imports.h"
+
+namespace ecs {
+
+// ProfilerOverlaySystem: per-system frame timings (View > Frame Profiler).
+// Reads the FrameProfiler that main.cpp drives from its system marks and
+// lists the most expensive sections by p99, with entity and allocation
+// counts, followed by hit/miss counts for the LRU caches behind the diff
+// views.  The footer button records a Chrome trace and writes it to
+// `tracePath` on the second click.
+struct ProfilerOverlaySystem : afterhours::System<UIContext<InputAction>> {
+    FrameProfiler* profiler = nullptr;
+    std::string tracePath = "output/profile_trace.json";
+
+    static constexpr int MAX_ROWS = 16;
+    static constexpr int TRACE_BUTTON_ID = 1000;  // Past every row's ID
+    static constexpr uint64_t REFRESH_FRAMES = 30;  // Re-summarize cadence
+    static constexpr float PANEL_W = 520.0f;
+    static constexpr float ROW_H = 18.0f;
+
+    void for_each_with(Entity& /*ctxEntity*/, UIContext<InputAction>& ctx,
+                       float) override {
+        auto* layout = find_singleton<LayoutComponent>();
+        if (!layout || !profiler) return;
+        profiler->set_enabled(layout->profilerVisible);
+        if (!layout->profilerVisible) return;
+
+        if (rows_.empty() || profiler->frames() >= nextRefresh_) {
+            rebuild_rows();
+            nextRefresh_ = profiler->frames() + REFRESH_FRAMES;
+        }
+
+        Entity& uiRoot = ui_imm::getUIRootEntity();
+        float sh = static_cast<float>(afterhours::graphics::get_screen_height());
+        float rowPx = resolve_to_pixels(h720(ROW_H), sh);
+        float panelH = rowPx * static_cast<float>(rows_.size() + 2) + 8.0f;
+        float x = layout->mainContent.x + layout->mainContent.width - PANEL_W - 8.0f;
+        float y = layout->mainContent.y + 8.0f;
+
+        auto panel = div(ctx, mk(uiRoot, 9800),
+            ComponentConfig{}
+                .with_size(ComponentSize{pixels(PANEL_W), pixels(panelH)})
+                .with_absolute_position()
+                .with_translate(x, y)
+                .with_custom_background(afterhours::Color{20, 20, 20, 230})
+                .with_flex_direction(FlexDirection::Column)
+                .with_padding(Padding{
+                    .top = h720(4), .right = w1280(8),
+                    .bottom = h720(4), .left = w1280(8)})
+                .with_roundness(0.0f)
+                .with_render_layer(90)
+                .with_debug_name("profiler_panel"));
+
+        for (size_t i = 0; i < rows_.size(); ++i) {
+            bool header = i == 0 || i == cacheHeaderRow_;
+            div(ctx, mk(panel.ent(), static_cast<int>(i)),
+                ComponentConfig{}
+                    .with_label(rows_[i])
+                    .with_size(ComponentSize{percent(1.0f), pixels(rowPx)})
+                    .with_font("mono", h720(theme::layout::FONT_CODE - 3.0f))
+                    .with_custom_text_color(header ? theme::TEXT_SECONDARY
+                                                   : theme::TEXT_PRIMARY)
+                    .with_alignment(TextAlignment::Left)
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_render_layer(90)
+                    .with_debug_name("profiler_row"));
+        }
+
+        std::string traceLabel =
+            profiler->tracing()
+                ? "Save trace (" + std::to_string(profiler->trace_event_count()) +
+                      " events)"
+                : "Record trace";
+        if (button(ctx, mk(panel.ent(), TRACE_BUTTON_ID),
+                   preset::Button(traceLabel)
+                       .with_size(ComponentSize{children(), pixels(rowPx)})
+                       .with_font_size(FontSize::Medium)
+                       .with_render_layer(90)
+                       .with_debug_name("profiler_trace_btn"))) {
+            toggle_trace();
+        }
+    }
+
+private:
+    std::vector<std::string> rows_;
+    size_t cacheHeaderRow_ = 0;
+    uint64_t nextRefresh_ = 0;
+
+    void rebuild_rows() {
+        auto stats = profiler->summarize(/*countEntities=*/true);
+        std::sort(stats.begin(), stats.end(),
+                  [](const auto& a, const auto& b) { return a.p99Ms > b.p99Ms; });
+
+        rows_.clear();
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "%-28s %7s %7s %6s %7s", "system",
+                      "p50 ms", "p99 ms", "ents", "allocs");
+        rows_.emplace_back(buf);
+        for (const auto& s : stats) {
+            if (static_cast<int>(rows_.size()) > MAX_ROWS) break;
+            std::string ents = s.entities < 0 ? "-" : std::to_string(s.entities);
+            std::snprintf(buf, sizeof(buf), "%-28.28s %7.2f %7.2f %6s %7.0f",
+                          s.name.c_str(), s.p50Ms, s.p99Ms, ents.c_str(),
+                          s.meanAllocs);
+            rows_.emplace_back(buf);
+        }
+
+        cacheHeaderRow_ = rows_.size();
+        std::snprintf(buf, sizeof(buf), "%-20s %7s %7s %5s %6s %9s", "cache", "hits",
+                      "misses", "hit%", "evict", "MB used");
+        rows_.emplace_back(buf);
+        if (auto* store = find_singleton<CommitDetailStore>()) {
+            add_cache_row("commit details", store->cache);
+        }
+        if (auto* repo = find_singleton<RepoComponent, ActiveTab>()) {
+            add_cache_row("file diffs", repo->fileDiffCache);
+        }
+        if (auto* syntax = find_singleton<SyntaxCache, ActiveTab>()) {
+            add_cache_row("syntax images", syntax->images);
+        }
+        if (auto* words = find_singleton<WordDiffCache, ActiveTab>()) {
+            add_cache_row("word diffs", words->cache);
+        }
+    }
+
+    template <typename Cache>
+    void add_cache_row(const char* name, const Cache& cache) {
+        const auto& s = cache.stats();
+        uint64_t lookups = s.hits + s.misses;
+        double hitPct = lookups ? 100.0 * static_cast<double>(s.hits) /
+                                      static_cast<double>(lookups)
+                                : 0.0;
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "%-20.20s %7llu %7llu %4.0f%% %6llu %4.1f/%-4.0f",
+                      name, static_cast<unsigned long long>(s.hits),
+                      static_cast<unsigned long long>(s.misses), hitPct,
+                      static_cast<unsigned long long>(s.evictions),
+                      static_cast<double>(cache.bytes()) / (1024.0 * 1024.0),
+                      static_cast<double>(cache.budget()) / (1024.0 * 1024.0));
+        rows_.emplace_back(buf);
+    }
+
+    void toggle_trace() {
+        if (!profiler->tracing()) {
+            profiler->start_trace();
+            return;
+        }
+        profiler->stop_trace();
+        auto* menu = find_singleton<MenuComponent>();
+        if (profiler->write_chrome_trace(tracePath)) {
+            log_info("profiler: wrote {} trace events to {}",
+                     profiler->trace_event_count(), tracePath);
+            if (menu) menu->pendingToast = "Trace saved to " + tracePath;
+        } else if (menu) {
+            menu->pendingToast = "Could not write " + tracePath;
+        }
+    }
+};
+
+}  // namespace ecs
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../git/git_runner.h"
+#include "../util/background_task.h"
+#include "../util/repo_file_index.h"
+#include "completion_system.h"
+#include "components.h"
+
+namespace ecs {
+
+// Keeps RepoFileIndexCache loaded for the sidebar's "All" view.  Nothing
+// is listed until the view is shown (the sidebar sets `wanted`); then
+// `git ls-files -z` is streamed into a RepoFileIndex on a worker, and
+// reloaded when the repo, HEAD or the set of staged paths changes.  The
+// previous index stays on screen until the new one arrives, and expanded
+// directories carry over by path.
+struct RepoFileIndexSystem
+    : afterhours::System<RepoComponent, RepoFileIndexCache> {
+
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       RepoFileIndexCache& cache, float) override {
+        bool wanted = cache.wanted;
+        cache.wanted = false;
+        if (!wanted || repo.repoPath.empty() || cache.loadTicket != 0) return;
+        if (!stale(repo, cache)) return;
+        start(entity, repo, cache);
+    }
+
+    static std::shared_ptr<const RepoFileIndex> load_index(
+        const std::string& repoPath) {
+        RepoFileIndex::Builder builder;
+        auto result = git::git_ls_files_stream(
+            repoPath, [&](std::string_view chunk) { return builder.feed(chunk); });
+        auto index = std::make_shared<RepoFileIndex>(builder.finish());
+        // Stopping at the memory budget kills git, so that's not a failure
+        if (!result.success() && !index->truncated()) return nullptr;
+        return index;
+    }
+
+   private:
+    // Only staged paths appearing or disappearing change what ls-files
+    // lists; edits and unstaged changes are handled by the overlay.
+    static bool stale(const RepoComponent& repo, const RepoFileIndexCache& cache) {
+        if (!cache.index && !cache.failed) return true;
+        if (cache.repoPath != repo.repoPath) return true;
+        if (cache.headHash != repo.headCommitHash) return true;
+        if (cache.statusVersion == repo.statusVersion) return false;
+        if (cache.statusVersion != repo.statusChangesFrom) return true;
+        return !repo.stagedChanges.added.empty() ||
+               !repo.stagedChanges.removed.empty();
+    }
+
+    static void start(afterhours::Entity& entity, const RepoComponent& repo,
+                      RepoFileIndexCache& cache) {
+        uint64_t ticket = cache.nextLoadTicket++;
+        cache.loadTicket = ticket;
+        // Keyed now, so changes while loading trigger another load
+        bool sameRepo = cache.repoPath == repo.repoPath;
+        if (!sameRepo) {
+            cache.index.reset();
+            cache.expanded.clear();
+            cache.rowsValid = false;
+        }
+        cache.repoPath = repo.repoPath;
+        cache.headHash = repo.headCommitHash;
+        cache.statusVersion = repo.statusVersion;
+
+        run_in_background([id = entity.id, repoPath = repo.repoPath, ticket]() {
+            auto index = load_index(repoPath);
+            post_completion(id, [index, ticket](afterhours::Entity& e) {
+                if (!e.has<RepoFileIndexCache>()) return;
+                auto& cache = e.get<RepoFileIndexCache>();
+                if (cache.loadTicket != ticket) return;
+                cache.loadTicket = 0;
+                cache.failed = index == nullptr;
+                if (!index) return;
+                cache.expanded = remap_expanded(cache, *index);
+                cache.index = index;
+                cache.rowsValid = false;
+            });
+        });
+    }
+
+    static std::unordered_set<RepoFileIndex::NodeId> remap_expanded(
+        const RepoFileIndexCache& cache, const RepoFileIndex& next) {
+        std::unordered_set<RepoFileIndex::NodeId> out;
+        if (!cache.index) return out;
+        for (auto id : cache.expanded) {
+            auto found = next.find(cache.index->path(id));
+            if (found != RepoFileIndex::NONE && next.node(found).isDir) {
+                out.insert(found);
+            }
+        }
+        return out;
+    }
+};
+
+} // namespace ecs
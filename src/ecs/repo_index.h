@@ -0,0 +1,131 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "components.h"
+
+namespace ecs {
+
+// ---- Repo selection indexes ----
+//
+// Hash-map lookups from commit hash to commitLog row and from repo-relative
+// path to currentDiff entry.  Rebuild right after replacing commitLog /
+// currentDiff (git/log_update.h keeps the commit index in step when commits
+// are prepended or appended) so per-frame selection lookups stay O(1)
+// regardless of history or diff size.
+
+// Strip an absolute repo prefix and a leading "./" so selection paths and
+// diff paths compare equal.
+inline std::string_view normalize_repo_path(std::string_view repoPath,
+                                            std::string_view path) {
+    if (!repoPath.empty() && path.size() > repoPath.size() &&
+        path.starts_with(repoPath) && path[repoPath.size()] == '/') {
+        path.remove_prefix(repoPath.size() + 1);
+    }
+    while (path.starts_with("./")) path.remove_prefix(2);
+    return path;
+}
+
+// Index builders take plain vectors so they can run on a worker thread
+// alongside parsing; the results are move-assigned into RepoComponent.
+inline CommitIndex build_commit_index(const CommitLog& commits) {
+    CommitIndex index;
+    index.keys.reserve(commits.size());
+    for (size_t i = 0; i < commits.size(); ++i) index.add(commits[i], i);
+    return index;
+}
+
+inline std::unordered_map<std::string, size_t> build_diff_index(
+    const std::string& repoPath, const std::vector<FileDiff>& diffs) {
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(diffs.size());
+    for (size_t i = 0; i < diffs.size(); ++i) {
+        index.emplace(
+            std::string(normalize_repo_path(repoPath, diffs[i].filePath)), i);
+    }
+    return index;
+}
+
+inline void rebuild_commit_index(RepoComponent& repo) {
+    repo.commitIndex = build_commit_index(repo.commitLog);
+}
+
+inline void rebuild_diff_index(RepoComponent& repo) {
+    repo.diffIndexByPath = build_diff_index(repo.repoPath, repo.currentDiff);
+}
+
+// Row of `hash` in repo.commitLog, or -1 if it isn't loaded.
+inline int find_commit_index(const RepoComponent& repo, const std::string& hash) {
+    size_t row = repo.commitIndex.row(hash);
+    if (row >= repo.commitLog.size()) return -1;
+    return static_cast<int>(row);
+}
+
+inline const CommitEntry* find_commit(const RepoComponent& repo,
+                                      const std::string& hash) {
+    int idx = find_commit_index(repo, hash);
+    return idx < 0 ? nullptr : &repo.commitLog[static_cast<size_t>(idx)];
+}
+
+// Diff entry whose normalized path is exactly `path`, or null.
+inline const FileDiff* find_indexed_file_diff(const RepoComponent& repo,
+                                              const std::string& path) {
+    auto key = normalize_repo_path(repo.repoPath, path);
+    auto it = repo.diffIndexByPath.find(std::string(key));
+    if (it == repo.diffIndexByPath.end() ||
+        it->second >= repo.currentDiff.size()) {
+        return nullptr;
+    }
+    return &repo.currentDiff[it->second];
+}
+
+// Diff entry for a selected path.  Exact (normalized) matches hit the index;
+// suffix matching on a '/' boundary is kept as a fallback for paths that
+// were recorded relative to a different root.
+inline const FileDiff* find_file_diff(const RepoComponent& repo,
+                                      const std::string& path) {
+    if (auto* d = find_indexed_file_diff(repo, path)) return d;
+    for (auto& d : repo.currentDiff) {
+        if (d.filePath.ends_with("/" + path) ||
+            path.ends_with("/" + d.filePath)) {
+            return &d;
+        }
+    }
+    return nullptr;
+}
+
+// The diff MainContentSystem shows: the selected working-tree file if
+// there is one, otherwise the selected commit.  Both are null while it is
+// loading.  Background decorators (word diff, syntax colors) key their
+// results on source(), which stays the same object until the diff is
+// reloaded.
+struct ShownDiff {
+    std::shared_ptr<const FileDiff> file;
+    std::shared_ptr<const CommitDetail> commit;
+
+    std::shared_ptr<const void> source() const {
+        if (file) return file;
+        return commit;
+    }
+    std::span<const FileDiff> diffs() const {
+        if (file) return std::span<const FileDiff>(file.get(), 1);
+        if (commit) return commit->diff;
+        return {};
+    }
+};
+
+inline ShownDiff shown_diff(const RepoComponent& repo, const DiffViewCache& view,
+                            const CommitDetailCache& detail) {
+    ShownDiff shown;
+    if (!repo.selectedFilePath.empty()) {
+        if (view.valid && view.filePath == repo.selectedFilePath) shown.file = view.source;
+    } else if (detail.cachedCommitHash == repo.selectedCommitHash) {
+        shown.commit = detail.detail;
+    }
+    return shown;
+}
+
+} // namespace ecs
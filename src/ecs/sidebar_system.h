@@ -1,8 +1,13 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 #include <ctime>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "../git/git_commands.h"
@@ -73,6 +78,129 @@ inline afterhours::Color status_color(char status) {
     return theme::statusColor(status);
 }
 
+// Status letter shown for a file in the staged or unstaged list
+inline char row_status(const FileStatus& file, bool staged) {
+    char c = staged ? file.indexStatus : file.workTreeStatus;
+    if (c == ' ' || c == '\0') c = staged ? 'A' : 'M';
+    return c;
+}
+
+// ---- Tree view model upkeep ----
+
+inline FileTree::Leaf tree_leaf(const FileStatus& file, bool staged) {
+    return FileTree::Leaf{row_status(file, staged), file.additions,
+                          file.deletions};
+}
+
+inline void build_tree(FileTree& tree, const std::vector<FileStatus>& files,
+                       bool staged) {
+    std::vector<std::pair<std::string_view, FileTree::Leaf>> entries;
+    entries.reserve(files.size());
+    for (const auto& f : files) entries.emplace_back(f.path, tree_leaf(f, staged));
+    tree.build(entries);
+}
+
+inline void build_tree(FileTree& tree, const std::vector<std::string>& paths) {
+    std::vector<std::pair<std::string_view, FileTree::Leaf>> entries;
+    entries.reserve(paths.size());
+    for (const auto& p : paths) entries.emplace_back(p, FileTree::Leaf{'U'});
+    tree.build(entries);
+}
+
+// Apply one list's change set.  Removals go straight to the tree; added
+// and changed entries are looked up in the (already updated) list.
+inline void update_tree(FileTree& tree, const std::vector<FileStatus>& files,
+                        const StatusChangeSet& changes, bool staged) {
+    for (const auto& p : changes.removed) tree.remove(p);
+    if (changes.added.empty() && changes.changed.empty()) return;
+    std::unordered_set<std::string_view> wanted;
+    wanted.reserve(changes.added.size() + changes.changed.size());
+    for (const auto& p : changes.added) wanted.insert(p);
+    for (const auto& p : changes.changed) wanted.insert(p);
+    for (const auto& f : files) {
+        if (wanted.contains(f.path)) tree.upsert(f.path, tree_leaf(f, staged));
+    }
+}
+
+inline void update_tree(FileTree& tree, const StatusChangeSet& changes) {
+    for (const auto& p : changes.removed) tree.remove(p);
+    for (const auto& p : changes.added) tree.upsert(p, FileTree::Leaf{'U'});
+}
+
+// Bring the trees up to date with the status lists: nothing if they
+// already match, the last refresh's deltas if they're one step behind,
+// otherwise a full build.
+inline void sync_file_trees(const RepoComponent& repo, FileTreeCache& cache) {
+    if (cache.valid && cache.repoPath == repo.repoPath) {
+        if (cache.statusVersion == repo.statusVersion) return;
+        if (cache.statusVersion == repo.statusChangesFrom) {
+            update_tree(cache.staged, repo.stagedFiles, repo.stagedChanges, true);
+            update_tree(cache.unstaged, repo.unstagedFiles, repo.unstagedChanges,
+                        false);
+            update_tree(cache.untracked, repo.untrackedChanges);
+            cache.statusVersion = repo.statusVersion;
+            return;
+        }
+    }
+    build_tree(cache.staged, repo.stagedFiles, true);
+    build_tree(cache.unstaged, repo.unstagedFiles, false);
+    build_tree(cache.untracked, repo.untrackedFiles);
+    cache.repoPath = repo.repoPath;
+    cache.statusVersion = repo.statusVersion;
+    cache.valid = true;
+}
+
+// All view: status letters for changed tracked files, and how many sit
+// under each directory.  Untracked files aren't in the index, so they're
+// left out.  Rebuilt only when the status lists change.
+inline void sync_index_overlay(const RepoComponent& repo,
+                               RepoFileIndexCache& cache) {
+    if (cache.overlayValid && cache.overlayRepoPath == repo.repoPath &&
+        cache.overlayVersion == repo.statusVersion) {
+        return;
+    }
+    cache.changedFiles.clear();
+    cache.changedDirs.clear();
+    auto add = [&](const FileStatus& f, bool staged) {
+        // A file changed in both lists shows its worktree status
+        if (!cache.changedFiles.emplace(f.path, row_status(f, staged)).second) return;
+        std::string_view dir = f.path;
+        while (true) {
+            size_t slash = dir.rfind('/');
+            dir = slash == std::string_view::npos ? std::string_view{}
+                                                  : dir.substr(0, slash);
+            ++cache.changedDirs[std::string(dir)];
+            if (dir.empty()) break;
+        }
+    };
+    for (const auto& f : repo.unstagedFiles) add(f, false);
+    for (const auto& f : repo.stagedFiles) add(f, true);
+    cache.overlayRepoPath = repo.repoPath;
+    cache.overlayVersion = repo.statusVersion;
+    cache.overlayValid = true;
+}
+
+// All view: the rows shown with `expanded` directories open, in display
+// order, into `out`.
+inline void flatten_index(const RepoFileIndex& index,
+                          const std::unordered_set<RepoFileIndex::NodeId>& expanded,
+                          std::vector<RepoFileIndex::NodeId>& out) {
+    out.clear();
+    std::vector<std::pair<RepoFileIndex::NodeId, size_t>> stack;  // (dir, next child)
+    stack.emplace_back(RepoFileIndex::ROOT, 0);
+    while (!stack.empty()) {
+        auto& [dir, next] = stack.back();
+        auto kids = index.children(dir);
+        if (next >= kids.size()) {
+            stack.pop_back();
+            continue;
+        }
+        RepoFileIndex::NodeId id = kids[next++];
+        out.push_back(id);
+        if (index.node(id).isDir && expanded.contains(id)) stack.emplace_back(id, 0);
+    }
+}
+
 } // namespace sidebar_detail
 
 // Commit log helpers now live in src/util/git_helpers.h
@@ -234,7 +362,8 @@ struct SidebarSystem : afterhours::System<UIContext<InputAction>> {
             // Render file list directly into filesBg (no intermediate container)
             // to avoid framework bug where nested container children render wrong
             if (repoPtr) {
-                render_file_list(ctx, filesBg.ent(), *repoPtr);
+                render_file_list(ctx, filesBg.ent(), *repoPtr,
+                                 layout.fileViewMode, filesH);
             } else {
                 div(ctx, mk(filesBg.ent(), 2150),
                     ComponentConfig{}
@@ -318,9 +447,24 @@ struct SidebarSystem : afterhours::System<UIContext<InputAction>> {
                     .with_debug_name("log_header"));
         }
 
+        // Search box: a query replaces the log with matching commits
+        auto* search = find_singleton<CommitSearchState, ActiveTab>();
+        if (search) {
+            afterhours::text_input::text_input(ctx, mk(logBg.ent(), 2315),
+                search->query,
+                ComponentConfig{}
+                    .with_size(ComponentSize{logW, h720(26)})
+                    .with_padding(Padding{
+                        .top = h720(0), .right = w1280(8),
+                        .bottom = h720(0), .left = w1280(8)})
+                    .with_custom_background(theme::INPUT_BG)
+                    .with_roundness(0.0f)
+                    .with_debug_name("commit_search_input"));
+        }
+
         // === Scrollable commit log entries ===
         float sh2 = static_cast<float>(afterhours::graphics::get_screen_height());
-        float logHeaderConsumed = resolve_to_pixels(h720(28.0f), sh2);
+        float logHeaderConsumed = resolve_to_pixels(h720(search ? 54.0f : 28.0f), sh2);
         float logScrollH = layout.sidebarLog.height - logHeaderConsumed;
         if (logScrollH < 20.0f) logScrollH = 20.0f;
 
@@ -329,8 +473,11 @@ struct SidebarSystem : afterhours::System<UIContext<InputAction>> {
                 .with_size(ComponentSize{logW, pixels(logScrollH)})
                 .with_debug_name("commit_log_scroll"));
 
-        if (repoPtr) {
-            render_commit_log_entries(ctx, logScroll.ent(), *repoPtr);
+        if (repoPtr && search && search->active()) {
+            render_commit_search_results(ctx, logScroll.ent(), *repoPtr, *search,
+                                         logScrollH);
+        } else if (repoPtr) {
+            render_commit_log_entries(ctx, logScroll.ent(), *repoPtr, logScrollH);
         } else {
             div(ctx, mk(logScroll.ent(), 0),
                 ComponentConfig{}
@@ -959,7 +1106,17 @@ private:
     float sidebarPixelWidth_ = 0; // Set before rendering
     void render_file_list(UIContext<InputAction>& ctx,
                           Entity& scrollParent,
-                          RepoComponent& repo) {
+                          RepoComponent& repo,
+                          LayoutComponent::FileViewMode viewMode,
+                          float viewportPx) {
+        // The All view lists clean files too, so it ignores the empty state
+        if (viewMode == LayoutComponent::FileViewMode::All) {
+            if (auto* index = find_singleton<RepoFileIndexCache, ActiveTab>()) {
+                render_repo_index(ctx, scrollParent, repo, *index, viewportPx);
+                return;
+            }
+        }
+
         bool empty = repo.stagedFiles.empty() &&
                      repo.unstagedFiles.empty() &&
                      repo.untrackedFiles.empty();
@@ -1013,6 +1170,14 @@ private:
             return;
         }
 
+        if (viewMode == LayoutComponent::FileViewMode::Tree) {
+            if (auto* trees = find_singleton<FileTreeCache, ActiveTab>()) {
+                sidebar_detail::sync_file_trees(repo, *trees);
+                render_file_tree(ctx, scrollParent, repo, *trees, viewportPx);
+                return;
+            }
+        }
+
         int nextId = 2600;
         bool firstSection = true;
 
@@ -1053,6 +1218,386 @@ private:
         }
     }
 
+    // Tree view: the same three sections, each as a directory tree.  Only
+    // expanded directories are walked, and only when a tree changes
+    // (FileTreeCache::Rows); each frame builds just the rows in view, as
+    // in the All view, so expanding a directory with tens of thousands of
+    // files costs a screenful of rows.
+    void render_file_tree(UIContext<InputAction>& ctx, Entity& scrollParent,
+                          RepoComponent& repo, FileTreeCache& trees,
+                          float viewportPx) {
+        int nextId = 2600;
+        int spacerId = 2580;
+        bool firstSection = true;
+        float rowPx = file_row_px();
+        float topPx = 0.0f;  // Where the next section starts
+        auto section = [&](const char* label, FileTree& tree,
+                           FileTreeCache::Rows& rows) {
+            if (tree.file_count() == 0) return;
+            render_section_header(ctx, scrollParent, nextId++, label,
+                                  tree.file_count(), firstSection);
+            topPx += section_header_px(firstSection);
+            firstSection = false;
+
+            if (rows.version != tree.version()) {
+                rows.ids.clear();
+                tree.for_each_visible([&](FileTree::NodeId id, const FileTree::Node&) {
+                    rows.ids.push_back(id);
+                });
+                rows.version = tree.version();
+            }
+
+            // Row IDs follow the row's position, as before virtualizing
+            RowWindow w = file_row_window(scrollParent, topPx, rowPx, rows.ids.size(),
+                                          viewportPx);
+            render_row_spacer(ctx, scrollParent, spacerId++,
+                              rowPx * static_cast<float>(w.first), "tree_top_spacer");
+            FileTree::NodeId toggled = FileTree::NONE;
+            for (size_t i = w.first; i < w.last; ++i) {
+                FileTree::NodeId id = rows.ids[i];
+                if (render_tree_row(ctx, scrollParent, nextId + static_cast<int>(i),
+                                    tree, id, tree.node(id), repo)) {
+                    toggled = id;
+                }
+            }
+            render_row_spacer(ctx, scrollParent, spacerId++,
+                              rowPx * static_cast<float>(rows.ids.size() - w.last),
+                              "tree_bottom_spacer");
+            nextId += static_cast<int>(rows.ids.size());
+            topPx += rowPx * static_cast<float>(rows.ids.size());
+            // Applied after the loop so it doesn't change mid-iteration
+            if (toggled != FileTree::NONE) {
+                tree.set_expanded(toggled, !tree.node(toggled).expanded);
+            }
+        };
+        section("Staged Changes", trees.staged, trees.stagedRows);
+        section("Unstaged Changes", trees.unstaged, trees.unstagedRows);
+        section("Untracked", trees.untracked, trees.untrackedRows);
+    }
+
+    // File rows overlapping a viewportPx-tall view of scrollParent, for a
+    // list of `count` rows starting `topPx` down its content: [first, last),
+    // with OVERSCAN_ROWS either side.  As in the commit log, the rows
+    // outside it are stood in for by spacers (render_row_spacer) so the
+    // scroll extent is unchanged.
+    struct RowWindow {
+        size_t first = 0;
+        size_t last = 0;
+    };
+
+    static float file_row_px() {
+        constexpr float ROW_H = static_cast<float>(theme::layout::FILE_ROW_HEIGHT);
+        float rowPx = resolve_to_pixels(
+            h720(ROW_H), static_cast<float>(afterhours::graphics::get_screen_height()));
+        return rowPx < 1.0f ? ROW_H : rowPx;
+    }
+
+    // Height of a render_section_header() row, close enough for picking
+    // rows (the overscan absorbs the difference).
+    static float section_header_px(bool isFirst) {
+        float px = resolve_to_pixels(
+            h720(22.0f), static_cast<float>(afterhours::graphics::get_screen_height()));
+        return isFirst ? px : px + 6.0f;
+    }
+
+    static RowWindow file_row_window(Entity& scrollParent, float topPx, float rowPx,
+                                     size_t count, float viewportPx) {
+        constexpr size_t OVERSCAN_ROWS = 10;
+        float scrollPx = 0.0f;
+        if (scrollParent.has<afterhours::ui::HasScrollView>()) {
+            scrollPx = std::fabs(
+                scrollParent.get<afterhours::ui::HasScrollView>().scroll_offset.y);
+        }
+        float from = std::max(scrollPx - topPx, 0.0f);
+        float to = scrollPx + viewportPx - topPx;
+        auto firstVisible = static_cast<size_t>(from / rowPx);
+        size_t lastVisible = to > 0.0f ? static_cast<size_t>(to / rowPx) + 1 : 0;
+        RowWindow w;
+        w.first = std::min(
+            count, firstVisible > OVERSCAN_ROWS ? firstVisible - OVERSCAN_ROWS : 0);
+        w.last = std::max(w.first, std::min(count, lastVisible + OVERSCAN_ROWS));
+        return w;
+    }
+
+    void render_row_spacer(UIContext<InputAction>& ctx, Entity& parent, int id,
+                           float px, const char* debugName) {
+        if (px <= 0.0f) return;
+        div(ctx, mk(parent, id),
+            ComponentConfig{}
+                .with_size(ComponentSize{percent(1.0f), pixels(px)})
+                .with_transparent_bg()
+                .with_roundness(0.0f)
+                .with_debug_name(debugName));
+    }
+
+    // All view: every tracked file as a tree.  The rows of the expanded
+    // directories are flattened once per expand/collapse or reload
+    // (cache.rows), and only those in view are built, so even a
+    // million-file repository costs a screenful of rows per frame.
+    void render_repo_index(UIContext<InputAction>& ctx, Entity& scrollParent,
+                           RepoComponent& repo, RepoFileIndexCache& cache,
+                           float viewportPx) {
+        cache.wanted = true;
+        auto notice = [&](const std::string& text) {
+            div(ctx, mk(scrollParent, 2500),
+                preset::EmptyStateText(text)
+                    .with_size(ComponentSize{percent(1.0f), h720(28)})
+                    .with_padding(Padding{
+                        .top = h720(20), .right = w1280(8),
+                        .bottom = h720(4), .left = w1280(8)})
+                    .with_debug_name("all_files_notice"));
+        };
+        if (!cache.index || cache.repoPath != repo.repoPath) {
+            notice(cache.failed ? "Couldn't list repository files"
+                                : "Loading files\xe2\x80\xa6");
+            return;
+        }
+        sidebar_detail::sync_index_overlay(repo, cache);
+
+        // Held by copy so a reload landing mid-frame can't free it
+        std::shared_ptr<const RepoFileIndex> index = cache.index;
+        auto revealed = RepoFileIndex::NONE;
+        if (!cache.reveal.empty()) {
+            // Expand down to a file picked in the quick-open panel
+            revealed = index->find(cache.reveal);
+            for (auto dir = revealed == RepoFileIndex::NONE ? RepoFileIndex::NONE
+                                                            : index->node(revealed).parent;
+                 dir != RepoFileIndex::ROOT && dir != RepoFileIndex::NONE;
+                 dir = index->node(dir).parent) {
+                cache.expanded.insert(dir);
+            }
+            cache.reveal.clear();
+            cache.rowsValid = false;
+        }
+        if (!cache.rowsValid) {
+            sidebar_detail::flatten_index(*index, cache.expanded, cache.rows);
+            cache.rowsValid = true;
+        }
+
+        std::string header = index->truncated() ? "All Files (partial)" : "All Files";
+        render_section_header(ctx, scrollParent, 2600, header,
+                              index->file_count(), true);
+
+        float rowPx = file_row_px();
+        float topPx = section_header_px(true);
+        if (revealed != RepoFileIndex::NONE &&
+            scrollParent.has<afterhours::ui::HasScrollView>()) {
+            scroll_row_into_view(scrollParent.get<afterhours::ui::HasScrollView>(),
+                                 cache.rows, revealed, topPx, rowPx, viewportPx);
+        }
+
+        // Row IDs follow the row's position, after the header's
+        RowWindow w = file_row_window(scrollParent, topPx, rowPx, cache.rows.size(),
+                                      viewportPx);
+        render_row_spacer(ctx, scrollParent, 2590, rowPx * static_cast<float>(w.first),
+                          "all_files_top_spacer");
+        RepoFileIndex::NodeId toggled = RepoFileIndex::NONE;
+        for (size_t i = w.first; i < w.last; ++i) {
+            RepoFileIndex::NodeId id = cache.rows[i];
+            if (render_index_row(ctx, scrollParent, 2601 + static_cast<int>(i), *index,
+                                 id, cache.expanded.contains(id), cache, repo)) {
+                toggled = id;
+            }
+        }
+        render_row_spacer(ctx, scrollParent, 2591,
+                          rowPx * static_cast<float>(cache.rows.size() - w.last),
+                          "all_files_bottom_spacer");
+        // Applied after the loop so it doesn't change mid-iteration
+        if (toggled != RepoFileIndex::NONE) {
+            if (!cache.expanded.erase(toggled)) cache.expanded.insert(toggled);
+            cache.rowsValid = false;
+        }
+    }
+
+    // Scroll so `target`'s row in `rows` (laid out from topPx down) is in
+    // view, if it isn't already.
+    template <typename NodeId>
+    static void scroll_row_into_view(afterhours::ui::HasScrollView& sv,
+                                     const std::vector<NodeId>& rows, NodeId target,
+                                     float topPx, float rowPx, float viewportPx) {
+        auto it = std::find(rows.begin(), rows.end(), target);
+        if (it == rows.end()) return;
+        float rowTop = topPx + rowPx * static_cast<float>(it - rows.begin());
+        float scrollPx = std::fabs(sv.scroll_offset.y);
+        if (rowTop >= scrollPx && rowTop + rowPx <= scrollPx + viewportPx) return;
+        float want = std::max(rowTop - (viewportPx - rowPx) / 2.0f, 0.0f);
+        sv.scroll_offset.y = std::copysign(want, sv.scroll_offset.y);
+    }
+
+    // One All-view row: [indent] [chevron] [name] [changed count | status].
+    // Only changed files can be selected.  Returns true when a directory
+    // row was clicked.
+    bool render_index_row(UIContext<InputAction>& ctx, Entity& parent, int id,
+                          const RepoFileIndex& index, RepoFileIndex::NodeId nodeId,
+                          bool expanded, const RepoFileIndexCache& cache,
+                          RepoComponent& repo) {
+        constexpr float ROW_H = static_cast<float>(theme::layout::FILE_ROW_HEIGHT);
+        constexpr float INDENT_W = 12.0f;
+        constexpr float CHEVRON_W = 12.0f;
+        constexpr float BADGE_W = 28.0f;
+        constexpr float PAD = 12.0f + 3.0f * 4.0f;  // Row padding + gaps
+
+        const RepoFileIndex::Node& node = index.node(nodeId);
+        // Paths are only built for rows that need a lookup
+        char status = 0;
+        uint32_t changedBelow = 0;
+        std::string path;
+        if (node.isDir) {
+            if (!cache.changedDirs.empty()) {
+                auto it = cache.changedDirs.find(index.path(nodeId));
+                if (it != cache.changedDirs.end()) changedBelow = it->second;
+            }
+        } else if (!cache.changedFiles.empty()) {
+            path = index.path(nodeId);
+            auto it = cache.changedFiles.find(path);
+            if (it != cache.changedFiles.end()) status = it->second;
+        }
+        bool selected = status != 0 && path == repo.selectedFilePath;
+        auto rowWidth = sidebarPixelWidth_ > 0 ? pixels(sidebarPixelWidth_) : percent(1.0f);
+
+        auto row = div(ctx, mk(parent, id),
+            preset::SelectableRow(selected)
+                .with_size(ComponentSize{rowWidth, h720(ROW_H)})
+                .with_debug_name(node.isDir ? "index_dir_row" : "index_file_row"));
+        row.ent().addComponentIfMissing<HasClickListener>([](Entity&){});
+
+        auto textCol = selected ? afterhours::Color{255, 255, 255, 255}
+                     : (node.isDir || status == 0) ? theme::TEXT_SECONDARY
+                                                   : theme::TEXT_PRIMARY;
+        float indentW = INDENT_W * static_cast<float>(node.depth);
+        float nameW = std::max(sidebarPixelWidth_ - PAD - indentW - CHEVRON_W -
+                                   BADGE_W,
+                               40.0f);
+
+        if (indentW > 0.0f) {
+            div(ctx, mk(row.ent(), 1),
+                ComponentConfig{}
+                    .with_size(ComponentSize{pixels(indentW), pixels(1)})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("index_indent"));
+        }
+
+        div(ctx, mk(row.ent(), 2),
+            preset::MetaText(node.isDir ? (expanded ? "\xe2\x96\xbe" : "\xe2\x96\xb8")
+                                        : "")
+                .with_size(ComponentSize{pixels(CHEVRON_W), children()})
+                .with_custom_text_color(theme::TEXT_SECONDARY)
+                .with_debug_name("index_chevron"));
+
+        div(ctx, mk(row.ent(), 3),
+            preset::BodyText(std::string(index.name(nodeId)))
+                .with_size(ComponentSize{pixels(nameW), children()})
+                .with_custom_text_color(textCol)
+                .with_text_overflow(afterhours::ui::TextOverflow::Ellipsis)
+                .with_debug_name(node.isDir ? "index_dir_name" : "index_file_name"));
+
+        // Directories show how many changed files they hold
+        std::string badge = node.isDir ? (changedBelow ? std::to_string(changedBelow) : "")
+                                       : (status ? std::string(1, status) : "");
+        div(ctx, mk(row.ent(), 4),
+            preset::MetaText(badge)
+                .with_size(ComponentSize{pixels(BADGE_W), children()})
+                .with_custom_text_color(
+                    node.isDir ? theme::TEXT_SECONDARY
+                               : sidebar_detail::status_color(status))
+                .with_alignment(TextAlignment::Right)
+                .with_debug_name(node.isDir ? "index_count" : "index_status"));
+
+        if (!row.ent().get<HasClickListener>().down) return false;
+        if (node.isDir) return true;
+        if (status == 0) return false;
+        repo.selectedFilePath = path;
+        repo.selectedCommitHash.clear();
+        return false;
+    }
+
+    // One tree row: [indent] [chevron] [name] [+N -N] [count | status].
+    // Returns true when a directory row was clicked.
+    bool render_tree_row(UIContext<InputAction>& ctx, Entity& parent, int id,
+                         const FileTree& tree, FileTree::NodeId nodeId,
+                         const FileTree::Node& node, RepoComponent& repo) {
+        constexpr float ROW_H = static_cast<float>(theme::layout::FILE_ROW_HEIGHT);
+        constexpr float INDENT_W = 12.0f;
+        constexpr float CHEVRON_W = 12.0f;
+        constexpr float STATS_W = 56.0f;
+        constexpr float BADGE_W = 28.0f;
+        constexpr float PAD = 12.0f + 3.0f * 4.0f;  // Row padding + gaps
+
+        std::string path = node.isDir ? std::string{} : tree.path(nodeId);
+        bool selected = !node.isDir && path == repo.selectedFilePath;
+        auto rowWidth = sidebarPixelWidth_ > 0 ? pixels(sidebarPixelWidth_) : percent(1.0f);
+
+        auto row = div(ctx, mk(parent, id),
+            preset::SelectableRow(selected)
+                .with_size(ComponentSize{rowWidth, h720(ROW_H)})
+                .with_debug_name(node.isDir ? "tree_dir_row" : "tree_file_row"));
+        row.ent().addComponentIfMissing<HasClickListener>([](Entity&){});
+
+        auto textCol = selected ? afterhours::Color{255, 255, 255, 255}
+                                : theme::TEXT_PRIMARY;
+        float indentW = INDENT_W * static_cast<float>(node.depth);
+        std::string stats = sidebar_detail::format_stats(node.additions,
+                                                         node.deletions);
+        float statsW = stats.empty() ? 0.0f : STATS_W;
+        float nameW = std::max(sidebarPixelWidth_ - PAD - indentW - CHEVRON_W -
+                                   statsW - BADGE_W,
+                               40.0f);
+
+        if (indentW > 0.0f) {
+            div(ctx, mk(row.ent(), 1),
+                ComponentConfig{}
+                    .with_size(ComponentSize{pixels(indentW), pixels(1)})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("tree_indent"));
+        }
+
+        div(ctx, mk(row.ent(), 2),
+            preset::MetaText(node.isDir ? (node.expanded ? "\xe2\x96\xbe"
+                                                         : "\xe2\x96\xb8")
+                                        : "")
+                .with_size(ComponentSize{pixels(CHEVRON_W), children()})
+                .with_custom_text_color(theme::TEXT_SECONDARY)
+                .with_debug_name("tree_chevron"));
+
+        div(ctx, mk(row.ent(), 3),
+            preset::BodyText(tree.name(nodeId))
+                .with_size(ComponentSize{pixels(nameW), children()})
+                .with_custom_text_color(node.isDir ? theme::TEXT_SECONDARY : textCol)
+                .with_text_overflow(afterhours::ui::TextOverflow::Ellipsis)
+                .with_debug_name(node.isDir ? "tree_dir_name" : "tree_file_name"));
+
+        if (!stats.empty()) {
+            div(ctx, mk(row.ent(), 4),
+                preset::MetaText(stats)
+                    .with_size(ComponentSize{pixels(statsW), children()})
+                    .with_custom_text_color(theme::TEXT_SECONDARY)
+                    .with_font_size(FontSize::Small)
+                    .with_alignment(TextAlignment::Right)
+                    .with_text_overflow(afterhours::ui::TextOverflow::Ellipsis)
+                    .with_debug_name("tree_stats"));
+        }
+
+        // Directories show how many changed files they hold
+        std::string badge = node.isDir ? std::to_string(node.fileCount)
+                                       : std::string(1, node.leaf.status);
+        div(ctx, mk(row.ent(), 5),
+            preset::MetaText(badge)
+                .with_size(ComponentSize{pixels(BADGE_W), children()})
+                .with_custom_text_color(
+                    node.isDir ? theme::TEXT_SECONDARY
+                               : sidebar_detail::status_color(node.leaf.status))
+                .with_alignment(TextAlignment::Right)
+                .with_debug_name(node.isDir ? "tree_count" : "tree_status"));
+
+        if (!row.ent().get<HasClickListener>().down) return false;
+        if (node.isDir) return true;
+        repo.selectedFilePath = path;
+        repo.selectedCommitHash.clear();
+        return false;
+    }
+
     // Render a section header: "Staged Changes  1"
     // isFirst: true for the very first section (no top margin needed)
     void render_section_header(UIContext<InputAction>& ctx,
@@ -1071,28 +1616,29 @@ private:
         div(ctx, mk(parent, id), config);
     }
 
-    // Render a file row: [filename] [dir (gray)] [status badge]
+    // Render a file row: [filename] [dir (gray)] [+N -N] [status badge]
     void render_file_row(UIContext<InputAction>& ctx,
                          Entity& parent, int id,
                          const FileStatus& file,
                          RepoComponent& repo, bool staged) {
-        char statusChar = staged ? file.indexStatus : file.workTreeStatus;
-        if (statusChar == ' ' || statusChar == '\0') {
-            statusChar = staged ? 'A' : 'M';
-        }
-        render_file_row_impl(ctx, parent, id, file.path, statusChar, repo);
+        char statusChar = sidebar_detail::row_status(file, staged);
+        render_file_row_impl(ctx, parent, id, file.path, statusChar,
+                             sidebar_detail::format_stats(file.additions,
+                                                          file.deletions),
+                             repo);
     }
 
     void render_untracked_row(UIContext<InputAction>& ctx,
                                Entity& parent, int id,
                                const std::string& path,
                                RepoComponent& repo) {
-        render_file_row_impl(ctx, parent, id, path, 'U', repo);
+        render_file_row_impl(ctx, parent, id, path, 'U', {}, repo);
     }
 
     void render_file_row_impl(UIContext<InputAction>& ctx,
                                Entity& parent, int id,
                                const std::string& path, char statusChar,
+                               const std::string& stats,
                                RepoComponent& repo) {
         bool selected = (path == repo.selectedFilePath);
         constexpr float ROW_H = static_cast<float>(theme::layout::FILE_ROW_HEIGHT);
@@ -1117,7 +1663,9 @@ private:
         constexpr float PAD_L = 8.0f;
         constexpr float PAD_R = 4.0f;
         constexpr float GAP = 3.0f;
-        float totalW = std::max(sidebarPixelWidth_ - PAD_L - PAD_R, 40.0f);
+        // Line counts from the numstat summary; hidden for untracked files
+        float statsW = stats.empty() ? 0.0f : 56.0f;
+        float totalW = std::max(sidebarPixelWidth_ - PAD_L - PAD_R - statsW, 40.0f);
         float nameW, dirW;
         if (dir.empty()) {
             nameW = totalW - GAP - STATUS_W;
@@ -1144,6 +1692,17 @@ private:
                     .with_debug_name("file_dir"));
         }
 
+        if (!stats.empty()) {
+            div(ctx, mk(row.ent(), 4),
+                preset::MetaText(stats)
+                    .with_size(ComponentSize{pixels(statsW), children()})
+                    .with_custom_text_color(theme::TEXT_SECONDARY)
+                    .with_font_size(FontSize::Small)
+                    .with_alignment(TextAlignment::Right)
+                    .with_text_overflow(afterhours::ui::TextOverflow::Ellipsis)
+                    .with_debug_name("file_stats"));
+        }
+
         auto statusCol = sidebar_detail::status_color(statusChar);
         div(ctx, mk(row.ent(), 3),
             preset::MetaText(statusStr)
@@ -1163,10 +1722,12 @@ private:
 
     // ---- Commit log rendering (T021) ----
 
-    // Render all commit log entries in a scrollable list
+    // Render the commit log entries visible in the scroll list (viewportPx
+    // tall) and request more history as the end comes into range
     void render_commit_log_entries(UIContext<InputAction>& ctx,
                                    Entity& scrollParent,
-                                   RepoComponent& repo) {
+                                   RepoComponent& repo,
+                                   float viewportPx) {
         if (repo.commitLog.empty()) {
             div(ctx, mk(scrollParent, 0),
                 preset::EmptyStateText("No commits yet")
@@ -1178,18 +1739,84 @@ private:
             return;
         }
 
-        constexpr int MAX_VISIBLE = 500;
-        int count = std::min(static_cast<int>(repo.commitLog.size()), MAX_VISIBLE);
+        constexpr float ROW_H = static_cast<float>(theme::layout::COMMIT_ROW_HEIGHT);
+        float rowPx = resolve_to_pixels(
+            h720(ROW_H), static_cast<float>(afterhours::graphics::get_screen_height()));
+        if (rowPx < 1.0f) rowPx = 26.0f;
+
+        afterhours::ui::HasScrollView* sv = nullptr;
+        if (scrollParent.has<afterhours::ui::HasScrollView>()) {
+            sv = &scrollParent.get<afterhours::ui::HasScrollView>();
+        }
+
+        // Commits prepended by an incremental refresh push the list down;
+        // unless the view is at the top (where new commits should show),
+        // shift the scroll offset so the same rows stay in view.
+        if (repo.commitLogPrepended > 0) {
+            if (sv && sv->scroll_offset.y != 0.0f) {
+                sv->scroll_offset.y += std::copysign(
+                    rowPx * static_cast<float>(repo.commitLogPrepended),
+                    sv->scroll_offset.y);
+            }
+            repo.commitLogPrepended = 0;
+        }
+
+        // Only rows overlapping the viewport (plus OVERSCAN_ROWS) are built;
+        // spacers keep the scroll extent.  Row IDs follow the row index.
+        constexpr size_t OVERSCAN_ROWS = 10;
+        // Ask for the next page while this many loaded rows are still below
+        // the viewport, so the page lands before the user gets there.
+        constexpr size_t PREFETCH_ROWS = 100;
+
+        size_t total = repo.commitLog.size();
+        float scrollPx = sv ? std::fabs(sv->scroll_offset.y) : 0.0f;
+        auto firstVisible = static_cast<size_t>(scrollPx / rowPx);
+        auto lastVisible = static_cast<size_t>((scrollPx + viewportPx) / rowPx) + 1;
+        size_t first = firstVisible > OVERSCAN_ROWS ? firstVisible - OVERSCAN_ROWS : 0;
+        first = std::min(first, total);
+        size_t last = std::min(total, lastVisible + OVERSCAN_ROWS);
+
+        if (repo.commitLogHasMore && !repo.commitLogPageLoading &&
+            lastVisible + PREFETCH_ROWS >= total) {
+            repo.commitLogPageRequested = true;
+        }
+
+        if (first > 0) {
+            div(ctx, mk(scrollParent, 3),
+                ComponentConfig{}
+                    .with_size(ComponentSize{percent(1.0f),
+                                             pixels(rowPx * static_cast<float>(first))})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("commit_log_top_spacer"));
+        }
+
+        // Lanes for just the rows being built, once per frame
+        auto* graph = find_singleton<CommitGraphCache, ActiveTab>();
+        if (graph && graph->graph.size() == total) {
+            graph->graph.query(static_cast<uint32_t>(first), static_cast<uint32_t>(last),
+                               graph->window);
+        } else {
+            graph = nullptr;  // Not laid out yet
+        }
+        for (size_t i = first; i < last; ++i) {
+            render_commit_row(ctx, scrollParent, static_cast<int>(i),
+                              repo.commitLog[i], repo, graph);
+        }
 
-        bool multipleCommits = (count > 1);
-        for (int i = 0; i < count; ++i) {
-            render_commit_row(ctx, scrollParent, i, repo.commitLog[i], repo,
-                              multipleCommits);
+        if (last < total) {
+            div(ctx, mk(scrollParent, 4),
+                ComponentConfig{}
+                    .with_size(ComponentSize{percent(1.0f),
+                                             pixels(rowPx * static_cast<float>(total - last))})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("commit_log_bottom_spacer"));
         }
 
-        // Lazy load indicator at bottom
+        // Shown only if the user outruns the prefetch
         if (repo.commitLogHasMore) {
-            div(ctx, mk(scrollParent, 9990),
+            div(ctx, mk(scrollParent, 5),
                 ComponentConfig{}
                     .with_label("\xe2\x97\x8b Loading more...")
                     .with_size(ComponentSize{percent(1.0f), h720(20)})
@@ -1204,24 +1831,120 @@ private:
         }
     }
 
+    // Commits matching the search box, windowed like the log: newest first
+    // from the index, or in git's order as a content search streams in
+    void render_commit_search_results(UIContext<InputAction>& ctx,
+                                      Entity& scrollParent,
+                                      RepoComponent& repo,
+                                      const CommitSearchState& search,
+                                      float viewportPx) {
+        bool content = !search.pickaxeQuery.empty();
+        std::string status;
+        if (content) {
+            if (search.pickaxePattern.empty()) {
+                status = "Type text to find commits that add or remove it";
+            } else if (!search.results.empty()) {
+                // Listed below
+            } else if (search.pickaxe_searching()) {
+                status = "Searching history\xe2\x80\xa6";
+            } else if (!search.pickaxeError.empty()) {
+                status = search.pickaxeError;
+            } else {
+                status = "No commits touch \"" + search.pickaxePattern + "\"";
+            }
+        } else if (!search.index) {
+            status = search.failed ? "Couldn't index history"
+                                   : "Indexing history\xe2\x80\xa6";
+        } else if (search.results.empty()) {
+            status = "No matching commits";
+        }
+        if (!status.empty()) {
+            div(ctx, mk(scrollParent, 0),
+                preset::EmptyStateText(status)
+                    .with_size(ComponentSize{percent(1.0f), h720(32)})
+                    .with_padding(Padding{
+                        .top = h720(16), .right = w1280(8),
+                        .bottom = h720(8), .left = w1280(8)})
+                    .with_debug_name("commit_search_status"));
+            return;
+        }
+
+        constexpr float ROW_H = static_cast<float>(theme::layout::COMMIT_ROW_HEIGHT);
+        constexpr size_t OVERSCAN_ROWS = 10;
+        float rowPx = resolve_to_pixels(
+            h720(ROW_H), static_cast<float>(afterhours::graphics::get_screen_height()));
+        if (rowPx < 1.0f) rowPx = 26.0f;
+
+        float scrollPx = 0.0f;
+        if (scrollParent.has<afterhours::ui::HasScrollView>()) {
+            scrollPx = std::fabs(
+                scrollParent.get<afterhours::ui::HasScrollView>().scroll_offset.y);
+        }
+        size_t total = search.results.size();
+        auto firstVisible = static_cast<size_t>(scrollPx / rowPx);
+        auto lastVisible = static_cast<size_t>((scrollPx + viewportPx) / rowPx) + 1;
+        size_t first = std::min(
+            total, firstVisible > OVERSCAN_ROWS ? firstVisible - OVERSCAN_ROWS : 0);
+        size_t last = std::min(total, lastVisible + OVERSCAN_ROWS);
+
+        if (first > 0) {
+            div(ctx, mk(scrollParent, 3),
+                ComponentConfig{}
+                    .with_size(ComponentSize{percent(1.0f),
+                                             pixels(rowPx * static_cast<float>(first))})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("commit_search_top_spacer"));
+        }
+        for (size_t i = first; i < last; ++i) {
+            render_commit_row(ctx, scrollParent, static_cast<int>(i),
+                              search.results[i], repo);
+        }
+        if (last < total) {
+            div(ctx, mk(scrollParent, 4),
+                ComponentConfig{}
+                    .with_size(ComponentSize{percent(1.0f),
+                                             pixels(rowPx * static_cast<float>(total - last))})
+                    .with_transparent_bg()
+                    .with_roundness(0.0f)
+                    .with_debug_name("commit_search_bottom_spacer"));
+        }
+
+        if (content && (search.pickaxe_searching() || search.pickaxeCapped)) {
+            std::string footer = search.pickaxeCapped
+                ? "First " + std::to_string(total) + " matches"
+                : "\xe2\x97\x8b Searching history\xe2\x80\xa6";
+            div(ctx, mk(scrollParent, 5),
+                preset::MetaText(footer)
+                    .with_size(ComponentSize{percent(1.0f), h720(20)})
+                    .with_padding(Padding{
+                        .top = h720(3), .right = w1280(8),
+                        .bottom = h720(3), .left = w1280(8)})
+                    .with_alignment(TextAlignment::Center)
+                    .with_debug_name("commit_search_footer"));
+        }
+    }
+
     // Render a single commit row: [graph_col] [subject] [badge pills] [hash]
-    // showGraphLine controls whether the vertical connecting line is drawn
+    // With `graph` (log rows, whose index is their graph row) the graph
+    // column shows the row's lanes; without it, just a dot.
     void render_commit_row(UIContext<InputAction>& ctx,
                            Entity& parent, int index,
                            const CommitEntry& commit,
                            RepoComponent& repo,
-                           bool showGraphLine = true) {
+                           const CommitGraphCache* graph = nullptr) {
         bool selected = (commit.hash == repo.selectedCommitHash);
         constexpr float ROW_H = static_cast<float>(theme::layout::COMMIT_ROW_HEIGHT);
 
         int baseId = index * 2 + 10;
         float sidebarW = sidebarPixelWidth_ > 0 ? sidebarPixelWidth_ : 300.0f;
 
-        auto badges = commit_log_detail::parse_decorations(commit.decorations);
-
         constexpr float DOT_SIZE = 8.0f;
         constexpr float LINE_W = 2.0f;
         constexpr float GRAPH_COL_W = 22.0f;
+        constexpr float LANE_W = 12.0f;
+        // Lanes further right are folded onto the last one shown
+        constexpr CommitGraph::Lane MAX_GRAPH_LANES = 8;
 
         auto row = div(ctx, mk(parent, baseId),
             preset::SelectableRow(selected)
@@ -1239,59 +1962,98 @@ private:
         float rowPx = resolve_to_pixels(h720(ROW_H), shG);
         if (rowPx < 1.0f) rowPx = 26.0f;
 
-        // Graph wrapper: 22px wide container for line and dot.
+        // Every row in the window gets the same width so subjects line up
+        CommitGraph::Lane lanesShown =
+            graph ? std::clamp<CommitGraph::Lane>(graph->window.lanes, 1, MAX_GRAPH_LANES) : 1;
+        float graphColW = graph ? std::max(GRAPH_COL_W, LANE_W * static_cast<float>(lanesShown) + 4.0f)
+                                : GRAPH_COL_W;
+        auto laneX = [&](CommitGraph::Lane lane) {
+            if (!graph) return GRAPH_COL_W / 2.0f;
+            return 2.0f + LANE_W * (static_cast<float>(std::min(lane, lanesShown - 1)) + 0.5f);
+        };
+        auto laneColor = [](CommitGraph::Lane lane) {
+            constexpr size_t N = sizeof(theme::GRAPH_LANES) / sizeof(theme::GRAPH_LANES[0]);
+            return theme::GRAPH_LANES[lane % N];
+        };
+
         auto graphWrap = div(ctx, mk(row.ent(), 1),
             ComponentConfig{}
-                .with_size(ComponentSize{pixels(GRAPH_COL_W), pixels(rowPx)})
+                .with_size(ComponentSize{pixels(graphColW), pixels(rowPx)})
                 .with_roundness(0.0f)
                 .with_debug_name("graph_wrap"));
 
-        // Line: 0-width div with border-left, absolutely positioned
-        // so the border is centered on the dot center (GRAPH_COL_W/2).
-        // Border draws LINE_W px right from element's left edge,
-        // so left edge = center - LINE_W/2.
-        if (showGraphLine) {
-            float lineX = (GRAPH_COL_W - LINE_W) / 2.0f;
-            div(ctx, mk(graphWrap.ent(), 1),
+        // Lines are thin absolutely positioned fills, centred on lane centres
+        int segmentId = 10;
+        auto segment = [&](float x, float y, float w, float h, afterhours::Color color) {
+            if (w <= 0.0f || h <= 0.0f) return;
+            div(ctx, mk(graphWrap.ent(), segmentId++),
                 ComponentConfig{}
-                    .with_size(ComponentSize{pixels(0), pixels(rowPx)})
-                    .with_absolute_position(lineX, 0.0f)
-                    .with_border_left(theme::GRAPH_LINE, pixels(LINE_W))
+                    .with_size(ComponentSize{pixels(w), pixels(h)})
+                    .with_absolute_position(x, y)
+                    .with_custom_background(color)
                     .with_roundness(0.0f)
                     .with_debug_name("graph_line"));
+        };
+
+        afterhours::Color dotColor = theme::GRAPH_DOT;
+        CommitGraph::Lane nodeLane = 0;
+        if (graph) {
+            const CommitGraph& g = graph->graph;
+            auto r = static_cast<uint32_t>(index);
+            float mid = rowPx / 2.0f;
+            nodeLane = g.lane(r);
+            dotColor = laneColor(nodeLane);
+
+            // Lanes passing through, starting or ending at this row
+            for (const auto& span : graph->window.spans) {
+                if (span.lane >= lanesShown || span.fromRow > r ||
+                    (span.toRow != CommitGraph::OPEN && span.toRow < r)) {
+                    continue;
+                }
+                float top = span.fromRow == r ? mid : 0.0f;
+                float bottom = span.toRow == r ? mid : rowPx;
+                segment(laneX(span.lane) - LINE_W / 2.0f, top, LINE_W, bottom - top,
+                        laneColor(span.lane));
+            }
+            // Bends: down out of this row and across along its bottom edge,
+            // then down into the target lane's centre on the next row.  The
+            // colour is the side branch's, not the commit's.
+            for (const auto& edge : graph->window.edges) {
+                if (edge.row != r && edge.row + 1 != r) continue;
+                auto color = laneColor(edge.from == g.lane(edge.row) ? edge.to : edge.from);
+                float xTo = laneX(edge.to);
+                if (edge.row == r) {
+                    float xFrom = laneX(edge.from);
+                    segment(xFrom - LINE_W / 2.0f, mid, LINE_W, rowPx - mid, color);
+                    segment(std::min(xFrom, xTo) - LINE_W / 2.0f, rowPx - LINE_W,
+                            std::fabs(xTo - xFrom) + LINE_W, LINE_W, color);
+                } else {
+                    segment(xTo - LINE_W / 2.0f, 0.0f, LINE_W, mid, color);
+                }
+            }
         }
 
-        // Dot: absolute, centered both ways
-        float dotX = (GRAPH_COL_W - DOT_SIZE) / 2.0f;
+        // Dot: absolute, centered both ways on its lane
+        float dotX = laneX(nodeLane) - DOT_SIZE / 2.0f;
         float dotY = (rowPx - DOT_SIZE) / 2.0f;
         div(ctx, mk(graphWrap.ent(), 2),
             ComponentConfig{}
                 .with_size(ComponentSize{pixels(DOT_SIZE), pixels(DOT_SIZE)})
                 .with_absolute_position(dotX, dotY)
-                .with_custom_background(theme::GRAPH_DOT)
+                .with_custom_background(dotColor)
                 .with_roundness(1.0f)
                 .with_render_layer(1)
                 .with_debug_name("commit_dot"));
 
         constexpr float BADGE_EST_W = 46.0f;
 
-        const commit_log_detail::Decoration* bestBadge = nullptr;
-        for (auto& b : badges) {
-            if (!bestBadge) { bestBadge = &b; continue; }
-            auto rank = [](commit_log_detail::DecorationType t) -> int {
-                switch (t) {
-                    case commit_log_detail::DecorationType::Head:         return 4;
-                    case commit_log_detail::DecorationType::LocalBranch:  return 3;
-                    case commit_log_detail::DecorationType::Tag:          return 2;
-                    case commit_log_detail::DecorationType::RemoteBranch: return 1;
-                    default: return 0;
-                }
-            };
-            if (rank(b.type) > rank(bestBadge->type)) bestBadge = &b;
-        }
+        const commit_log_detail::Decoration* bestBadge =
+            commit.bestBadge >= 0
+                ? &commit.badges[static_cast<size_t>(commit.bestBadge)]
+                : nullptr;
 
         bool hasBadge = (bestBadge != nullptr);
-        float fixedW = GRAPH_COL_W
+        float fixedW = graphColW
                      + (hasBadge ? BADGE_EST_W + 4.0f : 0.0f)
                      + 4.0f;
         float subjectW = sidebarW - 4.0f - fixedW;
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../git/git_runner.h"
+#include "../util/background_task.h"
+#include "../util/syntax_highlight.h"
+#include "completion_system.h"
+#include "components.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+// Highlights the files of the diff on screen on a worker thread.  Each
+// file's whole pre-image and post-image is read (git cat-file by the blob
+// ids in the diff's index line, or the working tree for files git has no
+// blob for) and highlighted top to bottom, then rows pick their lines by
+// number.  The diff draws in plain colors until the result lands; images
+// already in SyntaxCache are reused, so revisiting a diff whose blobs are
+// all cached is assembled on the spot.
+struct SyntaxHighlightSystem
+    : afterhours::System<RepoComponent, DiffViewCache, CommitDetailCache,
+                         SyntaxCache> {
+    // Bounds per diff: files past MAX_FILES and images over MAX_IMAGE_BYTES
+    // stay uncolored.
+    static constexpr size_t MAX_FILES = 64;
+    static constexpr size_t MAX_IMAGE_BYTES = 2u * 1024u * 1024u;
+
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       DiffViewCache& view, CommitDetailCache& detail,
+                       SyntaxCache& cache, float) override {
+        ShownDiff diff = shown_diff(repo, view, detail);
+        std::shared_ptr<const void> source = diff.source();
+        if (!source) {
+            cache.shownSource.reset();
+            cache.shown.reset();
+            return;
+        }
+        if (source == cache.shownSource || source == cache.pending) return;
+
+        auto jobs = plan(diff, cache);
+        bool complete = std::none_of(jobs.begin(), jobs.end(), [](const FileJob& j) {
+            return j.oldSide.needed() || j.newSide.needed();
+        });
+        if (complete) {
+            cache.shownSource = source;
+            cache.shown = std::make_shared<const ui::DiffSyntax>(assemble(diff, jobs));
+            return;
+        }
+        start(entity, cache, repo.repoPath, std::move(source), std::move(diff),
+              std::move(jobs));
+    }
+
+   private:
+    struct Side {
+        std::string blob;       // Cache key; empty if git has no id for it
+        bool fromDisk = false;  // Working-tree post-image: fall back to the file
+        std::shared_ptr<const syntax::Highlighted> image;
+
+        bool needed() const { return !image && (!blob.empty() || fromDisk); }
+    };
+
+    struct FileJob {
+        size_t fileIndex = 0;
+        const syntax::Grammar* grammar = nullptr;
+        std::string path;
+        Side oldSide, newSide;
+    };
+
+    static std::vector<FileJob> plan(const ShownDiff& diff, SyntaxCache& cache) {
+        std::vector<FileJob> jobs;
+        auto diffs = diff.diffs();
+        for (size_t i = 0; i < diffs.size() && i < MAX_FILES; ++i) {
+            const FileDiff& fd = diffs[i];
+            if (fd.isBinary || fd.hunks.empty()) continue;
+            const auto* grammar = syntax::grammar_for_path(fd.filePath);
+            if (!grammar) continue;
+
+            FileJob job{i, grammar, fd.filePath, {}, {}};
+            if (!fd.isNew) job.oldSide.blob = fd.oldBlob;
+            if (!fd.isDeleted) {
+                job.newSide.blob = fd.newBlob;
+                job.newSide.fromDisk = diff.file != nullptr;
+            }
+            for (Side* side : {&job.oldSide, &job.newSide}) {
+                if (side->blob.empty()) continue;
+                if (const auto* hit = cache.images.get(side->blob)) side->image = *hit;
+            }
+            jobs.push_back(std::move(job));
+        }
+        return jobs;
+    }
+
+    static ui::DiffSyntax assemble(const ShownDiff& diff, const std::vector<FileJob>& jobs) {
+        ui::DiffSyntax out;
+        out.files.resize(diff.diffs().size());
+        for (const auto& job : jobs) {
+            out.files[job.fileIndex] = {job.oldSide.image, job.newSide.image};
+        }
+        return out;
+    }
+
+    static std::optional<std::string> read_image(const std::string& repoPath,
+                                                 const std::string& path,
+                                                 const Side& side) {
+        if (!side.blob.empty()) {
+            auto result = git::git_cat_blob(repoPath, side.blob);
+            if (result.success()) return result.stdout_str();
+        }
+        // The working-tree side of `git diff` names a blob git hasn't stored
+        if (!side.fromDisk) return std::nullopt;
+        std::error_code ec;
+        auto full = std::filesystem::path(repoPath) / path;
+        auto size = std::filesystem::file_size(full, ec);
+        if (ec || size > MAX_IMAGE_BYTES) return std::nullopt;
+        std::ifstream in(full, std::ios::binary);
+        if (!in) return std::nullopt;
+        return std::string((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    }
+
+    static void start(afterhours::Entity& entity, SyntaxCache& cache,
+                      const std::string& repoPath, std::shared_ptr<const void> source,
+                      ShownDiff diff, std::vector<FileJob> jobs) {
+        cache.pending = source;
+        run_in_background([id = entity.id, repoPath, source, diff = std::move(diff),
+                           jobs = std::move(jobs)]() mutable {
+            std::vector<std::pair<std::string, std::shared_ptr<const syntax::Highlighted>>> fresh;
+            for (auto& job : jobs) {
+                for (Side* side : {&job.oldSide, &job.newSide}) {
+                    if (!side->needed()) continue;
+                    auto text = read_image(repoPath, job.path, *side);
+                    if (!text || text->size() > MAX_IMAGE_BYTES ||
+                        text->find('\0') != std::string::npos) {
+                        continue;
+                    }
+                    side->image = std::make_shared<const syntax::Highlighted>(
+                        syntax::highlight(*job.grammar, *text));
+                    if (!side->blob.empty()) fresh.emplace_back(side->blob, side->image);
+                }
+            }
+            auto result = std::make_shared<const ui::DiffSyntax>(assemble(diff, jobs));
+            post_completion(id, [source, result, fresh = std::move(fresh)](afterhours::Entity& e) {
+                if (!e.has<SyntaxCache>()) return;
+                auto& cache = e.get<SyntaxCache>();
+                for (const auto& [blob, image] : fresh) {
+                    cache.images.put(blob, image, image->approx_bytes());
+                }
+                // Moved on since: the images are cached for when it comes back
+                if (cache.pending != source) return;
+                cache.pending.reset();
+                cache.shownSource = source;
+                cache.shown = result;
+            });
+        });
+    }
+};
+
+} // namespace ecs
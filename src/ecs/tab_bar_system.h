@@ -252,6 +252,14 @@ struct TabBarSystem : afterhours::System<UIContext<InputAction>> {
         newEntity.addComponent<ActiveTab>();
         newEntity.addComponent<RepoComponent>();
         newEntity.addComponent<CommitDetailCache>();
+        newEntity.addComponent<DiffViewCache>();
+        newEntity.addComponent<FileTreeCache>();
+        newEntity.addComponent<RepoFileIndexCache>();
+        newEntity.addComponent<FileFinderCache>();
+        newEntity.addComponent<CommitSearchState>();
+        newEntity.addComponent<CommitGraphCache>();
+        newEntity.addComponent<WordDiffCache>();
+        newEntity.addComponent<SyntaxCache>();
         newEntity.addComponent<BranchDialogState>();
         newEntity.addComponent<CommitEditorComponent>();
 
@@ -115,10 +115,10 @@ private:
         };
 
         if (sidebarBtn(row1.ent(), nextId++, "Push", hasRepo)) {
-            enqueue_network_op("Push", git::git_run_async(repo->repoPath, {"push"}));
+            enqueue_network_op("Push", repo->repoPath, {"push"});
         }
         if (sidebarBtn(row1.ent(), nextId++, "Pull", hasRepo)) {
-            enqueue_network_op("Pull", git::git_run_async(repo->repoPath, {"pull"}));
+            enqueue_network_op("Pull", repo->repoPath, {"pull"});
         }
         if (sidebarBtn(row1.ent(), nextId++, "Stash", hasRepo)) {
             auto* menuComp = ::ecs::find_singleton<MenuComponent>();
@@ -224,13 +224,13 @@ private:
             if (editor) editor->commitRequested = true;
         }
         if (toolbarButton("Push", hasRepo)) {
-            enqueue_network_op("Push", git::git_run_async(repo->repoPath, {"push"}));
+            enqueue_network_op("Push", repo->repoPath, {"push"});
         }
         if (toolbarButton("Pull", hasRepo)) {
-            enqueue_network_op("Pull", git::git_run_async(repo->repoPath, {"pull"}));
+            enqueue_network_op("Pull", repo->repoPath, {"pull"});
         }
         if (toolbarButton("Fetch", hasRepo)) {
-            enqueue_network_op("Fetch", git::git_run_async(repo->repoPath, {"fetch"}));
+            enqueue_network_op("Fetch", repo->repoPath, {"fetch"});
         }
 
         toolbarSeparator();
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../util/background_task.h"
+#include "completion_system.h"
+#include "components.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+// Computes intra-line highlights for the diff on screen on a worker
+// thread.  The diff shows plain red/green lines until its highlights land
+// in WordDiffCache; revisiting a diff that is still cached is immediate.
+struct WordDiffSystem
+    : afterhours::System<RepoComponent, DiffViewCache, CommitDetailCache,
+                         WordDiffCache> {
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       DiffViewCache& view, CommitDetailCache& detail,
+                       WordDiffCache& words, float) override {
+        ShownDiff diff = shown_diff(repo, view, detail);
+        std::shared_ptr<const void> source = diff.source();
+
+        if (!source) {
+            words.shownSource.reset();
+            words.shown.reset();
+            return;
+        }
+        if (source == words.shownSource) return;
+
+        if (const auto* hit = words.cache.get(source.get())) {
+            words.shownSource = source;
+            words.shown = hit->highlights;
+            return;
+        }
+        if (words.pending == source) return;
+        start(entity, words, std::move(source), std::move(diff));
+    }
+
+   private:
+    // Stale completions still go into the cache: stepping back to a diff
+    // that finished after the user moved on is then a hit.
+    static void start(afterhours::Entity& entity, WordDiffCache& words,
+                      std::shared_ptr<const void> source, ShownDiff diff) {
+        words.pending = source;
+        run_in_background([id = entity.id, source, diff = std::move(diff)]() {
+            auto highlights = std::make_shared<const ui::DiffWordHighlights>(
+                ui::build_word_highlights(diff.diffs()));
+            size_t bytes = highlights->approx_bytes();
+            post_completion(id, [source, highlights, bytes](afterhours::Entity& e) {
+                if (!e.has<WordDiffCache>()) return;
+                auto& words = e.get<WordDiffCache>();
+                if (words.pending == source) words.pending.reset();
+                words.cache.put(source.get(),
+                                WordDiffCache::Entry{source, highlights}, bytes);
+            });
+        });
+    }
+};
+
+} // namespace ecs
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../vendor/afterhours/src/core/system.h"
+#include "../git/git_parser.h"
+#include "../git/git_runner.h"
+#include "../ui/commit_detail.h"
+#include "../util/background_task.h"
+#include "completion_system.h"
+#include "components.h"
+#include "repo_index.h"
+
+namespace ecs {
+
+// Loads hunks for working-tree files on worker threads.  A refresh only
+// fetches `git diff --numstat` (see AsyncGitDataRefreshSystem), so the
+// selected file's hunks come from `git diff -- <path>` here; untracked
+// files are synthesized as all-added.  Results go into
+// RepoComponent::fileDiffCache, which status refreshes invalidate per
+// path.  Once the selection is loaded, the files directly above and below
+// it in the sidebar are prefetched.
+struct WorkingDiffLoaderSystem : afterhours::System<RepoComponent> {
+
+    // Upper bound on concurrent prefetch workers (selection loads always start).
+    static constexpr size_t MAX_IN_FLIGHT = 4;
+
+    void for_each_with(afterhours::Entity& entity, RepoComponent& repo,
+                       float) override {
+        if (repo.selectedFilePath.empty() || repo.repoPath.empty()) return;
+
+        std::string path(
+            normalize_repo_path(repo.repoPath, repo.selectedFilePath));
+        if (repo.fileDiffLoading.contains(path)) return;
+        if (!repo.fileDiffCache.contains(path)) {
+            start(entity, repo, path);
+            return;
+        }
+
+        prefetch_neighbors(entity, repo, path);
+    }
+
+    // Hunks for one file: tracked files (present in the numstat summary)
+    // via git, anything else read from disk.  Null means "no diff".
+    static std::shared_ptr<const FileDiff> load_file_diff(
+        const std::string& repoPath, const std::string& path, bool tracked) {
+        if (tracked) {
+            auto result = git::git_diff_file(repoPath, path);
+            if (!result.success()) return nullptr;
+            auto diffs = git::parse_diff(result.stdout_str());
+            if (diffs.empty()) return nullptr;
+            return std::make_shared<const FileDiff>(std::move(diffs.front()));
+        }
+        auto synth = build_new_file_diff(repoPath, path);
+        if (!synth) return nullptr;
+        return std::make_shared<const FileDiff>(std::move(*synth));
+    }
+
+   private:
+    static void start(afterhours::Entity& entity, RepoComponent& repo,
+                      const std::string& path) {
+        // Exact match only: a suffix match would let an untracked new_bar.cpp
+        // pass for a modified bar.cpp and come back as "no diff"
+        bool tracked = find_indexed_file_diff(repo, path) != nullptr;
+        uint64_t ticket = repo.nextFileDiffTicket++;
+        repo.fileDiffLoading[path] = ticket;
+        run_in_background([id = entity.id, repoPath = repo.repoPath, path,
+                           tracked, ticket]() {
+            auto diff = load_file_diff(repoPath, path, tracked);
+            size_t bytes = path.size() +
+                           (diff ? commit_detail_view::approx_bytes(*diff) : 0);
+            post_completion(id, [path, diff, bytes, ticket](afterhours::Entity& e) {
+                if (!e.has<RepoComponent>()) return;
+                auto& repo = e.get<RepoComponent>();
+                // Invalidated (or restarted) since this load began
+                auto it = repo.fileDiffLoading.find(path);
+                if (it == repo.fileDiffLoading.end() || it->second != ticket) return;
+                repo.fileDiffLoading.erase(it);
+                repo.fileDiffCache.put(path, diff, bytes);
+            });
+        });
+    }
+
+    // Sidebar order: staged, unstaged, untracked.
+    void prefetch_neighbors(afterhours::Entity& entity, RepoComponent& repo,
+                            const std::string& path) {
+        order_.clear();
+        for (auto& f : repo.stagedFiles) order_.push_back(&f.path);
+        for (auto& f : repo.unstagedFiles) order_.push_back(&f.path);
+        for (auto& p : repo.untrackedFiles) order_.push_back(&p);
+        size_t idx = 0;
+        while (idx < order_.size() && *order_[idx] != path) ++idx;
+        if (idx == order_.size()) return;
+
+        for (size_t n : {idx + 1, idx - 1}) {
+            if (n >= order_.size()) continue;  // idx - 1 wraps when idx == 0
+            if (repo.fileDiffLoading.size() >= MAX_IN_FLIGHT) return;
+            const std::string& neighbor = *order_[n];
+            if (repo.fileDiffCache.contains(neighbor) ||
+                repo.fileDiffLoading.contains(neighbor)) {
+                continue;
+            }
+            start(entity, repo, neighbor);
+        }
+    }
+
+    std::vector<const std::string*> order_;  // Reused across frames
+};
+
+} // namespace ecs
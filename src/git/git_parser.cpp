@@ -2,9 +2,12 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <cstdlib>
 #include <sstream>
 #include <string_view>
 
+#include "../util/git_helpers.h"
+
 namespace git {
 
 namespace {
@@ -60,6 +63,16 @@ StatusResult parse_status(const std::string& output) {
             fs.indexStatus = line[2];
             fs.workTreeStatus = line[3];
 
+            // hI (the index blob) is the 8th field; it changes whenever
+            // the staged content does, even if XY stays the same
+            size_t hash_start = skip_fields(line, 7);
+            if (hash_start != std::string::npos) {
+                size_t hash_end = line.find(' ', hash_start);
+                if (hash_end != std::string::npos) {
+                    fs.indexHash = line.substr(hash_start, hash_end - hash_start);
+                }
+            }
+
             if (line[0] == '1') {
                 // Ordinary changed entry: path starts after the 8th space
                 size_t path_start = skip_fields(line, 8);
@@ -150,6 +163,9 @@ std::vector<ecs::CommitEntry> parse_log(const std::string& log_output) {
             entry.authorDate = fields[4];
             if (fields.size() > 5) entry.decorations = fields[5];
             if (fields.size() > 6) entry.parentHashes = fields[6];
+            entry.authorTime = git_helpers::parse_iso8601(entry.authorDate);
+            entry.badges = git_helpers::parse_decorations(entry.decorations);
+            entry.bestBadge = git_helpers::best_decoration_index(entry.badges);
             entries.push_back(std::move(entry));
         }
     }
@@ -255,6 +271,20 @@ std::vector<ecs::FileDiff> parse_diff(const std::string& diff_output) {
             } else if (line[0] == '-') {
                 currentFile->deletions++;
             }
+        } else if (line.starts_with("index ") && currentFile && !currentHunk) {
+            // "index <old>..<new>[ <mode>]"; an all-zero id is a missing side
+            std::string_view ids(line);
+            ids.remove_prefix(6);
+            ids = ids.substr(0, ids.find(' '));
+            size_t dots = ids.find("..");
+            if (dots != std::string_view::npos) {
+                auto blob = [](std::string_view id) {
+                    bool zero = id.find_first_not_of('0') == std::string_view::npos;
+                    return zero ? std::string() : std::string(id);
+                };
+                currentFile->oldBlob = blob(ids.substr(0, dots));
+                currentFile->newBlob = blob(ids.substr(dots + 2));
+            }
         } else if (line.starts_with("rename from ")) {
             if (currentFile) {
                 currentFile->isRenamed = true;
@@ -276,6 +306,52 @@ std::vector<ecs::FileDiff> parse_diff(const std::string& diff_output) {
     return diffs;
 }
 
+// ---- Numstat Parser ----
+
+std::vector<ecs::FileDiff> parse_numstat(const std::string& output) {
+    std::vector<ecs::FileDiff> files;
+    size_t pos = 0;
+
+    // Next NUL-terminated field (the last one may lack its NUL)
+    auto next_field = [&output, &pos](std::string& field) {
+        if (pos >= output.size()) return false;
+        size_t end = output.find('\0', pos);
+        if (end == std::string::npos) end = output.size();
+        field.assign(output, pos, end - pos);
+        pos = end + 1;
+        return true;
+    };
+
+    std::string record;
+    while (next_field(record)) {
+        // "<added>\t<deleted>\t<path>", or "<added>\t<deleted>\t" followed by
+        // old and new path fields for a rename.  Binary files show "-".
+        while (!record.empty() && record.front() == '\n') record.erase(0, 1);
+        if (record.empty()) continue;
+        size_t tab1 = record.find('\t');
+        size_t tab2 = tab1 == std::string::npos ? tab1 : record.find('\t', tab1 + 1);
+        if (tab2 == std::string::npos) continue;
+
+        ecs::FileDiff file;
+        std::string added = record.substr(0, tab1);
+        std::string deleted = record.substr(tab1 + 1, tab2 - tab1 - 1);
+        if (added == "-" || deleted == "-") {
+            file.isBinary = true;
+        } else {
+            file.additions = std::atoi(added.c_str());
+            file.deletions = std::atoi(deleted.c_str());
+        }
+
+        file.filePath = record.substr(tab2 + 1);
+        if (file.filePath.empty()) {
+            if (!next_field(file.oldPath) || !next_field(file.filePath)) break;
+            file.isRenamed = true;
+        }
+        files.push_back(std::move(file));
+    }
+    return files;
+}
+
 // ---- Branch Parser (T031) ----
 
 std::vector<ecs::BranchInfo> parse_branch_list(const std::string& output) {
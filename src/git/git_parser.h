@@ -34,6 +34,12 @@ std::vector<ecs::CommitEntry> parse_log(const std::string& log_output);
 // Parse unified diff output from: git diff / git diff --staged / git show
 std::vector<ecs::FileDiff> parse_diff(const std::string& diff_output);
 
+// ---- Numstat Parser ----
+
+// Parse output of: git diff --numstat -z
+// One FileDiff per file with path, counts and rename/binary flags; no hunks.
+std::vector<ecs::FileDiff> parse_numstat(const std::string& numstat_output);
+
 // ---- Branch Parser (T031) ----
 
 // Parse output of: git branch --list --format="%(refname:short)|%(objectname:short)|%(HEAD)|%(upstream:short)|%(upstream:track)"
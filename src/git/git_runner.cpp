@@ -1,14 +1,33 @@
 #include "git_runner.h"
 
+#include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
 
+#include "../util/background_task.h"
+#include "git_stats.h"
+
 namespace git {
 
-static LogCallback g_log_callback = nullptr;
-static std::mutex g_log_mutex;
+// The log hook, leaked so workers still running at exit can use it.  The
+// mutex only guards swapping the callback; it is invoked outside the lock.
+struct LogHook {
+    std::shared_ptr<const LogCallback> callback;
+    std::mutex mutex;
+};
+
+static LogHook& log_hook() {
+    static auto* hook = new LogHook();
+    return *hook;
+}
 
-void set_log_callback(LogCallback cb) { g_log_callback = cb; }
+void set_log_callback(LogCallback cb) {
+    auto& hook = log_hook();
+    auto next = cb ? std::make_shared<const LogCallback>(std::move(cb)) : nullptr;
+    std::lock_guard lock(hook.mutex);
+    hook.callback = std::move(next);
+}
 
 namespace {
 
@@ -22,26 +41,87 @@ std::string build_command_string(
     return result;
 }
 
-}  // namespace
+// Fixed origin for GitInvocation::startMs so timeline entries line up.
+double ms_since_epoch(std::chrono::steady_clock::time_point t) {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t - epoch).count();
+}
 
-GitResult git_run(const std::string& repo_path,
-                  const std::vector<std::string>& args) {
+std::vector<std::string> git_command(const std::string& repo_path,
+                                     const std::vector<std::string>& args) {
     std::vector<std::string> cmd = {"git"};
     if (!repo_path.empty()) {
         cmd.push_back("-C");
         cmd.push_back(repo_path);
     }
     cmd.insert(cmd.end(), args.begin(), args.end());
+    return cmd;
+}
+
+// Record stats and notify the command log for a finished invocation.
+void finish_invocation(const std::vector<std::string>& cmd,
+                       const std::vector<std::string>& args,
+                       const GitResult& result, const std::string& loggedOutput,
+                       size_t stdoutBytes,
+                       std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end) {
+    GitInvocation inv;
+    inv.command = build_command_string(cmd);
+    inv.subcommand = git_subcommand(args);
+    inv.startMs = ms_since_epoch(start);
+    inv.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+    inv.bytesRead = stdoutBytes + result.stderr_str().size();
+    inv.exitCode = result.exit_code();
+    GitStats::get().record(inv);
+
+    std::shared_ptr<const LogCallback> callback;
+    {
+        auto& hook = log_hook();
+        std::lock_guard lock(hook.mutex);
+        callback = hook.callback;
+    }
+    if (callback) {
+        (*callback)(inv.command, loggedOutput, result.stderr_str(),
+                    result.success(), inv.durationMs);
+    }
+}
+
+}  // namespace
+
+GitResult git_run(const std::string& repo_path,
+                  const std::vector<std::string>& args) {
+    auto cmd = git_command(repo_path, args);
 
     GitResult result;
+    auto start = std::chrono::steady_clock::now();
     result.raw = run_process("", cmd);
+    auto end = std::chrono::steady_clock::now();
 
-    if (g_log_callback) {
-        std::lock_guard lock(g_log_mutex);
-        g_log_callback(build_command_string(cmd), result.stdout_str(),
-                       result.stderr_str(), result.success());
-    }
+    finish_invocation(cmd, args, result, result.stdout_str(),
+                      result.stdout_str().size(), start, end);
+    return result;
+}
 
+GitResult git_run_streaming(const std::string& repo_path,
+                            const std::vector<std::string>& args,
+                            const std::function<bool(std::string_view)>& on_stdout,
+                            const std::atomic<bool>* cancel) {
+    auto cmd = git_command(repo_path, args);
+
+    GitResult result;
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    result.raw = run_process_streaming("", cmd, [&](std::string_view chunk) {
+        bytes += chunk.size();
+        // Don't keep a long stream (log -S, ls-files) running past shutdown
+        if (background_stopping()) return false;
+        return on_stdout(chunk);
+    }, cancel, &BackgroundTasks::get().stopping);
+    auto end = std::chrono::steady_clock::now();
+
+    finish_invocation(cmd, args, result,
+                      "[" + std::to_string(bytes) + " bytes streamed]", bytes,
+                      start, end);
     return result;
 }
 
@@ -51,7 +131,7 @@ std::future<GitResult> git_run_async(
     std::packaged_task<GitResult()> task(
         [repo_path, args]() { return git_run(repo_path, args); });
     auto future = task.get_future();
-    std::thread(std::move(task)).detach();
+    run_in_background(std::move(task));
     return future;
 }
 
@@ -67,13 +147,13 @@ GitResult git_status(const std::string& repo_path) {
                    {"status", "--porcelain=v2", "--branch"});
 }
 
+// Machine-readable log format with NUL separators:
+// hash\0shortHash\0subject\0author\0date\0decorations\0parentHashes
+static constexpr const char* LOG_FORMAT =
+    "--format=%H%x00%h%x00%s%x00%an%x00%aI%x00%D%x00%P";
+
 GitResult git_log(const std::string& repo_path, int max_count, int skip) {
-    // Machine-readable format with NUL separators:
-    // hash\0shortHash\0subject\0author\0date\0decorations\0parentHashes
-    std::vector<std::string> args = {
-        "log",
-        "--format=%H%x00%h%x00%s%x00%an%x00%aI%x00%D%x00%P",
-    };
+    std::vector<std::string> args = {"log", LOG_FORMAT};
     if (max_count > 0) {
         args.push_back("-" + std::to_string(max_count));
     }
@@ -83,6 +163,61 @@ GitResult git_log(const std::string& repo_path, int max_count, int skip) {
     return git_run(repo_path, args);
 }
 
+GitResult git_log_range(const std::string& repo_path, const std::string& range,
+                        int max_count) {
+    std::vector<std::string> args = {"log", LOG_FORMAT};
+    if (max_count > 0) {
+        args.push_back("-" + std::to_string(max_count));
+    }
+    args.push_back(range);
+    args.push_back("--");
+    return git_run(repo_path, args);
+}
+
+GitResult git_log_from(const std::string& repo_path,
+                       const std::vector<std::string>& starts, int max_count) {
+    std::vector<std::string> args = {"log", LOG_FORMAT};
+    if (max_count > 0) {
+        args.push_back("-" + std::to_string(max_count));
+    }
+    args.insert(args.end(), starts.begin(), starts.end());
+    args.push_back("--");
+    return git_run(repo_path, args);
+}
+
+GitResult git_log_ref_tips(const std::string& repo_path) {
+    return git_run(repo_path, {"log", "--no-walk", LOG_FORMAT, "HEAD",
+                               "--branches", "--tags", "--remotes", "--"});
+}
+
+GitResult git_ref_list(const std::string& repo_path) {
+    return git_run(repo_path, {"for-each-ref", "--format=%(objectname) %(HEAD) %(refname)",
+                               "refs/heads", "refs/tags", "refs/remotes"});
+}
+
+GitResult git_log_search_stream(const std::string& repo_path, const std::string& range,
+                                const std::function<bool(std::string_view)>& on_stdout) {
+    return git_run_streaming(
+        repo_path, {"log", "--format=%H%x1f%an <%ae>%x1f%at%x1f%s%x1f%b%x1e", range, "--"},
+        on_stdout);
+}
+
+GitResult git_log_pickaxe_stream(const std::string& repo_path, const std::string& pattern,
+                                 bool regex,
+                                 const std::function<bool(std::string_view)>& on_stdout,
+                                 const std::atomic<bool>* cancel) {
+    return git_run_streaming(
+        repo_path, {"log", LOG_FORMAT, (regex ? "-G" : "-S") + pattern, "HEAD", "--"},
+        on_stdout, cancel);
+}
+
+GitResult git_is_ancestor(const std::string& repo_path,
+                          const std::string& ancestor,
+                          const std::string& descendant) {
+    return git_run(repo_path,
+                   {"merge-base", "--is-ancestor", ancestor, descendant});
+}
+
 GitResult git_diff(const std::string& repo_path) {
     return git_run(repo_path, {"diff"});
 }
@@ -91,6 +226,21 @@ GitResult git_diff_staged(const std::string& repo_path) {
     return git_run(repo_path, {"diff", "--staged"});
 }
 
+GitResult git_ls_files_stream(const std::string& repo_path,
+                              const std::function<bool(std::string_view)>& on_stdout) {
+    return git_run_streaming(repo_path, {"ls-files", "-z"}, on_stdout);
+}
+
+GitResult git_diff_file(const std::string& repo_path, const std::string& path) {
+    return git_run(repo_path, {"diff", "--", path});
+}
+
+GitResult git_diff_numstat(const std::string& repo_path, bool staged) {
+    std::vector<std::string> args = {"diff", "--numstat", "-z"};
+    if (staged) args.push_back("--staged");
+    return git_run(repo_path, args);
+}
+
 GitResult git_add(const std::string& repo_path,
                   const std::vector<std::string>& paths) {
     std::vector<std::string> args = {"add"};
@@ -166,6 +316,10 @@ GitResult git_show_commit_info(const std::string& repo_path,
     });
 }
 
+GitResult git_cat_blob(const std::string& repo_path, const std::string& blob_id) {
+    return git_run(repo_path, {"cat-file", "blob", blob_id});
+}
+
 // --- Async convenience wrappers ---
 
 std::future<GitResult> git_status_async(const std::string& repo_path) {
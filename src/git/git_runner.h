@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <future>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../util/process.h"
@@ -17,13 +19,17 @@ struct GitResult {
     int exit_code() const { return raw.exit_code; }
 };
 
-// Log callback type -- called for every git command executed
+// Log callback type -- called for every git command executed, with its
+// wall-clock duration
 using LogCallback = std::function<void(const std::string& command,
                                        const std::string& output,
                                        const std::string& error,
-                                       bool success)>;
+                                       bool success,
+                                       double durationMs)>;
 
-// Set the global log callback (called by T038 command log)
+// Set the global log callback (called by T038 command log).  It runs on
+// whichever thread ran the command, concurrently and without a lock held,
+// so it must be thread-safe itself.
 void set_log_callback(LogCallback cb);
 
 // Synchronous git execution
@@ -31,6 +37,16 @@ void set_log_callback(LogCallback cb);
 GitResult git_run(const std::string& repo_path,
                   const std::vector<std::string>& args);
 
+// Streaming git execution: stdout goes to `on_stdout` chunk by chunk (see
+// run_process_streaming, also for `cancel`) and stdout_str() stays empty.
+// With or without a `cancel` flag the stream also stops when shutdown
+// begins (see shutdown_background_tasks), even while git prints nothing.
+// The command log records the byte count instead of the output.
+GitResult git_run_streaming(const std::string& repo_path,
+                            const std::vector<std::string>& args,
+                            const std::function<bool(std::string_view)>& on_stdout,
+                            const std::atomic<bool>* cancel = nullptr);
+
 // Asynchronous git execution (for push/pull/fetch)
 std::future<GitResult> git_run_async(
     const std::string& repo_path,
@@ -50,12 +66,62 @@ GitResult git_status(const std::string& repo_path);
 GitResult git_log(const std::string& repo_path, int max_count = 100,
                   int skip = 0);
 
+// git log <range> in the same format, e.g. "old..new" for commits added
+// since `old` (max_count 0 = unlimited)
+GitResult git_log_range(const std::string& repo_path, const std::string& range,
+                        int max_count = 0);
+
+// git log starting from several commits at once (the pagination cursor,
+// see git/log_update.h)
+GitResult git_log_from(const std::string& repo_path,
+                       const std::vector<std::string>& starts,
+                       int max_count = 0);
+
+// git log --no-walk over HEAD and every branch, tag and remote ref, in the
+// same format: one entry per ref tip, carrying its current decorations
+GitResult git_log_ref_tips(const std::string& repo_path);
+
+// The same refs as "<object> <*|space> <refname>" lines (the '*' marks the
+// branch HEAD points at).  Reads only the refs, not the commits, so it is
+// a cheap way to tell whether git_log_ref_tips would say anything new.
+GitResult git_ref_list(const std::string& repo_path);
+
+// git log <range> for the commit search index, streamed: per commit
+// hash, "name <email>", author unix time, subject and body, separated by
+// 0x1f and terminated by 0x1e (see util/commit_search_index.h)
+GitResult git_log_search_stream(const std::string& repo_path, const std::string& range,
+                                const std::function<bool(std::string_view)>& on_stdout);
+
+// git log -S<pattern> (or -G<pattern> when `regex`) from HEAD, streamed
+// in git_log's format: commits whose diffs add or remove the string, or
+// touch a line matching the regex, as git finds them
+GitResult git_log_pickaxe_stream(const std::string& repo_path, const std::string& pattern,
+                                 bool regex,
+                                 const std::function<bool(std::string_view)>& on_stdout,
+                                 const std::atomic<bool>* cancel = nullptr);
+
+// git merge-base --is-ancestor: exit code 0 if `ancestor` is reachable
+// from `descendant`, 1 if not, anything else on error
+GitResult git_is_ancestor(const std::string& repo_path,
+                          const std::string& ancestor,
+                          const std::string& descendant);
+
 // git diff (unstaged changes)
 GitResult git_diff(const std::string& repo_path);
 
 // git diff --staged
 GitResult git_diff_staged(const std::string& repo_path);
 
+// git ls-files -z, streamed (every path in the index, NUL-terminated)
+GitResult git_ls_files_stream(const std::string& repo_path,
+                              const std::function<bool(std::string_view)>& on_stdout);
+
+// git diff -- <path> (unstaged changes to one file)
+GitResult git_diff_file(const std::string& repo_path, const std::string& path);
+
+// git diff --numstat -z [--staged] (per-file line counts, no hunks)
+GitResult git_diff_numstat(const std::string& repo_path, bool staged = false);
+
 // git add <paths>
 GitResult git_add(const std::string& repo_path,
                   const std::vector<std::string>& paths);
@@ -105,6 +171,9 @@ GitResult git_show(const std::string& repo_path,
 GitResult git_show_commit_info(const std::string& repo_path,
                                 const std::string& commit_hash);
 
+// git cat-file blob <id> (file contents by blob id, abbreviated ids OK)
+GitResult git_cat_blob(const std::string& repo_path, const std::string& blob_id);
+
 // --- Async convenience wrappers ---
 // Each runs the corresponding git command on a background thread via
 // std::async.  The returned future becomes ready when the subprocess
@@ -0,0 +1,161 @@
+#include "git_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace git {
+
+std::string git_subcommand(const std::vector<std::string>& args) {
+    for (size_t i = 0; i < args.size(); ++i) {
+        const auto& a = args[i];
+        if (a == "git") continue;
+        // Global options that take a separate value
+        if (a == "-C" || a == "-c" || a == "--git-dir" || a == "--work-tree") {
+            ++i;
+            continue;
+        }
+        if (!a.empty() && a[0] == '-') continue;
+        return a;
+    }
+    return {};
+}
+
+// ---- LatencyHistogram ----
+
+size_t LatencyHistogram::bucket_for(double ms) {
+    if (!(ms >= 1.0)) return 0;  // Also catches NaN
+    auto b = static_cast<size_t>(std::floor(std::log2(ms))) + 1;
+    return std::min(b, BUCKETS - 1);
+}
+
+double LatencyHistogram::bucket_upper_ms(size_t i) {
+    if (i + 1 >= BUCKETS) return std::numeric_limits<double>::infinity();
+    return std::ldexp(1.0, static_cast<int>(i));
+}
+
+void LatencyHistogram::add(double ms, size_t bytes, bool failed) {
+    ++counts[bucket_for(ms)];
+    ++total;
+    if (failed) ++failures;
+    totalMs += ms;
+    maxMs = std::max(maxMs, ms);
+    bytesRead += bytes;
+}
+
+double LatencyHistogram::quantile_upper_ms(double q) const {
+    if (total == 0) return 0.0;
+    auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(total)));
+    rank = std::clamp<uint64_t>(rank, 1, total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(bucket_upper_ms(i), maxMs);
+    }
+    return maxMs;
+}
+
+// ---- GitStats ----
+
+namespace {
+
+void write_json_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+// Leaked: background workers may record after main() returns.
+GitStats& GitStats::get() {
+    static auto* stats = new GitStats();
+    return *stats;
+}
+
+void GitStats::record(const GitInvocation& inv) {
+    std::lock_guard lock(mutex_);
+    bySubcommand_[inv.subcommand].add(inv.durationMs, inv.bytesRead,
+                                      inv.exitCode != 0);
+
+    if (!trace_.is_open()) return;
+    if (!traceFirst_) trace_ << ",\n";
+    traceFirst_ = false;
+    auto tid = std::hash<std::thread::id>{}(std::this_thread::get_id()) % 100000;
+    trace_ << "{\"name\":";
+    write_json_string(trace_, inv.subcommand.empty() ? "git" : "git " + inv.subcommand);
+    trace_ << ",\"cat\":\"git\",\"ph\":\"X\",\"ts\":"
+           << static_cast<int64_t>(inv.startMs * 1000.0)
+           << ",\"dur\":" << static_cast<int64_t>(inv.durationMs * 1000.0)
+           << ",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"command\":";
+    write_json_string(trace_, inv.command);
+    trace_ << ",\"bytes\":" << inv.bytesRead << ",\"exit\":" << inv.exitCode
+           << "}}";
+    trace_.flush();
+}
+
+std::map<std::string, LatencyHistogram> GitStats::snapshot() const {
+    std::lock_guard lock(mutex_);
+    return bySubcommand_;
+}
+
+std::string GitStats::format_report() const {
+    auto stats = snapshot();
+    std::vector<std::pair<std::string, LatencyHistogram>> rows(stats.begin(),
+                                                               stats.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.quantile_upper_ms(0.99) > b.second.quantile_upper_ms(0.99);
+    });
+
+    std::string out;
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "%-14s %6s %9s %9s %9s %9s %10s\n",
+                  "subcommand", "count", "mean ms", "p50 <=ms", "p99 <=ms",
+                  "max ms", "bytes");
+    out += buf;
+    for (const auto& [name, h] : rows) {
+        std::snprintf(buf, sizeof(buf),
+                      "%-14.14s %6llu %9.1f %9.0f %9.0f %9.1f %10llu\n",
+                      name.empty() ? "(none)" : name.c_str(),
+                      static_cast<unsigned long long>(h.total),
+                      h.totalMs / static_cast<double>(h.total),
+                      h.quantile_upper_ms(0.50), h.quantile_upper_ms(0.99),
+                      h.maxMs, static_cast<unsigned long long>(h.bytesRead));
+        out += buf;
+    }
+    return out;
+}
+
+bool GitStats::open_trace(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    trace_.open(path, std::ios::out | std::ios::trunc);
+    if (!trace_) return false;
+    trace_ << "{\"traceEvents\":[\n";
+    traceFirst_ = true;
+    return true;
+}
+
+void GitStats::close_trace() {
+    std::lock_guard lock(mutex_);
+    if (!trace_.is_open()) return;
+    trace_ << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    trace_.close();
+}
+
+void GitStats::reset() {
+    std::lock_guard lock(mutex_);
+    bySubcommand_.clear();
+}
+
+}  // namespace git
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace git {
+
+// Timing and size of one git invocation, filled in by git_run().
+struct GitInvocation {
+    std::string command;      // Full command line, for the timeline
+    std::string subcommand;   // "log", "status", ... ("" if none)
+    double startMs = 0.0;     // Steady-clock ms since the first git_run()
+    double durationMs = 0.0;
+    size_t bytesRead = 0;     // stdout + stderr
+    int exitCode = -1;
+};
+
+// First non-option argument of a git argument list ("-C <path>" and other
+// global options are skipped).
+std::string git_subcommand(const std::vector<std::string>& args);
+
+// Per-subcommand latency histogram.  Buckets are powers of two in
+// milliseconds: bucket 0 is < 1 ms, bucket i covers [2^(i-1), 2^i) ms,
+// and the last bucket is open-ended (>= ~16 s).
+struct LatencyHistogram {
+    static constexpr size_t BUCKETS = 16;
+
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t failures = 0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    uint64_t bytesRead = 0;
+
+    static size_t bucket_for(double ms);
+    // Upper bound of bucket `i` in ms (infinity for the last bucket).
+    static double bucket_upper_ms(size_t i);
+
+    void add(double ms, size_t bytes, bool failed);
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1).
+    double quantile_upper_ms(double q) const;
+};
+
+// Process-wide git latency statistics, plus an optional timeline file
+// (--trace-git).  Thread-safe: git_run() records from worker threads.
+class GitStats {
+   public:
+    static GitStats& get();
+
+    void record(const GitInvocation& inv);
+
+    // Copy of the per-subcommand histograms.
+    std::map<std::string, LatencyHistogram> snapshot() const;
+
+    // Multi-line summary, slowest subcommands (by p99) first.
+    std::string format_report() const;
+
+    // Stream every invocation to `path` as Chrome trace events.  The file
+    // is valid JSON once close_trace() runs; Chrome and Perfetto also load
+    // a truncated one.  Returns false if the file can't be opened.
+    bool open_trace(const std::string& path);
+    void close_trace();
+
+    void reset();
+
+   private:
+    mutable std::mutex mutex_;
+    std::map<std::string, LatencyHistogram> bySubcommand_;
+    std::ofstream trace_;
+    bool traceFirst_ = true;
+};
+
+}  // namespace git
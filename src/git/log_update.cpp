@@ -0,0 +1,117 @@
+#include "log_update.h"
+
+#include <iterator>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+namespace git {
+
+void set_decorations(ecs::CommitEntry& commit, std::string decorations) {
+    commit.decorations = std::move(decorations);
+    commit.badges = git_helpers::parse_decorations(commit.decorations);
+    commit.bestBadge = git_helpers::best_decoration_index(commit.badges);
+}
+
+bool has_merge_commit(const std::vector<ecs::CommitEntry>& commits) {
+    for (const auto& c : commits) {
+        if (c.parentHashes.find(' ') != std::string::npos) return true;
+    }
+    return false;
+}
+
+ecs::CommitLog make_commit_log(std::vector<ecs::CommitEntry>&& commits) {
+    return ecs::CommitLog(std::make_move_iterator(commits.begin()),
+                          std::make_move_iterator(commits.end()));
+}
+
+void prepend_commits(ecs::CommitLog& log, ecs::CommitIndex& index,
+                     std::vector<ecs::CommitEntry>&& newer) {
+    if (newer.empty()) return;
+    index.shift(newer.size());
+    for (size_t i = 0; i < newer.size(); ++i) index.add(newer[i], i);
+    log.insert(log.begin(), std::make_move_iterator(newer.begin()),
+               std::make_move_iterator(newer.end()));
+}
+
+namespace {
+
+// Add the parents of `commit` that aren't loaded to `out` (deduplicated
+// through `seen`).
+void add_unloaded_parents(const ecs::CommitEntry& commit,
+                          const ecs::CommitIndex& index,
+                          std::unordered_set<std::string>& seen,
+                          std::vector<std::string>& out) {
+    std::string_view parents = commit.parentHashes;
+    while (!parents.empty()) {
+        size_t end = parents.find(' ');
+        std::string_view parent = parents.substr(0, end);
+        parents.remove_prefix(end == std::string_view::npos ? parents.size() : end + 1);
+        if (parent.empty()) continue;
+        std::string hash(parent);
+        if (index.contains(hash) || !seen.insert(hash).second) continue;
+        out.push_back(std::move(hash));
+    }
+}
+
+}  // namespace
+
+std::vector<std::string> log_frontier(const ecs::CommitLog& log,
+                                      const ecs::CommitIndex& index) {
+    std::vector<std::string> frontier;
+    std::unordered_set<std::string> seen;
+    for (const auto& c : log) add_unloaded_parents(c, index, seen, frontier);
+    return frontier;
+}
+
+size_t append_page(ecs::CommitLog& log, ecs::CommitIndex& index,
+                   std::vector<std::string>& frontier,
+                   std::vector<ecs::CommitEntry>&& page) {
+    size_t first = log.size();
+    for (auto& c : page) {
+        if (!index.add(c, log.size())) continue;
+        log.push_back(std::move(c));
+    }
+
+    std::vector<std::string> next;
+    std::unordered_set<std::string> seen;
+    for (auto& hash : frontier) {
+        if (index.contains(hash) || !seen.insert(hash).second) continue;
+        next.push_back(std::move(hash));
+    }
+    for (size_t i = first; i < log.size(); ++i) {
+        add_unloaded_parents(log[i], index, seen, next);
+    }
+    frontier = std::move(next);
+    return log.size() - first;
+}
+
+size_t apply_ref_tips(ecs::CommitLog& log, ecs::CommitIndex& index,
+                      const std::vector<ecs::CommitEntry>& tips) {
+    std::vector<size_t> decorated;
+    std::unordered_set<size_t> isTip;
+    size_t changed = 0;
+    for (const auto& tip : tips) {
+        size_t row = index.row(tip.hash);
+        if (row >= log.size() || tip.decorations.empty()) continue;
+        if (!isTip.insert(index.key(row)).second) continue;
+        decorated.push_back(index.key(row));
+        auto& commit = log[row];
+        if (commit.decorations != tip.decorations) {
+            set_decorations(commit, tip.decorations);
+            ++changed;
+        }
+    }
+    for (size_t key : index.decorated) {
+        size_t row = index.row_of_key(key);
+        if (isTip.contains(key) || row >= log.size()) continue;
+        if (!log[row].decorations.empty()) {
+            set_decorations(log[row], {});
+            ++changed;
+        }
+    }
+    index.decorated = std::move(decorated);
+    return changed;
+}
+
+}  // namespace git
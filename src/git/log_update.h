@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../ecs/components.h"  // CommitEntry, CommitLog, CommitIndex
+
+namespace git {
+
+// ---- Incremental commit log updates ----
+//
+// A refresh where HEAD only moved forward fetches just `old..HEAD` and
+// prepends it to the loaded log instead of replacing the list.  Ref tips
+// (git_log_ref_tips) are re-read whenever the refs changed, going by a
+// fingerprint of git_ref_list and HEAD, so branch/tag badges on the
+// commits already loaded stay current.  Both updates cost O(commits or
+// tips involved), not O(commits loaded): they run on the UI thread.
+
+// Set a commit's %D string and re-derive its badges (as parse_log does).
+void set_decorations(ecs::CommitEntry& commit, std::string decorations);
+
+// True if any commit has more than one parent.  Commits from a merged side
+// branch can interleave by date with history already loaded, so a range
+// containing a merge is reloaded in full instead of prepended.
+bool has_merge_commit(const std::vector<ecs::CommitEntry>& commits);
+
+// A parsed log as a CommitLog.
+ecs::CommitLog make_commit_log(std::vector<ecs::CommitEntry>&& commits);
+
+// Insert `newer` (newest first) in front of `log` and index it.  `newer`
+// must not contain commits already in `index`.
+void prepend_commits(ecs::CommitLog& log, ecs::CommitIndex& index,
+                     std::vector<ecs::CommitEntry>&& newer);
+
+// ---- Pagination ----
+//
+// The next page of history is `git log <frontier>`, where the frontier is
+// every parent of a loaded commit that isn't loaded itself.  For linear
+// history that is just `<last-hash>^`; with merges it is each open side
+// of the walk, so the continuation matches what one long `git log` would
+// have listed, without `--skip` re-walking everything already loaded.
+
+// Frontier of a freshly loaded log.  `index` is build_commit_index(log).
+std::vector<std::string> log_frontier(const ecs::CommitLog& log,
+                                      const ecs::CommitIndex& index);
+
+// Append a page, skipping commits already loaded, and advance `index` and
+// `frontier` to match.  Returns how many commits were appended.
+size_t append_page(ecs::CommitLog& log, ecs::CommitIndex& index,
+                   std::vector<std::string>& frontier,
+                   std::vector<ecs::CommitEntry>&& page);
+
+// Make decorations in `log` match `tips`: commits that are a tip get its
+// decorations, every other commit gets none.  Only the tips and the rows
+// `index` lists as decorated are visited; `index.decorated` is updated.
+// Returns how many commits changed.
+size_t apply_ref_tips(ecs::CommitLog& log, ecs::CommitIndex& index,
+                      const std::vector<ecs::CommitEntry>& tips);
+
+}  // namespace git
@@ -0,0 +1,123 @@
+#include "status_delta.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace git {
+
+namespace {
+
+const std::string& key_of(const ecs::FileStatus& f) { return f.path; }
+const std::string& key_of(const std::string& path) { return path; }
+
+bool same_entry(const ecs::FileStatus& a, const ecs::FileStatus& b) {
+    return same_status(a, b);
+}
+bool same_entry(const std::string&, const std::string&) { return true; }
+
+template <typename T>
+void apply_delta(std::vector<T>& current, std::vector<T>&& next,
+                 ecs::StatusChangeSet& changes) {
+    // Fast path: same paths in the same order, nothing changed
+    if (current.size() == next.size() &&
+        std::equal(current.begin(), current.end(), next.begin(),
+                   [](const T& a, const T& b) {
+                       return key_of(a) == key_of(b) && same_entry(a, b);
+                   })) {
+        return;
+    }
+
+    constexpr size_t NONE = static_cast<size_t>(-1);
+    std::unordered_map<std::string_view, size_t> oldIndex;
+    oldIndex.reserve(current.size());
+    for (size_t i = 0; i < current.size(); ++i) {
+        oldIndex.emplace(key_of(current[i]), i);
+    }
+
+    // Match before moving anything: oldIndex views current's paths
+    std::vector<size_t> match(next.size(), NONE);
+    std::vector<bool> kept(current.size(), false);
+    for (size_t i = 0; i < next.size(); ++i) {
+        auto it = oldIndex.find(key_of(next[i]));
+        if (it == oldIndex.end()) continue;
+        match[i] = it->second;
+        kept[it->second] = true;
+    }
+    for (size_t i = 0; i < current.size(); ++i) {
+        if (!kept[i]) changes.removed.push_back(key_of(current[i]));
+    }
+
+    std::vector<T> merged;
+    merged.reserve(next.size());
+    for (size_t i = 0; i < next.size(); ++i) {
+        if (match[i] == NONE) {
+            changes.added.push_back(key_of(next[i]));
+            merged.push_back(std::move(next[i]));
+        } else if (same_entry(current[match[i]], next[i])) {
+            merged.push_back(std::move(current[match[i]]));
+        } else {
+            changes.changed.push_back(key_of(next[i]));
+            merged.push_back(std::move(next[i]));
+        }
+    }
+    current = std::move(merged);
+}
+
+}  // namespace
+
+std::vector<std::string> affected_paths(const ecs::StatusChangeSet& changes) {
+    const auto& [added, removed, changed] = changes;
+    std::vector<std::string> paths;
+    paths.reserve(added.size() + removed.size() + changed.size());
+    paths.insert(paths.end(), added.begin(), added.end());
+    paths.insert(paths.end(), removed.begin(), removed.end());
+    paths.insert(paths.end(), changed.begin(), changed.end());
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+    return paths;
+}
+
+bool same_status(const ecs::FileStatus& a, const ecs::FileStatus& b) {
+    return a.path == b.path && a.indexStatus == b.indexStatus &&
+           a.workTreeStatus == b.workTreeStatus && a.origPath == b.origPath &&
+           a.additions == b.additions && a.deletions == b.deletions &&
+           a.indexHash == b.indexHash && a.worktreeStamp == b.worktreeStamp;
+}
+
+void apply_status_delta(std::vector<ecs::FileStatus>& current,
+                        std::vector<ecs::FileStatus>&& next,
+                        ecs::StatusChangeSet& changes) {
+    apply_delta(current, std::move(next), changes);
+}
+
+void apply_status_delta(std::vector<std::string>& current,
+                        std::vector<std::string>&& next,
+                        ecs::StatusChangeSet& changes) {
+    apply_delta(current, std::move(next), changes);
+}
+
+void stamp_worktree(const std::string& repoPath,
+                    std::vector<ecs::FileStatus>& files) {
+    namespace fs = std::filesystem;
+    for (auto& f : files) {
+        std::error_code ec;
+        fs::path full = fs::path(repoPath) / f.path;
+        auto mtime = fs::last_write_time(full, ec);
+        if (ec) {
+            f.worktreeStamp = 0;
+            continue;
+        }
+        auto size = fs::file_size(full, ec);
+        if (ec) size = 0;
+        // Mix the size in so a same-tick rewrite of a different length
+        // still differs.  0 is reserved for "missing".
+        auto ticks = static_cast<uint64_t>(mtime.time_since_epoch().count());
+        uint64_t stamp = ticks ^ (static_cast<uint64_t>(size) * 0x9E3779B97F4A7C15ull);
+        f.worktreeStamp = stamp != 0 ? static_cast<int64_t>(stamp) : 1;
+    }
+}
+
+}  // namespace git
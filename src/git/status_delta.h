@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../ecs/components.h"  // FileStatus, StatusChangeSet
+
+namespace git {
+
+// ---- Keyed status updates ----
+//
+// A refresh brings the staged/unstaged/untracked lists to the new
+// `git status` snapshot by path instead of replacing them: entries that
+// didn't change are kept as they are, and the paths that appeared,
+// disappeared or changed are collected so other systems can invalidate
+// just those (per-file diff cache, file tree).
+
+// Every path in a change set (ecs::StatusChangeSet), sorted and
+// deduplicated; a path that moved between sections shows up once.
+std::vector<std::string> affected_paths(const ecs::StatusChangeSet& changes);
+
+// Equal status letters, rename source, line counts and content stamps.
+bool same_status(const ecs::FileStatus& a, const ecs::FileStatus& b);
+
+// Bring `current` to `next`, keyed by path and in `next`'s order, and
+// record what differed in `changes`.  `current` isn't touched at all when
+// nothing did.
+void apply_status_delta(std::vector<ecs::FileStatus>& current,
+                        std::vector<ecs::FileStatus>&& next,
+                        ecs::StatusChangeSet& changes);
+void apply_status_delta(std::vector<std::string>& current,
+                        std::vector<std::string>&& next,
+                        ecs::StatusChangeSet& changes);
+
+// Fingerprint each file's worktree copy (mtime and size) into
+// worktreeStamp, so an edit that leaves the status letters and line
+// counts alone still counts as a change.  Runs on the refresh worker.
+void stamp_worktree(const std::string& repoPath,
+                    std::vector<ecs::FileStatus>& files);
+
+}  // namespace git
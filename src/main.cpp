@@ -1,7 +1,9 @@
 #include <argh.h>
 
 #include <chrono>
+#include <filesystem>
 #include <string>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #ifdef __APPLE__
@@ -16,6 +18,11 @@ extern "C" void metal_wait_all_screenshots(void);
 #include "settings.h"
 #include "ui_context.h"
 #include <afterhours/src/plugins/ui/validation_systems.h>
+#include "util/alloc_counter.h"
+#include "util/background_task.h"
+#include "util/frame_profiler.h"
+#include "util/frame_scheduler.h"
+#include "util/frame_stats.h"
 #include "util/process.h"
 
 #include "../vendor/afterhours/src/ecs.h"
@@ -23,6 +30,8 @@ extern "C" void metal_wait_all_screenshots(void);
 #include "ecs/components.h"
 #include "ecs/app_reset.h"
 #include "ecs/async_git_refresh_system.h"
+#include "ecs/commit_detail_loader_system.h"
+#include "ecs/completion_system.h"
 #include "ecs/file_watcher_system.h"
 #include "ecs/layout_system.h"
 #include "ecs/main_content_system.h"
@@ -32,9 +41,18 @@ extern "C" void metal_wait_all_screenshots(void);
 #include "ecs/tab_bar_system.h"
 #include "ecs/toolbar_system.h"
 #include "ecs/network_ops_system.h"
+#include "ecs/profiler_overlay_system.h"
 #include "ecs/validation_summary_system.h"
+#include "ecs/working_diff_loader_system.h"
+#include "ecs/repo_file_index_system.h"
+#include "ecs/commit_graph_system.h"
+#include "ecs/word_diff_system.h"
+#include "ecs/syntax_highlight_system.h"
+#include "ecs/commit_search_system.h"
+#include "ecs/file_finder_system.h"
 #include "git/git_runner.h"
 #include "git/git_parser.h"
+#include "git/git_stats.h"
 
 // E2E testing support
 #include <afterhours/src/plugins/e2e_testing/e2e_testing.h>
@@ -90,8 +108,237 @@ std::string pendingScreenshotName;
 // Validation
 std::string validationReportPath;
 
+// Time spent in systemManager->run() per frame
+FrameTimeStats frameStats;
+
+// Idle-aware frame pacing (interactive mode only)
+FrameScheduler frameScheduler;
+
+// --idle-benchmark=<seconds>: measure idle CPU, then quit (0 = off)
+float idleBenchmarkSeconds = 0.0f;
+
+// Per-system timings (View > Frame Profiler); --profile opens the overlay,
+// --trace-out=<path> records a Chrome trace from startup and writes it on exit
+FrameProfiler profiler;
+bool profileOverlay = false;
+std::string traceOutPath;
+
+// --trace-git[=<path>]: stream every git invocation to a timeline file
+std::string gitTracePath;
+
 }  // namespace app_state
 
+// Run all systems for one frame and record how long the UI thread spent.
+static void run_systems_timed(float dt) {
+    auto& prof = app_state::profiler;
+    bool profiling = prof.enabled();
+    auto start = std::chrono::steady_clock::now();
+    if (profiling) prof.begin_frame(start);
+    app_state::systemManager->run(dt);
+    if (profiling) {
+        prof.end_frame(std::chrono::steady_clock::now(),
+                       alloc_counter::thread_allocations());
+    }
+    app_state::frameStats.record(ms_since(start));
+}
+
+static void write_trace_out() {
+    auto& prof = app_state::profiler;
+    if (app_state::traceOutPath.empty() || prof.trace_event_count() == 0) return;
+    if (prof.write_chrome_trace(app_state::traceOutPath)) {
+        log_info("profiler: wrote {} trace events to {}",
+                 prof.trace_event_count(), app_state::traceOutPath);
+    } else {
+        log_warn("profiler: could not write {}", app_state::traceOutPath);
+    }
+}
+
+// ---- Per-system profiling ----
+//
+// SystemManager runs systems in registration order, so a marker system
+// registered in front of each real one splits the frame into per-system
+// sections without touching the systems themselves.  Markers opt out via
+// should_run() while the profiler is off.
+struct ProfileMark : afterhours::System<> {
+    size_t section = 0;
+
+    bool should_run(const float) override {
+        return app_state::profiler.enabled();
+    }
+    void once(float) override {
+        app_state::profiler.mark(section, std::chrono::steady_clock::now(),
+                                 alloc_counter::thread_allocations());
+    }
+};
+
+// Entities a System<Cs...> iterates, for the overlay's entity column.
+template <typename... Cs>
+static std::function<size_t()> entity_counter(const afterhours::System<Cs...>*) {
+    if constexpr (sizeof...(Cs) == 0) {
+        return {};
+    } else {
+        return [] {
+            auto q = afterhours::EntityQuery({.force_merge = true});
+            (q.template whereHasComponent<Cs>(), ...);
+            return q.gen().size();
+        };
+    }
+}
+
+static void add_profile_mark(afterhours::SystemManager& sm, std::string name,
+                             std::function<size_t()> countEntities = {}) {
+    auto mark = std::make_unique<ProfileMark>();
+    mark->section = app_state::profiler.add_section(std::move(name),
+                                                    std::move(countEntities));
+    sm.register_update_system(std::move(mark));
+}
+
+template <typename S>
+static void register_profiled(afterhours::SystemManager& sm, std::string name,
+                              std::unique_ptr<S> system) {
+    add_profile_mark(sm, std::move(name), entity_counter(system.get()));
+    sm.register_update_system(std::move(system));
+}
+
+// Per-subcommand git latency summary, plus closing the --trace-git file.
+static void finish_git_stats() {
+    auto report = git::GitStats::get().format_report();
+    if (!report.empty()) log_info("git latency:\n{}", report);
+    if (!app_state::gitTracePath.empty()) {
+        git::GitStats::get().close_trace();
+        log_info("git trace written to {}", app_state::gitTracePath);
+    }
+}
+
+static void log_frame_stats() {
+    const auto& s = app_state::frameStats;
+    if (s.frames == 0) return;
+    log_info("frame time: {} frames, mean {:.2f} ms, worst {:.2f} ms, "
+             "{} over {:.1f} ms budget",
+             s.frames, s.mean_ms(), s.worstMs, s.overBudget, s.budgetMs);
+    const auto& pacing = app_state::frameScheduler.stats();
+    if (pacing.idleFrames > 0) {
+        log_info("frame pacing: {} active, {} idle frames",
+                 pacing.activeFrames, pacing.idleFrames);
+    }
+}
+
+// ---- Idle frame pacing ----
+
+// How long clicks and key presses keep the frame rate up: long enough for
+// the toasts they commonly trigger to animate at full rate.
+static constexpr auto INPUT_HOLD = std::chrono::milliseconds(2500);
+
+// Block while nothing is happening.  Finished background work and file
+// watcher events cut the wait short; input is picked up by the next frame.
+static void wait_while_idle() {
+    auto& sched = app_state::frameScheduler;
+    auto wait = sched.idle_wait(std::chrono::steady_clock::now());
+    if (wait <= wait.zero()) return;
+    if (frame_wake().wait_for(wait)) {
+        sched.invalidate(std::chrono::steady_clock::now());
+    }
+}
+
+// Raylib-style key codes (KEY_SPACE .. KEY_MENU)
+static bool any_key_activity() {
+    for (int key = 32; key <= 348; ++key) {
+        if (afterhours::graphics::is_key_down(key) ||
+            afterhours::graphics::is_key_pressed(key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Look for anything in the frame that just ran which should keep the frame
+// rate up: input, UI focus/hover changes, or visible animations.
+static void track_frame_activity(bool toastQueued) {
+    using clock = std::chrono::steady_clock;
+    auto now = clock::now();
+    auto& sched = app_state::frameScheduler;
+
+    static afterhours::vec2 lastMouse{-1.0f, -1.0f};
+    auto mouse = afterhours::graphics::get_mouse_position();
+    if (mouse.x != lastMouse.x || mouse.y != lastMouse.y) {
+        lastMouse = mouse;
+        sched.invalidate(now);
+    }
+
+    if (toastQueued || any_key_activity()) {
+        sched.animate_until(now + INPUT_HOLD);
+    }
+
+    if (auto* ctx = ecs::find_singleton<ui_imm::UIContextType>()) {
+        static afterhours::EntityID lastHot = -1, lastActive = -1, lastFocus = -1;
+        if (ctx->mouse.just_pressed || ctx->mouse.just_released) {
+            sched.animate_until(now + INPUT_HOLD);
+        }
+        if (ctx->hot_id != lastHot || ctx->active_id != lastActive ||
+            ctx->focus_id != lastFocus) {
+            lastHot = ctx->hot_id;
+            lastActive = ctx->active_id;
+            lastFocus = ctx->focus_id;
+            sched.invalidate(now);
+        }
+    }
+
+    // Loading spinner
+    auto* repo = ecs::find_singleton<ecs::RepoComponent, ecs::ActiveTab>();
+    if (repo && repo->isRefreshing) sched.invalidate(now);
+
+    sched.frame_done(now);
+}
+
+// User + system CPU time of the whole process (all threads), in seconds.
+static double process_cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto secs = [](const timeval& tv) {
+        return static_cast<double>(tv.tv_sec) +
+               static_cast<double>(tv.tv_usec) / 1e6;
+    };
+    return secs(usage.ru_utime) + secs(usage.ru_stime);
+}
+
+// --idle-benchmark: once the first refresh has landed and the scheduler
+// has gone idle, measure CPU use over the requested wall time, log it and
+// quit.  Run with --headless for an unattended number.
+static void idle_benchmark_tick() {
+    using clock = std::chrono::steady_clock;
+    static bool measuring = false;
+    static clock::time_point wallStart;
+    static double cpuStart = 0.0;
+    static FrameScheduler::Stats framesStart;
+
+    auto now = clock::now();
+    const auto& sched = app_state::frameScheduler;
+
+    if (!measuring) {
+        auto* repo = ecs::find_singleton<ecs::RepoComponent, ecs::ActiveTab>();
+        bool loaded = !repo || repo->repoPath.empty() || repo->hasLoadedOnce;
+        if (!loaded || sched.is_active(now)) return;
+        measuring = true;
+        wallStart = now;
+        cpuStart = process_cpu_seconds();
+        framesStart = sched.stats();
+        return;
+    }
+
+    double wallSecs = std::chrono::duration<double>(now - wallStart).count();
+    if (wallSecs < app_state::idleBenchmarkSeconds) return;
+
+    double cpuSecs = process_cpu_seconds() - cpuStart;
+    uint64_t frames = (sched.stats().activeFrames - framesStart.activeFrames) +
+                      (sched.stats().idleFrames - framesStart.idleFrames);
+    log_info("idle benchmark: {:.1f} ms CPU over {:.1f} s ({:.2f}% of a core), "
+             "{} frames ({:.1f} fps)",
+             cpuSecs * 1000.0, wallSecs, 100.0 * cpuSecs / wallSecs, frames,
+             static_cast<double>(frames) / wallSecs);
+    app_state::idleBenchmarkSeconds = 0.0f;
+    afterhours::graphics::request_quit();
+}
+
 struct HandleFileWatcherToggle : afterhours::System<afterhours::testing::PendingE2ECommand> {
     void for_each_with(afterhours::Entity&, afterhours::testing::PendingE2ECommand& cmd, float) override {
         if (cmd.is_consumed()) return;
@@ -105,6 +352,24 @@ struct HandleFileWatcherToggle : afterhours::System<afterhours::testing::Pending
     }
 };
 
+// Per-process directory for full outputs the command log truncated.
+static std::string command_log_spill_dir() {
+    return (std::filesystem::temp_directory_path() /
+            ("fh_cmdlog_" + std::to_string(::getpid()))).string();
+}
+
+// Delete the command log's spill files (on exit).
+static void remove_command_log_spill() {
+    if (app_state::editorEntity &&
+        app_state::editorEntity->has<ecs::CommandLogComponent>()) {
+        auto& cmdLog = app_state::editorEntity->get<ecs::CommandLogComponent>();
+        cmdLog.log->clear();
+        const auto& dir = cmdLog.log->limits().spillDir;
+        std::error_code ec;
+        if (!dir.empty()) std::filesystem::remove_all(dir, ec);
+    }
+}
+
 // Init callback: runs after Sokol/Metal window is created
 static void app_init() {
     using namespace afterhours;
@@ -151,13 +416,19 @@ static void app_init() {
     app_state::editorEntity = &entity;
 
     auto& layoutComp = entity.addComponent<ecs::LayoutComponent>();
-    (void)layoutComp;
+    layoutComp.profilerVisible = app_state::profileOverlay;
 
     auto& menuComp = entity.addComponent<ecs::MenuComponent>();
     (void)menuComp;
 
     auto& cmdLog = entity.addComponent<ecs::CommandLogComponent>();
+    {
+        CommandLogBuffer::Limits limits;
+        limits.spillDir = command_log_spill_dir();
+        cmdLog.log = std::make_shared<CommandLogBuffer>(std::move(limits));
+    }
     entity.addComponent<ecs::NetworkOpsComponent>();
+    entity.addComponent<ecs::CommitDetailStore>();
 
     // Create the tab strip singleton
     auto& tabStripEntity = EntityHelper::createEntity();
@@ -180,6 +451,14 @@ static void app_init() {
         }
 
         tab.addComponent<ecs::CommitDetailCache>();
+        tab.addComponent<ecs::DiffViewCache>();
+        tab.addComponent<ecs::FileTreeCache>();
+        tab.addComponent<ecs::RepoFileIndexCache>();
+        tab.addComponent<ecs::FileFinderCache>();
+        tab.addComponent<ecs::CommitSearchState>();
+        tab.addComponent<ecs::CommitGraphCache>();
+        tab.addComponent<ecs::WordDiffCache>();
+        tab.addComponent<ecs::SyntaxCache>();
         tab.addComponent<ecs::BranchDialogState>();
 
         auto& editor = tab.addComponent<ecs::CommitEditorComponent>();
@@ -223,15 +502,16 @@ static void app_init() {
     }
 
     // Wire git log callback to record all git commands in the CommandLogComponent
-    git::set_log_callback([&cmdLog](const std::string& cmd,
-                                     const std::string& out,
-                                     const std::string& err,
-                                     bool success) {
+    git::set_log_callback([log = cmdLog.log](const std::string& cmd,
+                                              const std::string& out,
+                                              const std::string& err,
+                                              bool success,
+                                              double durationMs) {
         auto now = std::chrono::system_clock::now();
         double ts = static_cast<double>(
             std::chrono::duration_cast<std::chrono::seconds>(
                 now.time_since_epoch()).count());
-        cmdLog.entries.push_back({cmd, out, err, success, ts});
+        log->record(cmd, out, err, success, ts, durationMs);
     });
 
     // Setup SystemManager with all systems
@@ -241,32 +521,73 @@ static void app_init() {
     {
         // Ensure toast and modal singletons exist before any UI system
         // accesses them (e.g. sidebar renders modal dialogs)
+        add_profile_mark(sm, "singletons");
         afterhours::toast::enforce_singletons(sm);
         afterhours::modal::enforce_singletons(sm);
 
         // Pre-layout (context begin, clear children)
+        add_profile_mark(sm, "ui pre-layout");
         ui_imm::registerUIPreLayoutSystems(sm);
 
+        // Hand finished background work (git refreshes, commit details,
+        // network ops) to its owners before anything reads repo state
+        register_profiled(sm, "CompletionDispatchSystem",
+                          std::make_unique<ecs::CompletionDispatchSystem>());
+
         // Tab sync: capture view mode changes into active Tab each frame
-        sm.register_update_system(std::make_unique<ecs::TabSyncSystem>());
+        register_profiled(sm, "TabSyncSystem", std::make_unique<ecs::TabSyncSystem>());
 
         // Layout calculation must run before UI systems so panel rects
         // (toolbar, sidebar, status bar, etc.) have correct sizes when
         // the UI-creating systems read them.
-        sm.register_update_system(std::make_unique<ecs::LayoutUpdateSystem>());
+        register_profiled(sm, "LayoutUpdateSystem",
+                          std::make_unique<ecs::LayoutUpdateSystem>());
 
         // UI-creating systems (order determines visual stacking;
         // later systems draw on top of earlier ones)
-        sm.register_update_system(std::make_unique<ecs::TabBarSystem>());
-        sm.register_update_system(std::make_unique<ecs::ToolbarSystem>());
-        sm.register_update_system(std::make_unique<ecs::SidebarSystem>());
-        sm.register_update_system(std::make_unique<ecs::MainContentSystem>());
-        sm.register_update_system(std::make_unique<ecs::StatusBarSystem>());
+        register_profiled(sm, "TabBarSystem", std::make_unique<ecs::TabBarSystem>());
+        register_profiled(sm, "ToolbarSystem", std::make_unique<ecs::ToolbarSystem>());
+        // Before the sidebar, so a keystroke's results and a new page's
+        // graph lanes show the same frame
+        register_profiled(sm, "CommitSearchSystem",
+                          std::make_unique<ecs::CommitSearchSystem>());
+        register_profiled(sm, "CommitGraphSystem",
+                          std::make_unique<ecs::CommitGraphSystem>());
+        register_profiled(sm, "SidebarSystem", std::make_unique<ecs::SidebarSystem>());
+        // Between sidebar (selection) and main content (render) so a
+        // prefetched commit or file diff shows up the same frame it is clicked
+        register_profiled(sm, "CommitDetailLoaderSystem",
+                          std::make_unique<ecs::CommitDetailLoaderSystem>());
+        register_profiled(sm, "WorkingDiffLoaderSystem",
+                          std::make_unique<ecs::WorkingDiffLoaderSystem>());
+        register_profiled(sm, "WordDiffSystem",
+                          std::make_unique<ecs::WordDiffSystem>());
+        register_profiled(sm, "SyntaxHighlightSystem",
+                          std::make_unique<ecs::SyntaxHighlightSystem>());
+        register_profiled(sm, "RepoFileIndexSystem",
+                          std::make_unique<ecs::RepoFileIndexSystem>());
+        register_profiled(sm, "FileFinderIndexSystem",
+                          std::make_unique<ecs::FileFinderIndexSystem>());
+        register_profiled(sm, "MainContentSystem",
+                          std::make_unique<ecs::MainContentSystem>());
+        register_profiled(sm, "StatusBarSystem",
+                          std::make_unique<ecs::StatusBarSystem>());
+        register_profiled(sm, "FileFinderPanelSystem",
+                          std::make_unique<ecs::FileFinderPanelSystem>());
         // MenuBarSystem runs last so dropdown elements draw on top of
         // toolbar/sidebar when a menu is open
-        sm.register_update_system(std::make_unique<ecs::MenuBarSystem>());
+        register_profiled(sm, "MenuBarSystem", std::make_unique<ecs::MenuBarSystem>());
+        {
+            auto overlay = std::make_unique<ecs::ProfilerOverlaySystem>();
+            overlay->profiler = &app_state::profiler;
+            if (!app_state::traceOutPath.empty()) {
+                overlay->tracePath = app_state::traceOutPath;
+            }
+            register_profiled(sm, "ProfilerOverlaySystem", std::move(overlay));
+        }
 
         // Post-layout (entity mapping, autolayout, interactions)
+        add_profile_mark(sm, "ui post-layout");
         ui_imm::registerUIPostLayoutSystems(sm);
 
         // Update systems
@@ -275,18 +596,21 @@ static void app_init() {
         if (app_state::testModeEnabled) {
             fileWatcherPtr->disabled = true;
         }
-        sm.register_update_system(std::move(fileWatcherPtr));
-        sm.register_update_system(std::make_unique<ecs::AsyncGitDataRefreshSystem>());
-        sm.register_update_system(std::make_unique<ecs::NetworkOpsPollingSystem>());
+        register_profiled(sm, "FileWatcherSystem", std::move(fileWatcherPtr));
+        register_profiled(sm, "AsyncGitDataRefreshSystem",
+                          std::make_unique<ecs::AsyncGitDataRefreshSystem>());
 
         // Toast notification systems
+        add_profile_mark(sm, "toasts");
         ui_imm::registerToastSystems(sm);
 
         // Modal dialog systems
+        add_profile_mark(sm, "modals");
         ui_imm::registerModalSystems(sm);
 
         // E2E testing systems (only in test mode)
         if (app_state::testModeEnabled) {
+            add_profile_mark(sm, "e2e handlers");
             if (app_state::e2eNoResize) {
                 sm.register_update_system(std::make_unique<SkipResizeCommand>());
             }
@@ -313,12 +637,18 @@ static void app_init() {
         }
 
         // Render systems
+        {
+            auto mark = std::make_unique<ProfileMark>();
+            mark->section = app_state::profiler.add_section("render");
+            sm.register_render_system(std::move(mark));
+        }
         sm.register_render_system(
             std::make_unique<MainRenderSystem>());
         ui_imm::registerUIRenderSystems(sm);
         ui_imm::registerModalRenderSystems(sm);
 
         // UI validation systems (design rule enforcement)
+        add_profile_mark(sm, "validation");
         afterhours::ui::validation::register_systems<InputAction>(sm);
 
         {
@@ -336,6 +666,8 @@ static void app_init() {
         }
     }
 
+    if (!app_state::traceOutPath.empty()) app_state::profiler.start_trace();
+
     // Single settings write for all init-time mutations, then re-enable auto-save
     Settings::get().write_save_file();
     Settings::get().auto_save_enabled = true;
@@ -442,7 +774,7 @@ static void e2e_render_and_screenshot(float dt) {
     afterhours::testing::test_input::reset_frame();
     afterhours::graphics::begin_drawing();
     afterhours::graphics::clear_background(afterhours::Color{30, 30, 30, 255});
-    app_state::systemManager->run(dt);
+    run_systems_timed(dt);
     afterhours::graphics::end_drawing();
 
     // Queue for capture after SCREENSHOT_DELAY frames
@@ -467,20 +799,42 @@ static void app_frame() {
             metal_wait_all_screenshots();
 #endif
             app_state::e2eRunner.print_results();
+            log_frame_stats();
+            write_trace_out();
+            finish_git_stats();
+            remove_command_log_spill();
             _exit(app_state::e2eRunner.has_failed() ? 1 : 0);
         }
         return;
     }
 
+    wait_while_idle();
+
+    auto* menu = ecs::find_singleton<ecs::MenuComponent>();
+    bool toastQueued = menu && !menu->pendingToast.empty();
+
     afterhours::graphics::begin_drawing();
     afterhours::graphics::clear_background(
         afterhours::Color{30, 30, 30, 255});
-    app_state::systemManager->run(dt);
+    run_systems_timed(dt);
     afterhours::graphics::end_drawing();
+
+    track_frame_activity(toastQueued);
+    if (app_state::idleBenchmarkSeconds > 0.0f) idle_benchmark_tick();
 }
 
 // Cleanup callback: runs when window is closing
 static void app_cleanup() {
+    // Stop streaming git commands and give workers a moment to finish
+    if (size_t left = shutdown_background_tasks(std::chrono::seconds(2))) {
+        log_info("exiting with {} background task(s) still running", left);
+    }
+
+    log_frame_stats();
+    write_trace_out();
+    finish_git_stats();
+    remove_command_log_spill();
+
     // Batch all cleanup mutations into a single disk write
     Settings::get().auto_save_enabled = false;
 
@@ -522,6 +876,7 @@ int main(int argc, char* argv[]) {
     app_state::testModeEnabled = cmdl["--test-mode"];
     app_state::e2eNoResize = cmdl["--e2e-no-resize"];
     app_state::headless = cmdl["--headless"];
+    app_state::profileOverlay = cmdl["--profile"];
     for (auto& [name, value] : cmdl.params()) {
         if (name == "screenshot-dir") {
             app_state::screenshotDir = value;
@@ -533,8 +888,22 @@ int main(int argc, char* argv[]) {
             app_state::e2eTimeout = std::stof(value);
         } else if (name == "validation-report") {
             app_state::validationReportPath = value;
+        } else if (name == "idle-benchmark") {
+            app_state::idleBenchmarkSeconds = std::stof(value);
+        } else if (name == "trace-out") {
+            app_state::traceOutPath = value;
+        } else if (name == "trace-git") {
+            app_state::gitTracePath = value;
         }
     }
+    if (cmdl["--trace-git"] && app_state::gitTracePath.empty()) {
+        app_state::gitTracePath = "output/git_trace.json";
+    }
+    if (!app_state::gitTracePath.empty() &&
+        !git::GitStats::get().open_trace(app_state::gitTracePath)) {
+        log_warn("could not open git trace file {}", app_state::gitTracePath);
+        app_state::gitTracePath.clear();
+    }
 
     // If test script specified, enable test mode
     if (!app_state::testScriptPath.empty() || !app_state::testScriptDir.empty()) {
@@ -7,6 +7,7 @@
 #include <thread>
 
 #include "../../vendor/afterhours/src/logging.h"
+#include "../util/frame_scheduler.h"
 
 namespace platform {
 
@@ -122,6 +123,7 @@ private:
         const FSEventStreamEventId* /*event_ids*/) {
         auto* self = static_cast<FSEventsWatcher*>(context);
         self->changed_.store(true, std::memory_order_release);
+        frame_wake().notify();
     }
 
     std::atomic<bool> changed_{false};
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cmath>
 #include <ctime>
 #include <string>
+#include <vector>
 
 #include "../ecs/ui_imports.h"
+#include <afterhours/src/plugins/clipboard.h>
+#include <afterhours/src/plugins/toast.h>
 
 namespace ecs {
 
@@ -17,6 +21,39 @@ inline std::string format_timestamp(double timestamp) {
     return std::string(buf);
 }
 
+// Commands slower than this are flagged in the log (yellow, with duration).
+constexpr double CMDLOG_SLOW_MS = 250.0;
+
+constexpr float CMDLOG_ENTRY_CMD_H = 22.0f;
+constexpr float CMDLOG_ENTRY_OUTPUT_H = 18.0f;
+constexpr float CMDLOG_OVERSCAN = 100.0f;  // Design units beyond the viewport
+
+// Height of one entry in design units: command line plus optional
+// output and error lines.
+inline float cmdlog_entry_height(const CommandLogBuffer::Entry& e) {
+    return CMDLOG_ENTRY_CMD_H + (e.output.empty() ? 0.0f : CMDLOG_ENTRY_OUTPUT_H) +
+           (e.error.empty() ? 0.0f : CMDLOG_ENTRY_OUTPUT_H);
+}
+
+// First 200 bytes of an excerpt, flattened to one line.
+inline std::string cmdlog_one_line(const std::string& text) {
+    std::string line = text.size() > 200 ? text.substr(0, 200) + "..." : text;
+    for (auto& ch : line) {
+        if (ch == '\n' || ch == '\r') ch = ' ';
+    }
+    return line;
+}
+
+inline std::string format_duration(double ms) {
+    char buf[24];
+    if (ms >= 1000.0) {
+        std::snprintf(buf, sizeof(buf), "%.1f s", ms / 1000.0);
+    } else {
+        std::snprintf(buf, sizeof(buf), "%.0f ms", ms);
+    }
+    return std::string(buf);
+}
+
 inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
                                Entity& uiRoot,
                                LayoutComponent& layout) {
@@ -100,7 +137,16 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
             .with_roundness(0.0f)
             .with_debug_name("cmdlog_title"));
 
-    std::string countLabel = std::to_string(cmdLog.entries.size()) + " commands";
+    size_t slowCount = 0;
+    cmdLog.log->for_each_newest([&slowCount](size_t, const CommandLogBuffer::Entry& e) {
+        if (e.durationMs >= CMDLOG_SLOW_MS) ++slowCount;
+        return true;
+    });
+    size_t kept = cmdLog.log->size();
+    uint64_t total = cmdLog.log->total_recorded();
+    std::string countLabel = std::to_string(total) + " commands";
+    if (kept < total) countLabel += " (last " + std::to_string(kept) + " kept)";
+    if (slowCount > 0) countLabel += ", " + std::to_string(slowCount) + " slow";
     div(ctx, mk(headerBar.ent(), 3222),
         ComponentConfig{}
             .with_label(countLabel)
@@ -125,7 +171,7 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
             .with_roundness(0.0f)
             .with_debug_name("cmdlog_scroll"));
 
-    if (cmdLog.entries.empty()) {
+    if (kept == 0) {
         div(ctx, mk(scrollArea.ent(), 3240),
             ComponentConfig{}
                 .with_label("No commands executed yet")
@@ -141,25 +187,76 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
         return;
     }
 
-    constexpr float ENTRY_CMD_H = 22.0f;
-    constexpr float ENTRY_OUTPUT_H = 18.0f;
-    constexpr int MAX_VISIBLE = 200;
+    // Only entries overlapping the viewport are emitted; the rest become
+    // two spacers so the scroll extent is unchanged.  Entry IDs come from
+    // the entry's sequence number, so rows keep their entities as new
+    // commands push them down.
+    float pxPerUnit = resolve_to_pixels(h720(720.0f), cmdLogScreenH) / 720.0f;
+    if (pxPerUnit <= 0.0f) pxPerUnit = 1.0f;
+    float scrollPx = 0.0f;
+    if (scrollArea.ent().has<afterhours::ui::HasScrollView>()) {
+        scrollPx = std::fabs(
+            scrollArea.ent().get<afterhours::ui::HasScrollView>().scroll_offset.y);
+    }
+    float top = scrollPx / pxPerUnit - CMDLOG_OVERSCAN;
+    float bottom = (scrollPx + cmdLogScrollH) / pxPerUnit + CMDLOG_OVERSCAN;
+
+    // Entry heights vary (output/error lines are optional), so find the
+    // visible window with one pass over the buffer.
+    size_t first = 0, last = 0;
+    float firstY = 0.0f, totalH = 0.0f;
+    cmdLog.log->for_each_newest([&](size_t i, const CommandLogBuffer::Entry& e) {
+        float h = cmdlog_entry_height(e);
+        if (totalH + h <= top) {
+            first = i + 1;
+            firstY = totalH + h;
+        }
+        if (totalH < bottom) last = i + 1;
+        totalH += h;
+        return true;
+    });
 
-    int count = 0;
-    for (auto it = cmdLog.entries.rbegin(); it != cmdLog.entries.rend() && count < MAX_VISIBLE; ++it, ++count) {
-        auto& entry = *it;
-        int entryId = count;
+    std::vector<CommandLogBuffer::Entry> visible;
+    visible.reserve(last > first ? last - first : 0);
+    cmdLog.log->for_each_newest([&](size_t i, const CommandLogBuffer::Entry& e) {
+        if (i >= last) return false;
+        if (i >= first) visible.push_back(e);
+        return true;
+    });
+
+    auto w = percent(1.0f);
+    if (firstY > 0.0f) {
+        div(ctx, mk(scrollArea.ent(), 3231),
+            ComponentConfig{}
+                .with_size(ComponentSize{w, h720(firstY)})
+                .with_transparent_bg()
+                .with_roundness(0.0f)
+                .with_debug_name("cmdlog_top_spacer"));
+    }
+
+    float visibleBottom = firstY;
+    for (const auto& entry : visible) {
+        visibleBottom += cmdlog_entry_height(entry);
+        int entryId = 3300 + static_cast<int>(entry.seq % 1000000) * 4;
 
         std::string prefix = entry.success ? "\xe2\x9c\x93 " : "\xe2\x9c\x97 ";
         std::string timeStr = format_timestamp(entry.timestamp);
         std::string cmdLabel = prefix + timeStr + "  " + entry.command;
+        bool slow = entry.durationMs >= CMDLOG_SLOW_MS;
+        if (slow) cmdLabel += "  (" + format_duration(entry.durationMs) + ")";
+        if (entry.truncated) {
+            cmdLabel += entry.can_spill() ? "  [copy full output path]"
+                                          : "  [truncated]";
+        }
 
-        afterhours::Color cmdColor = entry.success ? theme::STATUS_ADDED : theme::STATUS_DELETED;
+        afterhours::Color cmdColor = !entry.success ? theme::STATUS_DELETED
+                                     : slow         ? theme::STATUS_MODIFIED
+                                                    : theme::STATUS_ADDED;
 
-        div(ctx, mk(scrollArea.ent(), 3300 + entryId * 10),
+        auto cmdRow = div(ctx, mk(scrollArea.ent(), entryId),
             ComponentConfig{}
                 .with_label(cmdLabel)
-                .with_size(ComponentSize{percent(1.0f), h720(ENTRY_CMD_H)})
+                .with_size(ComponentSize{percent(1.0f), h720(CMDLOG_ENTRY_CMD_H)})
                 .with_padding(Padding{
                     .top = h720(2), .right = w1280(8),
                     .bottom = h720(2), .left = w1280(8)})
@@ -167,22 +264,30 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_font_size(afterhours::ui::FontSize::Medium)
                 .with_alignment(TextAlignment::Left)
                 .with_roundness(0.0f)
-                .with_debug_name("cmdlog_entry_" + std::to_string(entryId)));
+                .with_debug_name("cmdlog_entry_" + std::to_string(entry.seq)));
 
-        if (!entry.output.empty()) {
-            std::string displayOut = entry.output;
-            if (displayOut.size() > 200) {
-                displayOut = displayOut.substr(0, 200) + "...";
-            }
-            for (auto& ch : displayOut) {
-                if (ch == '\n') ch = ' ';
-                if (ch == '\r') ch = ' ';
+        // The full output is written to a spill file on the first click;
+        // hand out its path
+        if (entry.can_spill()) {
+            cmdRow.ent().addComponentIfMissing<HasClickListener>([](Entity&) {});
+            if (cmdRow.ent().get<HasClickListener>().down) {
+                std::string path = cmdLog.log->spill(entry.seq);
+                if (!path.empty()) {
+                    afterhours::clipboard::set_text(path);
+                    afterhours::toast::send_info(
+                        ctx, "Copied path of full output to clipboard", 1.5f);
+                } else {
+                    afterhours::toast::send_info(
+                        ctx, "Full output is no longer available", 1.5f);
+                }
             }
+        }
 
-            div(ctx, mk(scrollArea.ent(), 3300 + entryId * 10 + 1),
+        if (!entry.output.empty()) {
+            div(ctx, mk(scrollArea.ent(), entryId + 1),
                 ComponentConfig{}
-                    .with_label(displayOut)
-                    .with_size(ComponentSize{percent(1.0f), h720(ENTRY_OUTPUT_H)})
+                    .with_label(cmdlog_one_line(entry.output))
+                    .with_size(ComponentSize{percent(1.0f), h720(CMDLOG_ENTRY_OUTPUT_H)})
                     .with_padding(Padding{
                         .top = h720(0), .right = w1280(8),
                         .bottom = h720(2), .left = w1280(24)})
@@ -190,23 +295,14 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
                     .with_font_size(afterhours::ui::FontSize::Medium)
                     .with_alignment(TextAlignment::Left)
                     .with_roundness(0.0f)
-                    .with_debug_name("cmdlog_out_" + std::to_string(entryId)));
+                    .with_debug_name("cmdlog_out_" + std::to_string(entry.seq)));
         }
 
         if (!entry.error.empty()) {
-            std::string displayErr = entry.error;
-            if (displayErr.size() > 200) {
-                displayErr = displayErr.substr(0, 200) + "...";
-            }
-            for (auto& ch : displayErr) {
-                if (ch == '\n') ch = ' ';
-                if (ch == '\r') ch = ' ';
-            }
-
-            div(ctx, mk(scrollArea.ent(), 3300 + entryId * 10 + 2),
+            div(ctx, mk(scrollArea.ent(), entryId + 2),
                 ComponentConfig{}
-                    .with_label(displayErr)
-                    .with_size(ComponentSize{percent(1.0f), h720(ENTRY_OUTPUT_H)})
+                    .with_label(cmdlog_one_line(entry.error))
+                    .with_size(ComponentSize{percent(1.0f), h720(CMDLOG_ENTRY_OUTPUT_H)})
                     .with_padding(Padding{
                         .top = h720(0), .right = w1280(8),
                         .bottom = h720(2), .left = w1280(24)})
@@ -214,9 +310,18 @@ inline void render_command_log(afterhours::ui::UIContext<InputAction>& ctx,
                     .with_font_size(afterhours::ui::FontSize::Medium)
                     .with_alignment(TextAlignment::Left)
                     .with_roundness(0.0f)
-                    .with_debug_name("cmdlog_err_" + std::to_string(entryId)));
+                    .with_debug_name("cmdlog_err_" + std::to_string(entry.seq)));
         }
     }
+
+    if (totalH > visibleBottom) {
+        div(ctx, mk(scrollArea.ent(), 3232),
+            ComponentConfig{}
+                .with_size(ComponentSize{w, h720(totalH - visibleBottom)})
+                .with_transparent_bg()
+                .with_roundness(0.0f)
+                .with_debug_name("cmdlog_bottom_spacer"));
+    }
 }
 
 } // namespace ecs
@@ -1,14 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "../git/error_humanizer.h"
 #include "../git/git_parser.h"
 #include "../git/git_runner.h"
 #include "../util/git_helpers.h"
+#include "../ecs/repo_index.h"
 #include "../ecs/ui_imports.h"
 #include "diff_renderer.h"
 
@@ -21,10 +26,6 @@ using git_helpers::DecorationType;
 using git_helpers::Decoration;
 using git_helpers::parse_decorations;
 
-inline std::string relative_time(const std::string& isoDate) {
-    return git_helpers::relative_time(isoDate, /*suffix=*/true);
-}
-
 struct CommitInfo {
     std::string subject;
     std::string body;
@@ -67,22 +68,89 @@ inline CommitInfo parse_commit_info(const std::string& output) {
     return info;
 }
 
+// Run git show, parse the result and build the diff display model, or
+// nullopt with git's error in `error` if either git call fails.  Touches
+// no ECS state, so it is safe to call from a worker thread.
+inline std::optional<CommitDetail> load_commit_detail(const std::string& repoPath,
+                                                      const std::string& hash,
+                                                      std::string& error) {
+    auto failed = [&](const git::GitResult& result) {
+        error = git::humanize_error(result.stderr_str());
+        error = error.substr(0, error.find('\n'));
+        if (error.empty()) error = "git show failed";
+        return std::nullopt;
+    };
+
+    CommitDetail detail;
+    detail.hash = hash;
+
+    auto diffResult = git::git_show(repoPath, hash);
+    if (!diffResult.success()) return failed(diffResult);
+    detail.diff = git::parse_diff(diffResult.stdout_str());
+
+    auto infoResult = git::git_show_commit_info(repoPath, hash);
+    if (!infoResult.success()) return failed(infoResult);
+    auto info = parse_commit_info(infoResult.stdout_str());
+    detail.body = std::move(info.body);
+    detail.authorEmail = std::move(info.authorEmail);
+    detail.parents = std::move(info.parents);
+
+    detail.model = ui::build_diff_display(detail.diff);
+    return detail;
+}
+
+// Rough heap footprint of a loaded commit (or of one file's diff), used as
+// its cache cost.  Counts string payloads; container overhead is
+// approximated.
+inline size_t approx_bytes(const FileDiff& fd) {
+    size_t bytes = sizeof(FileDiff) + fd.filePath.size() + fd.oldPath.size();
+    for (auto& hunk : fd.hunks) {
+        bytes += sizeof(DiffHunk) + hunk.header.size();
+        for (auto& line : hunk.lines) {
+            bytes += sizeof(std::string) + line.size();
+        }
+    }
+    return bytes;
+}
+
+inline size_t approx_bytes(const CommitDetail& detail) {
+    size_t bytes = sizeof(CommitDetail) + detail.body.size() +
+                   detail.authorEmail.size() + detail.parents.size();
+    for (auto& fd : detail.diff) bytes += approx_bytes(fd);
+    for (auto& row : detail.model.rows) {
+        bytes += sizeof(ui::DiffRow) + row.label.size();
+    }
+    return bytes;
+}
+
+// Rough height in pixels of a label wrapped to `widthPx`.  Used to
+// estimate where the diff starts on the page; it needn't be exact.
+inline float approx_text_px(const std::string& text, float fontPx, float widthPx) {
+    float charsPerLine = std::max(1.0f, widthPx / (fontPx * 0.55f));
+    float lines = 0.0f;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) end = text.size();
+        float len = static_cast<float>(end - start);
+        lines += std::max(1.0f, std::ceil(len / charsPerLine));
+        start = end + 1;
+    }
+    return lines * fontPx * 1.25f;
+}
+
 } // namespace commit_detail_view
 
 inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                                   Entity& parent,
                                   RepoComponent& repo,
                                   CommitDetailCache& detailCache,
-                                  LayoutComponent& layout) {
+                                  LayoutComponent& layout,
+                                  const WordDiffCache* words = nullptr,
+                                  const SyntaxCache* syntax = nullptr) {
     namespace cdv = commit_detail_view;
 
-    const CommitEntry* selectedCommit = nullptr;
-    for (auto& c : repo.commitLog) {
-        if (c.hash == repo.selectedCommitHash) {
-            selectedCommit = &c;
-            break;
-        }
-    }
+    const CommitEntry* selectedCommit = find_commit(repo, repo.selectedCommitHash);
 
     if (!selectedCommit) {
         auto container = div(ctx, mk(parent, 3049),
@@ -124,35 +192,27 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
         return;
     }
 
-    bool commitJustChanged = (detailCache.cachedCommitHash != repo.selectedCommitHash);
+    // Details arrive asynchronously (CommitDetailLoaderSystem); until then
+    // the header renders from the log entry and the diff area shows a
+    // placeholder.
+    bool detailLoaded = detailCache.detail &&
+                        detailCache.cachedCommitHash == repo.selectedCommitHash;
+    const CommitDetail* detail = detailLoaded ? detailCache.detail.get() : nullptr;
+    bool loadFailed = !detail && !detailCache.error.empty() &&
+                      detailCache.cachedCommitHash == repo.selectedCommitHash;
+    bool commitJustChanged = (detailCache.shownCommitHash != repo.selectedCommitHash);
     if (commitJustChanged) {
-        auto diffResult = git::git_show(repo.repoPath, repo.selectedCommitHash);
-        auto infoResult = git::git_show_commit_info(repo.repoPath, repo.selectedCommitHash);
-
-        if (diffResult.success()) {
-            detailCache.commitDetailDiff = git::parse_diff(diffResult.stdout_str());
-        } else {
-            detailCache.commitDetailDiff.clear();
-        }
-
-        if (infoResult.success()) {
-            auto info = cdv::parse_commit_info(infoResult.stdout_str());
-            detailCache.commitDetailBody = info.body;
-            detailCache.commitDetailAuthorEmail = info.authorEmail;
-            detailCache.commitDetailParents = info.parents;
-        } else {
-            detailCache.commitDetailBody.clear();
-            detailCache.commitDetailAuthorEmail.clear();
-            detailCache.commitDetailParents.clear();
-        }
-
-        detailCache.cachedCommitHash = repo.selectedCommitHash;
+        detailCache.shownCommitHash = repo.selectedCommitHash;
     }
 
     int nextId = 3050;
     constexpr float PAD = 16.0f;
     constexpr float LABEL_W = 70.0f;
     float contentW = layout.mainContent.width;
+    float textW = std::max(contentW - PAD * 2, 100.0f);
+    // Running estimate of where the diff starts in the scroll content, so
+    // render_inline_diff can cull its rows against the page's scroll offset.
+    float diffTopPx = 0.0f;
 
     auto scrollContainer = div(ctx, mk(parent, nextId++),
         ComponentConfig{}
@@ -186,6 +246,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
         detailCache.cachedCommitHash.clear();
         return;
     }
+    diffTopPx += 18.0f + cdv::approx_text_px("<- Back", 17.0f, textW);
 
     div(ctx, mk(scrollContainer.ent(), nextId++),
         ComponentConfig{}
@@ -199,11 +260,12 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
             .with_alignment(TextAlignment::Left)
             .with_roundness(0.0f)
             .with_debug_name("commit_subject"));
+    diffTopPx += 12.0f + cdv::approx_text_px(selectedCommit->subject, 20.0f, textW);
 
-    if (!detailCache.commitDetailBody.empty()) {
+    if (detail && !detail->body.empty()) {
         div(ctx, mk(scrollContainer.ent(), nextId++),
             ComponentConfig{}
-                .with_label(detailCache.commitDetailBody)
+                .with_label(detail->body)
                 .with_size(ComponentSize{percent(1.0f), children()})
                 .with_padding(Padding{
                     .top = pixels(4), .right = pixels(PAD),
@@ -213,6 +275,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_alignment(TextAlignment::Left)
                 .with_roundness(0.0f)
                 .with_debug_name("commit_body"));
+        diffTopPx += 12.0f + cdv::approx_text_px(detail->body, 14.0f, textW);
     }
 
     float metaValueW = contentW - PAD * 4 - LABEL_W - 8.0f;
@@ -232,6 +295,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
             .with_rounded_corners(theme::layout::ROUNDED_CORNERS)
             .with_roundness(theme::layout::ROUNDNESS_BOX)
             .with_debug_name("commit_meta_box"));
+    diffTopPx += 28.0f;
 
     auto metaRow = [&](const std::string& label, const std::string& value,
                        afterhours::Color valueColor = theme::TEXT_PRIMARY) {
@@ -243,6 +307,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_transparent_bg()
                 .with_roundness(0.0f)
                 .with_debug_name("meta_row"));
+        diffTopPx += 4.0f + cdv::approx_text_px(label, 13.0f, LABEL_W);
 
         div(ctx, mk(row.ent(), 1),
             ComponentConfig{}
@@ -276,21 +341,29 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
     metaRow("Commit:", selectedCommit->hash, theme::TEXT_SECONDARY);
 
     std::string authorStr = selectedCommit->author;
-    if (!detailCache.commitDetailAuthorEmail.empty()) {
-        authorStr += " <" + detailCache.commitDetailAuthorEmail + ">";
+    if (detail && !detail->authorEmail.empty()) {
+        authorStr += " <" + detail->authorEmail + ">";
     }
     metaRow("Author:", authorStr);
 
-    std::string dateStr = selectedCommit->authorDate;
-    std::string relTime = cdv::relative_time(selectedCommit->authorDate);
-    if (!relTime.empty()) {
-        dateStr += " (" + relTime + ")";
+    // The relative part only changes when its displayed unit ticks over,
+    // so rebuild the label then rather than every frame.
+    std::time_t now = std::time(nullptr);
+    if (commitJustChanged || now >= detailCache.dateLabelValidUntil) {
+        detailCache.dateLabel = selectedCommit->authorDate;
+        detailCache.dateLabelValidUntil = std::numeric_limits<std::time_t>::max();
+        if (selectedCommit->authorTime != 0) {
+            std::string relTime = git_helpers::relative_time(
+                selectedCommit->authorTime, now, /*suffix=*/true,
+                &detailCache.dateLabelValidUntil);
+            detailCache.dateLabel += " (" + relTime + ")";
+        }
     }
-    metaRow("Date:", dateStr);
+    metaRow("Date:", detailCache.dateLabel);
 
-    if (!detailCache.commitDetailParents.empty()) {
+    if (detail && !detail->parents.empty()) {
         std::string parentDisplay;
-        std::string remaining = detailCache.commitDetailParents;
+        std::string remaining = detail->parents;
         while (!remaining.empty()) {
             size_t sp = remaining.find(' ');
             std::string hash;
@@ -317,6 +390,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_transparent_bg()
                 .with_roundness(0.0f)
                 .with_debug_name("meta_badge_row"));
+        diffTopPx += 4.0f + cdv::approx_text_px("Refs:", 13.0f, textW);
 
         div(ctx, mk(badgeRow.ent(), 1),
             ComponentConfig{}
@@ -332,9 +406,8 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_roundness(0.0f)
                 .with_debug_name("refs_label"));
 
-        auto badges = cdv::parse_decorations(selectedCommit->decorations);
         int badgeId = 20;
-        for (auto& badge : badges) {
+        for (auto& badge : selectedCommit->badges) {
             afterhours::Color bg, text;
             switch (badge.type) {
                 case cdv::DecorationType::Head:
@@ -373,8 +446,35 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .top = pixels(8), .bottom = pixels(8)})
             .with_roundness(0.0f)
             .with_debug_name("commit_sep"));
+    diffTopPx += 17.0f;
 
-    if (detailCache.commitDetailDiff.empty()) {
+    if (loadFailed) {
+        div(ctx, mk(scrollContainer.ent(), nextId++),
+            ComponentConfig{}
+                .with_label("Couldn't load this commit: " + detailCache.error)
+                .with_size(ComponentSize{percent(1.0f), children()})
+                .with_padding(Padding{
+                    .top = pixels(16), .right = pixels(PAD),
+                    .bottom = pixels(16), .left = pixels(PAD)})
+                .with_custom_text_color(theme::TEXT_SECONDARY)
+                .with_font_size(afterhours::ui::FontSize::Large)
+                .with_alignment(TextAlignment::Center)
+                .with_roundness(0.0f)
+                .with_debug_name("commit_load_error"));
+    } else if (!detail) {
+        div(ctx, mk(scrollContainer.ent(), nextId++),
+            ComponentConfig{}
+                .with_label("Loading commit...")
+                .with_size(ComponentSize{percent(1.0f), children()})
+                .with_padding(Padding{
+                    .top = pixels(16), .right = pixels(PAD),
+                    .bottom = pixels(16), .left = pixels(PAD)})
+                .with_custom_text_color(theme::TEXT_SECONDARY)
+                .with_font_size(afterhours::ui::FontSize::Large)
+                .with_alignment(TextAlignment::Center)
+                .with_roundness(0.0f)
+                .with_debug_name("commit_loading_msg"));
+    } else if (detail->diff.empty()) {
         div(ctx, mk(scrollContainer.ent(), nextId++),
             ComponentConfig{}
                 .with_label("No file changes in this commit")
@@ -389,14 +489,14 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_debug_name("empty_diff_msg"));
     } else {
         int totalAdd = 0, totalDel = 0;
-        for (auto& d : detailCache.commitDetailDiff) {
+        for (auto& d : detail->diff) {
             totalAdd += d.additions;
             totalDel += d.deletions;
         }
 
         std::string summaryLabel = "FILES CHANGED (" +
-            std::to_string(detailCache.commitDetailDiff.size()) + " file" +
-            (detailCache.commitDetailDiff.size() != 1 ? "s" : "") +
+            std::to_string(detail->diff.size()) + " file" +
+            (detail->diff.size() != 1 ? "s" : "") +
             ", +" + std::to_string(totalAdd) + " -" + std::to_string(totalDel) + ")";
 
         div(ctx, mk(scrollContainer.ent(), nextId++),
@@ -412,6 +512,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                 .with_alignment(TextAlignment::Left)
                 .with_roundness(0.0f)
                 .with_debug_name("files_changed_header"));
+        diffTopPx += 8.0f + cdv::approx_text_px(summaryLabel, 13.0f, textW);
 
         constexpr float STATS_W = 55.0f;
         constexpr float BAR_W = 50.0f;
@@ -423,8 +524,8 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
         float fileNameW = contentW - PAD * 2 - BADGE_W - STATS_W - BAR_W - 8.0f * 3;
         if (fileNameW < 80.0f) fileNameW = 80.0f;
 
-        for (size_t fi = 0; fi < detailCache.commitDetailDiff.size(); ++fi) {
-            auto& fd = detailCache.commitDetailDiff[fi];
+        for (size_t fi = 0; fi < detail->diff.size(); ++fi) {
+            auto& fd = detail->diff[fi];
 
             std::string badge = "M";
             afterhours::Color badgeColor = theme::STATUS_MODIFIED;
@@ -445,6 +546,7 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                     .with_custom_background(theme::WINDOW_BG)
                     .with_roundness(0.0f)
                     .with_debug_name("file_summary_row"));
+            diffTopPx += 6.0f + cdv::approx_text_px("M", 14.0f, textW);
 
             div(ctx, mk(fileRow.ent(), 1),
                 ComponentConfig{}
@@ -535,12 +637,28 @@ inline void render_commit_detail(afterhours::ui::UIContext<InputAction>& ctx,
                     .top = pixels(8), .bottom = pixels(8)})
                 .with_roundness(0.0f)
                 .with_debug_name("diff_sep"));
+        diffTopPx += 17.0f;
 
+        const ui::DiffDisplayModel* model = &detail->model;
+        if (layout.diffViewMode == LayoutComponent::DiffViewMode::SideBySide) {
+            if (detailCache.splitModelHash != detail->hash) {
+                detailCache.splitModel = ui::build_split_diff_display(detail->diff);
+                detailCache.splitModelHash = detail->hash;
+            }
+            model = &detailCache.splitModel;
+        }
         ui::render_inline_diff(ctx, scrollContainer.ent(),
-                               detailCache.commitDetailDiff,
+                               detail->diff,
+                               *model,
                                layout.mainContent.width,
                                layout.mainContent.height,
-                               /*embedInParentScroll=*/true);
+                               /*embedInParentScroll=*/true,
+                               /*resetScroll=*/false,
+                               ui::DiffOverlays{
+                                   words ? words->ready_for(detailCache.detail.get()) : nullptr,
+                                   syntax ? syntax->ready_for(detailCache.detail.get())
+                                          : nullptr},
+                               diffTopPx);
     }
 }
 
@@ -0,0 +1,310 @@
+#include "diff_display.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "../ecs/components.h"
+
+namespace ui {
+
+namespace {
+
+// Right-align n into a fixed-width column; 0 leaves the column blank.
+void append_line_number(std::string& out, int n) {
+    char buf[16];
+    size_t len = 0;
+    if (n > 0) {
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), n);
+        (void)ec;
+        len = static_cast<size_t>(end - buf);
+    }
+    if (len < diff_detail::LINE_NUMBER_COLS) {
+        out.append(diff_detail::LINE_NUMBER_COLS - len, ' ');
+    }
+    out.append(buf, len);
+}
+
+std::string file_header_label(const ecs::FileDiff& fileDiff) {
+    std::string label = fileDiff.filePath;
+    if (fileDiff.isRenamed && !fileDiff.oldPath.empty()) {
+        label = fileDiff.oldPath + " -> " + fileDiff.filePath;
+    }
+
+    std::string stats;
+    if (fileDiff.additions > 0) {
+        stats += "+" + std::to_string(fileDiff.additions);
+    }
+    if (fileDiff.deletions > 0) {
+        if (!stats.empty()) stats += " ";
+        stats += "-" + std::to_string(fileDiff.deletions);
+    }
+    if (!stats.empty()) {
+        label += "  " + stats;
+    }
+
+    if (fileDiff.isNew) {
+        label += "  (new file)";
+    } else if (fileDiff.isDeleted) {
+        label += "  (deleted)";
+    } else if (fileDiff.isBinary) {
+        label += "  (binary)";
+    }
+    return label;
+}
+
+}  // namespace
+
+size_t text_columns(std::string_view text) {
+    size_t n = 0;
+    for (unsigned char c : text) n += (c & 0xC0) != 0x80;
+    return n;
+}
+
+std::pair<size_t, size_t> column_bytes(std::string_view text, size_t first, size_t last) {
+    size_t col = 0, begin = text.size();
+    for (size_t i = 0; i < text.size(); ++i) {
+        if ((static_cast<unsigned char>(text[i]) & 0xC0) == 0x80) continue;
+        if (col == first) begin = i;
+        if (col == last) return {std::min(begin, i), i};
+        ++col;
+    }
+    return {begin, text.size()};
+}
+
+std::pair<size_t, size_t> DiffDisplayModel::visible_range(float top,
+                                                          float bottom) const {
+    // First row whose bottom edge is below `top`
+    auto first = std::partition_point(rows.begin(), rows.end(),
+        [top](const DiffRow& r) { return r.y + r.height <= top; });
+    // First row whose top edge is at or below `bottom`
+    auto last = std::partition_point(first, rows.end(),
+        [bottom](const DiffRow& r) { return r.y < bottom; });
+    return {static_cast<size_t>(first - rows.begin()),
+            static_cast<size_t>(last - rows.begin())};
+}
+
+namespace {
+
+std::string_view line_content(const std::string& line) {
+    return line.size() > 1 ? std::string_view(line).substr(1) : std::string_view{};
+}
+
+// One side of a LinePair: line-number column, two spaces, code text.
+// Filler sides stay empty.
+void append_split_half(std::string& out, int lineNo, std::string_view content,
+                       uint32_t& contentOffset) {
+    if (lineNo == 0 && content.empty()) {
+        contentOffset = static_cast<uint32_t>(out.size());
+        return;
+    }
+    append_line_number(out, lineNo);
+    out += "  ";
+    contentOffset = static_cast<uint32_t>(out.size());
+    out += content;
+}
+
+DiffDisplayModel build_display(const std::vector<ecs::FileDiff>& diffs, bool split) {
+    DiffDisplayModel model;
+
+    size_t rowCount = 1;
+    for (auto& d : diffs) {
+        rowCount += 2;
+        for (auto& h : d.hunks) rowCount += 1 + h.lines.size();
+        model.totalAdditions += d.additions;
+        model.totalDeletions += d.deletions;
+    }
+    model.rows.reserve(rowCount);
+
+    float y = 0.0f;
+    auto push = [&](DiffRowKind kind, float height) -> DiffRow& {
+        DiffRow& row = model.rows.emplace_back();
+        row.kind = kind;
+        row.y = y;
+        row.height = height;
+        y += height;
+        return row;
+    };
+
+    {
+        DiffRow& row = push(DiffRowKind::StatsHeader, diff_detail::DIFF_HEADER_H);
+        row.label = std::to_string(diffs.size()) + " file"
+            + (diffs.size() != 1 ? "s" : "") + " changed  +"
+            + std::to_string(model.totalAdditions) + "  -"
+            + std::to_string(model.totalDeletions);
+    }
+
+    for (size_t fi = 0; fi < diffs.size(); ++fi) {
+        const auto& fileDiff = diffs[fi];
+        int fileIndex = static_cast<int>(fi);
+
+        {
+            DiffRow& row = push(DiffRowKind::FileHeader, diff_detail::FILE_HEADER_H);
+            row.fileIndex = fileIndex;
+            row.label = file_header_label(fileDiff);
+        }
+
+        // Binary files: just the header and a notice, no hunks or spacer
+        if (fileDiff.isBinary) {
+            DiffRow& row = push(DiffRowKind::BinaryNotice, diff_detail::BINARY_NOTICE_H);
+            row.fileIndex = fileIndex;
+            row.label = "Binary file not shown";
+            continue;
+        }
+
+        for (size_t hi = 0; hi < fileDiff.hunks.size(); ++hi) {
+            const auto& hunk = fileDiff.hunks[hi];
+            int hunkIndex = static_cast<int>(hi);
+            {
+                DiffRow& row = push(DiffRowKind::HunkHeader, diff_detail::HUNK_HEADER_H);
+                row.fileIndex = fileIndex;
+                row.hunkIndex = hunkIndex;
+                row.label = hunk.header;
+            }
+
+            int oldLine = hunk.oldStart;
+            int newLine = hunk.newStart;
+            const auto& lines = hunk.lines;
+            if (split) {
+                auto pushPair = [&](const std::string* oldSide, const std::string* newSide,
+                                    DiffLineClass oldClass, DiffLineClass newClass) {
+                    DiffRow& row = push(DiffRowKind::LinePair, diff_detail::LINE_HEIGHT);
+                    row.fileIndex = fileIndex;
+                    row.hunkIndex = hunkIndex;
+                    row.lineClass = oldSide ? oldClass : DiffLineClass::Filler;
+                    row.rightClass = newSide ? newClass : DiffLineClass::Filler;
+                    std::string_view oldText = oldSide ? line_content(*oldSide) : std::string_view{};
+                    std::string_view newText = newSide ? line_content(*newSide) : std::string_view{};
+                    if (oldSide) row.lineIndex = static_cast<int>(oldSide - lines.data());
+                    if (newSide) row.rightLineIndex = static_cast<int>(newSide - lines.data());
+                    if (oldSide) row.oldLine = oldLine++;
+                    if (newSide) row.newLine = newLine++;
+                    row.label.reserve(diff_detail::LINE_NUMBER_COLS * 2 + 4 +
+                                      oldText.size() + newText.size());
+                    append_split_half(row.label, row.oldLine, oldText, row.contentOffset);
+                    row.rightOffset = static_cast<uint32_t>(row.label.size());
+                    append_split_half(row.label, row.newLine, newText, row.rightContentOffset);
+                };
+
+                size_t i = 0;
+                while (i < lines.size()) {
+                    char prefix = lines[i].empty() ? ' ' : lines[i][0];
+                    if (prefix != '-' && prefix != '+') {
+                        pushPair(&lines[i], &lines[i], DiffLineClass::Context,
+                                 DiffLineClass::Context);
+                        ++i;
+                        continue;
+                    }
+                    // A change block: deletions, then the additions that replace them
+                    size_t delBegin = i;
+                    while (i < lines.size() && !lines[i].empty() && lines[i][0] == '-') ++i;
+                    size_t addBegin = i;
+                    while (i < lines.size() && !lines[i].empty() && lines[i][0] == '+') ++i;
+                    size_t dels = addBegin - delBegin;
+                    size_t adds = i - addBegin;
+                    for (size_t k = 0; k < std::max(dels, adds); ++k) {
+                        pushPair(k < dels ? &lines[delBegin + k] : nullptr,
+                                 k < adds ? &lines[addBegin + k] : nullptr,
+                                 DiffLineClass::Deletion, DiffLineClass::Addition);
+                    }
+                }
+                continue;
+            }
+
+            for (size_t li = 0; li < lines.size(); ++li) {
+                const auto& line = lines[li];
+                DiffRow& row = push(DiffRowKind::Line, diff_detail::LINE_HEIGHT);
+                row.fileIndex = fileIndex;
+                row.hunkIndex = hunkIndex;
+                row.lineIndex = static_cast<int>(li);
+
+                char prefix = line.empty() ? ' ' : line[0];
+                if (prefix == '+') {
+                    row.lineClass = DiffLineClass::Addition;
+                    row.newLine = newLine++;
+                } else if (prefix == '-') {
+                    row.lineClass = DiffLineClass::Deletion;
+                    row.oldLine = oldLine++;
+                } else {
+                    row.oldLine = oldLine++;
+                    row.newLine = newLine++;
+                }
+
+                std::string_view content = line_content(line);
+                row.label.reserve(diff_detail::LINE_NUMBER_COLS * 2 + 3 + content.size());
+                append_line_number(row.label, row.oldLine);
+                row.label += ' ';
+                append_line_number(row.label, row.newLine);
+                row.label += "  ";
+                row.contentOffset = static_cast<uint32_t>(row.label.size());
+                row.label += content;
+                row.columns = static_cast<uint32_t>(text_columns(content));
+                model.widestLine = std::max(model.widestLine, row.contentOffset + row.columns);
+            }
+        }
+
+        // Spacer between files
+        if (fi + 1 < diffs.size()) {
+            DiffRow& row = push(DiffRowKind::FileSpacer, diff_detail::FILE_SPACER_H);
+            row.fileIndex = fileIndex;
+        }
+    }
+
+    model.totalHeight = y;
+    return model;
+}
+
+}  // namespace
+
+DiffDisplayModel build_diff_display(const std::vector<ecs::FileDiff>& diffs) {
+    return build_display(diffs, false);
+}
+
+DiffDisplayModel build_split_diff_display(const std::vector<ecs::FileDiff>& diffs) {
+    return build_display(diffs, true);
+}
+
+std::span<const word_diff::Span> DiffWordHighlights::line(int file, int hunk,
+                                                          int line) const {
+    if (file < 0 || hunk < 0 || line < 0) return {};
+    auto f = static_cast<size_t>(file);
+    auto h = static_cast<size_t>(hunk);
+    if (f >= files.size() || h >= files[f].size()) return {};
+    return files[f][h].line(static_cast<size_t>(line));
+}
+
+size_t DiffWordHighlights::approx_bytes() const {
+    size_t bytes = sizeof(DiffWordHighlights);
+    for (const auto& hunks : files) {
+        bytes += sizeof(hunks) + hunks.size() * sizeof(word_diff::HunkHighlights);
+        for (const auto& h : hunks) {
+            bytes += h.lineFirst.size() * sizeof(uint32_t) +
+                     h.spans.size() * sizeof(word_diff::Span);
+        }
+    }
+    return bytes;
+}
+
+std::span<const syntax::Span> DiffSyntax::line(int file, bool newSide,
+                                               int lineNo) const {
+    if (file < 0 || lineNo <= 0 || static_cast<size_t>(file) >= files.size()) return {};
+    const auto& f = files[static_cast<size_t>(file)];
+    const auto& image = newSide ? f.newImage : f.oldImage;
+    if (!image) return {};
+    return image->line(static_cast<size_t>(lineNo - 1));
+}
+
+DiffWordHighlights build_word_highlights(std::span<const ecs::FileDiff> diffs) {
+    DiffWordHighlights out;
+    out.files.resize(diffs.size());
+    for (size_t fi = 0; fi < diffs.size(); ++fi) {
+        if (diffs[fi].isBinary) continue;
+        auto& hunks = out.files[fi];
+        hunks.reserve(diffs[fi].hunks.size());
+        for (const auto& hunk : diffs[fi].hunks) {
+            hunks.push_back(word_diff::diff_hunk(hunk.lines));
+        }
+    }
+    return out;
+}
+
+} // namespace ui
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../util/syntax_highlight.h"
+#include "../util/word_diff.h"
+
+namespace ecs { struct FileDiff; }
+
+namespace ui {
+
+namespace diff_detail {
+
+// Row heights in h720 design units.  The display model lays rows out with
+// these so the renderer can map a scroll offset to a row range without
+// touching the rows it skips.
+constexpr float LINE_HEIGHT   = 20.0f;
+constexpr float GUTTER_WIDTH  = 40.0f;
+constexpr float HUNK_HEADER_H = 24.0f;
+constexpr float FILE_HEADER_H = 28.0f;
+constexpr float DIFF_HEADER_H = 28.0f;
+constexpr float BINARY_NOTICE_H = 24.0f;
+constexpr float FILE_SPACER_H = 8.0f;
+constexpr float CODE_PAD_LEFT = 8.0f;
+
+// Width of each line-number column in the composed gutter label.
+constexpr size_t LINE_NUMBER_COLS = 5;
+
+// Glyph advance of the mono code font, in ems.  Labels are monospace, so
+// a character column maps to x without measuring text.
+constexpr float MONO_ADVANCE = 0.6f;
+
+} // namespace diff_detail
+
+// Monospace columns taken by UTF-8 text: one per character, so
+// continuation bytes share their lead byte's column.
+size_t text_columns(std::string_view text);
+
+// Byte range [begin, end) of the characters in columns [first, last) of
+// `text`, clamped to its length.
+std::pair<size_t, size_t> column_bytes(std::string_view text, size_t first, size_t last);
+
+// ---- Diff display model ----
+//
+// Render-ready form of a parsed diff.  Built once when the diff changes
+// (selection, refresh, commit load) so the per-frame render pass only walks
+// prebuilt rows: no substr, no to_string, no label concatenation.
+
+enum class DiffRowKind : uint8_t {
+    StatsHeader,   // "N files changed  +A  -D"
+    FileHeader,    // path + stats + (new file)/(deleted)/(binary)
+    HunkHeader,    // the @@ line
+    Line,          // one +/-/context line
+    LinePair,      // side by side: old-side and new-side line in one row
+    BinaryNotice,  // "Binary file not shown"
+    FileSpacer,    // gap between files
+};
+
+// Filler marks the blank half of a LinePair whose other side has no
+// counterpart (more deletions than additions in a block, or vice versa).
+enum class DiffLineClass : uint8_t { Context, Addition, Deletion, Filler };
+
+struct DiffRow {
+    DiffRowKind kind = DiffRowKind::Line;
+    DiffLineClass lineClass = DiffLineClass::Context;   // Old side for LinePair
+    DiffLineClass rightClass = DiffLineClass::Filler;   // LinePair new side
+    int fileIndex = -1;   // Index into the source FileDiff vector
+    int hunkIndex = -1;   // Index into FileDiff::hunks
+    int lineIndex = -1;   // Index into DiffHunk::lines (old side for LinePair)
+    int rightLineIndex = -1;  // LinePair new side
+    int oldLine = 0;      // 0 = no old-side line number
+    int newLine = 0;      // 0 = no new-side line number
+    uint32_t contentOffset = 0;  // Start of the code text inside label
+    // LinePair only: label holds the old-side half then the new-side half,
+    // each a line-number column, two spaces and the code text.
+    uint32_t rightOffset = 0;         // Start of the new-side half
+    uint32_t rightContentOffset = 0;  // Start of its code text
+    uint32_t columns = 0;  // Line only: code text width in columns
+    float y = 0.0f;       // Top edge in design units
+    float height = 0.0f;  // Height in design units
+    std::string label;    // Full prebuilt label (gutter + content for lines)
+
+    std::string_view content() const {
+        if (kind == DiffRowKind::LinePair) {
+            return std::string_view(label).substr(contentOffset, rightOffset - contentOffset);
+        }
+        return std::string_view(label).substr(contentOffset);
+    }
+
+    // LinePair halves, gutter included
+    std::string_view left_label() const {
+        return std::string_view(label).substr(0, rightOffset);
+    }
+    std::string_view right_label() const {
+        return std::string_view(label).substr(rightOffset);
+    }
+    std::string_view right_content() const {
+        return std::string_view(label).substr(rightContentOffset);
+    }
+};
+
+struct DiffDisplayModel {
+    std::vector<DiffRow> rows;
+    float totalHeight = 0.0f;
+    int totalAdditions = 0;
+    int totalDeletions = 0;
+    // Widest Line row label (gutter + code) in columns: the horizontal
+    // scroll extent, measured once here rather than per frame.
+    uint32_t widestLine = 0;
+
+    bool empty() const { return rows.empty(); }
+    void clear() { *this = DiffDisplayModel{}; }
+
+    // Half-open row range [first, last) overlapping the band
+    // [top, bottom) in design units.
+    std::pair<size_t, size_t> visible_range(float top, float bottom) const;
+};
+
+// Build the display model for a set of file diffs.
+DiffDisplayModel build_diff_display(const std::vector<ecs::FileDiff>& diffs);
+
+// Side-by-side variant: headers are the same rows as the inline model, but
+// hunk lines become LinePair rows.  Context lines sit on both sides; within
+// each run of changes the n-th deletion is paired with the n-th addition
+// and the longer side's excess gets a Filler opposite, so both columns stay
+// aligned and scroll as one list.
+DiffDisplayModel build_split_diff_display(const std::vector<ecs::FileDiff>& diffs);
+
+// ---- Intra-line highlights ----
+//
+// Word-diff spans for a set of file diffs, in FileDiff/hunk order.  Built
+// on a worker (see WordDiffSystem) and shared by the inline and split
+// models: a row finds its spans through fileIndex/hunkIndex/lineIndex.
+
+struct DiffWordHighlights {
+    std::vector<std::vector<word_diff::HunkHighlights>> files;
+
+    std::span<const word_diff::Span> line(int file, int hunk, int line) const;
+    size_t approx_bytes() const;
+};
+
+DiffWordHighlights build_word_highlights(std::span<const ecs::FileDiff> diffs);
+
+// ---- Syntax colors ----
+//
+// Token spans for the files of a diff, taken from each file's full pre-
+// and post-image so comments and strings opened outside a hunk still color
+// correctly.  Built on a worker (see SyntaxHighlightSystem); rows find
+// their line through oldLine (deleted lines) or newLine (everything else).
+
+struct DiffSyntax {
+    struct File {
+        std::shared_ptr<const syntax::Highlighted> oldImage;  // Null: no colors
+        std::shared_ptr<const syntax::Highlighted> newImage;
+    };
+    std::vector<File> files;  // FileDiff order
+
+    // lineNo is 1-based, as in DiffRow
+    std::span<const syntax::Span> line(int file, bool newSide, int lineNo) const;
+};
+
+} // namespace ui
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+
 #include "../ecs/ui_imports.h"
 #include "../git/git_commands.h"
+#include "diff_display.h"
 #include <afterhours/src/plugins/clipboard.h>
 #include <afterhours/src/plugins/toast.h>
 
@@ -18,17 +24,26 @@ const auto& GUTTER_BORDER  = theme::GUTTER_BORDER;
 const auto& GUTTER_ADD_BG  = theme::GUTTER_ADD_BG;
 const auto& GUTTER_DEL_BG  = theme::GUTTER_DEL_BG;
 
-constexpr float LINE_HEIGHT   = 20.0f;
-constexpr float GUTTER_WIDTH  = 40.0f;
-constexpr float HUNK_HEADER_H = 24.0f;
-constexpr float FILE_HEADER_H = 28.0f;
-constexpr float DIFF_HEADER_H = 28.0f;
-constexpr float CODE_PAD_LEFT = 8.0f;
-
 // ID ranges for diff elements to avoid collision with other systems.
-// MainContentSystem uses 3000-3999. We use 4000-59999.
+// MainContentSystem uses 3000-3999. We use 4000-8099.
 constexpr int BASE_ID = 4000;
 
+// Rows are keyed on their slot (row index modulo ROW_SLOTS) rather than
+// the row index, so long diffs stay inside the range above.  The visible
+// window never holds more rows than there are slots.
+constexpr int ROW_SLOTS = 4096;
+
+// Extra design units rendered above and below the viewport so rows don't
+// pop in at the edges while scrolling.
+constexpr float OVERSCAN = 200.0f;
+
+// Embedded in a parent scroll the diff's offset is the caller's estimate,
+// so cull with more slack in that mode.
+constexpr float EMBED_OVERSCAN = 2.0f * OVERSCAN;
+
+// Columns laid out left and right of the visible part of a code line.
+constexpr float H_OVERSCAN_COLS = 32.0f;
+
 inline std::string hunk_to_text(const ecs::DiffHunk& hunk) {
     std::string text = hunk.header + "\n";
     for (auto& line : hunk.lines) {
@@ -48,54 +63,270 @@ inline std::string file_diff_to_text(const ecs::FileDiff& diff) {
 
 } // namespace diff_detail
 
-// Render a single diff line as a composed label.
-// Format: "  OldLn  NewLn  content"
-inline void render_diff_line(UIContext<InputAction>& ctx,
-                              Entity& parent,
-                              int id,
-                              const std::string& line,
-                              int& oldLine,
-                              int& newLine,
-                              float contentWidth = 0) {
-    afterhours::Color bgColor, textColor;
-    std::string oldNum, newNum;
-    std::string content;
-
-    // Determine line type from prefix character
-    char prefix = line.empty() ? ' ' : line[0];
-    content = line.size() > 1 ? line.substr(1) : "";
-
-    if (prefix == '+') {
-        bgColor   = diff_detail::DIFF_ADD_BG;
-        textColor = theme::DIFF_ADD_TEXT;
-        newNum    = std::to_string(newLine++);
-    } else if (prefix == '-') {
-        bgColor   = diff_detail::DIFF_DEL_BG;
-        textColor = theme::DIFF_DEL_TEXT;
-        oldNum    = std::to_string(oldLine++);
-    } else {
-        bgColor   = theme::PANEL_BG;
-        textColor = theme::TEXT_PRIMARY;
-        oldNum    = std::to_string(oldLine++);
-        newNum    = std::to_string(newLine++);
+// Decorations computed off the UI thread for the diff being drawn.  Either
+// may be null until it is ready; lines then draw without it.
+struct DiffOverlays {
+    const DiffWordHighlights* words = nullptr;
+    const DiffSyntax* syntax = nullptr;
+};
+
+// Horizontal slice of a line in view, in row-local pixels.  Code outside
+// it (plus H_OVERSCAN_COLS) is not laid out, so a minified line tens of
+// thousands of characters wide costs about as much as a short one.
+struct CodeWindow {
+    float leftPx = 0.0f;
+    float rightPx = std::numeric_limits<float>::max();
+    float lineWidth = 0.0f;  // Line row width when wider than the view; 0 = contentWidth
+};
+
+inline void diff_line_colors(DiffLineClass lineClass,
+                             afterhours::Color& bgColor,
+                             afterhours::Color& textColor) {
+    switch (lineClass) {
+        case DiffLineClass::Addition:
+            bgColor   = diff_detail::DIFF_ADD_BG;
+            textColor = theme::DIFF_ADD_TEXT;
+            break;
+        case DiffLineClass::Deletion:
+            bgColor   = diff_detail::DIFF_DEL_BG;
+            textColor = theme::DIFF_DEL_TEXT;
+            break;
+        case DiffLineClass::Context:
+            bgColor   = theme::PANEL_BG;
+            textColor = theme::TEXT_PRIMARY;
+            break;
+        case DiffLineClass::Filler:
+            bgColor   = diff_detail::GUTTER_BG;
+            textColor = theme::TEXT_SECONDARY;
+            break;
+    }
+}
+
+inline afterhours::Color syntax_color(syntax::Kind kind, afterhours::Color plain) {
+    switch (kind) {
+        case syntax::Kind::Keyword: return theme::SYNTAX_KEYWORD;
+        case syntax::Kind::Type:    return theme::SYNTAX_TYPE;
+        case syntax::Kind::String:  return theme::SYNTAX_STRING;
+        case syntax::Kind::Comment: return theme::SYNTAX_COMMENT;
+        case syntax::Kind::Number:  return theme::SYNTAX_NUMBER;
+        case syntax::Kind::Preproc: return theme::SYNTAX_PREPROC;
+        case syntax::Kind::Plain:   break;
+    }
+    return plain;
+}
+
+inline afterhours::Color word_highlight_color(DiffLineClass lineClass) {
+    return lineClass == DiffLineClass::Deletion ? theme::DIFF_DEL_WORD_BG
+                                                : theme::DIFF_ADD_WORD_BG;
+}
+
+// Pixel metrics for placing text by column inside a diff line.
+struct CodeMetrics {
+    float padPx = 0.0f;      // Left padding before column 0
+    float advancePx = 0.0f;  // One monospace column
+    float rowPx = 0.0f;
+
+    static CodeMetrics current() {
+        float screenW = static_cast<float>(afterhours::graphics::get_screen_width());
+        float screenH = static_cast<float>(afterhours::graphics::get_screen_height());
+        return CodeMetrics{
+            resolve_to_pixels(w1280(diff_detail::CODE_PAD_LEFT), screenW),
+            resolve_to_pixels(h720(theme::layout::FONT_CODE), screenH) *
+                diff_detail::MONO_ADVANCE,
+            resolve_to_pixels(h720(diff_detail::LINE_HEIGHT), screenH)};
+    }
+
+    float x_of(size_t column) const {
+        return padPx + static_cast<float>(column) * advancePx;
+    }
+
+    // Code columns [first, last) to lay out for `window`, counted from
+    // the start of the code after a `gutterCols`-wide gutter.
+    std::pair<size_t, size_t> columns(uint32_t gutterCols, const CodeWindow& window) const {
+        if (advancePx <= 0.0f) return {0, 0};
+        auto column = [&](float px) {
+            float c = (px - padPx) / advancePx - static_cast<float>(gutterCols);
+            return static_cast<size_t>(std::clamp(c, 0.0f, 1e9f));
+        };
+        return {column(std::floor(window.leftPx - diff_detail::H_OVERSCAN_COLS * advancePx)),
+                column(std::ceil(std::min(window.rightPx, 1e12f) +
+                                 diff_detail::H_OVERSCAN_COLS * advancePx))};
     }
+};
+
+// Lay out one run of code starting at code column `col` as its own label,
+// clipped to the code columns [first, last).  Returns the run's width.
+inline size_t render_code_run(UIContext<InputAction>& ctx,
+                              Entity& lineEnt,
+                              int& id,
+                              const CodeMetrics& m,
+                              uint32_t gutterCols,
+                              std::string_view text,
+                              size_t col,
+                              std::pair<size_t, size_t> window,
+                              afterhours::Color color) {
+    size_t width = text_columns(text);
+    size_t a = std::max(col, window.first);
+    size_t b = std::min(col + width, window.second);
+    if (a >= b) return width;
+    auto [begin, end] = column_bytes(text, a - col, b - col);
+    std::string_view piece = text.substr(begin, end - begin);
+    if (piece.find_first_not_of(" \t") == std::string_view::npos) return width;
+    div(ctx, mk(lineEnt, id++),
+        ComponentConfig{}
+            .with_size(ComponentSize{pixels(static_cast<float>(b - a) * m.advancePx),
+                                     pixels(m.rowPx)})
+            .with_absolute_position(m.x_of(gutterCols + a), 0.0f)
+            .with_custom_text_color(color)
+            .with_label(std::string(piece))
+            .with_font("mono", h720(theme::layout::FONT_CODE))
+            .with_alignment(TextAlignment::Left)
+            .with_transparent_bg()
+            .with_roundness(0.0f)
+            .with_debug_name("diff_code_run"));
+    return width;
+}
+
+// Whether a line's code is drawn as separate runs (syntax colors, or too
+// wide for the window) instead of as part of the line's own label.
+inline bool code_as_runs(std::span<const syntax::Span> spans, size_t codeColumns,
+                         std::pair<size_t, size_t> window) {
+    return !spans.empty() || window.first > 0 || codeColumns > window.second;
+}
 
-    // Right-pad line numbers for alignment
-    auto padNum = [](const std::string& n, size_t width) -> std::string {
-        if (n.empty()) return std::string(width, ' ');
-        if (n.size() >= width) return n;
-        return std::string(width - n.size(), ' ') + n;
+// Draw the visible part of a line's code as runs, one label per stretch
+// of color: neighbouring tokens that resolve to the same color share a
+// label, and whitespace between tokens joins the run before it, so most
+// lines take a handful of labels.  The line's own label then carries only
+// the gutter (see line_label).  Plain runs keep `plain`, the line's text
+// color.
+inline void render_code_runs(UIContext<InputAction>& ctx,
+                             Entity& lineEnt,
+                             std::string_view label,
+                             uint32_t contentOffset,
+                             std::span<const syntax::Span> spans,
+                             std::pair<size_t, size_t> window,
+                             afterhours::Color plain) {
+    auto m = CodeMetrics::current();
+    std::string_view content = label.substr(contentOffset);
+    size_t col = 0;
+    int id = 100000;
+    auto draw = [&](size_t begin, size_t end, afterhours::Color color) {
+        col += render_code_run(ctx, lineEnt, id, m, contentOffset,  // Gutter is ASCII
+                               content.substr(begin, end - begin), col, window, color);
     };
+    // The run being gathered: content bytes [runBegin, runEnd)
+    size_t runBegin = 0;
+    size_t runEnd = 0;
+    afterhours::Color runColor = plain;
+    auto flush = [&]() {
+        if (runEnd > runBegin) draw(runBegin, runEnd, runColor);
+        runBegin = runEnd;
+    };
+    auto run = [&](size_t begin, size_t end, afterhours::Color color) {
+        std::string_view piece = content.substr(begin, end - begin);
+        if (piece.find_first_not_of(" \t") == std::string_view::npos) {
+            // Indentation measures but draws nothing; later gaps join the run
+            if (runEnd == runBegin) {
+                draw(begin, end, color);
+                runBegin = end;
+            }
+            runEnd = end;
+            return;
+        }
+        bool same = color.r == runColor.r && color.g == runColor.g &&
+                    color.b == runColor.b && color.a == runColor.a;
+        if (runEnd > runBegin && !same) flush();
+        runColor = color;
+        runEnd = end;
+    };
+    size_t pos = 0;
+    for (const auto& span : spans) {
+        if (col >= window.second) return;
+        if (span.end > content.size() || span.begin < pos) break;
+        if (span.begin > pos) run(pos, span.begin, plain);
+        run(span.begin, span.end, syntax_color(span.kind, plain));
+        pos = span.end;
+    }
+    if (pos < content.size() && col < window.second) {
+        // Past the window's right edge nothing is drawn, so stop measuring
+        // there (`col` trails the gathered run, so this errs long)
+        size_t end = pos + column_bytes(content.substr(pos), 0, window.second - col).second;
+        run(pos, end, plain);
+    }
+    flush();
+}
+
+// Label for a line div: the whole line, or just its gutter when the code
+// is drawn as runs.
+inline std::string line_label(std::string_view label, uint32_t contentOffset, bool runs) {
+    return std::string(runs ? label.substr(0, contentOffset) : label);
+}
 
-    std::string label = padNum(oldNum, 5) + " " + padNum(newNum, 5) + "  " + content;
+// Tint the changed runs of a line label.  `contentOffset` is where the
+// code starts in `label`; spans are byte offsets from there.  The tints
+// are translucent and drawn over the text, positioned by column and
+// clipped to the code columns `window`.
+inline void render_word_spans(UIContext<InputAction>& ctx,
+                              Entity& lineEnt,
+                              std::string_view label,
+                              uint32_t contentOffset,
+                              std::span<const word_diff::Span> spans,
+                              std::pair<size_t, size_t> window,
+                              afterhours::Color color) {
+    if (spans.empty()) return;
+    auto m = CodeMetrics::current();
+    std::string_view content = label.substr(contentOffset);
+    size_t col = 0;
+    size_t pos = 0;
+    int id = 10;
+    for (const auto& span : spans) {
+        if (span.end > content.size() || span.begin < pos || col >= window.second) break;
+        col += text_columns(content.substr(pos, span.begin - pos));
+        size_t width = text_columns(content.substr(span.begin, span.end - span.begin));
+        size_t a = std::max(col, window.first);
+        size_t b = std::min(col + width, window.second);
+        if (a < b) {
+            div(ctx, mk(lineEnt, id++),
+                ComponentConfig{}
+                    .with_size(ComponentSize{pixels(static_cast<float>(b - a) * m.advancePx),
+                                             pixels(m.rowPx)})
+                    .with_absolute_position(m.x_of(contentOffset + a), 0.0f)
+                    .with_custom_background(color)
+                    .with_roundness(0.0f)
+                    .with_debug_name("diff_word"));
+        }
+        col += width;
+        pos = span.end;
+    }
+}
+
+// Render a prebuilt diff line row.
+// Label format: "  OldLn  NewLn  content" (composed once by build_diff_display)
+inline void render_diff_line(UIContext<InputAction>& ctx,
+                              Entity& parent,
+                              int id,
+                              const DiffRow& row,
+                              float contentWidth = 0,
+                              const DiffOverlays& overlays = {},
+                              const CodeWindow& window = {}) {
+    afterhours::Color bgColor, textColor;
+    diff_line_colors(row.lineClass, bgColor, textColor);
+    bool deleted = row.lineClass == DiffLineClass::Deletion;
+    auto code = overlays.syntax
+        ? overlays.syntax->line(row.fileIndex, !deleted, deleted ? row.oldLine : row.newLine)
+        : std::span<const syntax::Span>{};
+    auto columns = CodeMetrics::current().columns(row.contentOffset, window);
+    bool runs = code_as_runs(code, row.columns, columns);
+    if (window.lineWidth > 0) contentWidth = window.lineWidth;
 
     auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
-    div(ctx, mk(parent, id),
+    auto line = div(ctx, mk(parent, id),
         ComponentConfig{}
             .with_size(ComponentSize{w, h720(diff_detail::LINE_HEIGHT)})
             .with_custom_background(bgColor)
             .with_custom_text_color(textColor)
-            .with_label(label)
+            .with_label(line_label(row.label, row.contentOffset, runs))
             .with_font("mono", h720(theme::layout::FONT_CODE))
             .with_alignment(TextAlignment::Left)
             .with_padding(Padding{
@@ -103,22 +334,94 @@ inline void render_diff_line(UIContext<InputAction>& ctx,
                 .bottom = h720(0), .left = w1280(diff_detail::CODE_PAD_LEFT)})
             .with_roundness(0.0f)
             .with_debug_name("diff_line"));
+    if (runs) {
+        render_code_runs(ctx, line.ent(), row.label, row.contentOffset, code, columns,
+                         textColor);
+    }
+    if (overlays.words) {
+        render_word_spans(ctx, line.ent(), row.label, row.contentOffset,
+                          overlays.words->line(row.fileIndex, row.hunkIndex, row.lineIndex),
+                          columns, word_highlight_color(row.lineClass));
+    }
 }
 
-// Render a single hunk with its header and all diff lines.
-inline void render_hunk(UIContext<InputAction>& ctx,
-                         Entity& parent,
-                         const ecs::FileDiff& fileDiff,
-                         const ecs::DiffHunk& hunk,
-                         int& nextId,
-                         float contentWidth = 0) {
-    (void)fileDiff; // Kept for future stage/discard functionality
+// Render a side-by-side row: old side on the left half, new side on the
+// right.  Both halves were composed by build_split_diff_display, so this
+// is one row container and two labels, same as an inline row plus one.
+// Each half shows the columns that fit in it; long lines are clipped.
+inline void render_diff_line_pair(UIContext<InputAction>& ctx,
+                                   Entity& parent,
+                                   int id,
+                                   const DiffRow& row,
+                                   float contentWidth = 0,
+                                   const DiffOverlays& overlays = {},
+                                float embedTopPx = 0.0f) {
+    auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
+    auto pairRow = div(ctx, mk(parent, id),
+        ComponentConfig{}
+            .with_size(ComponentSize{w, h720(diff_detail::LINE_HEIGHT)})
+            .with_flex_direction(FlexDirection::Row)
+            .with_roundness(0.0f)
+            .with_debug_name("diff_line_pair"));
+
+    float halfPx = 0.5f * (contentWidth > 0
+        ? contentWidth
+        : static_cast<float>(afterhours::graphics::get_screen_width()));
+    auto metrics = CodeMetrics::current();
+    auto half = [&](int childId, DiffLineClass lineClass, std::string_view label,
+                    uint32_t contentOffset, int lineIndex, int lineNo, bool left) {
+        afterhours::Color bgColor, textColor;
+        diff_line_colors(lineClass, bgColor, textColor);
+        auto code = overlays.syntax ? overlays.syntax->line(row.fileIndex, !left, lineNo)
+                                    : std::span<const syntax::Span>{};
+        auto columns = metrics.columns(contentOffset, CodeWindow{0.0f, halfPx});
+        // Bytes bound the columns, so the common short line isn't measured
+        size_t codeBytes = label.size() - contentOffset;
+        bool runs = code_as_runs(code, codeBytes > columns.second
+                                           ? text_columns(label.substr(contentOffset))
+                                           : codeBytes,
+                                 columns);
+        auto config = ComponentConfig{}
+            .with_size(ComponentSize{percent(0.5f), percent(1.0f)})
+            .with_custom_background(bgColor)
+            .with_custom_text_color(textColor)
+            .with_label(line_label(label, contentOffset, runs))
+            .with_font("mono", h720(theme::layout::FONT_CODE))
+            .with_alignment(TextAlignment::Left)
+            .with_padding(Padding{
+                .top = h720(0), .right = w1280(0),
+                .bottom = h720(0), .left = w1280(diff_detail::CODE_PAD_LEFT)})
+            .with_roundness(0.0f)
+            .with_debug_name(left ? "diff_line_old" : "diff_line_new");
+        if (left) config = config.with_border_right(diff_detail::GUTTER_BORDER);
+        auto halfDiv = div(ctx, mk(pairRow.ent(), childId), config);
+        if (runs) {
+            render_code_runs(ctx, halfDiv.ent(), label, contentOffset, code, columns,
+                             textColor);
+        }
+        if (overlays.words) {
+            render_word_spans(ctx, halfDiv.ent(), label, contentOffset,
+                              overlays.words->line(row.fileIndex, row.hunkIndex, lineIndex),
+                              columns, word_highlight_color(lineClass));
+        }
+    };
+    half(0, row.lineClass, row.left_label(), row.contentOffset, row.lineIndex,
+         row.oldLine, true);
+    half(1, row.rightClass, row.right_label(), row.rightContentOffset - row.rightOffset,
+         row.rightLineIndex, row.newLine, false);
+}
 
+// Render a hunk header row (label + copy button).  The clipboard text is
+// only built when the button is actually clicked.
+inline void render_hunk_header(UIContext<InputAction>& ctx,
+                                Entity& parent,
+                                int id,
+                                const DiffRow& row,
+                                const ecs::DiffHunk& hunk,
+                                float contentWidth = 0) {
     auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
 
-    // Hunk header row: label + copy button
-    int hunkHeaderId = nextId++;
-    auto hunkRow = div(ctx, mk(parent, hunkHeaderId),
+    auto hunkRow = div(ctx, mk(parent, id),
         ComponentConfig{}
             .with_size(ComponentSize{w, h720(diff_detail::HUNK_HEADER_H)})
             .with_flex_direction(FlexDirection::Row)
@@ -130,7 +433,7 @@ inline void render_hunk(UIContext<InputAction>& ctx,
 
     div(ctx, mk(hunkRow.ent(), 0),
         ComponentConfig{}
-            .with_label(hunk.header)
+            .with_label(row.label)
             .with_size(ComponentSize{percent(1.0f), percent(1.0f)})
             .with_custom_text_color(theme::DIFF_HUNK_HEADER)
             .with_font("mono", h720(theme::layout::FONT_CODE))
@@ -140,45 +443,163 @@ inline void render_hunk(UIContext<InputAction>& ctx,
                 .bottom = h720(4), .left = w1280(12)})
             .with_debug_name("hunk_header_label"));
 
-    {
-        std::string hunkText = diff_detail::hunk_to_text(hunk);
-        auto copyBtn = button(ctx, mk(hunkRow.ent(), 1),
-            preset::Button("Copy")
-                .with_size(ComponentSize{children(), h720(18)})
-                .with_padding(Padding{
-                    .top = h720(2), .right = w1280(8),
-                    .bottom = h720(2), .left = w1280(8)})
-                .with_custom_background(afterhours::Color{60, 60, 65, 255})
-                .with_custom_text_color(theme::TEXT_SECONDARY)
-                .with_font_size(afterhours::ui::FontSize::Small)
-                .with_debug_name("copy_hunk_btn"));
-        if (copyBtn) {
-            afterhours::clipboard::set_text(hunkText);
-            afterhours::toast::send_info(ctx, "Copied hunk to clipboard", 1.5f);
-        }
+    auto copyBtn = button(ctx, mk(hunkRow.ent(), 1),
+        preset::Button("Copy")
+            .with_size(ComponentSize{children(), h720(18)})
+            .with_padding(Padding{
+                .top = h720(2), .right = w1280(8),
+                .bottom = h720(2), .left = w1280(8)})
+            .with_custom_background(afterhours::Color{60, 60, 65, 255})
+            .with_custom_text_color(theme::TEXT_SECONDARY)
+            .with_font_size(afterhours::ui::FontSize::Small)
+            .with_debug_name("copy_hunk_btn"));
+    if (copyBtn) {
+        afterhours::clipboard::set_text(diff_detail::hunk_to_text(hunk));
+        afterhours::toast::send_info(ctx, "Copied hunk to clipboard", 1.5f);
     }
+}
 
-    // Render each line in the hunk
-    int oldLine = hunk.oldStart;
-    int newLine = hunk.newStart;
+// Render a file header row (label + copy button).
+inline void render_file_header(UIContext<InputAction>& ctx,
+                                Entity& parent,
+                                int id,
+                                const DiffRow& row,
+                                const ecs::FileDiff& fileDiff,
+                                float contentWidth = 0) {
+    auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
 
-    for (auto& line : hunk.lines) {
-        render_diff_line(ctx, parent, nextId++, line, oldLine, newLine, contentWidth);
+    auto fileHeaderRow = div(ctx, mk(parent, id),
+        ComponentConfig{}
+            .with_size(ComponentSize{w, h720(diff_detail::FILE_HEADER_H)})
+            .with_flex_direction(FlexDirection::Row)
+            .with_justify_content(JustifyContent::SpaceBetween)
+            .with_align_items(AlignItems::Center)
+            .with_custom_background(theme::SIDEBAR_BG)
+            .with_border_bottom(theme::BORDER)
+            .with_roundness(0.0f)
+            .with_debug_name("file_header_row"));
+
+    div(ctx, mk(fileHeaderRow.ent(), 0),
+        ComponentConfig{}
+            .with_label(row.label)
+            .with_size(ComponentSize{percent(1.0f), percent(1.0f)})
+            .with_custom_text_color(theme::TEXT_PRIMARY)
+            .with_font_size(afterhours::ui::FontSize::XL)
+            .with_alignment(TextAlignment::Left)
+            .with_padding(Padding{
+                .top = h720(8), .right = w1280(0),
+                .bottom = h720(8), .left = w1280(16)})
+            .with_debug_name("file_header_label"));
+
+    auto fileCopyBtn = button(ctx, mk(fileHeaderRow.ent(), 1),
+        preset::Button("Copy Diff")
+            .with_size(ComponentSize{children(), h720(18)})
+            .with_padding(Padding{
+                .top = h720(2), .right = w1280(8),
+                .bottom = h720(2), .left = w1280(8)})
+            .with_custom_background(afterhours::Color{60, 60, 65, 255})
+            .with_custom_text_color(theme::TEXT_SECONDARY)
+            .with_font_size(afterhours::ui::FontSize::Small)
+            .with_debug_name("copy_file_diff_btn"));
+    if (fileCopyBtn) {
+        afterhours::clipboard::set_text(diff_detail::file_diff_to_text(fileDiff));
+        afterhours::toast::send_info(ctx, "Copied diff to clipboard", 1.5f);
+    }
+}
+
+// Render one row of a diff display model.
+inline void render_diff_row(UIContext<InputAction>& ctx,
+                             Entity& parent,
+                             int id,
+                             const DiffRow& row,
+                             const std::vector<ecs::FileDiff>& diffs,
+                             float contentWidth = 0,
+                             const DiffOverlays& overlays = {},
+                             const CodeWindow& window = {}) {
+    auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
+
+    switch (row.kind) {
+        case DiffRowKind::StatsHeader:
+            div(ctx, mk(parent, id),
+                ComponentConfig{}
+                    .with_size(ComponentSize{percent(1.0f), h720(diff_detail::DIFF_HEADER_H)})
+                    .with_padding(Padding{
+                        .top = h720(6), .right = w1280(12),
+                        .bottom = h720(4), .left = w1280(12)})
+                    .with_custom_text_color(theme::TEXT_PRIMARY)
+                    .with_custom_background(afterhours::Color{35, 35, 38, 255})
+                    .with_label(row.label)
+                    .with_font_size(afterhours::ui::FontSize::Medium)
+                    .with_alignment(TextAlignment::Left)
+                    .with_roundness(0.0f)
+                    .with_debug_name("diff_stats_header"));
+            break;
+        case DiffRowKind::FileHeader:
+            render_file_header(ctx, parent, id, row,
+                               diffs[static_cast<size_t>(row.fileIndex)],
+                               contentWidth);
+            break;
+        case DiffRowKind::HunkHeader: {
+            auto& fileDiff = diffs[static_cast<size_t>(row.fileIndex)];
+            render_hunk_header(ctx, parent, id, row,
+                               fileDiff.hunks[static_cast<size_t>(row.hunkIndex)],
+                               contentWidth);
+            break;
+        }
+        case DiffRowKind::Line:
+            render_diff_line(ctx, parent, id, row, contentWidth, overlays, window);
+            break;
+        case DiffRowKind::LinePair:
+            render_diff_line_pair(ctx, parent, id, row, contentWidth, overlays);
+            break;
+        case DiffRowKind::BinaryNotice:
+            div(ctx, mk(parent, id),
+                ComponentConfig{}
+                    .with_size(ComponentSize{w, h720(diff_detail::BINARY_NOTICE_H)})
+                    .with_custom_background(theme::PANEL_BG)
+                    .with_custom_text_color(theme::TEXT_SECONDARY)
+                    .with_label(row.label)
+                    .with_font_size(afterhours::ui::FontSize::Medium)
+                    .with_alignment(TextAlignment::Center)
+                    .with_padding(Padding{
+                        .top = h720(4), .right = w1280(8),
+                        .bottom = h720(4), .left = w1280(8)})
+                    .with_roundness(0.0f)
+                    .with_debug_name("binary_notice"));
+            break;
+        case DiffRowKind::FileSpacer:
+            div(ctx, mk(parent, id),
+                ComponentConfig{}
+                    .with_size(ComponentSize{w, h720(diff_detail::FILE_SPACER_H)})
+                    .with_custom_background(theme::PANEL_BG)
+                    .with_roundness(0.0f)
+                    .with_debug_name("file_spacer"));
+            break;
     }
 }
 
-// Render the complete inline diff view for all file diffs.
+// Render the complete diff view from a prebuilt display model: inline, or
+// side by side when given the build_split_diff_display model.  `overlays`
+// adds intra-line highlights and syntax colors once they have been
+// computed; until then lines draw without them.
 // This is the main entry point called by MainContentSystem.
+//
+// Only rows overlapping the viewport (plus OVERSCAN) are emitted; the rest
+// are replaced by two fixed-height spacers so the scroll extent is unchanged.
 // When embedInParentScroll is true, diff content is added directly to the parent
 // without creating a nested scroll container (used by commit detail view).
+// `embedTopPx` is then where the diff starts inside the parent's scroll
+// content, as estimated by the caller; rows are culled against the parent's
+// scroll offset minus that, with EMBED_OVERSCAN covering the estimate's error.
 inline void render_inline_diff(UIContext<InputAction>& ctx,
                                 Entity& parent,
                                 const std::vector<ecs::FileDiff>& diffs,
+                                const DiffDisplayModel& model,
                                 float contentWidth, float contentHeight,
                                 bool embedInParentScroll = false,
-                                bool resetScroll = false) {
-    int nextId = diff_detail::BASE_ID;
-
+                                bool resetScroll = false,
+                                const DiffOverlays& overlays = {},
+                                float embedTopPx = 0.0f) {
     auto w = contentWidth > 0 ? pixels(contentWidth) : percent(1.0f);
 
     // When embedded, attach directly to parent; otherwise create our own scroll wrapper.
@@ -188,10 +609,11 @@ inline void render_inline_diff(UIContext<InputAction>& ctx,
         auto h = contentHeight > 0
                      ? pixels(contentHeight - diff_detail::DIFF_HEADER_H)
                      : percent(1.0f);
-        auto scrollContainer = div(ctx, mk(parent, nextId++),
+        auto scrollContainer = div(ctx, mk(parent, diff_detail::BASE_ID),
             ComponentConfig{}
                 .with_size(ComponentSize{w, h})
                 .with_overflow(Overflow::Scroll, Axis::Y)
+                .with_overflow(Overflow::Scroll, Axis::X)
                 .with_flex_direction(FlexDirection::Column)
                 .with_custom_background(theme::PANEL_BG)
                 .with_roundness(0.0f)
@@ -202,135 +624,75 @@ inline void render_inline_diff(UIContext<InputAction>& ctx,
         contentParent = &scrollContainer.ent();
     }
 
-    // Stats summary header inside scroll
-    {
-        int totalAdditions = 0, totalDeletions = 0;
-        for (auto& d : diffs) {
-            totalAdditions += d.additions;
-            totalDeletions += d.deletions;
-        }
-        std::string stats = std::to_string(diffs.size()) + " file"
-            + (diffs.size() != 1 ? "s" : "") + " changed  +"
-            + std::to_string(totalAdditions) + "  -"
-            + std::to_string(totalDeletions);
-
-        div(ctx, mk(*contentParent, nextId++),
-            ComponentConfig{}
-                .with_size(ComponentSize{percent(1.0f), h720(diff_detail::DIFF_HEADER_H)})
-                .with_padding(Padding{
-                    .top = h720(6), .right = w1280(12),
-                    .bottom = h720(4), .left = w1280(12)})
-                .with_custom_text_color(theme::TEXT_PRIMARY)
-                .with_custom_background(afterhours::Color{35, 35, 38, 255})
-                .with_label(stats)
-                .with_font_size(afterhours::ui::FontSize::Medium)
-                .with_alignment(TextAlignment::Left)
-                .with_roundness(0.0f)
-                .with_debug_name("diff_stats_header"));
+    // Map the scroll position (pixels) into design units to pick rows.
+    float screenH = static_cast<float>(afterhours::graphics::get_screen_height());
+    float pxPerUnit = resolve_to_pixels(h720(720.0f), screenH) / 720.0f;
+    if (pxPerUnit <= 0.0f) pxPerUnit = 1.0f;
+    float scrollPx = 0.0f;
+    float scrollXPx = 0.0f;
+    if (contentParent->has<afterhours::ui::HasScrollView>()) {
+        const auto& scroll = contentParent->get<afterhours::ui::HasScrollView>();
+        scrollPx = std::fabs(scroll.scroll_offset.y);
+        scrollXPx = std::fabs(scroll.scroll_offset.x);
     }
+    float viewportPx = contentHeight > 0 ? contentHeight : screenH;
 
-    for (auto& fileDiff : diffs) {
-        // File header bar
-        std::string fileLabel = fileDiff.filePath;
-        if (fileDiff.isRenamed && !fileDiff.oldPath.empty()) {
-            fileLabel = fileDiff.oldPath + " -> " + fileDiff.filePath;
-        }
-
-        std::string statsLabel;
-        if (fileDiff.additions > 0) {
-            statsLabel += "+" + std::to_string(fileDiff.additions);
-        }
-        if (fileDiff.deletions > 0) {
-            if (!statsLabel.empty()) statsLabel += " ";
-            statsLabel += "-" + std::to_string(fileDiff.deletions);
-        }
-        if (!statsLabel.empty()) {
-            fileLabel += "  " + statsLabel;
-        }
+    float overscan = diff_detail::OVERSCAN;
+    if (embedInParentScroll) {
+        scrollPx -= embedTopPx;
+        overscan = diff_detail::EMBED_OVERSCAN;
+    }
+    float top = scrollPx / pxPerUnit - overscan;
+    float bottom = (scrollPx + viewportPx) / pxPerUnit + overscan;
+    auto [first, last] = model.visible_range(top, bottom);
+    last = std::min(last, first + static_cast<size_t>(diff_detail::ROW_SLOTS));
+
+    // Horizontally, Line rows are as wide as the widest one so the view
+    // can scroll across it, but each lays out only the columns in view.
+    // Embedded in the commit detail page there is no sideways scroll, so
+    // long lines are clipped at the view's edge instead.
+    CodeWindow window;
+    float viewWidthPx = contentWidth > 0
+        ? contentWidth
+        : static_cast<float>(afterhours::graphics::get_screen_width());
+    window.rightPx = viewWidthPx;
+    if (!embedInParentScroll) {
+        auto metrics = CodeMetrics::current();
+        float extentPx = metrics.x_of(model.widestLine) + metrics.padPx;
+        if (extentPx > viewWidthPx) window.lineWidth = extentPx;
+        window.leftPx = scrollXPx;
+        window.rightPx = scrollXPx + viewWidthPx;
+    }
 
-        if (fileDiff.isNew) {
-            fileLabel += "  (new file)";
-        } else if (fileDiff.isDeleted) {
-            fileLabel += "  (deleted)";
-        } else if (fileDiff.isBinary) {
-            fileLabel += "  (binary)";
-        }
+    // Row IDs are tied to the row's slot so entities stay stable while scrolling.
+    constexpr int TOP_SPACER_ID = diff_detail::BASE_ID + 1;
+    constexpr int BOTTOM_SPACER_ID = diff_detail::BASE_ID + 2;
+    constexpr int FIRST_ROW_ID = diff_detail::BASE_ID + 3;
 
-        int fileHeaderRowId = nextId++;
-        auto fileHeaderRow = div(ctx, mk(*contentParent, fileHeaderRowId),
+    if (first > 0) {
+        float topH = first < model.rows.size() ? model.rows[first].y
+                                               : model.totalHeight;
+        div(ctx, mk(*contentParent, TOP_SPACER_ID),
             ComponentConfig{}
-                .with_size(ComponentSize{w, h720(diff_detail::FILE_HEADER_H)})
-                .with_flex_direction(FlexDirection::Row)
-                .with_justify_content(JustifyContent::SpaceBetween)
-                .with_align_items(AlignItems::Center)
-                .with_custom_background(theme::SIDEBAR_BG)
-                .with_border_bottom(theme::BORDER)
+                .with_size(ComponentSize{w, h720(topH)})
+                .with_transparent_bg()
                 .with_roundness(0.0f)
-                .with_debug_name("file_header_row"));
-
-        div(ctx, mk(fileHeaderRow.ent(), 0),
-            ComponentConfig{}
-                .with_label(fileLabel)
-                .with_size(ComponentSize{percent(1.0f), percent(1.0f)})
-                .with_custom_text_color(theme::TEXT_PRIMARY)
-                .with_font_size(afterhours::ui::FontSize::XL)
-                .with_alignment(TextAlignment::Left)
-                .with_padding(Padding{
-                    .top = h720(8), .right = w1280(0),
-                    .bottom = h720(8), .left = w1280(16)})
-                .with_debug_name("file_header_label"));
-
-        {
-            std::string diffText = diff_detail::file_diff_to_text(fileDiff);
-            auto fileCopyBtn = button(ctx, mk(fileHeaderRow.ent(), 1),
-                preset::Button("Copy Diff")
-                    .with_size(ComponentSize{children(), h720(18)})
-                    .with_padding(Padding{
-                        .top = h720(2), .right = w1280(8),
-                        .bottom = h720(2), .left = w1280(8)})
-                    .with_custom_background(afterhours::Color{60, 60, 65, 255})
-                    .with_custom_text_color(theme::TEXT_SECONDARY)
-                    .with_font_size(afterhours::ui::FontSize::Small)
-                    .with_debug_name("copy_file_diff_btn"));
-            if (fileCopyBtn) {
-                afterhours::clipboard::set_text(diffText);
-                afterhours::toast::send_info(ctx, "Copied diff to clipboard", 1.5f);
-            }
-        }
-
-        // Binary files: just show the header, no hunks
-        if (fileDiff.isBinary) {
-            div(ctx, mk(*contentParent, nextId++),
-                ComponentConfig{}
-                    .with_size(ComponentSize{w, h720(24)})
-                    .with_custom_background(theme::PANEL_BG)
-                    .with_custom_text_color(theme::TEXT_SECONDARY)
-                    .with_label("Binary file not shown")
-                    .with_font_size(afterhours::ui::FontSize::Medium)
-                    .with_alignment(TextAlignment::Center)
-                    .with_padding(Padding{
-                        .top = h720(4), .right = w1280(8),
-                        .bottom = h720(4), .left = w1280(8)})
-                    .with_roundness(0.0f)
-                    .with_debug_name("binary_notice"));
-            continue;
-        }
+                .with_debug_name("diff_top_spacer"));
+    }
 
-        // Render each hunk (passing contentWidth for proper sizing)
-        for (auto& hunk : fileDiff.hunks) {
-            render_hunk(ctx, *contentParent, fileDiff, hunk, nextId,
-                        contentWidth);
-        }
+    for (size_t i = first; i < last; ++i) {
+        int slot = static_cast<int>(i % diff_detail::ROW_SLOTS);
+        render_diff_row(ctx, *contentParent, FIRST_ROW_ID + slot,
+                        model.rows[i], diffs, contentWidth, overlays, window);
+    }
 
-        // Spacer between files
-        if (&fileDiff != &diffs.back()) {
-            div(ctx, mk(*contentParent, nextId++),
-                ComponentConfig{}
-                    .with_size(ComponentSize{w, h720(8)})
-                    .with_custom_background(theme::PANEL_BG)
-                    .with_roundness(0.0f)
-                    .with_debug_name("file_spacer"));
-        }
+    if (last < model.rows.size()) {
+        div(ctx, mk(*contentParent, BOTTOM_SPACER_ID),
+            ComponentConfig{}
+                .with_size(ComponentSize{w, h720(model.totalHeight - model.rows[last].y)})
+                .with_transparent_bg()
+                .with_roundness(0.0f)
+                .with_debug_name("diff_bottom_spacer"));
     }
 }
 
@@ -74,6 +74,10 @@ inline std::vector<Menu> createMenuBar() {
             set_pending_toast("Select All is not yet implemented");
         }),
         MenuItem::separator(),
+        MenuItem::item("Go to File...", "Cmd+P", [] {
+            auto* f = ecs::find_singleton<ecs::FileFinderCache, ecs::ActiveTab>();
+            if (f) f->show();
+        }),
         MenuItem::item("Find...", "Cmd+F", [] {
             set_pending_toast("Find is not yet implemented");
         }),
@@ -89,6 +93,10 @@ inline std::vector<Menu> createMenuBar() {
             auto* l = ecs::find_singleton<ecs::LayoutComponent>();
             if (l) l->commandLogVisible = !l->commandLogVisible;
         }),
+        MenuItem::item("Toggle Frame Profiler", "", [] {
+            auto* l = ecs::find_singleton<ecs::LayoutComponent>();
+            if (l) l->profilerVisible = !l->profilerVisible;
+        }),
         MenuItem::separator(),
         MenuItem::item("Inline Diff", "Cmd+Shift+I", [] {
             auto* l = ecs::find_singleton<ecs::LayoutComponent>();
@@ -168,15 +176,15 @@ inline std::vector<Menu> createMenuBar() {
         MenuItem::separator(),
         MenuItem::item("Push", "Cmd+Shift+P", [] {
             auto* r = ecs::find_singleton<ecs::RepoComponent, ecs::ActiveTab>();
-            if (r) ecs::enqueue_network_op("Push", git::git_run_async(r->repoPath, {"push"}));
+            if (r) ecs::enqueue_network_op("Push", r->repoPath, {"push"});
         }),
         MenuItem::item("Pull", "", [] {
             auto* r = ecs::find_singleton<ecs::RepoComponent, ecs::ActiveTab>();
-            if (r) ecs::enqueue_network_op("Pull", git::git_run_async(r->repoPath, {"pull"}));
+            if (r) ecs::enqueue_network_op("Pull", r->repoPath, {"pull"});
         }),
         MenuItem::item("Fetch", "", [] {
             auto* r = ecs::find_singleton<ecs::RepoComponent, ecs::ActiveTab>();
-            if (r) ecs::enqueue_network_op("Fetch", git::git_run_async(r->repoPath, {"fetch"}));
+            if (r) ecs::enqueue_network_op("Fetch", r->repoPath, {"fetch"});
         }),
     }});
 
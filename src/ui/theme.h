@@ -32,6 +32,16 @@ inline Color DIFF_ADD_BG = {35, 52, 35, 255};         // #233423 — green tint
 inline Color DIFF_ADD_TEXT = {126, 231, 135, 255};    // #7EE787
 inline Color DIFF_DEL_BG = {61, 17, 23, 255};         // #3D1117
 inline Color DIFF_DEL_TEXT = {255, 123, 114, 255};    // #FF7B72
+inline Color DIFF_ADD_WORD_BG = {46, 160, 67, 90};    // Changed words, over DIFF_ADD_BG
+inline Color DIFF_DEL_WORD_BG = {248, 81, 73, 90};    // Changed words, over DIFF_DEL_BG
+
+// Syntax colors for diff code (plain text keeps the line's own color)
+inline Color SYNTAX_KEYWORD = {198, 120, 221, 255};  // #C678DD
+inline Color SYNTAX_TYPE = {229, 192, 123, 255};     // #E5C07B
+inline Color SYNTAX_STRING = {152, 195, 121, 255};   // #98C379
+inline Color SYNTAX_COMMENT = {127, 132, 142, 255};  // #7F848E
+inline Color SYNTAX_NUMBER = {209, 154, 102, 255};   // #D19A66
+inline Color SYNTAX_PREPROC = {97, 175, 239, 255};   // #61AFEF
 inline Color DIFF_HUNK_HEADER = {78, 154, 220, 255};  // #4E9ADC
 inline Color DIFF_HUNK_BG = {26, 35, 50, 255};        // #1A2332
 inline Color GUTTER_BG = {30, 30, 30, 255};      // #1E1E1E (matches WINDOW_BG)
@@ -71,6 +81,15 @@ inline Color BADGE_TAG_TEXT = {204, 204, 204, 255};  // #CCCCCC (tag text)
 // Commit graph
 inline Color GRAPH_DOT = {150, 110, 220, 255};  // Purple/violet for graph dots
 inline Color GRAPH_LINE = {100, 80, 150, 255}; // Connecting lines between commits
+// Lane colours, cycled by lane index
+inline Color GRAPH_LANES[] = {
+    {150, 110, 220, 255},  // Violet (matches GRAPH_DOT)
+    {78, 154, 220, 255},   // Blue
+    {87, 166, 74, 255},    // Green
+    {227, 179, 65, 255},   // Amber
+    {220, 110, 110, 255},  // Red
+    {90, 190, 190, 255},   // Teal
+};
 
 // Row separator
 inline Color ROW_SEPARATOR = {48, 48, 48, 255};  // #303030 (more visible)
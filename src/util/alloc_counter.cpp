@@ -0,0 +1,94 @@
+#include "alloc_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t t_allocations = 0;
+
+void* raw_alloc(std::size_t size) { return std::malloc(size); }
+
+void* raw_aligned_alloc(std::size_t size, std::size_t alignment) {
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size) != 0) return nullptr;
+    return p;
+}
+
+// Standard operator new semantics: on failure call the installed
+// new_handler and retry, throwing bad_alloc only when there is none.
+template <typename Alloc>
+void* counted_new(Alloc&& alloc) {
+    ++t_allocations;
+    while (true) {
+        if (void* p = alloc()) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* counted_alloc(std::size_t size) {
+    if (size == 0) size = 1;
+    return counted_new([size] { return raw_alloc(size); });
+}
+
+void* counted_aligned_alloc(std::size_t size, std::align_val_t align) {
+    auto alignment = static_cast<std::size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    if (size == 0) size = 1;
+    return counted_new([size, alignment] { return raw_aligned_alloc(size, alignment); });
+}
+
+// The nothrow forms run the same handler loop and report failure as null.
+void* counted_alloc_nothrow(std::size_t size) noexcept {
+    try {
+        return counted_alloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}  // namespace
+
+namespace alloc_counter {
+
+uint64_t thread_allocations() { return t_allocations; }
+
+}  // namespace alloc_counter
+
+// ---- Global operator new/delete replacements ----
+//
+// Always linked in, not only while the profiler overlay is open: the
+// overlay is toggled at runtime, and the cost outside it is one
+// thread-local increment per allocation.
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc_nothrow(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return counted_alloc_nothrow(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    return counted_aligned_alloc(size, align);
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return counted_aligned_alloc(size, align);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
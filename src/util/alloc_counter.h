@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Heap allocation counter for the frame profiler.  alloc_counter.cpp
+// replaces the global operator new to bump a per-thread counter, so the
+// UI thread can measure its own allocations without seeing workers'.
+namespace alloc_counter {
+
+// Number of operator new calls made by the calling thread so far.
+uint64_t thread_allocations();
+
+}  // namespace alloc_counter
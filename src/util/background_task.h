@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Bookkeeping for detached workers.  Leaked on purpose: a worker that is
+// still running when main() returns may touch it after static destruction.
+struct BackgroundTasks {
+    std::mutex mutex;
+    std::condition_variable idle;
+    size_t inFlight = 0;
+    std::atomic<bool> stopping{false};
+
+    static BackgroundTasks& get() {
+        static auto* tasks = new BackgroundTasks();
+        return *tasks;
+    }
+};
+
+// True once shutdown has begun.  Long-running workers (streaming git
+// commands, index builds) check this and stop early.
+inline bool background_stopping() {
+    return BackgroundTasks::get().stopping.load(std::memory_order_acquire);
+}
+
+// Run fn on a detached worker thread.  Workers report back by posting to
+// the completion queue (see ecs/completion_system.h) rather than through a
+// future, so nothing on the UI thread has to poll or block on them.
+template <typename F>
+void run_in_background(F&& fn) {
+    auto& tasks = BackgroundTasks::get();
+    {
+        std::lock_guard lock(tasks.mutex);
+        ++tasks.inFlight;
+    }
+    std::thread([fn = std::forward<F>(fn), &tasks]() mutable {
+        fn();
+        std::lock_guard lock(tasks.mutex);
+        if (--tasks.inFlight == 0) tasks.idle.notify_all();
+    }).detach();
+}
+
+// Called once on exit: asks workers to stop, then waits up to `timeout` for
+// them to finish.  Returns the number still running.  Those may outlive
+// main(); everything a worker can reach after this point (the completion
+// queue, the frame wake signal, git stats and the git log hook) is leaked
+// rather than destroyed, so they stay valid.
+inline size_t shutdown_background_tasks(std::chrono::milliseconds timeout) {
+    auto& tasks = BackgroundTasks::get();
+    tasks.stopping.store(true, std::memory_order_release);
+    std::unique_lock lock(tasks.mutex);
+    tasks.idle.wait_for(lock, timeout, [&] { return tasks.inFlight == 0; });
+    return tasks.inFlight;
+}
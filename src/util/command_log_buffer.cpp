@@ -0,0 +1,240 @@
+#include "command_log_buffer.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+bool is_utf8_continuation(char c) {
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+void remove_file(const std::string& path) {
+    if (path.empty()) return;
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+}  // namespace
+
+CommandLogBuffer::CommandLogBuffer() : CommandLogBuffer(Limits{}) {}
+
+CommandLogBuffer::CommandLogBuffer(Limits limits) : limits_(std::move(limits)) {
+    if (limits_.maxEntries == 0) limits_.maxEntries = 1;
+    if (!limits_.spillDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(limits_.spillDir, ec);
+        if (ec) limits_.spillDir.clear();
+    }
+}
+
+CommandLogBuffer::~CommandLogBuffer() { clear(); }
+
+std::string CommandLogBuffer::excerpt(const std::string& text, size_t headBytes,
+                                      size_t tailBytes) {
+    if (text.size() <= headBytes + tailBytes) return text;
+
+    size_t headEnd = headBytes;
+    while (headEnd > 0 && is_utf8_continuation(text[headEnd])) --headEnd;
+    size_t tailStart = text.size() - tailBytes;
+    while (tailStart < text.size() && is_utf8_continuation(text[tailStart])) {
+        ++tailStart;
+    }
+
+    std::string out;
+    out.reserve(headEnd + (text.size() - tailStart) + 48);
+    out.append(text, 0, headEnd);
+    out += "\n... [" + std::to_string(tailStart - headEnd) + " bytes omitted] ...\n";
+    out.append(text, tailStart, std::string::npos);
+    return out;
+}
+
+size_t CommandLogBuffer::entry_bytes(const Entry& e) {
+    return sizeof(Entry) + e.command.size() + e.output.size() + e.error.size() +
+           e.spillPath.size();
+}
+
+std::string CommandLogBuffer::write_spill(uint64_t seq, const std::string& text) const {
+    if (limits_.spillDir.empty()) return {};
+    std::string path = limits_.spillDir + "/cmd_" + std::to_string(seq) + ".log";
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return {};
+    out << text;
+    if (!out) {
+        out.close();
+        remove_file(path);
+        return {};
+    }
+    return path;
+}
+
+void CommandLogBuffer::record(const std::string& command, const std::string& output,
+                              const std::string& error, bool success,
+                              double timestamp, double durationMs) {
+    Entry e;
+    e.command = command;
+    e.output = excerpt(output, limits_.headBytes, limits_.tailBytes);
+    e.error = excerpt(error, limits_.headBytes, limits_.tailBytes);
+    e.success = success;
+    e.timestamp = timestamp;
+    e.durationMs = durationMs;
+    e.outputBytes = output.size();
+    e.errorBytes = error.size();
+    size_t keep = limits_.headBytes + limits_.tailBytes;
+    e.truncated = output.size() > keep || error.size() > keep;
+
+    // Hold the full text (built outside the lock) so spill() can write it
+    // later; the file itself only appears if the user asks for it.
+    if (e.truncated && !limits_.spillDir.empty()) {
+        auto text = std::make_shared<std::string>();
+        text->reserve(output.size() + error.size() + 16);
+        *text += output;
+        if (!error.empty()) {
+            *text += "\n--- stderr ---\n";
+            *text += error;
+        }
+        e.fullText = std::move(text);
+    }
+
+    std::lock_guard lock(mutex_);
+    e.seq = nextSeq_++;
+    size_t size = entry_bytes(e);
+    while (count_ > 0 &&
+           (count_ >= limits_.maxEntries || bytes_ + size > limits_.maxBytes)) {
+        evict_oldest();
+    }
+    if (e.fullText) {
+        ++heldCount_;
+        heldBytes_ += e.fullText->size();
+    }
+
+    if (count_ == slots_.size()) {
+        // Full but below maxEntries: unwrap, then grow
+        std::rotate(slots_.begin(),
+                    slots_.begin() + static_cast<std::ptrdiff_t>(head_),
+                    slots_.end());
+        head_ = 0;
+        slots_.push_back(std::move(e));
+    } else {
+        slots_[(head_ + count_) % slots_.size()] = std::move(e);
+    }
+    ++count_;
+    bytes_ += size;
+    trim_held();
+}
+
+std::string CommandLogBuffer::spill(uint64_t seq) {
+    std::shared_ptr<const std::string> text;
+    {
+        std::lock_guard lock(mutex_);
+        Entry* e = find(seq);
+        if (!e) return {};
+        if (!e->spillPath.empty()) return e->spillPath;
+        text = e->fullText;
+    }
+    if (!text) return {};
+
+    // Write without the lock so recording threads never wait on the disk
+    std::string path = write_spill(seq, *text);
+    if (path.empty()) return {};
+
+    std::lock_guard lock(mutex_);
+    Entry* e = find(seq);
+    if (!e) {
+        remove_file(path);  // Evicted while we were writing
+        return {};
+    }
+    if (e->spillPath.empty()) {
+        drop_held(*e);
+        e->spillPath = path;
+        bytes_ += path.size();
+        spillBytes_ += e->outputBytes + e->errorBytes;
+        trim_spills(seq);
+    }
+    return e->spillPath;
+}
+
+CommandLogBuffer::Entry* CommandLogBuffer::find(uint64_t seq) {
+    for (size_t i = 0; i < count_; ++i) {
+        Entry& e = slots_[(head_ + i) % slots_.size()];
+        if (e.seq == seq) return &e;
+    }
+    return nullptr;
+}
+
+void CommandLogBuffer::evict_oldest() {
+    Entry& oldest = slots_[head_];
+    bytes_ -= entry_bytes(oldest);
+    drop_held(oldest);
+    if (!oldest.spillPath.empty()) {
+        spillBytes_ -= oldest.outputBytes + oldest.errorBytes;
+        remove_file(oldest.spillPath);
+    }
+    oldest = Entry{};
+    head_ = (head_ + 1) % slots_.size();
+    --count_;
+}
+
+void CommandLogBuffer::drop_held(Entry& e) {
+    if (!e.fullText) return;
+    --heldCount_;
+    heldBytes_ -= e.fullText->size();
+    e.fullText.reset();
+}
+
+// Release the oldest held full outputs (keeping their excerpts) until the
+// count and size fit.  The newest entry's text is always kept.
+void CommandLogBuffer::trim_held() {
+    for (size_t i = 0; i + 1 < count_ && (heldCount_ > limits_.maxHeldOutputs ||
+                                          heldBytes_ > limits_.maxHeldBytes);
+         ++i) {
+        drop_held(slots_[(head_ + i) % slots_.size()]);
+    }
+}
+
+// Drop the oldest spill files (keeping their excerpts) until the total
+// fits.  The file just written for `keepSeq` is always kept.
+void CommandLogBuffer::trim_spills(uint64_t keepSeq) {
+    for (size_t i = 0; i < count_ && spillBytes_ > limits_.maxSpillBytes; ++i) {
+        Entry& e = slots_[(head_ + i) % slots_.size()];
+        if (e.spillPath.empty() || e.seq == keepSeq) continue;
+        spillBytes_ -= e.outputBytes + e.errorBytes;
+        bytes_ -= e.spillPath.size();
+        remove_file(e.spillPath);
+        e.spillPath.clear();
+    }
+}
+
+size_t CommandLogBuffer::size() const {
+    std::lock_guard lock(mutex_);
+    return count_;
+}
+
+size_t CommandLogBuffer::bytes() const {
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+size_t CommandLogBuffer::held_bytes() const {
+    std::lock_guard lock(mutex_);
+    return heldBytes_;
+}
+
+size_t CommandLogBuffer::spill_bytes() const {
+    std::lock_guard lock(mutex_);
+    return spillBytes_;
+}
+
+uint64_t CommandLogBuffer::total_recorded() const {
+    std::lock_guard lock(mutex_);
+    return nextSeq_ - 1;
+}
+
+void CommandLogBuffer::clear() {
+    std::lock_guard lock(mutex_);
+    while (count_ > 0) evict_oldest();
+    slots_.clear();
+    head_ = 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Ring buffer of executed git commands for the command log panel, bounded
+// by entry count and by retained bytes.  Only a head/tail excerpt of each
+// command's stdout/stderr is kept in memory.  When an excerpt drops text,
+// the full output of the last few such commands is also held, and spill()
+// writes it to a file when the user asks for it.  Nothing touches the disk
+// while recording.  Spill files are deleted with their entry (or when the
+// total spilled size passes `maxSpillBytes`).
+//
+// record() is called from worker threads (the git log callback); readers
+// on the UI thread go through for_each_newest(), which holds the lock.
+class CommandLogBuffer {
+   public:
+    struct Limits {
+        size_t maxEntries = 1000;
+        size_t maxBytes = 4u << 20;        // Commands + excerpts in memory
+        size_t headBytes = 2048;           // Kept from the start of output
+        size_t tailBytes = 1024;           // Kept from the end of output
+        size_t maxHeldOutputs = 8;         // Full outputs kept for spill()
+        size_t maxHeldBytes = 16u << 20;
+        size_t maxSpillBytes = 64u << 20;  // Full outputs on disk
+        std::string spillDir;              // Empty: no spill files
+    };
+
+    struct Entry {
+        uint64_t seq = 0;  // 1-based, increases with every record()
+        std::string command;
+        std::string output;  // Excerpt
+        std::string error;   // Excerpt
+        bool success = false;
+        double timestamp = 0.0;
+        double durationMs = 0.0;
+        size_t outputBytes = 0;  // Original sizes
+        size_t errorBytes = 0;
+        bool truncated = false;  // An excerpt dropped text
+        // Full stdout + stderr of a truncated entry, until it is spilled or
+        // newer truncated entries push it out
+        std::shared_ptr<const std::string> fullText;
+        std::string spillPath;  // Set once spill() has written the file
+
+        bool can_spill() const { return fullText || !spillPath.empty(); }
+    };
+
+    CommandLogBuffer();
+    explicit CommandLogBuffer(Limits limits);
+    ~CommandLogBuffer();
+
+    CommandLogBuffer(const CommandLogBuffer&) = delete;
+    CommandLogBuffer& operator=(const CommandLogBuffer&) = delete;
+
+    // Head/tail excerpt of `text`, cut on UTF-8 boundaries, with a marker
+    // for the omitted middle.  Returns `text` unchanged if it fits.
+    static std::string excerpt(const std::string& text, size_t headBytes,
+                               size_t tailBytes);
+
+    void record(const std::string& command, const std::string& output,
+                const std::string& error, bool success, double timestamp,
+                double durationMs);
+
+    // Write the full output of entry `seq` to a spill file (once) and
+    // return its path.  Empty if the entry is gone or its full text was
+    // not kept.
+    std::string spill(uint64_t seq);
+
+    size_t size() const;
+    size_t bytes() const;            // Retained in memory
+    size_t held_bytes() const;       // Full outputs awaiting spill()
+    size_t spill_bytes() const;      // Retained on disk
+    uint64_t total_recorded() const; // Including evicted entries
+    const Limits& limits() const { return limits_; }
+
+    // Visit entries newest first as fn(index, entry), under the lock.
+    // Stops early if fn returns false.
+    template <typename F>
+    void for_each_newest(F&& fn) const {
+        std::lock_guard lock(mutex_);
+        for (size_t i = 0; i < count_; ++i) {
+            if (!fn(i, at(count_ - 1 - i))) break;
+        }
+    }
+
+    void clear();
+
+   private:
+    // Entry `i` in age order (0 = oldest).
+    const Entry& at(size_t i) const {
+        return slots_[(head_ + i) % slots_.size()];
+    }
+    static size_t entry_bytes(const Entry& e);
+    Entry* find(uint64_t seq);
+    void evict_oldest();
+    void drop_held(Entry& e);
+    void trim_held();
+    void trim_spills(uint64_t keepSeq);
+    std::string write_spill(uint64_t seq, const std::string& text) const;
+
+    Limits limits_;
+    mutable std::mutex mutex_;
+    std::vector<Entry> slots_;  // Grows to maxEntries, then wraps
+    size_t head_ = 0;           // Oldest entry
+    size_t count_ = 0;
+    size_t bytes_ = 0;
+    size_t heldCount_ = 0;
+    size_t heldBytes_ = 0;
+    size_t spillBytes_ = 0;
+    uint64_t nextSeq_ = 1;
+};
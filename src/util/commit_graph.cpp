@@ -0,0 +1,145 @@
+#include "commit_graph.h"
+
+#include <algorithm>
+
+void CommitGraph::clear() {
+    rows_.clear();
+    spans_.clear();
+    edges_.clear();
+    checkpoints_.clear();
+    laneSpan_.clear();
+    freeLanes_ = {};
+    waiting_.clear();
+    width_ = 0;
+    open_ = 0;
+    prefix_ = 0;
+}
+
+CommitGraph::Lane CommitGraph::take_lane() {
+    ++open_;
+    if (!freeLanes_.empty()) {
+        Lane lane = freeLanes_.top();
+        freeLanes_.pop();
+        return lane;
+    }
+    laneSpan_.push_back(NO_SPAN);
+    return width_++;
+}
+
+void CommitGraph::release_lane(Lane lane, uint32_t lastRow) {
+    Span& span = spans_[laneSpan_[lane]];
+    span.toRow = std::max(lastRow, span.fromRow);
+    laneSpan_[lane] = NO_SPAN;
+    freeLanes_.push(lane);
+    --open_;
+}
+
+void CommitGraph::open_span(Lane lane, uint32_t fromRow) {
+    laneSpan_[lane] = static_cast<uint32_t>(spans_.size());
+    spans_.push_back(Span{lane, fromRow, OPEN});
+}
+
+void CommitGraph::wait_for(Lane lane, std::string_view parent) {
+    waiting_[std::string(parent)].push_back(lane);
+}
+
+void CommitGraph::add(std::string_view hash, std::string_view parents) {
+    auto row = static_cast<uint32_t>(rows_.size());
+    if (row % CHECKPOINT_ROWS == 0) {
+        Checkpoint cp;
+        for (uint32_t span : laneSpan_) {
+            if (span != NO_SPAN) cp.openSpans.push_back(span);
+        }
+        cp.spanCount = static_cast<uint32_t>(spans_.size());
+        checkpoints_.push_back(std::move(cp));
+    }
+
+    // Lanes waiting for this commit meet at the leftmost one
+    std::vector<Lane> incoming;
+    if (auto it = waiting_.find(std::string(hash)); it != waiting_.end()) {
+        incoming = std::move(it->second);
+        waiting_.erase(it);
+    }
+    Lane node;
+    if (incoming.empty()) {
+        node = take_lane();  // Branch tip
+        open_span(node, row);
+    } else {
+        std::sort(incoming.begin(), incoming.end());
+        node = incoming.front();
+        for (size_t i = 1; i < incoming.size(); ++i) {
+            edges_.push_back(Edge{row - 1, incoming[i], node});
+            release_lane(incoming[i], row - 1);
+        }
+    }
+    rows_.push_back(node);
+
+    std::vector<std::string_view> ps;
+    while (!parents.empty()) {
+        size_t sp = parents.find(' ');
+        std::string_view p = parents.substr(0, sp);
+        parents = sp == std::string_view::npos ? std::string_view{} : parents.substr(sp + 1);
+        if (!p.empty() && std::find(ps.begin(), ps.end(), p) == ps.end()) ps.push_back(p);
+    }
+    if (ps.empty()) {
+        release_lane(node, row);  // Root commit
+        return;
+    }
+
+    // First parent continues straight down; merge parents branch off
+    for (size_t i = 1; i < ps.size(); ++i) {
+        auto it = waiting_.find(std::string(ps[i]));
+        if (it != waiting_.end() && !it->second.empty()) {
+            Lane target = *std::min_element(it->second.begin(), it->second.end());
+            edges_.push_back(Edge{row, node, target});
+            continue;
+        }
+        Lane lane = take_lane();
+        open_span(lane, row + 1);
+        wait_for(lane, ps[i]);
+        edges_.push_back(Edge{row, node, lane});
+    }
+    wait_for(node, ps[0]);
+}
+
+void CommitGraph::prepend_linear(uint32_t count) {
+    prefix_ += count;
+}
+
+CommitGraph::Span CommitGraph::span_at(uint32_t id) const {
+    Span s = spans_[id];
+    if (id != 0) s.fromRow += prefix_;  // Span 0 starts at the top
+    if (s.toRow != OPEN) s.toRow += prefix_;
+    return s;
+}
+
+void CommitGraph::query(uint32_t first, uint32_t last, Window& out) const {
+    out.spans.clear();
+    out.edges.clear();
+    out.lanes = 0;
+    last = std::min(last, static_cast<uint32_t>(size()));
+    if (first >= last) return;
+
+    auto keep = [&](const Span& s) {
+        if (s.fromRow >= last || (s.toRow != OPEN && s.toRow < first)) return;
+        out.spans.push_back(s);
+        out.lanes = std::max(out.lanes, s.lane + 1);
+    };
+    uint32_t stored = first > prefix_ ? first - prefix_ : 0;
+    const Checkpoint& cp = checkpoints_[stored / CHECKPOINT_ROWS];
+    for (uint32_t id : cp.openSpans) keep(span_at(id));
+    for (auto id = cp.spanCount; id < spans_.size(); ++id) {
+        Span s = span_at(id);
+        if (s.fromRow >= last) break;
+        keep(s);
+    }
+
+    uint32_t edgeFrom = first > prefix_ ? first - 1 - prefix_ : 0;
+    auto it = std::lower_bound(edges_.begin(), edges_.end(), edgeFrom,
+                               [](const Edge& e, uint32_t row) { return e.row < row; });
+    for (; it != edges_.end() && it->row + prefix_ < last; ++it) {
+        out.edges.push_back(Edge{it->row + prefix_, it->from, it->to});
+        out.lanes = std::max({out.lanes, it->from + 1, it->to + 1});
+    }
+    for (uint32_t r = first; r < last; ++r) out.lanes = std::max(out.lanes, lane(r) + 1);
+}
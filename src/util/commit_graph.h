@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Lane layout for the commit graph, built one row at a time in log order
+// (children before parents) so loading the next page only lays out the
+// new rows.  Each commit sits in a lane (column); a lane is a vertical run
+// from the commit that opened it to the parent it is waiting for.  Merge
+// parents open a lane of their own, or join one already waiting for that
+// parent; lanes waiting for the same commit converge on it.  Freed lanes
+// are reused from the left, so a lane never moves sideways once placed.
+//
+// Vertical runs are stored as spans rather than per row, and checkpoints
+// every CHECKPOINT_ROWS rows list the spans open there, so query() costs
+// O(lanes open + rows asked for) however long the history is.
+//
+// Rows can also go in front, as long as they are a linear run down into
+// the current first row (what a fast-forward refresh prepends): the first
+// row always sits in lane 0 on span 0, so the run just lengthens that span
+// and everything stored below is read back offset by the run's length.
+class CommitGraph {
+   public:
+    using Lane = uint32_t;
+    static constexpr uint32_t OPEN = UINT32_MAX;
+
+    // A lane's line from the centre of `fromRow` to the centre of `toRow`
+    // (OPEN while its commit hasn't been added yet).
+    struct Span {
+        Lane lane = 0;
+        uint32_t fromRow = 0;
+        uint32_t toRow = OPEN;
+    };
+
+    // A line from the centre of (`row`, `from`) to the centre of
+    // (`row` + 1, `to`): a commit reaching a merge parent's lane, or a lane
+    // converging on a commit in another lane.
+    struct Edge {
+        uint32_t row = 0;
+        Lane from = 0;
+        Lane to = 0;
+    };
+
+    // Everything that draws into rows [first, last).
+    struct Window {
+        std::vector<Span> spans;
+        std::vector<Edge> edges;  // Includes those from row first - 1
+        Lane lanes = 0;           // 1 + the rightmost lane used
+    };
+
+    void clear();
+
+    // Lay out the next row.  `parents` is space-separated, as from %P.
+    void add(std::string_view hash, std::string_view parents);
+
+    // Put `count` rows in front of row 0: commits with one parent each,
+    // the last one's parent being the current row 0.  O(1).  The graph
+    // must not be empty.
+    void prepend_linear(uint32_t count);
+
+    size_t size() const { return prefix_ + rows_.size(); }
+    Lane lane(uint32_t row) const { return row < prefix_ ? 0 : rows_[row - prefix_]; }
+    Lane width() const { return width_; }  // Lanes ever used
+    size_t open_lanes() const { return open_; }
+
+    void query(uint32_t first, uint32_t last, Window& out) const;
+
+   private:
+    static constexpr uint32_t CHECKPOINT_ROWS = 256;
+    static constexpr uint32_t NO_SPAN = UINT32_MAX;
+
+    struct Checkpoint {
+        std::vector<uint32_t> openSpans;  // Span ids open at this row
+        uint32_t spanCount = 0;           // spans_.size() when taken
+    };
+
+    Lane take_lane();
+    void release_lane(Lane lane, uint32_t lastRow);
+    void open_span(Lane lane, uint32_t fromRow);
+    void wait_for(Lane lane, std::string_view parent);
+    Span span_at(uint32_t id) const;  // With rows offset by prefix_
+
+    // Everything below is stored by row - prefix_, the rows prepended so
+    // far (all lane 0, on span 0).
+    uint32_t prefix_ = 0;
+    std::vector<Lane> rows_;
+    std::vector<Span> spans_;  // Ordered by fromRow
+    std::vector<Edge> edges_;  // Ordered by row
+    std::vector<Checkpoint> checkpoints_;
+
+    std::vector<uint32_t> laneSpan_;  // Open span per lane, or NO_SPAN
+    std::priority_queue<Lane, std::vector<Lane>, std::greater<Lane>> freeLanes_;
+    // Commit hash -> lanes waiting for it
+    std::unordered_map<std::string, std::vector<Lane>> waiting_;
+    Lane width_ = 0;
+    size_t open_ = 0;
+};
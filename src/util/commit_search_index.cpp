@@ -0,0 +1,545 @@
+#include "commit_search_index.h"
+
+#include <algorithm>
+#include <charconv>
+#include <istream>
+#include <ostream>
+
+namespace {
+
+constexpr char FIELD_SEP = '\x1f';
+constexpr char RECORD_SEP = '\x1e';
+constexpr size_t MAX_WORD = 64;
+
+constexpr uint32_t MAGIC = 0x53434846;  // "FHCS"
+constexpr uint32_t VERSION = 1;
+
+char fold(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; }
+
+bool word_char(char c) {
+    auto u = static_cast<unsigned char>(c);
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || u >= 0x80;
+}
+
+// Lowercased words of 2+ characters, longer ones cut at MAX_WORD.
+// Returns false from fn to stop.
+template <typename F>
+void for_each_word(std::string_view text, F&& fn) {
+    std::string word;
+    auto flush = [&]() {
+        bool more = true;
+        if (word.size() >= 2) more = fn(std::string_view(word));
+        word.clear();
+        return more;
+    };
+    for (char c : text) {
+        if (word_char(c)) {
+            if (word.size() < MAX_WORD) word += fold(c);
+        } else if (!word.empty() && !flush()) {
+            return;
+        }
+    }
+    if (!word.empty()) flush();
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool is_hex(std::string_view s) {
+    return std::all_of(s.begin(), s.end(), [](char c) { return hex_value(c) >= 0; });
+}
+
+// Days since 1970-01-01 for a proleptic Gregorian date.
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    auto yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// YYYY, YYYY-MM or YYYY-MM-DD as UTC midnight of its first day.
+bool parse_date(std::string_view s, int64_t& out) {
+    int y = 0, m = 1, d = 1;
+    auto num = [](std::string_view part, int& v) {
+        auto res = std::from_chars(part.data(), part.data() + part.size(), v);
+        return res.ec == std::errc{} && res.ptr == part.data() + part.size();
+    };
+    if (s.size() != 4 && s.size() != 7 && s.size() != 10) return false;
+    if (!num(s.substr(0, 4), y)) return false;
+    if (s.size() >= 7 && (s[4] != '-' || !num(s.substr(5, 2), m))) return false;
+    if (s.size() == 10 && (s[7] != '-' || !num(s.substr(8, 2), d))) return false;
+    if (m < 1 || m > 12 || d < 1 || d > 31) return false;
+    out = days_from_civil(y, static_cast<unsigned>(m), static_cast<unsigned>(d)) * 86400;
+    return true;
+}
+
+bool starts_with_nibbles(std::string_view bytes, std::string_view hex) {
+    if (hex.size() > bytes.size() * 2) return false;
+    for (size_t i = 0; i < hex.size(); ++i) {
+        auto b = static_cast<unsigned char>(bytes[i / 2]);
+        int nibble = (i % 2 == 0) ? (b >> 4) : (b & 0xf);
+        if (nibble != hex_value(hex[i])) return false;
+    }
+    return true;
+}
+
+// ---- Binary cache helpers ----
+
+template <typename T>
+void put(std::ostream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+void put_str(std::ostream& out, std::string_view s) {
+    put(out, static_cast<uint64_t>(s.size()));
+    out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+template <typename T>
+void put_vec(std::ostream& out, const std::vector<T>& v) {
+    put(out, static_cast<uint64_t>(v.size()));
+    out.write(reinterpret_cast<const char*>(v.data()),
+              static_cast<std::streamsize>(v.size() * sizeof(T)));
+}
+
+template <typename T>
+bool get(std::istream& in, T& v) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&v), sizeof(v)));
+}
+
+// Sizes are checked against what's left in the stream, so a corrupt
+// length can't trigger a huge allocation.
+bool fits(std::istream& in, uint64_t bytes) {
+    auto here = in.tellg();
+    if (here < 0) return false;
+    in.seekg(0, std::ios::end);
+    auto end = in.tellg();
+    in.seekg(here);
+    return end >= here && bytes <= static_cast<uint64_t>(end - here);
+}
+
+bool get_str(std::istream& in, std::string& s) {
+    uint64_t n = 0;
+    if (!get(in, n) || !fits(in, n)) return false;
+    s.resize(n);
+    return static_cast<bool>(in.read(s.data(), static_cast<std::streamsize>(n)));
+}
+
+template <typename T>
+bool get_vec(std::istream& in, std::vector<T>& v) {
+    uint64_t n = 0;
+    if (!get(in, n) || n > UINT64_MAX / sizeof(T) || !fits(in, n * sizeof(T))) {
+        return false;
+    }
+    v.resize(n);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()),
+                                     static_cast<std::streamsize>(n * sizeof(T))));
+}
+
+}  // namespace
+
+// ---- Query ----
+
+CommitSearchIndex::Query CommitSearchIndex::parse_query(std::string_view text) {
+    Query q;
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find_first_of(" \t", start);
+        if (end == std::string_view::npos) end = text.size();
+        std::string_view tok = text.substr(start, end - start);
+        start = end + 1;
+        if (tok.empty()) continue;
+
+        auto value = [&](std::string_view key) -> std::string_view {
+            if (tok.size() <= key.size()) return {};
+            for (size_t i = 0; i < key.size(); ++i) {
+                if (fold(tok[i]) != key[i]) return {};
+            }
+            return tok.substr(key.size());
+        };
+        if (auto v = value("author:"); !v.empty()) {
+            std::string lower;
+            for (char c : v) lower += fold(c);
+            q.authors.push_back(std::move(lower));
+        } else if (auto a = value("after:"); !a.empty()) {
+            int64_t t = 0;
+            if (parse_date(a, t)) q.after = std::max(q.after, t);
+        } else if (auto b = value("before:"); !b.empty()) {
+            int64_t t = 0;
+            if (parse_date(b, t)) q.before = std::min(q.before, t);
+        } else {
+            for_each_word(tok, [&](std::string_view w) {
+                q.words.emplace_back(w);
+                return true;
+            });
+        }
+    }
+    return q;
+}
+
+// ---- Ingest ----
+
+void CommitSearchIndex::Ingest::feed(std::string_view chunk) {
+    while (!chunk.empty()) {
+        size_t end = chunk.find(RECORD_SEP);
+        if (end == std::string_view::npos) {
+            partial_.append(chunk);
+            return;
+        }
+        if (partial_.empty()) {
+            record(chunk.substr(0, end));
+        } else {
+            partial_.append(chunk.substr(0, end));
+            record(partial_);
+            partial_.clear();
+        }
+        chunk.remove_prefix(end + 1);
+    }
+}
+
+void CommitSearchIndex::Ingest::finish() {
+    if (!partial_.empty()) record(partial_);
+    partial_.clear();
+}
+
+void CommitSearchIndex::Ingest::record(std::string_view rec) {
+    // The format's trailing newline lands at the start of the next record
+    while (!rec.empty() && (rec.front() == '\n' || rec.front() == '\r')) {
+        rec.remove_prefix(1);
+    }
+    if (rec.empty()) return;
+
+    std::string_view fields[5];
+    for (int i = 0; i < 4; ++i) {
+        size_t sep = rec.find(FIELD_SEP);
+        if (sep == std::string_view::npos) return;
+        fields[i] = rec.substr(0, sep);
+        rec.remove_prefix(sep + 1);
+    }
+    fields[4] = rec;
+
+    int64_t time = 0;
+    std::from_chars(fields[2].data(), fields[2].data() + fields[2].size(), time);
+    if (index_.add(fields[0], fields[1], time, fields[3], fields[4]) != NONE) {
+        ++added_;
+    }
+}
+
+// ---- Building ----
+
+uint32_t CommitSearchIndex::term_id(std::string_view word) {
+    auto it = termIndex_.find(word);
+    if (it != termIndex_.end()) return it->second;
+    auto id = static_cast<uint32_t>(terms_.size());
+    terms_.emplace_back(word);
+    termIndex_.emplace(terms_.back(), id);
+    postings_.emplace_back();
+    return id;
+}
+
+uint32_t CommitSearchIndex::author_id(std::string_view author) {
+    auto it = authorIndex_.find(author);
+    if (it != authorIndex_.end()) return it->second;
+    auto id = static_cast<uint32_t>(authors_.size());
+    authors_.emplace_back(author);
+    authorIndex_.emplace(authors_.back(), id);
+    return id;
+}
+
+CommitSearchIndex::CommitId CommitSearchIndex::add(std::string_view hashHex,
+                                                   std::string_view author,
+                                                   int64_t authorTime,
+                                                   std::string_view subject,
+                                                   std::string_view body) {
+    if (hashHex.empty() || hashHex.size() % 2 != 0 || !is_hex(hashHex)) return NONE;
+    if (hashLen_ == 0) hashLen_ = hashHex.size() / 2;
+    if (hashHex.size() != hashLen_ * 2) return NONE;
+
+    auto id = static_cast<CommitId>(times_.size());
+    for (size_t i = 0; i < hashHex.size(); i += 2) {
+        hashes_ += static_cast<char>((hex_value(hashHex[i]) << 4) |
+                                     hex_value(hashHex[i + 1]));
+    }
+    times_.push_back(authorTime);
+    authorIds_.push_back(author_id(author));
+    subjects_.append(subject);
+    subjectOffsets_.push_back(static_cast<uint32_t>(subjects_.size()));
+
+    std::vector<uint32_t> ids;
+    for_each_word(subject, [&](std::string_view w) {
+        ids.push_back(term_id(w));
+        return true;
+    });
+    size_t bodyWords = 0;
+    for_each_word(body, [&](std::string_view w) {
+        ids.push_back(term_id(w));
+        return ++bodyWords < MAX_BODY_WORDS;
+    });
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    for (uint32_t t : ids) postings_[t].push_back(id);
+    return id;
+}
+
+bool CommitSearchIndex::append(const CommitSearchIndex& batch) {
+    if (batch.size() == 0) return true;
+    if (hashLen_ == 0) hashLen_ = batch.hashLen_;
+    if (batch.hashLen_ != hashLen_) return false;
+
+    auto base = static_cast<CommitId>(size());
+    hashes_ += batch.hashes_;
+    times_.insert(times_.end(), batch.times_.begin(), batch.times_.end());
+
+    std::vector<uint32_t> authorMap;
+    authorMap.reserve(batch.authors_.size());
+    for (const auto& a : batch.authors_) authorMap.push_back(author_id(a));
+    for (uint32_t a : batch.authorIds_) authorIds_.push_back(authorMap[a]);
+
+    auto subjectBase = static_cast<uint32_t>(subjects_.size());
+    subjects_ += batch.subjects_;
+    for (size_t i = 1; i < batch.subjectOffsets_.size(); ++i) {
+        subjectOffsets_.push_back(subjectBase + batch.subjectOffsets_[i]);
+    }
+
+    // Batch ids all follow ours, so postings stay ascending
+    for (size_t t = 0; t < batch.terms_.size(); ++t) {
+        auto& postings = postings_[term_id(batch.terms_[t])];
+        for (CommitId id : batch.postings_[t]) postings.push_back(base + id);
+    }
+    return true;
+}
+
+void CommitSearchIndex::seal() {
+    // A handful of new entries are inserted in place; a bulk load is sorted
+    auto merge = [](std::vector<uint32_t>& sorted, size_t& sealed, size_t total,
+                    auto less) {
+        if (sealed == total) return;
+        if (total - sealed <= std::max<size_t>(64, sorted.size() / 64)) {
+            for (auto id = static_cast<uint32_t>(sealed); id < total; ++id) {
+                sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), id, less),
+                              id);
+            }
+        } else {
+            for (auto id = static_cast<uint32_t>(sealed); id < total; ++id) {
+                sorted.push_back(id);
+            }
+            std::sort(sorted.begin(), sorted.end(), less);
+        }
+        sealed = total;
+    };
+    merge(sortedTerms_, sealedTerms_, terms_.size(),
+          [this](uint32_t a, uint32_t b) { return terms_[a] < terms_[b]; });
+    merge(sortedHashes_, sealedCommits_, size(),
+          [this](uint32_t a, uint32_t b) { return hash_bytes(a) < hash_bytes(b); });
+}
+
+// ---- Lookup ----
+
+std::string CommitSearchIndex::hash(CommitId id) const {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(hashLen_ * 2);
+    for (char c : hash_bytes(id)) {
+        auto b = static_cast<unsigned char>(c);
+        out += DIGITS[b >> 4];
+        out += DIGITS[b & 0xf];
+    }
+    return out;
+}
+
+template <typename F>
+void CommitSearchIndex::for_hash_prefix(std::string_view hex, F&& fn) const {
+    if (hex.empty() || !is_hex(hex) || hex.size() > hashLen_ * 2) return;
+    std::string key;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        key += static_cast<char>((hex_value(hex[i]) << 4) | hex_value(hex[i + 1]));
+    }
+    if (hex.size() % 2) key += static_cast<char>(hex_value(hex.back()) << 4);
+
+    auto first = sortedHashes_.begin();
+    auto last = first + static_cast<std::ptrdiff_t>(sealedCommits_);
+    auto it = std::lower_bound(first, last, key, [this](CommitId id, const std::string& k) {
+        return hash_bytes(id) < std::string_view(k);
+    });
+    for (; it != last && starts_with_nibbles(hash_bytes(*it), hex); ++it) fn(*it);
+    for (auto id = static_cast<CommitId>(sealedCommits_); id < size(); ++id) {
+        if (starts_with_nibbles(hash_bytes(id), hex)) fn(id);
+    }
+}
+
+template <typename F>
+void CommitSearchIndex::for_term_prefix(std::string_view prefix, F&& fn) const {
+    auto first = sortedTerms_.begin();
+    auto last = first + static_cast<std::ptrdiff_t>(sealedTerms_);
+    auto it = std::lower_bound(first, last, prefix, [this](uint32_t id, std::string_view p) {
+        return std::string_view(terms_[id]) < p;
+    });
+    for (; it != last && terms_[*it].starts_with(prefix); ++it) fn(*it);
+    for (auto id = static_cast<uint32_t>(sealedTerms_); id < terms_.size(); ++id) {
+        if (terms_[id].starts_with(prefix)) fn(id);
+    }
+}
+
+bool CommitSearchIndex::contains(std::string_view hashHex) const {
+    if (hashHex.size() != hashLen_ * 2) return false;
+    bool found = false;
+    for_hash_prefix(hashHex, [&](CommitId) { found = true; });
+    return found;
+}
+
+std::vector<CommitSearchIndex::CommitId> CommitSearchIndex::search(
+    const Query& query, size_t limit) const {
+    std::vector<CommitId> heap;
+    size_t n = size();
+    if (n == 0 || limit == 0) return heap;
+
+    // Candidates as a bitset, narrowed word by word
+    std::vector<uint64_t> candidates;
+    for (const auto& word : query.words) {
+        std::vector<uint64_t> bits((n + 63) / 64, 0);
+        auto set = [&bits](CommitId id) { bits[id / 64] |= uint64_t{1} << (id % 64); };
+        for_term_prefix(word, [&](uint32_t t) {
+            for (CommitId id : postings_[t]) set(id);
+        });
+        if (word.size() >= 4 && is_hex(word)) for_hash_prefix(word, set);
+
+        if (candidates.empty()) {
+            candidates = std::move(bits);
+        } else {
+            for (size_t i = 0; i < bits.size(); ++i) candidates[i] &= bits[i];
+        }
+        if (std::all_of(candidates.begin(), candidates.end(),
+                        [](uint64_t w) { return w == 0; })) {
+            return heap;
+        }
+    }
+    if (query.words.empty()) {
+        candidates.assign((n + 63) / 64, ~uint64_t{0});
+        if (n % 64) candidates.back() = (uint64_t{1} << (n % 64)) - 1;
+    }
+
+    std::vector<bool> authorOk;
+    if (!query.authors.empty()) {
+        authorOk.assign(authors_.size(), false);
+        bool any = false;
+        for (size_t a = 0; a < authors_.size(); ++a) {
+            std::string lower;
+            for (char c : authors_[a]) lower += fold(c);
+            bool ok = std::all_of(query.authors.begin(), query.authors.end(),
+                                  [&](const std::string& f) {
+                                      return lower.find(f) != std::string::npos;
+                                  });
+            authorOk[a] = ok;
+            any = any || ok;
+        }
+        if (!any) return heap;
+    }
+
+    // Newest first; the heap keeps the oldest kept result at the front
+    auto newer = [this](CommitId a, CommitId b) {
+        if (times_[a] != times_[b]) return times_[a] > times_[b];
+        return a < b;
+    };
+    for (size_t w = 0; w < candidates.size(); ++w) {
+        uint64_t bits = candidates[w];
+        while (bits) {
+            auto id = static_cast<CommitId>(w * 64 + static_cast<size_t>(__builtin_ctzll(bits)));
+            bits &= bits - 1;
+            int64_t t = times_[id];
+            if (t < query.after || t >= query.before) continue;
+            if (!authorOk.empty() && !authorOk[authorIds_[id]]) continue;
+            if (heap.size() < limit) {
+                heap.push_back(id);
+                std::push_heap(heap.begin(), heap.end(), newer);
+            } else if (newer(id, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), newer);
+                heap.back() = id;
+                std::push_heap(heap.begin(), heap.end(), newer);
+            }
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), newer);
+    return heap;
+}
+
+// ---- Persistence ----
+
+bool CommitSearchIndex::write(std::ostream& out, std::string_view tip) const {
+    put(out, MAGIC);
+    put(out, VERSION);
+    put(out, static_cast<uint64_t>(hashLen_));
+    put_str(out, tip);
+    put_str(out, hashes_);
+    put_vec(out, times_);
+    put_vec(out, authorIds_);
+    put_vec(out, subjectOffsets_);
+    put_str(out, subjects_);
+    put(out, static_cast<uint64_t>(authors_.size()));
+    for (const auto& a : authors_) put_str(out, a);
+    put(out, static_cast<uint64_t>(terms_.size()));
+    for (size_t t = 0; t < terms_.size(); ++t) {
+        put_str(out, terms_[t]);
+        put_vec(out, postings_[t]);
+    }
+    return static_cast<bool>(out);
+}
+
+bool CommitSearchIndex::read(std::istream& in, CommitSearchIndex& index,
+                             std::string& tip) {
+    uint32_t magic = 0, version = 0;
+    uint64_t hashLen = 0;
+    if (!get(in, magic) || magic != MAGIC) return false;
+    if (!get(in, version) || version != VERSION) return false;
+    if (!get(in, hashLen) || hashLen > 64) return false;
+
+    CommitSearchIndex tmp;
+    tmp.hashLen_ = hashLen;
+    std::string tipRead;
+    if (!get_str(in, tipRead) || !get_str(in, tmp.hashes_) ||
+        !get_vec(in, tmp.times_) || !get_vec(in, tmp.authorIds_) ||
+        !get_vec(in, tmp.subjectOffsets_) || !get_str(in, tmp.subjects_)) {
+        return false;
+    }
+    size_t n = tmp.times_.size();
+    if (tmp.hashes_.size() != n * hashLen || tmp.authorIds_.size() != n ||
+        tmp.subjectOffsets_.size() != n + 1 || tmp.subjectOffsets_.front() != 0 ||
+        !std::is_sorted(tmp.subjectOffsets_.begin(), tmp.subjectOffsets_.end()) ||
+        tmp.subjectOffsets_.back() != tmp.subjects_.size()) {
+        return false;
+    }
+
+    uint64_t count = 0;
+    if (!get(in, count)) return false;
+    std::string s;
+    for (uint64_t a = 0; a < count; ++a) {
+        if (!get_str(in, s)) return false;
+        tmp.author_id(s);
+    }
+    if (tmp.authors_.size() != count) return false;
+    for (uint32_t a : tmp.authorIds_) {
+        if (a >= count) return false;
+    }
+
+    if (!get(in, count)) return false;
+    for (uint64_t t = 0; t < count; ++t) {
+        if (!get_str(in, s)) return false;
+        uint32_t id = tmp.term_id(s);
+        if (id != t || !get_vec(in, tmp.postings_[id])) return false;
+        const auto& list = tmp.postings_[id];
+        if (!list.empty() && (list.back() >= n || !std::is_sorted(list.begin(), list.end()))) {
+            return false;
+        }
+    }
+
+    tmp.seal();
+    index = std::move(tmp);
+    tip = std::move(tipRead);
+    return true;
+}
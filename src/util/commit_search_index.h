@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Full-text index over a repository's history, for the commit search box.
+// Subject and body words (lowercased, 2+ characters) map to the commits
+// containing them; each query word matches every indexed word it is a
+// prefix of, and a query word of 4+ hex digits also matches hash prefixes.
+// Authors are interned, so `author:` filters test a few thousand names
+// rather than every commit.
+//
+// Filled from the record stream of git::git_log_search_stream (see
+// Ingest) and saved to disk between sessions with write()/read(), so a
+// restart only indexes the commits made since.
+class CommitSearchIndex {
+   public:
+    using CommitId = uint32_t;
+    static constexpr CommitId NONE = UINT32_MAX;
+
+    struct Query {
+        std::vector<std::string> words;    // Lowercase; all must match
+        std::vector<std::string> authors;  // Lowercase substrings; all must match
+        int64_t after = std::numeric_limits<int64_t>::min();  // authorTime >= after
+        int64_t before = std::numeric_limits<int64_t>::max(); // authorTime < before
+
+        bool empty() const {
+            return words.empty() && authors.empty() &&
+                   after == std::numeric_limits<int64_t>::min() &&
+                   before == std::numeric_limits<int64_t>::max();
+        }
+    };
+
+    // "fix crash author:ann after:2024-01-01 before:2024-06"; dates are
+    // YYYY, YYYY-MM or YYYY-MM-DD (UTC).  One-letter words are dropped.
+    static Query parse_query(std::string_view text);
+
+    // Consumes git::git_log_search_stream output: records end with 0x1e,
+    // fields (hash, "name <email>", unix time, subject, body) are split by
+    // 0x1f.  Records may span chunks.
+    class Ingest {
+       public:
+        explicit Ingest(CommitSearchIndex& index) : index_(index) {}
+        void feed(std::string_view chunk);
+        void finish();
+        size_t added() const { return added_; }
+
+       private:
+        void record(std::string_view rec);
+        CommitSearchIndex& index_;
+        std::string partial_;
+        size_t added_ = 0;
+    };
+
+    CommitSearchIndex() = default;
+    // Lookup maps point into the word and author tables, which a move
+    // keeps in place but a copy wouldn't.
+    CommitSearchIndex(const CommitSearchIndex&) = delete;
+    CommitSearchIndex& operator=(const CommitSearchIndex&) = delete;
+    CommitSearchIndex(CommitSearchIndex&&) = default;
+    CommitSearchIndex& operator=(CommitSearchIndex&&) = default;
+
+    // NONE if the hash isn't hex or its length differs from earlier ones.
+    CommitId add(std::string_view hashHex, std::string_view author,
+                 int64_t authorTime, std::string_view subject,
+                 std::string_view body);
+    // Append every commit of `batch`, which was built separately (say, by
+    // Ingest on a worker), after this index's.  Only the batch's distinct
+    // words and authors are looked up, nothing is re-tokenized.  False,
+    // appending nothing, if its hashes are a different length.
+    bool append(const CommitSearchIndex& batch);
+    // Fold words and hashes added since the last call into the sorted
+    // lookups.  search() is correct either way, just slower on the tail.
+    void seal();
+
+    size_t size() const { return times_.size(); }
+    size_t term_count() const { return terms_.size(); }
+    std::string hash(CommitId id) const;
+    std::string_view subject(CommitId id) const {
+        return std::string_view(subjects_).substr(
+            subjectOffsets_[id], subjectOffsets_[id + 1] - subjectOffsets_[id]);
+    }
+    std::string_view author(CommitId id) const { return authors_[authorIds_[id]]; }
+    int64_t author_time(CommitId id) const { return times_[id]; }
+    bool contains(std::string_view hashHex) const;
+
+    // Matching commits, newest first, at most `limit`.
+    std::vector<CommitId> search(const Query& query, size_t limit) const;
+
+    // Binary cache (native byte order) tagged with the commit the index
+    // covers up to; read() rejects other versions.
+    bool write(std::ostream& out, std::string_view tip) const;
+    static bool read(std::istream& in, CommitSearchIndex& index, std::string& tip);
+
+   private:
+    // Words per commit taken from a body; subjects are always indexed whole.
+    static constexpr size_t MAX_BODY_WORDS = 64;
+
+    uint32_t term_id(std::string_view word);
+    uint32_t author_id(std::string_view author);
+    std::string_view hash_bytes(CommitId id) const {
+        return std::string_view(hashes_).substr(id * hashLen_, hashLen_);
+    }
+    // Calls fn(CommitId) for every commit whose hash starts with `hex`.
+    template <typename F>
+    void for_hash_prefix(std::string_view hex, F&& fn) const;
+    template <typename F>
+    void for_term_prefix(std::string_view prefix, F&& fn) const;
+
+    size_t hashLen_ = 0;          // Bytes per hash (20 for SHA-1)
+    std::string hashes_;          // Raw hash bytes, hashLen_ per commit
+    std::vector<int64_t> times_;
+    std::vector<uint32_t> authorIds_;
+    std::vector<uint32_t> subjectOffsets_ = {0};
+    std::string subjects_;
+
+    std::deque<std::string> authors_;  // Stable addresses for the map keys
+    std::unordered_map<std::string_view, uint32_t> authorIndex_;
+
+    std::deque<std::string> terms_;
+    std::unordered_map<std::string_view, uint32_t> termIndex_;
+    std::vector<std::vector<CommitId>> postings_;  // Ascending commit ids
+
+    std::vector<uint32_t> sortedTerms_;     // Term ids by word, up to sealedTerms_
+    size_t sealedTerms_ = 0;
+    std::vector<CommitId> sortedHashes_;    // Commit ids by hash, up to sealedCommits_
+    size_t sealedCommits_ = 0;
+};
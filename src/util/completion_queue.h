@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Multi-producer single-consumer queue.  Any thread may push(); exactly one
+// thread (the UI thread) calls drain().  push() is a lock-free CAS onto an
+// intrusive stack; drain() detaches the whole stack with one exchange and
+// replays it oldest-first, so the consumer never races producers node by
+// node and there is no ABA window.
+template <typename T>
+class MpscQueue {
+   public:
+    MpscQueue() = default;
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        drain([](T&) {});
+    }
+
+    void push(T value) {
+        Node* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+        pushed_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Invoke fn(T&) on every queued item in push order.  Returns the number
+    // of items handled.  Cost is proportional to completed work only.
+    template <typename F>
+    size_t drain(F&& fn) {
+        Node* list = head_.exchange(nullptr, std::memory_order_acquire);
+        if (!list) return 0;
+
+        // The stack is newest-first; reverse it to preserve push order.
+        Node* ordered = nullptr;
+        while (list) {
+            Node* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            Node* next = ordered->next;
+            fn(ordered->value);
+            delete ordered;
+            ordered = next;
+            ++count;
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == nullptr;
+    }
+
+    // Monotonic count of pushes; lets a consumer tell whether anything
+    // arrived since it last looked without touching the queue.
+    size_t pushed() const { return pushed_.load(std::memory_order_acquire); }
+
+   private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head_{nullptr};
+    std::atomic<size_t> pushed_{0};
+};
@@ -0,0 +1,468 @@
+#include "file_finder.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+constexpr uint32_t EMPTY = UINT32_MAX;
+
+char fold(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + 32) : c; }
+
+uint32_t trigram(std::string_view s, size_t i) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(fold(s[i]))) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(fold(s[i + 1]))) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(fold(s[i + 2])));
+}
+
+std::vector<uint32_t> trigrams_of(std::string_view s) {
+    std::vector<uint32_t> out;
+    if (s.size() < 3) return out;
+    out.reserve(s.size() - 2);
+    for (size_t i = 0; i + 3 <= s.size(); ++i) out.push_back(trigram(s, i));
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+// Lowercased query words, split on whitespace.
+std::vector<std::string> split_words(std::string_view query) {
+    std::vector<std::string> words;
+    std::string cur;
+    for (char c : query) {
+        if (c == ' ' || c == '\t') {
+            if (!cur.empty()) words.push_back(std::move(cur));
+            cur.clear();
+        } else {
+            cur += fold(c);
+        }
+    }
+    if (!cur.empty()) words.push_back(std::move(cur));
+    return words;
+}
+
+bool word_start(std::string_view s, size_t i) {
+    if (i == 0) return true;
+    char prev = s[i - 1];
+    if (prev == '/' || prev == '_' || prev == '-' || prev == '.' || prev == ' ') {
+        return true;
+    }
+    return s[i] >= 'A' && s[i] <= 'Z' && prev >= 'a' && prev <= 'z';
+}
+
+// Subsequence match of `word` in `s`: find where the first left-to-right
+// match ends, walk back from there for the tightest start, and score that
+// window.  -1 when there's no match.  A run continuing (+12) always beats
+// starting a new one at a word start (+10, after a gap), so one unbroken
+// run from a word start is the best case: FileFinder::max_word_score().
+int score_word(std::string_view s, std::string_view word) {
+    size_t wi = 0;
+    size_t end = 0;
+    while (end < s.size() && wi < word.size()) {
+        if (fold(s[end]) == word[wi]) ++wi;
+        ++end;
+    }
+    if (wi < word.size()) return -1;
+
+    size_t start = end;
+    while (wi > 0) {
+        --start;
+        if (fold(s[start]) == word[wi - 1]) --wi;
+    }
+
+    int score = 0;
+    bool run = false;
+    for (size_t i = start; i < end && wi < word.size(); ++i) {
+        if (fold(s[i]) == word[wi]) {
+            score += 16;
+            if (run) {
+                score += 12;
+            } else if (word_start(s, i)) {
+                score += 10;
+            }
+            run = true;
+            ++wi;
+        } else {
+            score -= 1;  // Gap
+            run = false;
+        }
+    }
+    return std::max(score, 0);
+}
+
+// `foldedName` is the lowercase file name, for the NAME_BONUS check.
+int score_words(std::string_view path, size_t nameStart, std::string_view foldedName,
+                const std::vector<std::string>& words, bool lastInName) {
+    std::string_view name = path.substr(nameStart);
+    int total = 0;
+    for (const auto& word : words) {
+        int s = score_word(path, word);
+        if (s < 0) return -1;
+        // Prefer the file name when the word fits there
+        if (word.find('/') == std::string::npos) {
+            s = std::max(s, score_word(name, word));
+        }
+        total += s;
+    }
+    if (lastInName && foldedName.find(words.back()) != std::string_view::npos) {
+        total += FileFinder::NAME_BONUS;
+    }
+    return total;
+}
+
+// One bit per letter and digit, the rest of the bytes folded onto the
+// remaining bits.  A path can only match if its mask covers the query's.
+uint64_t char_bit(char c) {
+    auto u = static_cast<unsigned char>(c);
+    if (u >= 'a' && u <= 'z') return uint64_t{1} << (u - 'a');
+    if (u >= '0' && u <= '9') return uint64_t{1} << (26 + u - '0');
+    return uint64_t{1} << (36 + u % 28);
+}
+
+uint64_t char_mask(std::string_view s) {
+    uint64_t mask = 0;
+    for (char c : s) mask |= char_bit(fold(c));
+    return mask;
+}
+
+size_t name_start(std::string_view path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string_view::npos ? 0 : slash + 1;
+}
+
+}  // namespace
+
+// ---- Interner ----
+
+uint32_t FileFinder::Interner::find(std::string_view s) const {
+    if (slots_.empty()) return EMPTY;
+    size_t mask = slots_.size() - 1;
+    for (size_t i = std::hash<std::string_view>{}(s) & mask;; i = (i + 1) & mask) {
+        uint32_t id = slots_[i];
+        if (id == EMPTY) return EMPTY;
+        if (get(id) == s) return id;
+    }
+}
+
+uint32_t FileFinder::Interner::intern(std::string_view s, bool& added) {
+    uint32_t found = find(s);
+    added = found == EMPTY;
+    if (!added) return found;
+
+    if ((size() + 1) * 2 > slots_.size()) grow();
+    auto id = static_cast<uint32_t>(size());
+    arena_.append(s);
+    offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+    size_t mask = slots_.size() - 1;
+    size_t i = std::hash<std::string_view>{}(s) & mask;
+    while (slots_[i] != EMPTY) i = (i + 1) & mask;
+    slots_[i] = id;
+    return id;
+}
+
+void FileFinder::Interner::grow() {
+    std::vector<uint32_t> slots(std::max<size_t>(slots_.size() * 2, 64), EMPTY);
+    size_t mask = slots.size() - 1;
+    for (uint32_t id = 0; id < size(); ++id) {
+        size_t i = std::hash<std::string_view>{}(get(id)) & mask;
+        while (slots[i] != EMPTY) i = (i + 1) & mask;
+        slots[i] = id;
+    }
+    slots_ = std::move(slots);
+}
+
+void FileFinder::Interner::clear() {
+    arena_.clear();
+    offsets_.assign(1, 0);
+    slots_.clear();
+}
+
+// ---- FileFinder ----
+
+// A parsed query plus the bounds used to skip or stop early.
+struct FileFinder::Query {
+    std::vector<std::string> words;  // Lowercase
+    uint64_t chars = 0;              // char_mask of every word
+    bool lastInName = false;         // A file name may contain the last word
+    int maxWords = 0;                // Best possible score without NAME_BONUS
+    int good = 0;                    // Broad searches stop at `limit` of these
+    const std::atomic<bool>* cancel = nullptr;
+
+    bool cancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+};
+
+namespace {
+
+// Paths added past the sorted order before add() merges them in.
+constexpr size_t MAX_UNORDERED = 4096;
+
+// Scans check for cancellation once per this many paths.
+constexpr size_t CANCEL_STRIDE = 4096;
+
+}  // namespace
+
+void FileFinder::clear() {
+    paths_.clear();
+    info_.clear();
+    liveCount_ = 0;
+    order_.clear();
+    orderedCount_ = 0;
+    segments_.clear();
+    foldedSegments_.clear();
+    trigramSegments_.clear();
+    nameOf_.clear();
+    dirOf_.clear();
+}
+
+FileFinder::PathId FileFinder::add(std::string_view path) {
+    if (path.empty()) return NONE;
+    bool added = false;
+    PathId id = paths_.intern(path, added);
+    if (!added) {
+        if (!info_[id].live) {
+            info_[id].live = true;
+            ++liveCount_;
+        }
+        return id;
+    }
+
+    size_t nameAt = name_start(path);
+    info_.push_back(PathInfo{static_cast<uint32_t>(nameAt), 0, true});
+    ++liveCount_;
+
+    size_t start = 0;
+    while (start < path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) end = path.size();
+        std::string_view seg = path.substr(start, end - start);
+        bool isName = end == path.size();
+        start = end + 1;
+        if (seg.empty()) continue;
+
+        bool segAdded = false;
+        uint32_t sid = segments_.intern(seg, segAdded);
+        if (segAdded) {
+            nameOf_.emplace_back();
+            dirOf_.emplace_back();
+            for (char c : seg) foldedSegments_ += fold(c);
+            for (uint32_t t : trigrams_of(seg)) trigramSegments_[t].push_back(sid);
+        }
+        if (isName) info_[id].nameSeg = sid;
+        auto& list = isName ? nameOf_[sid] : dirOf_[sid];
+        if (list.empty() || list.back() != id) list.push_back(id);
+    }
+
+    // Merge geometrically during a bulk load, and before a long tail of
+    // unsorted paths makes broad searches slow
+    order_.push_back(Ordered{char_mask(path), static_cast<uint32_t>(path.size()), id});
+    if (order_.size() - orderedCount_ > std::max(MAX_UNORDERED, orderedCount_)) {
+        reorder();
+    }
+    return id;
+}
+
+bool FileFinder::remove(std::string_view path) {
+    uint32_t id = paths_.find(path);
+    if (id == EMPTY || !info_[id].live) return false;
+    info_[id].live = false;
+    --liveCount_;
+    return true;
+}
+
+bool FileFinder::contains(std::string_view path) const {
+    uint32_t id = paths_.find(path);
+    return id != EMPTY && info_[id].live;
+}
+
+void FileFinder::reorder() {
+    if (orderedCount_ == order_.size()) return;
+    auto tail = order_.begin() + static_cast<std::ptrdiff_t>(orderedCount_);
+    std::sort(tail, order_.end());
+    std::inplace_merge(order_.begin(), tail, order_.end());
+    orderedCount_ = order_.size();
+}
+
+int FileFinder::score(std::string_view path, std::string_view query) {
+    auto words = split_words(query);
+    if (words.empty()) return -1;
+    size_t nameAt = name_start(path);
+    std::string foldedName;
+    for (char c : path.substr(nameAt)) foldedName += fold(c);
+    return score_words(path, nameAt, foldedName, words,
+                       words.back().find('/') == std::string::npos);
+}
+
+std::vector<uint32_t> FileFinder::segments_with(std::string_view piece,
+                                                bool& broad) const {
+    broad = false;
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (uint32_t t : trigrams_of(piece)) {
+        auto it = trigramSegments_.find(t);
+        if (it == trigramSegments_.end()) return {};
+        lists.push_back(&it->second);
+    }
+    if (lists.empty()) return {};
+    std::sort(lists.begin(), lists.end(),
+              [](auto* a, auto* b) { return a->size() < b->size(); });
+    if (lists.front()->size() > BROAD_COST) {
+        broad = true;
+        return {};
+    }
+
+    std::vector<uint32_t> out = *lists.front();
+    for (size_t i = 1; i < lists.size() && !out.empty(); ++i) {
+        const auto& other = *lists[i];
+        std::erase_if(out, [&other](uint32_t sid) {
+            return !std::binary_search(other.begin(), other.end(), sid);
+        });
+    }
+    return out;
+}
+
+int FileFinder::score_path(PathId id, const Query& q) const {
+    const PathInfo& info = info_[id];
+    return score_words(paths_.get(id), info.nameStart, folded_segment(info.nameSeg),
+                       q.words, q.lastInName);
+}
+
+// Score `id` into the heap unless it can't beat the heap's worst entry
+// even with a perfect score.
+void FileFinder::offer_path(PathId id, const Query& q, size_t limit,
+                            std::vector<Match>& heap) const {
+    const PathInfo& info = info_[id];
+    if (!info.live) return;
+    if (heap.size() == limit) {
+        int bound = q.maxWords;
+        if (q.lastInName &&
+            folded_segment(info.nameSeg).find(q.words.back()) != std::string_view::npos) {
+            bound += NAME_BONUS;
+        }
+        if (bound < heap.front().score) return;
+    }
+    int s = score_path(id, q);
+    if (s >= 0) offer(heap, limit, Match{id, s});
+}
+
+// offer_path() for a path in the scan order; paths missing one of the
+// query's characters are rejected without touching the path itself.
+void FileFinder::offer_ordered(const Ordered& o, const Query& q, size_t limit,
+                               std::vector<Match>& heap) const {
+    if ((o.chars & q.chars) != q.chars) return;
+    offer_path(o.id, q, limit, heap);
+}
+
+// Walk paths shortest first and stop once the heap is full of good hits;
+// among equally good matches the shorter path ranks first anyway.
+void FileFinder::scan_shortest_first(const Query& q, size_t limit,
+                                     std::vector<Match>& heap) const {
+    // Paths added since the last reorder() aren't in order; take them all
+    for (size_t i = orderedCount_; i < order_.size(); ++i) {
+        if (i % CANCEL_STRIDE == 0 && q.cancelled()) return;
+        offer_ordered(order_[i], q, limit, heap);
+    }
+    for (size_t i = 0; i < orderedCount_; ++i) {
+        if (heap.size() == limit && heap.front().score >= q.good) return;
+        if (i % CANCEL_STRIDE == 0 && q.cancelled()) return;
+        offer_ordered(order_[i], q, limit, heap);
+    }
+}
+
+bool FileFinder::better(const Match& a, const Match& b) const {
+    if (a.score != b.score) return a.score > b.score;
+    std::string_view pa = paths_.get(a.id);
+    std::string_view pb = paths_.get(b.id);
+    if (pa.size() != pb.size()) return pa.size() < pb.size();
+    return pa < pb;
+}
+
+// `heap` holds the best `limit` so far, worst at the front.
+void FileFinder::offer(std::vector<Match>& heap, size_t limit, Match m) const {
+    auto cmp = [this](const Match& a, const Match& b) { return better(a, b); };
+    if (heap.size() < limit) {
+        heap.push_back(m);
+        std::push_heap(heap.begin(), heap.end(), cmp);
+    } else if (better(m, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), cmp);
+        heap.back() = m;
+        std::push_heap(heap.begin(), heap.end(), cmp);
+    }
+}
+
+std::vector<FileFinder::Match> FileFinder::search(
+    std::string_view query, size_t limit, const std::atomic<bool>* cancel) const {
+    std::vector<Match> heap;
+    Query q;
+    q.cancel = cancel;
+    q.words = split_words(query);
+    if (q.words.empty() || limit == 0 || liveCount_ == 0) return heap;
+    heap.reserve(limit);
+    for (const auto& word : q.words) {
+        q.chars |= char_mask(word);
+        q.maxWords += max_word_score(word.size());
+    }
+    const std::string& last = q.words.back();
+    q.lastInName = last.find('/') == std::string::npos;
+
+    // Narrow with the word piece whose segments cover the fewest paths
+    std::vector<uint32_t> driving;
+    size_t drivingCost = SIZE_MAX;
+    bool drivingIsLastWord = false;
+    for (size_t w = 0; w < q.words.size(); ++w) {
+        std::string_view word = q.words[w];
+        size_t start = 0;
+        while (start < word.size()) {
+            size_t end = std::min(word.find('/', start), word.size());
+            std::string_view piece = word.substr(start, end - start);
+            start = end + 1;
+            if (piece.size() < 3) continue;
+            bool broad = false;
+            auto segs = segments_with(piece, broad);
+            if (broad) continue;
+            bool isLast = w + 1 == q.words.size() && piece.size() == word.size();
+            size_t cost = 0;
+            bool inName = false;
+            for (uint32_t sid : segs) {
+                cost += nameOf_[sid].size() + dirOf_[sid].size();
+                inName = inName || !nameOf_[sid].empty();
+            }
+            // No file name contains the last word, so nothing earns the bonus
+            if (isLast && !inName) q.lastInName = false;
+            if (cost < drivingCost) {
+                driving = std::move(segs);
+                drivingCost = cost;
+                drivingIsLastWord = isLast;
+            }
+        }
+    }
+    q.good = (q.lastInName ? NAME_BONUS : 0) + q.maxWords * 3 / 4;
+
+    if (drivingCost <= BROAD_COST) {
+        std::vector<bool> seen(info_.size(), false);
+        auto visit = [&](const std::vector<PathId>& ids) {
+            for (PathId id : ids) {
+                if (seen[id]) continue;
+                seen[id] = true;
+                offer_path(id, q, limit, heap);
+            }
+        };
+        for (uint32_t sid : driving) visit(nameOf_[sid]);
+        // When the driving piece is the whole last word, every path that
+        // can earn NAME_BONUS was just visited; paths matching only through
+        // a directory can't beat a full set of those.
+        bool settled = drivingIsLastWord && heap.size() == limit &&
+                       heap.front().score >= NAME_BONUS;
+        if (!settled) {
+            for (uint32_t sid : driving) visit(dirOf_[sid]);
+        }
+    }
+
+    // Broad or short words, and abbreviations ("sbsys") that share no
+    // trigram with the path
+    if (drivingCost > BROAD_COST || heap.empty()) {
+        scan_shortest_first(q, limit, heap);
+    }
+
+    std::sort_heap(heap.begin(), heap.end(),
+                   [this](const Match& a, const Match& b) { return better(a, b); });
+    return heap;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Fuzzy "go to file" matching over every path in a repository.  Paths
+// are split into '/' segments and each distinct segment is indexed once
+// by its (case-folded) trigrams, with per-segment lists of the paths that
+// use it as a file name or as a directory.  A query word of three or more
+// characters therefore narrows 1M paths to the few that contain a
+// matching segment before anything is scored, and a word found in a file
+// name ranks above one found only in a directory, so those candidates are
+// usually enough on their own.
+//
+// Broad queries -- a word found in most of the repository ("src", "file"),
+// words too short to index, abbreviations with no shared trigram -- walk
+// the paths shortest first instead and stop once `limit` good hits are in.
+// Every candidate is checked against the query's character mask and an
+// upper bound on its score before it is scored in full, so a path that
+// lacks one of the query's characters, or can't beat what the heap
+// already holds, costs a few instructions.
+//
+// Paths can be added and removed one at a time (status deltas); a removed
+// path keeps its id and postings and is revived if it comes back.
+class FileFinder {
+   public:
+    using PathId = uint32_t;
+    static constexpr PathId NONE = UINT32_MAX;
+
+    struct Match {
+        PathId id = NONE;
+        int score = 0;
+    };
+
+    FileFinder() = default;
+
+    void clear();
+
+    // Add a path (no-op if already present) and return its id.
+    PathId add(std::string_view path);
+    // False if the path isn't present.
+    bool remove(std::string_view path);
+    bool contains(std::string_view path) const;
+
+    size_t size() const { return liveCount_; }
+    std::string_view path(PathId id) const { return paths_.get(id); }
+
+    // Merge paths added since the last call into the shortest-first order
+    // broad searches walk.  add() does this itself once enough pile up;
+    // call it after a bulk load.
+    void reorder();
+
+    // Up to `limit` paths matching `query`, best first.  Each
+    // space-separated word must occur in the path as a case-insensitive
+    // subsequence; see score().  Exact for selective queries; broad ones
+    // return the shortest paths among the good hits (see the class
+    // comment).  Setting `cancel` abandons a long scan; the result is
+    // then incomplete.  Safe to call from several threads at once, but
+    // not alongside add() / remove().
+    std::vector<Match> search(std::string_view query, size_t limit,
+                              const std::atomic<bool>* cancel = nullptr) const;
+
+    // Score of `path` for `query`, or -1 if some word doesn't match.
+    // Matched characters score more in runs and when a run begins at a
+    // word start; a path whose file name contains the last word outright
+    // gets NAME_BONUS, which outweighs everything else.  A word scores at
+    // most max_word_score() of its length.
+    static int score(std::string_view path, std::string_view query);
+
+    static constexpr int NAME_BONUS = 1 << 20;
+    static constexpr int max_word_score(size_t len) {
+        return 28 * static_cast<int>(len) - 2;
+    }
+
+    // Queries whose narrowest word piece reaches more paths than this are
+    // searched shortest-first rather than through the trigram postings.
+    static constexpr size_t BROAD_COST = 16384;
+   private:
+    // Strings in one arena, deduplicated through an open-addressing table.
+    class Interner {
+       public:
+        uint32_t find(std::string_view s) const;
+        uint32_t intern(std::string_view s, bool& added);
+        std::string_view get(uint32_t id) const {
+            return std::string_view(arena_).substr(
+                offsets_[id], offsets_[id + 1] - offsets_[id]);
+        }
+        size_t size() const { return offsets_.size() - 1; }
+        uint32_t offset(uint32_t id) const { return offsets_[id]; }
+        void clear();
+
+       private:
+        void grow();
+        std::string arena_;
+        std::vector<uint32_t> offsets_ = {0};
+        std::vector<uint32_t> slots_;  // Ids, UINT32_MAX when empty
+    };
+
+    struct PathInfo {
+        uint32_t nameStart = 0;  // Offset of the file name within the path
+        uint32_t nameSeg = 0;    // Segment id of the file name
+        bool live = false;
+    };
+
+    // A path in the shortest-first order.  Carries what the scan filters
+    // on, so a rejected path costs a sequential read.
+    struct Ordered {
+        uint64_t chars = 0;  // Mask of the (folded) characters in the path
+        uint32_t length = 0;
+        PathId id = NONE;
+
+        bool operator<(const Ordered& o) const {
+            return length != o.length ? length < o.length : id < o.id;
+        }
+    };
+
+    struct Query;
+
+    // Segments containing every trigram of `piece` (lowercase).  Gives up,
+    // setting `broad`, when every trigram is in more than BROAD_COST
+    // segments, since the candidates would cover most paths anyway.
+    std::vector<uint32_t> segments_with(std::string_view piece, bool& broad) const;
+    std::string_view folded_segment(uint32_t sid) const {
+        return std::string_view(foldedSegments_)
+            .substr(segments_.offset(sid), segments_.get(sid).size());
+    }
+    int score_path(PathId id, const Query& q) const;
+    void offer_path(PathId id, const Query& q, size_t limit,
+                    std::vector<Match>& heap) const;
+    void offer_ordered(const Ordered& o, const Query& q, size_t limit,
+                       std::vector<Match>& heap) const;
+    void scan_shortest_first(const Query& q, size_t limit,
+                             std::vector<Match>& heap) const;
+    bool better(const Match& a, const Match& b) const;
+    void offer(std::vector<Match>& heap, size_t limit, Match m) const;
+
+    Interner paths_;
+    std::vector<PathInfo> info_;
+    size_t liveCount_ = 0;
+    // Paths by (length, id); the last ones, from orderedCount_ on, were
+    // added since the last reorder() and aren't sorted yet.
+    std::vector<Ordered> order_;
+    size_t orderedCount_ = 0;
+
+    Interner segments_;
+    std::string foldedSegments_;  // Lowercase copy, same offsets as segments_
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigramSegments_;
+    std::vector<std::vector<PathId>> nameOf_;  // Segment -> paths named it
+    std::vector<std::vector<PathId>> dirOf_;   // Segment -> paths under it
+};
@@ -0,0 +1,241 @@
+#include "file_tree.h"
+
+#include <algorithm>
+
+namespace {
+
+// Split "a/b/c" into segments, skipping empty ones.
+template <typename F>
+void for_each_segment(std::string_view path, F&& fn) {
+    size_t start = 0;
+    while (start <= path.size()) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) end = path.size();
+        if (end > start) fn(path.substr(start, end - start), end == path.size());
+        start = end + 1;
+    }
+}
+
+}  // namespace
+
+FileTree::FileTree() { clear(); }
+
+void FileTree::clear() {
+    ++version_;
+    nodes_.clear();
+    freeList_.clear();
+    segments_.clear();
+    segmentIds_.clear();
+    childIndex_.clear();
+
+    Node root;
+    root.segment = intern("");
+    root.isDir = true;
+    root.expanded = true;
+    root.live = true;
+    nodes_.push_back(std::move(root));
+}
+
+uint32_t FileTree::intern(std::string_view segment) {
+    auto it = segmentIds_.find(segment);
+    if (it != segmentIds_.end()) return it->second;
+    auto id = static_cast<uint32_t>(segments_.size());
+    segments_.emplace_back(segment);
+    segmentIds_.emplace(segments_.back(), id);
+    return id;
+}
+
+FileTree::NodeId FileTree::child(NodeId parent, uint32_t segment) const {
+    auto it = childIndex_.find(child_key(parent, segment));
+    return it == childIndex_.end() ? NONE : it->second;
+}
+
+bool FileTree::child_less(NodeId a, NodeId b) const {
+    const Node& na = nodes_[a];
+    const Node& nb = nodes_[b];
+    if (na.isDir != nb.isDir) return na.isDir;
+    return segments_[na.segment] < segments_[nb.segment];
+}
+
+FileTree::NodeId FileTree::add_child(NodeId parent, uint32_t segment,
+                                     bool isDir, bool sorted) {
+    ++version_;
+    NodeId id;
+    if (!freeList_.empty()) {
+        id = freeList_.back();
+        freeList_.pop_back();
+    } else {
+        id = static_cast<NodeId>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& n = nodes_[id];
+    n = Node{};
+    n.segment = segment;
+    n.parent = parent;
+    n.depth = parent == ROOT ? 0 : nodes_[parent].depth + 1;
+    n.isDir = isDir;
+    n.live = true;
+    childIndex_.emplace(child_key(parent, segment), id);
+
+    auto& kids = nodes_[parent].children;
+    if (sorted) {
+        auto pos = std::lower_bound(
+            kids.begin(), kids.end(), id,
+            [this](NodeId a, NodeId b) { return child_less(a, b); });
+        kids.insert(pos, id);
+    } else {
+        kids.push_back(id);
+    }
+    return id;
+}
+
+void FileTree::sort_children(NodeId dir) {
+    auto& kids = nodes_[dir].children;
+    std::sort(kids.begin(), kids.end(),
+              [this](NodeId a, NodeId b) { return child_less(a, b); });
+}
+
+void FileTree::adjust(NodeId id, int files, int additions, int deletions) {
+    for (NodeId cur = id; cur != NONE; cur = nodes_[cur].parent) {
+        Node& n = nodes_[cur];
+        n.fileCount = static_cast<uint32_t>(static_cast<int>(n.fileCount) + files);
+        n.additions += additions;
+        n.deletions += deletions;
+    }
+}
+
+void FileTree::free_node(NodeId id) {
+    ++version_;
+    Node& n = nodes_[id];
+    childIndex_.erase(child_key(n.parent, n.segment));
+    n = Node{};
+    freeList_.push_back(id);
+}
+
+void FileTree::build(
+    const std::vector<std::pair<std::string_view, Leaf>>& entries) {
+    std::vector<std::string> expanded;
+    for (NodeId id = 1; id < nodes_.size(); ++id) {
+        if (nodes_[id].live && nodes_[id].isDir && nodes_[id].expanded) {
+            expanded.push_back(path(id));
+        }
+    }
+
+    clear();
+    for (const auto& [entryPath, leaf] : entries) {
+        NodeId cur = ROOT;
+        for_each_segment(entryPath, [&](std::string_view seg, bool last) {
+            if (cur == NONE) return;
+            uint32_t s = intern(seg);
+            NodeId next = child(cur, s);
+            if (next == NONE) {
+                next = add_child(cur, s, !last, /*sorted=*/false);
+            } else if (nodes_[next].isDir == last) {
+                next = NONE;  // File/directory clash; skip the entry
+            } else if (last) {
+                // Duplicate path: keep the last entry
+                const Leaf& old = nodes_[next].leaf;
+                adjust(next, -1, -old.additions, -old.deletions);
+            }
+            if (next != NONE && last) {
+                nodes_[next].leaf = leaf;
+                adjust(next, 1, leaf.additions, leaf.deletions);
+            }
+            cur = next;
+        });
+    }
+    for (NodeId id = 0; id < nodes_.size(); ++id) {
+        if (nodes_[id].isDir) sort_children(id);
+    }
+
+    for (const auto& p : expanded) set_expanded(find(p), true);
+}
+
+void FileTree::upsert(std::string_view path, const Leaf& leaf) {
+    NodeId cur = ROOT;
+    for_each_segment(path, [&](std::string_view seg, bool last) {
+        if (cur == NONE) return;
+        uint32_t s = intern(seg);
+        NodeId next = child(cur, s);
+        if (next == NONE) {
+            next = add_child(cur, s, !last, /*sorted=*/true);
+            if (last) {
+                nodes_[next].leaf = leaf;
+                adjust(next, 1, leaf.additions, leaf.deletions);
+            }
+        } else if (nodes_[next].isDir == last) {
+            next = NONE;  // File/directory clash
+        } else if (last) {
+            const Leaf old = nodes_[next].leaf;
+            nodes_[next].leaf = leaf;
+            adjust(next, 0, leaf.additions - old.additions,
+                   leaf.deletions - old.deletions);
+        }
+        cur = next;
+    });
+}
+
+bool FileTree::remove(std::string_view path) {
+    NodeId id = find(path);
+    if (id == NONE || nodes_[id].isDir) return false;
+    const Leaf& leaf = nodes_[id].leaf;
+    adjust(id, -1, -leaf.additions, -leaf.deletions);
+
+    // Detach and free the file, then any directories it leaves empty
+    while (id != ROOT) {
+        NodeId parent = nodes_[id].parent;
+        auto& kids = nodes_[parent].children;
+        auto pos = std::lower_bound(
+            kids.begin(), kids.end(), id,
+            [this](NodeId a, NodeId b) { return child_less(a, b); });
+        if (pos != kids.end() && *pos == id) {
+            kids.erase(pos);
+        } else {
+            kids.erase(std::remove(kids.begin(), kids.end(), id), kids.end());
+        }
+        free_node(id);
+        if (parent == ROOT || nodes_[parent].fileCount > 0) break;
+        id = parent;
+    }
+    return true;
+}
+
+FileTree::NodeId FileTree::find(std::string_view path) const {
+    NodeId cur = ROOT;
+    bool any = false;
+    for_each_segment(path, [&](std::string_view seg, bool) {
+        any = true;
+        if (cur == NONE) return;
+        auto it = segmentIds_.find(seg);
+        cur = it == segmentIds_.end() ? NONE : child(cur, it->second);
+    });
+    return any ? cur : NONE;
+}
+
+std::string FileTree::path(NodeId id) const {
+    std::vector<NodeId> chain;
+    for (NodeId cur = id; cur != ROOT && cur != NONE; cur = nodes_[cur].parent) {
+        chain.push_back(cur);
+    }
+    std::string out;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (!out.empty()) out += '/';
+        out += segments_[nodes_[*it].segment];
+    }
+    return out;
+}
+
+void FileTree::set_expanded(NodeId id, bool expanded) {
+    if (id == NONE || id == ROOT || !nodes_[id].isDir) return;
+    ++version_;
+    nodes_[id].expanded = expanded;
+}
+
+void FileTree::reveal(NodeId id) {
+    if (id == NONE) return;
+    ++version_;
+    for (NodeId cur = nodes_[id].parent; cur != ROOT && cur != NONE;
+         cur = nodes_[cur].parent) {
+        nodes_[cur].expanded = true;
+    }
+}
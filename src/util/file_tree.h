@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Directory tree over a set of changed files, for the sidebar's Tree view.
+// Path segments are interned, so each directory or file name is stored
+// once however many paths share it, and every directory keeps the file
+// count and line counts of everything below it.  The tree is edited in
+// place (upsert/remove) as status deltas arrive; expansion state lives on
+// the nodes and survives those edits.  Directories start collapsed, and
+// for_each_visible() only descends into expanded ones.
+class FileTree {
+   public:
+    using NodeId = uint32_t;
+    static constexpr NodeId ROOT = 0;
+    static constexpr NodeId NONE = UINT32_MAX;
+
+    struct Leaf {
+        char status = ' ';
+        int additions = 0;
+        int deletions = 0;
+    };
+
+    struct Node {
+        uint32_t segment = 0;  // Name, as an index into the segment table
+        NodeId parent = NONE;
+        uint32_t depth = 0;    // 0 for top-level entries
+        bool isDir = false;
+        bool expanded = false;
+        bool live = false;     // False once freed
+        Leaf leaf;             // Files only
+        uint32_t fileCount = 0;  // Files at or below this node
+        int additions = 0;       // Summed over those files
+        int deletions = 0;
+        std::vector<NodeId> children;  // Directories first, then by name
+    };
+
+    FileTree();
+
+    void clear();
+
+    // Replace the contents with `entries` (repo-relative path, leaf).
+    // Directories that were expanded and still exist stay expanded.
+    void build(const std::vector<std::pair<std::string_view, Leaf>>& entries);
+
+    // Insert or update one file, creating its directories.
+    void upsert(std::string_view path, const Leaf& leaf);
+    // Remove one file and any directories left empty.  False if absent.
+    bool remove(std::string_view path);
+
+    NodeId find(std::string_view path) const;
+    const Node& node(NodeId id) const { return nodes_[id]; }
+    const std::string& name(NodeId id) const {
+        return segments_[nodes_[id].segment];
+    }
+    std::string path(NodeId id) const;
+
+    size_t file_count() const { return nodes_[ROOT].fileCount; }
+    size_t node_count() const { return nodes_.size() - freeList_.size(); }
+    size_t segment_count() const { return segments_.size(); }
+
+    // Changes whenever the set or order of visible nodes may have, so a
+    // caller can keep a flattened copy of them.
+    uint64_t version() const { return version_; }
+
+    void set_expanded(NodeId id, bool expanded);
+    // Expand every directory above `id` so it becomes visible.
+    void reveal(NodeId id);
+
+    // Visit nodes in display order as fn(id, node), descending only into
+    // expanded directories.  The root itself isn't visited.  Stops after
+    // `limit` nodes and returns how many entries of the open directories
+    // were left unvisited (their expanded contents aren't counted).
+    template <typename F>
+    size_t for_each_visible(F&& fn, size_t limit = SIZE_MAX) const {
+        size_t visited = 0, skipped = 0;
+        std::vector<std::pair<NodeId, size_t>> stack;  // (dir, next child)
+        stack.emplace_back(ROOT, 0);
+        while (!stack.empty()) {
+            auto& [dir, next] = stack.back();
+            const auto& kids = nodes_[dir].children;
+            if (next >= kids.size()) {
+                stack.pop_back();
+                continue;
+            }
+            if (visited >= limit) {
+                skipped += kids.size() - next;
+                stack.pop_back();
+                continue;
+            }
+            NodeId id = kids[next++];
+            const Node& n = nodes_[id];
+            fn(id, n);
+            ++visited;
+            if (n.isDir && n.expanded) stack.emplace_back(id, 0);
+        }
+        return skipped;
+    }
+
+   private:
+    uint32_t intern(std::string_view segment);
+    NodeId child(NodeId parent, uint32_t segment) const;
+    NodeId add_child(NodeId parent, uint32_t segment, bool isDir, bool sorted);
+    bool child_less(NodeId a, NodeId b) const;
+    void sort_children(NodeId dir);
+    // Add to the counts of `id` and all its ancestors.
+    void adjust(NodeId id, int files, int additions, int deletions);
+    void free_node(NodeId id);
+
+    static uint64_t child_key(NodeId parent, uint32_t segment) {
+        return (static_cast<uint64_t>(parent) << 32) | segment;
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<NodeId> freeList_;
+    std::deque<std::string> segments_;  // Stable addresses for the views below
+    std::unordered_map<std::string_view, uint32_t> segmentIds_;
+    std::unordered_map<uint64_t, NodeId> childIndex_;
+    uint64_t version_ = 0;
+};
@@ -0,0 +1,155 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+constexpr uint32_t FRAME_EVENT = UINT32_MAX;
+
+// Nearest-rank percentile of an already-sorted sample set.
+double percentile(const std::vector<float>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    auto rank = static_cast<size_t>(
+        std::ceil(p * static_cast<double>(sorted.size())));
+    rank = std::clamp<size_t>(rank, 1, sorted.size());
+    return sorted[rank - 1];
+}
+
+void write_json_string(std::ostream& out, const std::string& s) {
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+}  // namespace
+
+size_t FrameProfiler::add_section(std::string name,
+                                  std::function<size_t()> countEntities) {
+    Section section;
+    section.name = std::move(name);
+    section.countEntities = std::move(countEntities);
+    section.samplesMs.assign(WINDOW, 0.0f);
+    section.samplesAllocs.assign(WINDOW, 0);
+    sections_.push_back(std::move(section));
+    return sections_.size() - 1;
+}
+
+void FrameProfiler::begin_frame(clock::time_point now) {
+    for (auto& s : sections_) {
+        s.samplesMs[cursor_] = 0.0f;
+        s.samplesAllocs[cursor_] = 0;
+    }
+    inFrame_ = true;
+    haveOpen_ = false;
+    frameStart_ = now;
+}
+
+void FrameProfiler::close_open_section(clock::time_point now, uint64_t allocs) {
+    if (!haveOpen_) return;
+    haveOpen_ = false;
+
+    auto& s = sections_[openSection_];
+    s.samplesMs[cursor_] += static_cast<float>(
+        std::chrono::duration<double, std::milli>(now - openStart_).count());
+    s.samplesAllocs[cursor_] += static_cast<uint32_t>(allocs - openAllocs_);
+
+    if (tracing_) record_trace(static_cast<uint32_t>(openSection_), openStart_, now);
+}
+
+void FrameProfiler::mark(size_t section, clock::time_point now, uint64_t allocs) {
+    if (!inFrame_ || section >= sections_.size()) return;
+    close_open_section(now, allocs);
+    haveOpen_ = true;
+    openSection_ = section;
+    openStart_ = now;
+    openAllocs_ = allocs;
+}
+
+void FrameProfiler::end_frame(clock::time_point now, uint64_t allocs) {
+    if (!inFrame_) return;
+    close_open_section(now, allocs);
+    if (tracing_) record_trace(FRAME_EVENT, frameStart_, now);
+    inFrame_ = false;
+    cursor_ = (cursor_ + 1) % WINDOW;
+    ++frames_;
+}
+
+void FrameProfiler::record_trace(uint32_t section, clock::time_point start,
+                                 clock::time_point end) {
+    if (trace_.size() >= MAX_TRACE_EVENTS) return;
+    using us = std::chrono::microseconds;
+    trace_.push_back(TraceEvent{
+        section,
+        std::chrono::duration_cast<us>(start - traceEpoch_).count(),
+        std::chrono::duration_cast<us>(end - start).count()});
+}
+
+std::vector<FrameProfiler::SectionStats> FrameProfiler::summarize(
+    bool countEntities) const {
+    size_t n = static_cast<size_t>(std::min<uint64_t>(frames_, WINDOW));
+    size_t last = (cursor_ + WINDOW - 1) % WINDOW;
+
+    std::vector<SectionStats> out;
+    out.reserve(sections_.size());
+    std::vector<float> sorted;
+    for (const auto& s : sections_) {
+        SectionStats stats;
+        stats.name = s.name;
+        if (n > 0) {
+            // Before the ring fills, valid slots are [0, n)
+            sorted.assign(s.samplesMs.begin(),
+                          s.samplesMs.begin() + static_cast<std::ptrdiff_t>(n));
+            std::sort(sorted.begin(), sorted.end());
+            stats.lastMs = s.samplesMs[last];
+            stats.p50Ms = percentile(sorted, 0.50);
+            stats.p99Ms = percentile(sorted, 0.99);
+
+            uint64_t allocs = 0;
+            for (size_t i = 0; i < n; ++i) allocs += s.samplesAllocs[i];
+            stats.meanAllocs =
+                static_cast<double>(allocs) / static_cast<double>(n);
+        }
+        if (countEntities && s.countEntities) {
+            stats.entities = static_cast<long>(s.countEntities());
+        }
+        out.push_back(std::move(stats));
+    }
+    return out;
+}
+
+void FrameProfiler::start_trace() {
+    trace_.clear();
+    traceEpoch_ = clock::now();
+    tracing_ = true;
+}
+
+bool FrameProfiler::write_chrome_trace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& e : trace_) {
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"name\":";
+        write_json_string(out, e.section == FRAME_EVENT
+                                   ? std::string("frame")
+                                   : sections_[e.section].name);
+        out << ",\"cat\":\"" << (e.section == FRAME_EVENT ? "frame" : "system")
+            << "\",\"ph\":\"X\",\"ts\":" << e.startUs << ",\"dur\":" << e.durUs
+            << ",\"pid\":1,\"tid\":1}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
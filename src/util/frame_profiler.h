@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Per-section frame profiler.  The frame is split into named sections by
+// calling mark() at each boundary (in main.cpp: one mark per ECS system);
+// a section runs from its mark to the next mark or end_frame().  Keeps a
+// rolling window of samples per section for p50/p99, and can record every
+// section as a Chrome trace event (chrome://tracing, Perfetto).
+class FrameProfiler {
+   public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr size_t WINDOW = 240;               // Frames of history
+    static constexpr size_t MAX_TRACE_EVENTS = 1u << 20;  // ~40 MB cap
+
+    struct SectionStats {
+        std::string name;
+        double lastMs = 0.0;
+        double p50Ms = 0.0;
+        double p99Ms = 0.0;
+        double meanAllocs = 0.0;  // Allocations per frame over the window
+        long entities = -1;       // Matching entities, -1 if not counted
+    };
+
+    // Register a section; returns the index to pass to mark().
+    // `countEntities` (optional) reports how many entities the section
+    // iterates; it is only called from summarize().
+    size_t add_section(std::string name,
+                       std::function<size_t()> countEntities = {});
+
+    // Sections are only timed while enabled (overlay open or tracing).
+    void set_enabled(bool enabled) { enabled_ = enabled; }
+    bool enabled() const { return enabled_ || tracing_; }
+
+    void begin_frame(clock::time_point now);
+    void mark(size_t section, clock::time_point now, uint64_t allocs);
+    void end_frame(clock::time_point now, uint64_t allocs);
+
+    size_t section_count() const { return sections_.size(); }
+    const std::string& section_name(size_t i) const { return sections_[i].name; }
+    uint64_t frames() const { return frames_; }
+
+    // Stats for every section, in registration order.
+    std::vector<SectionStats> summarize(bool countEntities = false) const;
+
+    // Chrome trace recording.  Events accumulate until written or stopped.
+    void start_trace();
+    void stop_trace() { tracing_ = false; }
+    bool tracing() const { return tracing_; }
+    size_t trace_event_count() const { return trace_.size(); }
+    // Write recorded events as Chrome trace JSON.  Returns false on I/O error.
+    bool write_chrome_trace(const std::string& path) const;
+
+   private:
+    struct Section {
+        std::string name;
+        std::function<size_t()> countEntities;
+        std::vector<float> samplesMs;       // Ring buffer, WINDOW entries
+        std::vector<uint32_t> samplesAllocs;
+    };
+
+    struct TraceEvent {
+        uint32_t section;
+        int64_t startUs;
+        int64_t durUs;
+    };
+
+    void close_open_section(clock::time_point now, uint64_t allocs);
+    void record_trace(uint32_t section, clock::time_point start,
+                      clock::time_point end);
+
+    std::vector<Section> sections_;
+    size_t cursor_ = 0;       // Ring slot for the current frame
+    uint64_t frames_ = 0;
+    bool inFrame_ = false;
+    clock::time_point frameStart_{};
+
+    // Section currently running (if any) and where it started
+    bool haveOpen_ = false;
+    size_t openSection_ = 0;
+    clock::time_point openStart_{};
+    uint64_t openAllocs_ = 0;
+
+    bool enabled_ = false;
+    bool tracing_ = false;
+    clock::time_point traceEpoch_{};
+    std::vector<TraceEvent> trace_;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// Cross-thread "something happened, draw soon" signal.  Background workers
+// and watcher threads notify(); the frame loop blocks in wait_for() while
+// idle and returns as soon as it is notified.
+class WakeSignal {
+   public:
+    void notify() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+        cv_.notify_one();
+    }
+
+    // Block until notified or `timeout` elapses.  Returns true if woken by
+    // notify() (including one that arrived before the call).
+    template <typename Rep, typename Period>
+    bool wait_for(std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        bool woken = cv_.wait_for(lock, timeout, [this] { return pending_; });
+        pending_ = false;
+        return woken;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_ = false;
+};
+
+// Leaked: background workers may notify after main() returns.
+inline WakeSignal& frame_wake() {
+    static auto* signal = new WakeSignal();
+    return *signal;
+}
+
+// Invalidation-driven frame pacing.  Anything that changes what is on
+// screen -- input, finished background work, a running animation -- keeps
+// the scheduler active and frames run at full rate.  Once nothing has
+// happened for ACTIVE_HOLD, frames drop to one per IDLE_INTERVAL and the
+// loop sleeps in between (see idle_wait()).
+class FrameScheduler {
+   public:
+    using clock = std::chrono::steady_clock;
+
+    // Full-rate grace period after the last invalidation, so hover states
+    // and layout settle without stutter.
+    static constexpr auto ACTIVE_HOLD = std::chrono::milliseconds(500);
+    // Frame spacing while idle.  Bounds the latency of the first input
+    // after an idle period, since input is only seen when a frame runs.
+    static constexpr auto IDLE_INTERVAL = std::chrono::milliseconds(100);
+
+    struct Stats {
+        uint64_t activeFrames = 0;
+        uint64_t idleFrames = 0;
+    };
+
+    // Something visible changed at `now`.
+    void invalidate(clock::time_point now) { animate_until(now + ACTIVE_HOLD); }
+
+    // Keep rendering at full rate until `until` (toasts, spinners).
+    void animate_until(clock::time_point until) {
+        activeUntil_ = std::max(activeUntil_, until);
+    }
+
+    bool is_active(clock::time_point now) const { return now < activeUntil_; }
+
+    // How long the frame loop may block before running the next frame.
+    clock::duration idle_wait(clock::time_point now) const {
+        if (is_active(now)) return clock::duration::zero();
+        auto due = lastFrame_ + IDLE_INTERVAL;
+        return due > now ? due - now : clock::duration::zero();
+    }
+
+    void frame_done(clock::time_point now) {
+        if (is_active(now)) {
+            ++stats_.activeFrames;
+        } else {
+            ++stats_.idleFrames;
+        }
+        lastFrame_ = now;
+    }
+
+    const Stats& stats() const { return stats_; }
+
+   private:
+    clock::time_point activeUntil_{};
+    clock::time_point lastFrame_{};
+    Stats stats_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+// Rolling UI-thread frame-time statistics.  record() is called once per
+// frame with the time spent running systems, so background work that
+// leaks onto the UI thread shows up as over-budget frames.
+struct FrameTimeStats {
+    double budgetMs = 1000.0 / 60.0;
+
+    uint64_t frames = 0;
+    uint64_t overBudget = 0;
+    double lastMs = 0.0;
+    double worstMs = 0.0;
+    double totalMs = 0.0;
+
+    void record(double ms) {
+        ++frames;
+        lastMs = ms;
+        worstMs = std::max(worstMs, ms);
+        totalMs += ms;
+        if (ms > budgetMs) ++overBudget;
+    }
+
+    double mean_ms() const {
+        return frames ? totalMs / static_cast<double>(frames) : 0.0;
+    }
+};
+
+// Milliseconds elapsed since `start` on the steady clock.
+inline double ms_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
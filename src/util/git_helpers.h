@@ -2,27 +2,43 @@
 
 #include <ctime>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace git_helpers {
 
 // Parse ISO 8601 date string (e.g. "2026-02-17T14:30:00+05:00") to time_t (UTC).
-inline std::time_t parse_iso8601(const std::string& dateStr) {
+// Returns 0 for anything that isn't a full date-time.
+inline std::time_t parse_iso8601(std::string_view dateStr) {
     if (dateStr.size() < 19) return 0;
+    auto num = [&](size_t pos, size_t len, int& out) -> bool {
+        out = 0;
+        for (size_t k = pos; k < pos + len; ++k) {
+            char c = dateStr[k];
+            if (c < '0' || c > '9') return false;
+            out = out * 10 + (c - '0');
+        }
+        return true;
+    };
+    int year, mon, mday, hour, min, sec;
+    if (!num(0, 4, year) || !num(5, 2, mon) || !num(8, 2, mday) ||
+        !num(11, 2, hour) || !num(14, 2, min) || !num(17, 2, sec)) {
+        return 0;
+    }
     std::tm tm{};
-    tm.tm_year = std::stoi(dateStr.substr(0, 4)) - 1900;
-    tm.tm_mon  = std::stoi(dateStr.substr(5, 2)) - 1;
-    tm.tm_mday = std::stoi(dateStr.substr(8, 2));
-    tm.tm_hour = std::stoi(dateStr.substr(11, 2));
-    tm.tm_min  = std::stoi(dateStr.substr(14, 2));
-    tm.tm_sec  = std::stoi(dateStr.substr(17, 2));
+    tm.tm_year = year - 1900;
+    tm.tm_mon  = mon - 1;
+    tm.tm_mday = mday;
+    tm.tm_hour = hour;
+    tm.tm_min  = min;
+    tm.tm_sec  = sec;
     tm.tm_isdst = -1;
     std::time_t t = timegm(&tm);
-    if (dateStr.size() > 19) {
+    if (dateStr.size() >= 22) {
         char sign = dateStr[19];
-        if (sign == '+' || sign == '-') {
-            int tzH = std::stoi(dateStr.substr(20, 2));
-            int tzM = (dateStr.size() >= 25) ? std::stoi(dateStr.substr(23, 2)) : 0;
+        int tzH = 0, tzM = 0;
+        if ((sign == '+' || sign == '-') && num(20, 2, tzH)) {
+            if (dateStr.size() >= 25) num(23, 2, tzM);
             int offset = tzH * 3600 + tzM * 60;
             t += (sign == '+') ? -offset : offset;
         }
@@ -30,23 +46,48 @@ inline std::time_t parse_iso8601(const std::string& dateStr) {
     return t;
 }
 
-// Human-readable relative time from ISO 8601 date.
+// Human-readable relative time between two epoch timestamps.
 // When suffix is true, appends " ago" (e.g. "3d ago" vs "3d").
+// If validUntil is given it receives the first `now` at which the label
+// would read differently, so callers can cache the string until then.
+inline std::string relative_time(std::time_t commitTime, std::time_t now,
+                                 bool suffix = false,
+                                 std::time_t* validUntil = nullptr) {
+    struct Unit { long seconds; long limit; const char* name; };
+    static constexpr Unit units[] = {
+        {1, 60, "s"},
+        {60, 3600, "m"},
+        {3600, 86400, "h"},
+        {86400, 604800, "d"},
+        {604800, 2592000, "w"},
+        {2592000, 31536000, "mo"},
+        {31536000, 0, "y"},
+    };
+
+    long diff = static_cast<long>(std::difftime(now, commitTime));
+    if (diff < 0) {
+        if (validUntil) *validUntil = commitTime;
+        return "now";
+    }
+    for (const auto& u : units) {
+        if (u.limit != 0 && diff >= u.limit) continue;
+        long value = diff / u.seconds;
+        if (validUntil) {
+            long next = (value + 1) * u.seconds;
+            if (u.limit != 0 && next > u.limit) next = u.limit;
+            *validUntil = commitTime + next;
+        }
+        return std::to_string(value) + u.name + (suffix ? " ago" : "");
+    }
+    return "";
+}
+
+// Human-readable relative time from ISO 8601 date.
 inline std::string relative_time(const std::string& isoDate, bool suffix = false) {
     if (isoDate.empty()) return "";
     std::time_t commitTime = parse_iso8601(isoDate);
     if (commitTime == 0) return "";
-    std::time_t now = std::time(nullptr);
-    long diff = static_cast<long>(std::difftime(now, commitTime));
-    std::string s = suffix ? " ago" : "";
-    if (diff < 0) return "now";
-    if (diff < 60) return std::to_string(diff) + "s" + s;
-    if (diff < 3600) return std::to_string(diff / 60) + "m" + s;
-    if (diff < 86400) return std::to_string(diff / 3600) + "h" + s;
-    if (diff < 604800) return std::to_string(diff / 86400) + "d" + s;
-    if (diff < 2592000) return std::to_string(diff / 604800) + "w" + s;
-    if (diff < 31536000) return std::to_string(diff / 2592000) + "mo" + s;
-    return std::to_string(diff / 31536000) + "y" + s;
+    return relative_time(commitTime, std::time(nullptr), suffix);
 }
 
 enum class DecorationType { LocalBranch, Head, RemoteBranch, Tag };
@@ -90,4 +131,27 @@ inline std::vector<Decoration> parse_decorations(const std::string& decStr) {
     return result;
 }
 
+// Display priority when only one badge fits (e.g. the sidebar commit row).
+inline int decoration_rank(DecorationType t) {
+    switch (t) {
+        case DecorationType::Head:         return 4;
+        case DecorationType::LocalBranch:  return 3;
+        case DecorationType::Tag:          return 2;
+        case DecorationType::RemoteBranch: return 1;
+    }
+    return 0;
+}
+
+// Index of the highest-ranked decoration (first wins ties), or -1.
+inline int best_decoration_index(const std::vector<Decoration>& decorations) {
+    int best = -1;
+    for (size_t i = 0; i < decorations.size(); ++i) {
+        if (best < 0 || decoration_rank(decorations[i].type) >
+                            decoration_rank(decorations[static_cast<size_t>(best)].type)) {
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
+
 } // namespace git_helpers
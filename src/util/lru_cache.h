@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// Least-recently-used cache bounded by a byte budget rather than an entry
+// count.  Callers supply each entry's size when inserting; the oldest
+// entries are evicted until the total fits.  The most recent insert is
+// always kept, even if it alone exceeds the budget.
+template <typename Key, typename Value>
+class LruCache {
+   public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    explicit LruCache(size_t budgetBytes) : budget_(budgetBytes) {}
+
+    // Look up and mark as most recently used.  Counts a hit or a miss.
+    const Value* get(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return nullptr;
+        }
+        ++stats_.hits;
+        order_.splice(order_.begin(), order_, it->second);
+        return &it->second->value;
+    }
+
+    // Look up and mark as most recently used without counting.  For
+    // callers collecting an entry they just inserted themselves.
+    const Value* touch(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return nullptr;
+        order_.splice(order_.begin(), order_, it->second);
+        return &it->second->value;
+    }
+
+    // Presence check that neither bumps recency nor touches the counters.
+    bool contains(const Key& key) const { return index_.contains(key); }
+
+    void put(const Key& key, Value value, size_t bytes) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            bytes_ -= it->second->bytes;
+            order_.erase(it->second);
+            index_.erase(it);
+        }
+        order_.push_front(Entry{key, std::move(value), bytes});
+        index_.emplace(key, order_.begin());
+        bytes_ += bytes;
+        evict();
+    }
+
+    void erase(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return;
+        bytes_ -= it->second->bytes;
+        order_.erase(it->second);
+        index_.erase(it);
+    }
+
+    void clear() {
+        order_.clear();
+        index_.clear();
+        bytes_ = 0;
+    }
+
+    void set_budget(size_t budgetBytes) {
+        budget_ = budgetBytes;
+        evict();
+    }
+
+    size_t size() const { return index_.size(); }
+    size_t bytes() const { return bytes_; }
+    size_t budget() const { return budget_; }
+    const Stats& stats() const { return stats_; }
+
+   private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t bytes;
+    };
+
+    void evict() {
+        while (bytes_ > budget_ && order_.size() > 1) {
+            auto& victim = order_.back();
+            bytes_ -= victim.bytes;
+            index_.erase(victim.key);
+            order_.pop_back();
+            ++stats_.evictions;
+        }
+    }
+
+    size_t budget_;
+    size_t bytes_ = 0;
+    std::list<Entry> order_;  // Front = most recently used
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index_;
+    Stats stats_;
+};
@@ -1,10 +1,13 @@
 #include "process.h"
 
+#include <poll.h>
+#include <signal.h>
 #include <spawn.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <array>
+#include <cerrno>
 #include <cstring>
 
 extern char** environ;
@@ -21,22 +24,27 @@ std::string read_fd(int fd) {
     return result;
 }
 
-}  // namespace
-
-ProcessResult run_process(const std::string& working_dir,
-                          const std::vector<std::string>& args) {
-    ProcessResult result;
-
+struct SpawnedProcess {
+    pid_t pid = -1;
+    int stdout_fd = -1;
+    int stderr_fd = -1;
+};
+
+// Start `args` with stdout/stderr on pipes.  On failure returns false and
+// sets `error`.
+bool spawn_piped(const std::string& working_dir,
+                 const std::vector<std::string>& args, SpawnedProcess& proc,
+                 std::string& error) {
     if (args.empty()) {
-        result.stderr_str = "No command specified";
-        return result;
+        error = "No command specified";
+        return false;
     }
 
     int stdout_pipe[2];
     int stderr_pipe[2];
     if (pipe(stdout_pipe) != 0 || pipe(stderr_pipe) != 0) {
-        result.stderr_str = "Failed to create pipes";
-        return result;
+        error = "Failed to create pipes";
+        return false;
     }
 
     posix_spawn_file_actions_t actions;
@@ -62,6 +70,7 @@ ProcessResult run_process(const std::string& working_dir,
     pid_t pid;
     int spawn_err =
         posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
 
     close(stdout_pipe[1]);
     close(stderr_pipe[1]);
@@ -69,23 +78,78 @@ ProcessResult run_process(const std::string& working_dir,
     if (spawn_err != 0) {
         close(stdout_pipe[0]);
         close(stderr_pipe[0]);
-        posix_spawn_file_actions_destroy(&actions);
-        result.stderr_str =
-            std::string("posix_spawnp failed: ") + strerror(spawn_err);
-        return result;
+        error = std::string("posix_spawnp failed: ") + strerror(spawn_err);
+        return false;
     }
 
-    result.stdout_str = read_fd(stdout_pipe[0]);
-    result.stderr_str = read_fd(stderr_pipe[0]);
-
-    close(stdout_pipe[0]);
-    close(stderr_pipe[0]);
+    proc.pid = pid;
+    proc.stdout_fd = stdout_pipe[0];
+    proc.stderr_fd = stderr_pipe[0];
+    return true;
+}
 
+int wait_exit_code(pid_t pid) {
     int status;
     waitpid(pid, &status, 0);
-    result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
 
-    posix_spawn_file_actions_destroy(&actions);
+}  // namespace
+
+ProcessResult run_process(const std::string& working_dir,
+                          const std::vector<std::string>& args) {
+    ProcessResult result;
+    SpawnedProcess proc;
+    if (!spawn_piped(working_dir, args, proc, result.stderr_str)) return result;
+
+    result.stdout_str = read_fd(proc.stdout_fd);
+    result.stderr_str = read_fd(proc.stderr_fd);
+
+    close(proc.stdout_fd);
+    close(proc.stderr_fd);
+
+    result.exit_code = wait_exit_code(proc.pid);
+    return result;
+}
+
+ProcessResult run_process_streaming(
+    const std::string& working_dir, const std::vector<std::string>& args,
+    const std::function<bool(std::string_view)>& on_stdout,
+    const std::atomic<bool>* cancel, const std::atomic<bool>* alsoCancel) {
+    ProcessResult result;
+    SpawnedProcess proc;
+    if (!spawn_piped(working_dir, args, proc, result.stderr_str)) return result;
+
+    auto cancelled = [&]() {
+        return (cancel && cancel->load()) || (alsoCancel && alsoCancel->load());
+    };
+    std::array<char, 65536> buf;
+    bool stopped = false;
+    while (true) {
+        if (cancel || alsoCancel) {
+            // Wait in short slices so a quiet child can still be cancelled
+            pollfd pfd{proc.stdout_fd, POLLIN, 0};
+            int ready = poll(&pfd, 1, CANCEL_POLL_MS);
+            if (cancelled()) {
+                stopped = true;
+                break;
+            }
+            if (ready == 0 || (ready < 0 && errno == EINTR)) continue;
+        }
+        ssize_t n = read(proc.stdout_fd, buf.data(), buf.size());
+        if (n <= 0) break;
+        if (!on_stdout(std::string_view(buf.data(), static_cast<size_t>(n)))) {
+            stopped = true;
+            break;
+        }
+    }
+    if (stopped) kill(proc.pid, SIGTERM);
+    close(proc.stdout_fd);
+
+    result.stderr_str = read_fd(proc.stderr_fd);
+    close(proc.stderr_fd);
+
+    result.exit_code = wait_exit_code(proc.pid);
     return result;
 }
 
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <future>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct ProcessResult {
@@ -16,6 +18,20 @@ struct ProcessResult {
 ProcessResult run_process(const std::string& working_dir,
                           const std::vector<std::string>& args);
 
+// Streaming -- stdout is handed to `on_stdout` in chunks as it arrives
+// instead of being buffered, for listings too large to hold twice.
+// Returning false stops reading and terminates the child (its exit code
+// is then not 0).  stderr is still collected.  Setting `cancel` or
+// `alsoCancel` does the same from another thread, even while the child
+// prints nothing (both are checked every CANCEL_POLL_MS).
+ProcessResult run_process_streaming(
+    const std::string& working_dir, const std::vector<std::string>& args,
+    const std::function<bool(std::string_view)>& on_stdout,
+    const std::atomic<bool>* cancel = nullptr,
+    const std::atomic<bool>* alsoCancel = nullptr);
+
+inline constexpr int CANCEL_POLL_MS = 50;
+
 // Asynchronous -- for slow git operations (push, pull, fetch)
 std::future<ProcessResult> run_process_async(
     const std::string& working_dir, const std::vector<std::string>& args,
@@ -0,0 +1,190 @@
+#include "repo_file_index.h"
+
+#include <algorithm>
+
+namespace {
+
+// Per-node cost counted against the budget: the record plus its slot in
+// the child id array.
+constexpr size_t NODE_BYTES =
+    sizeof(RepoFileIndex::Node) + sizeof(RepoFileIndex::NodeId);
+
+}  // namespace
+
+RepoFileIndex::RepoFileIndex() {
+    Node root;
+    root.isDir = true;
+    nodes_.push_back(root);
+}
+
+size_t RepoFileIndex::bytes() const {
+    return nodes_.size() * NODE_BYTES + names_.size();
+}
+
+std::string RepoFileIndex::path(NodeId id) const {
+    std::vector<NodeId> chain;
+    for (NodeId cur = id; cur != ROOT && cur != NONE; cur = nodes_[cur].parent) {
+        chain.push_back(cur);
+    }
+    std::string out;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+        if (!out.empty()) out += '/';
+        out += name(*it);
+    }
+    return out;
+}
+
+RepoFileIndex::NodeId RepoFileIndex::find(std::string_view path) const {
+    NodeId cur = ROOT;
+    bool any = false;
+    size_t start = 0;
+    while (start < path.size() && cur != NONE) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) end = path.size();
+        std::string_view seg = path.substr(start, end - start);
+        start = end + 1;
+        if (seg.empty()) continue;
+        any = true;
+
+        // Children are sorted by (directory first, name); try both kinds
+        auto kids = children(cur);
+        NodeId found = NONE;
+        for (bool wantDir : {true, false}) {
+            auto it = std::lower_bound(
+                kids.begin(), kids.end(), seg,
+                [this, wantDir](NodeId id, std::string_view key) {
+                    const Node& n = nodes_[id];
+                    if (n.isDir != wantDir) return n.isDir;
+                    return name(id) < key;
+                });
+            if (it != kids.end() && nodes_[*it].isDir == wantDir &&
+                name(*it) == seg) {
+                found = *it;
+                break;
+            }
+        }
+        cur = found;
+    }
+    return any ? cur : NONE;
+}
+
+// ---- Builder ----
+
+RepoFileIndex::Builder::Builder() : Builder(Limits{}) {}
+
+RepoFileIndex::Builder::Builder(Limits limits) : limits_(limits) {
+    Node root;
+    root.isDir = true;
+    nodes_.push_back(root);
+}
+
+std::string_view RepoFileIndex::Builder::name_of(NodeId id) const {
+    return std::string_view(names_).substr(nodes_[id].nameOffset,
+                                           nodes_[id].nameLength);
+}
+
+RepoFileIndex::NodeId RepoFileIndex::Builder::add_node(std::string_view name,
+                                                       NodeId parent,
+                                                       bool isDir) {
+    Node n;
+    n.nameOffset = static_cast<uint32_t>(names_.size());
+    n.nameLength = static_cast<uint32_t>(name.size());
+    n.parent = parent;
+    n.depth = parent == ROOT ? 0 : nodes_[parent].depth + 1;
+    n.isDir = isDir;
+    names_.append(name);
+    nodes_.push_back(n);
+    return static_cast<NodeId>(nodes_.size() - 1);
+}
+
+void RepoFileIndex::Builder::add_path(std::string_view path) {
+    if (nodes_.size() * NODE_BYTES + names_.size() + path.size() >
+        limits_.maxBytes) {
+        full_ = true;
+        return;
+    }
+
+    // Keep the directories this path shares with the previous one
+    size_t depth = 0;
+    size_t start = 0;
+    while (true) {
+        size_t end = path.find('/', start);
+        if (end == std::string_view::npos) break;
+        std::string_view seg = path.substr(start, end - start);
+        start = end + 1;
+        if (seg.empty()) continue;
+        if (depth < dirStack_.size() && name_of(dirStack_[depth]) == seg) {
+            ++depth;
+            continue;
+        }
+        dirStack_.resize(depth);
+        NodeId parent = depth == 0 ? ROOT : dirStack_[depth - 1];
+        dirStack_.push_back(add_node(seg, parent, /*isDir=*/true));
+        ++depth;
+    }
+    dirStack_.resize(depth);
+
+    std::string_view file = path.substr(start);
+    if (file.empty()) return;
+    NodeId parent = depth == 0 ? ROOT : dirStack_[depth - 1];
+    add_node(file, parent, /*isDir=*/false);
+    for (NodeId id : dirStack_) ++nodes_[id].fileCount;
+    ++nodes_[ROOT].fileCount;
+}
+
+bool RepoFileIndex::Builder::feed(std::string_view chunk) {
+    while (!chunk.empty() && !full_) {
+        size_t nul = chunk.find('\0');
+        if (nul == std::string_view::npos) {
+            partial_.append(chunk);
+            break;
+        }
+        if (partial_.empty()) {
+            add_path(chunk.substr(0, nul));
+        } else {
+            partial_.append(chunk.substr(0, nul));
+            add_path(partial_);
+            partial_.clear();
+        }
+        chunk.remove_prefix(nul + 1);
+    }
+    return !full_;
+}
+
+RepoFileIndex RepoFileIndex::Builder::finish() {
+    if (!partial_.empty() && !full_) add_path(partial_);
+    partial_.clear();
+
+    RepoFileIndex index;
+    index.truncated_ = full_;
+    index.nodes_ = std::move(nodes_);
+    index.names_ = std::move(names_);
+    auto& nodes = index.nodes_;
+
+    // Group children by parent (counting sort), then order each range
+    for (size_t i = 1; i < nodes.size(); ++i) ++nodes[nodes[i].parent].childCount;
+    uint32_t offset = 0;
+    for (auto& n : nodes) {
+        n.firstChild = offset;
+        offset += n.childCount;
+        n.childCount = 0;
+    }
+    index.children_.resize(offset);
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        Node& parent = nodes[nodes[i].parent];
+        index.children_[parent.firstChild + parent.childCount++] =
+            static_cast<NodeId>(i);
+    }
+    for (const auto& n : nodes) {
+        auto first = index.children_.begin() + n.firstChild;
+        std::sort(first, first + n.childCount, [&index](NodeId a, NodeId b) {
+            const Node& na = index.nodes_[a];
+            const Node& nb = index.nodes_[b];
+            if (na.isDir != nb.isDir) return na.isDir;
+            return index.name(a) < index.name(b);
+        });
+    }
+
+    *this = Builder(limits_);
+    return index;
+}
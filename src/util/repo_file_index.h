@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every tracked file in a repository as a compact, read-only tree, for
+// the sidebar's "All" view.  Built on a worker thread from the streamed
+// NUL-separated output of `git ls-files -z`, which lists the index in
+// path order, so each directory's entries arrive contiguously and the
+// tree can be built with a stack instead of per-directory lookups.
+//
+// Nodes are flat records (names in one shared arena, children as ranges
+// of one id array), about 40 bytes per file or directory.  Ingest stops
+// once `Limits::maxBytes` is reached; the index is then marked truncated
+// and holds the files read so far.
+class RepoFileIndex {
+   public:
+    using NodeId = uint32_t;
+    static constexpr NodeId ROOT = 0;
+    static constexpr NodeId NONE = UINT32_MAX;
+
+    struct Limits {
+        size_t maxBytes = 96u << 20;
+    };
+
+    struct Node {
+        uint32_t nameOffset = 0;  // Into the name arena
+        uint32_t nameLength = 0;
+        NodeId parent = NONE;
+        uint32_t firstChild = 0;  // Range in the child id array
+        uint32_t childCount = 0;  // Directories first, then by name
+        uint32_t fileCount = 0;   // Files at or below this node
+        uint32_t depth = 0;       // 0 for top-level entries
+        bool isDir = false;
+    };
+
+    // Incremental construction from a byte stream.
+    class Builder {
+       public:
+        Builder();
+        explicit Builder(Limits limits);
+
+        // Consume a chunk of `ls-files -z` output; paths may span chunks.
+        // Returns false once the memory budget is reached.
+        bool feed(std::string_view chunk);
+        RepoFileIndex finish();
+
+       private:
+        void add_path(std::string_view path);
+        NodeId add_node(std::string_view name, NodeId parent, bool isDir);
+        std::string_view name_of(NodeId id) const;
+
+        Limits limits_;
+        std::vector<Node> nodes_;
+        std::string names_;
+        std::vector<NodeId> dirStack_;  // Directories of the previous path
+        std::string partial_;           // Path split across chunks
+        bool full_ = false;
+    };
+
+    RepoFileIndex();
+
+    size_t file_count() const { return nodes_[ROOT].fileCount; }
+    size_t node_count() const { return nodes_.size(); }
+    size_t bytes() const;
+    bool truncated() const { return truncated_; }
+
+    const Node& node(NodeId id) const { return nodes_[id]; }
+    std::string_view name(NodeId id) const {
+        return std::string_view(names_).substr(nodes_[id].nameOffset,
+                                               nodes_[id].nameLength);
+    }
+    std::string path(NodeId id) const;
+    std::span<const NodeId> children(NodeId id) const {
+        const Node& n = nodes_[id];
+        return std::span<const NodeId>(children_).subspan(n.firstChild,
+                                                          n.childCount);
+    }
+
+    // File or directory at `path`, or NONE.
+    NodeId find(std::string_view path) const;
+
+   private:
+    std::vector<Node> nodes_;
+    std::string names_;
+    std::vector<NodeId> children_;
+    bool truncated_ = false;
+};
@@ -0,0 +1,404 @@
+#include "syntax_highlight.h"
+
+#include <array>
+#include <string>
+#include <unordered_set>
+
+namespace syntax {
+
+struct Grammar {
+    std::string_view name;
+    std::vector<std::string_view> extensions;  // Without the dot
+    std::vector<std::string_view> fileNames;
+    std::array<std::string_view, 2> lineComments{};
+    std::string_view blockOpen, blockClose;
+    std::string_view quotes;  // Single-line string delimiters
+    // Delimiters of strings that may span lines, longest first
+    std::array<std::string_view, 3> multiQuotes{};
+    bool preprocessor = false;       // '#' directives at line start
+    bool capitalizedTypes = false;   // Identifiers starting A-Z are types
+    std::unordered_set<std::string_view> keywords;
+    std::unordered_set<std::string_view> types;
+};
+
+namespace {
+
+bool is_ident_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool is_ident_char(char c) { return is_ident_start(c) || (c >= '0' && c <= '9'); }
+
+bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+const std::vector<Grammar>& grammars() {
+    static const std::vector<Grammar> all = [] {
+        std::vector<Grammar> g;
+        g.push_back(Grammar{
+            .name = "C/C++",
+            .extensions = {"c", "h", "cc", "cpp", "cxx", "hh", "hpp", "hxx", "inl",
+                           "ipp", "m", "mm"},
+            .fileNames = {},
+            .lineComments = {"//", ""},
+            .blockOpen = "/*", .blockClose = "*/",
+            .quotes = "\"'",
+            .multiQuotes = {},
+            .preprocessor = true,
+            .capitalizedTypes = false,
+            .keywords = {"alignas", "alignof", "asm", "auto", "break", "case", "catch",
+                         "class", "co_await", "co_return", "co_yield", "concept", "const",
+                         "consteval", "constexpr", "constinit", "const_cast", "continue",
+                         "decltype", "default", "delete", "do", "dynamic_cast", "else",
+                         "enum", "explicit", "export", "extern", "false", "final", "for",
+                         "friend", "goto", "if", "inline", "mutable", "namespace", "new",
+                         "noexcept", "nullptr", "operator", "override", "private",
+                         "protected", "public", "register", "reinterpret_cast", "requires",
+                         "return", "sizeof", "static", "static_assert", "static_cast",
+                         "struct", "switch", "template", "this", "thread_local", "throw",
+                         "true", "try", "typedef", "typeid", "typename", "union", "using",
+                         "virtual", "volatile", "while", "NULL"},
+            .types = {"bool", "char", "char8_t", "char16_t", "char32_t", "double", "float",
+                      "int", "long", "short", "signed", "unsigned", "void", "wchar_t",
+                      "size_t", "ptrdiff_t", "int8_t", "int16_t", "int32_t", "int64_t",
+                      "uint8_t", "uint16_t", "uint32_t", "uint64_t", "std"},
+        });
+        g.push_back(Grammar{
+            .name = "Python",
+            .extensions = {"py", "pyi", "pyw"},
+            .fileNames = {"SConstruct", "SConscript"},
+            .lineComments = {"#", ""},
+            .blockOpen = "", .blockClose = "",
+            .quotes = "\"'",
+            .multiQuotes = {"\"\"\"", "'''", ""},
+            .preprocessor = false,
+            .capitalizedTypes = true,
+            .keywords = {"and", "as", "assert", "async", "await", "break", "class",
+                         "continue", "def", "del", "elif", "else", "except", "False",
+                         "finally", "for", "from", "global", "if", "import", "in", "is",
+                         "lambda", "match", "case", "None", "nonlocal", "not", "or", "pass",
+                         "raise", "return", "self", "True", "try", "while", "with", "yield"},
+            .types = {"bool", "bytes", "dict", "float", "int", "list", "object", "set",
+                      "str", "tuple"},
+        });
+        g.push_back(Grammar{
+            .name = "JavaScript/TypeScript",
+            .extensions = {"js", "jsx", "mjs", "cjs", "ts", "tsx", "mts", "cts"},
+            .fileNames = {},
+            .lineComments = {"//", ""},
+            .blockOpen = "/*", .blockClose = "*/",
+            .quotes = "\"'",
+            .multiQuotes = {"`", "", ""},
+            .preprocessor = false,
+            .capitalizedTypes = true,
+            .keywords = {"abstract", "as", "async", "await", "break", "case", "catch",
+                         "class", "const", "continue", "debugger", "declare", "default",
+                         "delete", "do", "else", "enum", "export", "extends", "false",
+                         "finally", "for", "from", "function", "get", "if", "implements",
+                         "import", "in", "instanceof", "interface", "keyof", "let", "new",
+                         "null", "of", "private", "protected", "public", "readonly",
+                         "return", "set", "static", "super", "switch", "this", "throw",
+                         "true", "try", "type", "typeof", "undefined", "var", "void",
+                         "while", "with", "yield"},
+            .types = {"any", "bigint", "boolean", "never", "number", "object", "string",
+                      "symbol", "unknown"},
+        });
+        g.push_back(Grammar{
+            .name = "Rust",
+            .extensions = {"rs"},
+            .fileNames = {},
+            .lineComments = {"//", ""},
+            .blockOpen = "/*", .blockClose = "*/",
+            .quotes = "",
+            .multiQuotes = {"\"", "", ""},  // Rust strings may span lines
+            .preprocessor = false,
+            .capitalizedTypes = true,
+            .keywords = {"as", "async", "await", "break", "const", "continue", "crate",
+                         "dyn", "else", "enum", "extern", "false", "fn", "for", "if",
+                         "impl", "in", "let", "loop", "match", "mod", "move", "mut", "pub",
+                         "ref", "return", "self", "Self", "static", "struct", "super",
+                         "trait", "true", "type", "unsafe", "use", "where", "while"},
+            .types = {"bool", "char", "f32", "f64", "i8", "i16", "i32", "i64", "i128",
+                      "isize", "str", "u8", "u16", "u32", "u64", "u128", "usize"},
+        });
+        g.push_back(Grammar{
+            .name = "Go",
+            .extensions = {"go"},
+            .fileNames = {},
+            .lineComments = {"//", ""},
+            .blockOpen = "/*", .blockClose = "*/",
+            .quotes = "\"'",
+            .multiQuotes = {"`", "", ""},
+            .preprocessor = false,
+            .capitalizedTypes = false,
+            .keywords = {"break", "case", "chan", "const", "continue", "default", "defer",
+                         "else", "fallthrough", "false", "for", "func", "go", "goto", "if",
+                         "import", "interface", "iota", "map", "nil", "package", "range",
+                         "return", "select", "struct", "switch", "true", "type", "var"},
+            .types = {"any", "bool", "byte", "complex64", "complex128", "error", "float32",
+                      "float64", "int", "int8", "int16", "int32", "int64", "rune",
+                      "string", "uint", "uint8", "uint16", "uint32", "uint64", "uintptr"},
+        });
+        g.push_back(Grammar{
+            .name = "Java/Kotlin/C#/Swift",
+            .extensions = {"java", "kt", "kts", "cs", "swift", "scala", "groovy", "gradle",
+                           "dart"},
+            .fileNames = {},
+            .lineComments = {"//", ""},
+            .blockOpen = "/*", .blockClose = "*/",
+            .quotes = "\"'",
+            .multiQuotes = {"\"\"\"", "", ""},  // Text blocks / raw strings
+            .preprocessor = false,
+            .capitalizedTypes = true,
+            .keywords = {"abstract", "as", "async", "await", "base", "break", "case",
+                         "catch", "class", "companion", "const", "continue", "data",
+                         "default", "defer", "do", "else", "enum", "extends", "extension",
+                         "false", "final", "finally", "for", "fun", "func", "guard", "if",
+                         "implements", "import", "in", "init", "interface", "internal",
+                         "is", "let", "namespace", "new", "nil", "null", "object",
+                         "open", "override", "package", "private", "protected",
+                         "protocol", "public", "readonly", "return", "sealed", "self",
+                         "static", "struct", "super", "switch", "synchronized", "this",
+                         "throw", "throws", "true", "try", "using", "val", "var", "virtual",
+                         "void", "when", "where", "while"},
+            .types = {"boolean", "bool", "byte", "char", "decimal", "double", "float",
+                      "int", "long", "short", "string", "uint", "ulong"},
+        });
+        g.push_back(Grammar{
+            .name = "Shell",
+            .extensions = {"sh", "bash", "zsh", "ksh"},
+            .fileNames = {".bashrc", ".zshrc", ".profile", "configure"},
+            .lineComments = {"#", ""},
+            .blockOpen = "", .blockClose = "",
+            .quotes = "",
+            .multiQuotes = {"\"", "'", ""},  // Quoted strings may span lines
+            .preprocessor = false,
+            .capitalizedTypes = false,
+            .keywords = {"case", "do", "done", "elif", "else", "esac", "export", "fi",
+                         "for", "function", "if", "in", "local", "readonly", "return",
+                         "select", "set", "shift", "then", "until", "while"},
+            .types = {},
+        });
+        g.push_back(Grammar{
+            .name = "Ruby",
+            .extensions = {"rb", "rake", "gemspec"},
+            .fileNames = {"Gemfile", "Rakefile"},
+            .lineComments = {"#", ""},
+            .blockOpen = "", .blockClose = "",
+            .quotes = "\"'",
+            .multiQuotes = {},
+            .preprocessor = false,
+            .capitalizedTypes = true,
+            .keywords = {"alias", "and", "begin", "break", "case", "class", "def",
+                         "defined?", "do", "else", "elsif", "end", "ensure", "false", "for",
+                         "if", "in", "module", "next", "nil", "not", "or", "redo", "rescue",
+                         "retry", "return", "self", "super", "then", "true", "undef",
+                         "unless", "until", "when", "while", "yield"},
+            .types = {},
+        });
+        g.push_back(Grammar{
+            .name = "Lua",
+            .extensions = {"lua"},
+            .fileNames = {},
+            .lineComments = {"--", ""},
+            .blockOpen = "--[[", .blockClose = "]]",
+            .quotes = "\"'",
+            .multiQuotes = {"[[", "", ""},
+            .preprocessor = false,
+            .capitalizedTypes = false,
+            .keywords = {"and", "break", "do", "else", "elseif", "end", "false", "for",
+                         "function", "goto", "if", "in", "local", "nil", "not", "or",
+                         "repeat", "return", "then", "true", "until", "while"},
+            .types = {},
+        });
+        return g;
+    }();
+    return all;
+}
+
+// Closing delimiter of a multi-line string ("[[" closes with "]]").
+std::string_view closing(std::string_view open) { return open == "[[" ? "]]" : open; }
+
+// Position just past the end of a string whose body starts at `from`, or
+// npos if `close` doesn't occur on this line.  Backslash escapes apply.
+size_t find_string_end(std::string_view line, size_t from, std::string_view close) {
+    for (size_t i = from; i < line.size(); ++i) {
+        if (line[i] == '\\') {
+            ++i;
+            continue;
+        }
+        if (line.substr(i, close.size()) == close) return i + close.size();
+    }
+    return std::string_view::npos;
+}
+
+void push(std::vector<Span>& out, size_t begin, size_t end, Kind kind) {
+    if (begin >= end) return;
+    out.push_back(Span{static_cast<uint32_t>(begin), static_cast<uint32_t>(end), kind});
+}
+
+}  // namespace
+
+const Grammar* grammar_for_path(std::string_view path) {
+    size_t slash = path.find_last_of('/');
+    std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    std::string_view ext =
+        dot == std::string_view::npos ? std::string_view{} : name.substr(dot + 1);
+    for (const auto& g : grammars()) {
+        for (auto f : g.fileNames) {
+            if (f == name) return &g;
+        }
+        if (ext.empty()) continue;
+        for (auto e : g.extensions) {
+            if (e == ext) return &g;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view grammar_name(const Grammar& grammar) { return grammar.name; }
+
+void highlight_line(const Grammar& g, std::string_view line, LineState& state,
+                    std::vector<Span>& out) {
+    size_t pos = 0;
+    const size_t n = line.size();
+
+    // Finish whatever the previous line left open
+    if (state.open == LineState::BlockComment) {
+        size_t close = line.find(g.blockClose);
+        if (close == std::string_view::npos) {
+            push(out, 0, n, Kind::Comment);
+            return;
+        }
+        pos = close + g.blockClose.size();
+        push(out, 0, pos, Kind::Comment);
+        state = {};
+    } else if (state.open == LineState::String) {
+        size_t end = find_string_end(line, 0, closing(g.multiQuotes[state.delimiter]));
+        if (end == std::string_view::npos) {
+            push(out, 0, n, Kind::String);
+            return;
+        }
+        push(out, 0, end, Kind::String);
+        pos = end;
+        state = {};
+    }
+
+    bool lineStart = true;  // Only whitespace so far
+    while (pos < n) {
+        char c = line[pos];
+        if (c == ' ' || c == '\t' || c == '\r') {
+            ++pos;
+            continue;
+        }
+
+        if (g.preprocessor && lineStart && c == '#') {
+            size_t end = pos + 1;
+            while (end < n && (line[end] == ' ' || line[end] == '\t')) ++end;
+            while (end < n && is_ident_char(line[end])) ++end;
+            push(out, pos, end, Kind::Preproc);
+            pos = end;
+            lineStart = false;
+            continue;
+        }
+        lineStart = false;
+
+        std::string_view rest = line.substr(pos);
+        if (!g.blockOpen.empty() && rest.starts_with(g.blockOpen)) {
+            size_t close = line.find(g.blockClose, pos + g.blockOpen.size());
+            if (close == std::string_view::npos) {
+                push(out, pos, n, Kind::Comment);
+                state.open = LineState::BlockComment;
+                return;
+            }
+            push(out, pos, close + g.blockClose.size(), Kind::Comment);
+            pos = close + g.blockClose.size();
+            continue;
+        }
+        bool comment = false;
+        for (auto lc : g.lineComments) {
+            if (!lc.empty() && rest.starts_with(lc)) comment = true;
+        }
+        if (comment) {
+            push(out, pos, n, Kind::Comment);
+            return;
+        }
+
+        bool matchedString = false;
+        for (size_t d = 0; d < g.multiQuotes.size(); ++d) {
+            std::string_view open = g.multiQuotes[d];
+            if (open.empty() || !rest.starts_with(open)) continue;
+            size_t end = find_string_end(line, pos + open.size(), closing(open));
+            if (end == std::string_view::npos) {
+                push(out, pos, n, Kind::String);
+                state.open = LineState::String;
+                state.delimiter = static_cast<uint8_t>(d);
+                return;
+            }
+            push(out, pos, end, Kind::String);
+            pos = end;
+            matchedString = true;
+            break;
+        }
+        if (matchedString) continue;
+
+        if (g.quotes.find(c) != std::string_view::npos) {
+            size_t end = find_string_end(line, pos + 1, line.substr(pos, 1));
+            if (end == std::string_view::npos) end = n;  // Unterminated
+            push(out, pos, end, Kind::String);
+            pos = end;
+            continue;
+        }
+
+        bool afterIdent = pos > 0 && is_ident_char(line[pos - 1]);
+        if (!afterIdent && (is_digit(c) || (c == '.' && pos + 1 < n && is_digit(line[pos + 1])))) {
+            size_t end = pos + 1;
+            while (end < n) {
+                char d = line[end];
+                bool exponentSign = (d == '+' || d == '-') &&
+                                    (line[end - 1] == 'e' || line[end - 1] == 'E') &&
+                                    !(line.substr(pos, 2) == "0x" || line.substr(pos, 2) == "0X");
+                if (!is_ident_char(d) && d != '.' && d != '\'' && !exponentSign) break;
+                ++end;
+            }
+            push(out, pos, end, Kind::Number);
+            pos = end;
+            continue;
+        }
+
+        if (is_ident_start(c)) {
+            size_t end = pos + 1;
+            while (end < n && is_ident_char(line[end])) ++end;
+            std::string_view word = line.substr(pos, end - pos);
+            if (g.keywords.contains(word)) {
+                push(out, pos, end, Kind::Keyword);
+            } else if (g.types.contains(word) ||
+                       (g.capitalizedTypes && word[0] >= 'A' && word[0] <= 'Z')) {
+                push(out, pos, end, Kind::Type);
+            }
+            pos = end;
+            continue;
+        }
+        ++pos;
+    }
+}
+
+Highlighted highlight(const Grammar& grammar, std::string_view text) {
+    Highlighted out;
+    LineState state;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t nl = text.find('\n', start);
+        size_t end = nl == std::string_view::npos ? text.size() : nl;
+        if (nl == std::string_view::npos && start == text.size() && start > 0) break;
+        out.lineFirst.push_back(static_cast<uint32_t>(out.spans.size()));
+        highlight_line(grammar, text.substr(start, end - start), state, out.spans);
+        if (nl == std::string_view::npos) break;
+        start = nl + 1;
+    }
+    out.lineFirst.push_back(static_cast<uint32_t>(out.spans.size()));
+    return out;
+}
+
+}  // namespace syntax
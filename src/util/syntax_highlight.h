@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Tokenizer-based syntax highlighting with a built-in grammar per
+// language family (C/C++, Python, JS/TS, Rust, Go, Java, C#, Kotlin,
+// Swift, shell, Ruby, Lua).  Grammars are lexical only: comments,
+// strings, numbers, keywords, type names and preprocessor directives.
+//
+// Highlighting runs a line at a time.  LineState carries what the
+// previous line left open (a block comment or a multi-line string), so a
+// whole file highlighted top to bottom colors those constructs correctly
+// wherever a diff hunk happens to start, and a caller can resume from any
+// line whose incoming state it kept.
+namespace syntax {
+
+enum class Kind : uint8_t { Plain, Keyword, Type, String, Comment, Number, Preproc };
+
+// Byte range [begin, end) of one token within its line.  Plain text has
+// no spans.
+struct Span {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    Kind kind = Kind::Plain;
+};
+
+struct Grammar;
+
+// Grammar for a path's extension (or well-known file name); null if none.
+const Grammar* grammar_for_path(std::string_view path);
+std::string_view grammar_name(const Grammar& grammar);
+
+struct LineState {
+    enum Open : uint8_t { None, BlockComment, String };
+    Open open = None;
+    uint8_t delimiter = 0;  // Which multi-line string delimiter is open
+
+    bool operator==(const LineState&) const = default;
+};
+
+// Append the spans of one line (no trailing newline), given the state the
+// previous line left; updates `state` for the next line.
+void highlight_line(const Grammar& grammar, std::string_view line, LineState& state,
+                    std::vector<Span>& out);
+
+// Spans for every line of a text.
+struct Highlighted {
+    std::vector<uint32_t> lineFirst;  // line_count() + 1 entries
+    std::vector<Span> spans;
+
+    size_t line_count() const { return lineFirst.empty() ? 0 : lineFirst.size() - 1; }
+    std::span<const Span> line(size_t i) const {
+        if (i + 1 >= lineFirst.size()) return {};
+        return std::span<const Span>(spans.data() + lineFirst[i],
+                                     lineFirst[i + 1] - lineFirst[i]);
+    }
+    size_t approx_bytes() const {
+        return sizeof(Highlighted) + lineFirst.size() * sizeof(uint32_t) +
+               spans.size() * sizeof(Span);
+    }
+};
+
+Highlighted highlight(const Grammar& grammar, std::string_view text);
+
+}  // namespace syntax
@@ -0,0 +1,247 @@
+#include "word_diff.h"
+
+#include <algorithm>
+
+namespace word_diff {
+
+namespace {
+
+enum class TokenClass : uint8_t { Word, Space, Other };
+
+struct Token {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+    TokenClass cls = TokenClass::Other;
+};
+
+// Bytes >= 0x80 count as word characters so UTF-8 words stay whole.
+TokenClass class_of(unsigned char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9') || c == '_' || c >= 0x80) {
+        return TokenClass::Word;
+    }
+    if (c == ' ' || c == '\t' || c == '\r') return TokenClass::Space;
+    return TokenClass::Other;
+}
+
+std::vector<Token> tokenize(std::string_view text) {
+    std::vector<Token> tokens;
+    size_t i = 0;
+    while (i < text.size()) {
+        TokenClass cls = class_of(static_cast<unsigned char>(text[i]));
+        size_t j = i + 1;
+        if (cls != TokenClass::Other) {
+            while (j < text.size() &&
+                   class_of(static_cast<unsigned char>(text[j])) == cls) {
+                ++j;
+            }
+        }
+        tokens.push_back(Token{static_cast<uint32_t>(i), static_cast<uint32_t>(j), cls});
+        i = j;
+    }
+    return tokens;
+}
+
+// Myers' greedy O(ND) diff of a[0, n) against b[0, m).  Marks the
+// elements of a longest common subsequence in keepA/keepB; false if that
+// takes more than maxD edits.
+template <typename Eq>
+bool myers(int n, int m, int maxD, Eq eq, std::vector<char>& keepA,
+           std::vector<char>& keepB) {
+    keepA.assign(static_cast<size_t>(n), 0);
+    keepB.assign(static_cast<size_t>(m), 0);
+    maxD = std::min(maxD, n + m);
+    const int off = maxD + 1;
+    std::vector<int> v(static_cast<size_t>(2 * maxD + 3), 0);
+    std::vector<std::vector<int>> trace;
+
+    auto at = [off](std::vector<int>& vec, int k) -> int& {
+        return vec[static_cast<size_t>(k + off)];
+    };
+
+    int found = -1;
+    for (int d = 0; d <= maxD && found < 0; ++d) {
+        trace.push_back(v);
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && at(v, k - 1) < at(v, k + 1)))
+                        ? at(v, k + 1)
+                        : at(v, k - 1) + 1;
+            int y = x - k;
+            while (x < n && y < m && eq(x, y)) {
+                ++x;
+                ++y;
+            }
+            at(v, k) = x;
+            if (x >= n && y >= m) {
+                found = d;
+                break;
+            }
+        }
+    }
+    if (found < 0) return false;
+
+    int x = n, y = m;
+    for (int d = found; d >= 0; --d) {
+        auto& prev = trace[static_cast<size_t>(d)];
+        int k = x - y;
+        int prevK = (k == -d || (k != d && at(prev, k - 1) < at(prev, k + 1)))
+                        ? k + 1
+                        : k - 1;
+        int prevX = at(prev, prevK);
+        int prevY = prevX - prevK;
+        while (x > prevX && y > prevY) {
+            --x;
+            --y;
+            keepA[static_cast<size_t>(x)] = 1;
+            keepB[static_cast<size_t>(y)] = 1;
+        }
+        if (d > 0) {
+            x = prevX;
+            y = prevY;
+        }
+    }
+    return true;
+}
+
+void push_span(std::vector<Span>& out, uint32_t begin, uint32_t end) {
+    if (begin >= end) return;
+    if (!out.empty() && out.back().end == begin) {
+        out.back().end = end;
+    } else {
+        out.push_back(Span{begin, end});
+    }
+}
+
+// Narrow a one-word-for-one-word replacement to the characters that
+// differ.  False if the words have too little in common, in which case
+// the caller highlights them whole.
+bool refine_chars(std::string_view oldText, const Token& a, std::string_view newText,
+                  const Token& b, const Limits& limits, std::vector<Span>& oldOut,
+                  std::vector<Span>& newOut) {
+    std::string_view wa = oldText.substr(a.begin, a.end - a.begin);
+    std::string_view wb = newText.substr(b.begin, b.end - b.begin);
+    std::vector<char> keepA, keepB;
+    if (!myers(static_cast<int>(wa.size()), static_cast<int>(wb.size()), limits.maxEdits,
+               [&](int i, int j) { return wa[static_cast<size_t>(i)] == wb[static_cast<size_t>(j)]; },
+               keepA, keepB)) {
+        return false;
+    }
+    size_t common = static_cast<size_t>(std::count(keepA.begin(), keepA.end(), 1));
+    if (common * 2 < std::max(wa.size(), wb.size())) return false;
+    for (size_t i = 0; i < keepA.size(); ++i) {
+        if (!keepA[i]) push_span(oldOut, a.begin + static_cast<uint32_t>(i), a.begin + static_cast<uint32_t>(i) + 1);
+    }
+    for (size_t j = 0; j < keepB.size(); ++j) {
+        if (!keepB[j]) push_span(newOut, b.begin + static_cast<uint32_t>(j), b.begin + static_cast<uint32_t>(j) + 1);
+    }
+    return true;
+}
+
+}  // namespace
+
+bool diff_line_pair(std::string_view oldText, std::string_view newText,
+                    std::vector<Span>& oldOut, std::vector<Span>& newOut,
+                    const Limits& limits) {
+    if (oldText.size() > limits.maxLineBytes || newText.size() > limits.maxLineBytes) {
+        return false;
+    }
+    if (oldText == newText) return true;
+
+    auto ta = tokenize(oldText);
+    auto tb = tokenize(newText);
+    auto text = [](std::string_view s, const Token& t) {
+        return s.substr(t.begin, t.end - t.begin);
+    };
+    auto same = [&](size_t i, size_t j) { return text(oldText, ta[i]) == text(newText, tb[j]); };
+
+    // Common prefix and suffix cost nothing to match; Myers runs on the rest
+    size_t pre = 0;
+    while (pre < ta.size() && pre < tb.size() && same(pre, pre)) ++pre;
+    size_t suf = 0;
+    while (suf < ta.size() - pre && suf < tb.size() - pre &&
+           same(ta.size() - 1 - suf, tb.size() - 1 - suf)) {
+        ++suf;
+    }
+    int n = static_cast<int>(ta.size() - pre - suf);
+    int m = static_cast<int>(tb.size() - pre - suf);
+    std::vector<char> midA, midB;
+    if (!myers(n, m, limits.maxEdits,
+               [&](int i, int j) { return same(pre + static_cast<size_t>(i), pre + static_cast<size_t>(j)); },
+               midA, midB)) {
+        return false;
+    }
+    std::vector<char> keepA(ta.size(), 1), keepB(tb.size(), 1);
+    std::copy(midA.begin(), midA.end(), keepA.begin() + static_cast<std::ptrdiff_t>(pre));
+    std::copy(midB.begin(), midB.end(), keepB.begin() + static_cast<std::ptrdiff_t>(pre));
+
+    // Kept tokens pair up in order, so the unkept ones between two kept
+    // pairs form one changed region per side
+    std::vector<Span> oldSpans, newSpans;
+    size_t keptBytes = 0;
+    size_t i = 0, j = 0;
+    while (i < ta.size() || j < tb.size()) {
+        if (i < ta.size() && j < tb.size() && keepA[i] && keepB[j]) {
+            if (ta[i].cls != TokenClass::Space) keptBytes += 2 * (ta[i].end - ta[i].begin);
+            ++i;
+            ++j;
+            continue;
+        }
+        size_t i0 = i, j0 = j;
+        while (i < ta.size() && !keepA[i]) ++i;
+        while (j < tb.size() && !keepB[j]) ++j;
+        bool oneWordEach = i - i0 == 1 && j - j0 == 1 &&
+                           ta[i0].cls == TokenClass::Word && tb[j0].cls == TokenClass::Word;
+        if (oneWordEach &&
+            refine_chars(oldText, ta[i0], newText, tb[j0], limits, oldSpans, newSpans)) {
+            continue;
+        }
+        for (size_t t = i0; t < i; ++t) push_span(oldSpans, ta[t].begin, ta[t].end);
+        for (size_t t = j0; t < j; ++t) push_span(newSpans, tb[t].begin, tb[t].end);
+    }
+
+    // Mostly-rewritten lines read better without confetti
+    if (keptBytes * 4 < oldText.size() + newText.size()) return false;
+
+    oldOut.insert(oldOut.end(), oldSpans.begin(), oldSpans.end());
+    newOut.insert(newOut.end(), newSpans.begin(), newSpans.end());
+    return true;
+}
+
+HunkHighlights diff_hunk(const std::vector<std::string>& lines, const Limits& limits) {
+    HunkHighlights out;
+    std::vector<std::vector<Span>> perLine;
+    auto content = [](const std::string& line) {
+        return line.size() > 1 ? std::string_view(line).substr(1) : std::string_view{};
+    };
+
+    size_t i = 0;
+    while (i < lines.size()) {
+        if (lines[i].empty() || lines[i][0] != '-') {
+            ++i;
+            continue;
+        }
+        size_t delBegin = i;
+        while (i < lines.size() && !lines[i].empty() && lines[i][0] == '-') ++i;
+        size_t addBegin = i;
+        while (i < lines.size() && !lines[i].empty() && lines[i][0] == '+') ++i;
+        size_t pairs = std::min(addBegin - delBegin, i - addBegin);
+        for (size_t k = 0; k < pairs; ++k) {
+            if (perLine.empty()) perLine.resize(lines.size());
+            diff_line_pair(content(lines[delBegin + k]), content(lines[addBegin + k]),
+                           perLine[delBegin + k], perLine[addBegin + k], limits);
+        }
+    }
+
+    bool any = std::any_of(perLine.begin(), perLine.end(),
+                           [](const std::vector<Span>& s) { return !s.empty(); });
+    if (!any) return out;
+    out.lineFirst.reserve(lines.size() + 1);
+    for (const auto& spans : perLine) {
+        out.lineFirst.push_back(static_cast<uint32_t>(out.spans.size()));
+        out.spans.insert(out.spans.end(), spans.begin(), spans.end());
+    }
+    out.lineFirst.push_back(static_cast<uint32_t>(out.spans.size()));
+    return out;
+}
+
+}  // namespace word_diff
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Intra-line ("word") diff between a removed line and the line that
+// replaced it.  Lines are split into tokens -- runs of word characters,
+// runs of whitespace, and single punctuation characters -- and the token
+// sequences are compared with Myers' O(ND) algorithm, so highlights follow
+// the word boundaries a reader scans by.  Where one word was replaced by
+// one similar word, the highlight is narrowed to the characters that
+// differ.
+//
+// Every comparison is bounded: lines longer than Limits::maxLineBytes are
+// skipped, and the search gives up after Limits::maxEdits edits.  Either
+// way, or when the two lines share too little for highlights to help, the
+// pair gets none and stays plain red/green.
+namespace word_diff {
+
+// Byte range [begin, end) of a highlighted run within a line's text.
+struct Span {
+    uint32_t begin = 0;
+    uint32_t end = 0;
+};
+
+struct Limits {
+    size_t maxLineBytes = 1000;
+    int maxEdits = 128;  // Myers D bound, per token or character pass
+};
+
+// Runs that differ between `oldText` and `newText`, appended to oldOut
+// and newOut in order.  False, with nothing appended, if the pair is over
+// the limits or too dissimilar to highlight.
+bool diff_line_pair(std::string_view oldText, std::string_view newText,
+                    std::vector<Span>& oldOut, std::vector<Span>& newOut,
+                    const Limits& limits = {});
+
+// Highlights for every line of one hunk.  Lines carry their ' '/'-'/'+'
+// prefix; spans are offsets into the text after it.  Within each run of
+// changes the n-th deletion is compared with the n-th addition, the same
+// pairing the side-by-side view uses.
+struct HunkHighlights {
+    std::vector<uint32_t> lineFirst;  // lines + 1 entries; empty if none
+    std::vector<Span> spans;
+
+    std::span<const Span> line(size_t i) const {
+        if (i + 1 >= lineFirst.size()) return {};
+        return std::span<const Span>(spans.data() + lineFirst[i],
+                                     lineFirst[i + 1] - lineFirst[i]);
+    }
+};
+
+HunkHighlights diff_hunk(const std::vector<std::string>& lines,
+                         const Limits& limits = {});
+
+}  // namespace word_diff
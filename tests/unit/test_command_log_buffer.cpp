@@ -0,0 +1,250 @@
+// Unit tests for CommandLogBuffer (bounded command log with spill files).
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/command_log_buffer.h"
+
+namespace fs = std::filesystem;
+
+static std::vector<uint64_t> seqs_newest_first(const CommandLogBuffer& log) {
+    std::vector<uint64_t> out;
+    log.for_each_newest([&out](size_t, const CommandLogBuffer::Entry& e) {
+        out.push_back(e.seq);
+        return true;
+    });
+    return out;
+}
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string test_spill_dir(const char* name) {
+    auto dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    return dir.string();
+}
+
+// ===========================================================================
+// Excerpts
+// ===========================================================================
+
+TEST(excerpt_keeps_short_text) {
+    ASSERT_EQ(CommandLogBuffer::excerpt("hello", 3, 2), std::string("hello"));
+}
+
+TEST(excerpt_keeps_head_and_tail) {
+    std::string text = "abcdefghij";
+    std::string ex = CommandLogBuffer::excerpt(text, 3, 2);
+    ASSERT_TRUE(ex.starts_with("abc\n"));
+    ASSERT_TRUE(ex.ends_with("\nij"));
+    ASSERT_TRUE(ex.find("[5 bytes omitted]") != std::string::npos);
+}
+
+TEST(excerpt_cuts_on_utf8_boundaries) {
+    // "é" is two bytes; cutting inside it must back off / skip ahead
+    std::string text = "a\xc3\xa9" "bbbbbbbb" "\xc3\xa9z";
+    std::string ex = CommandLogBuffer::excerpt(text, 2, 2);
+    ASSERT_TRUE(ex.starts_with("a\n"));
+    ASSERT_TRUE(ex.ends_with("\nz"));
+}
+
+// ===========================================================================
+// Bounds
+// ===========================================================================
+
+TEST(ring_evicts_oldest_past_entry_limit) {
+    CommandLogBuffer::Limits limits;
+    limits.maxEntries = 3;
+    CommandLogBuffer log(limits);
+    for (int i = 0; i < 5; ++i) log.record("git " + std::to_string(i), "", "", true, 0, 0);
+
+    ASSERT_EQ(log.size(), static_cast<size_t>(3));
+    ASSERT_EQ(log.total_recorded(), static_cast<uint64_t>(5));
+    auto seqs = seqs_newest_first(log);
+    ASSERT_EQ(seqs.size(), static_cast<size_t>(3));
+    ASSERT_EQ(seqs[0], static_cast<uint64_t>(5));
+    ASSERT_EQ(seqs[2], static_cast<uint64_t>(3));
+}
+
+TEST(ring_evicts_oldest_past_byte_limit) {
+    CommandLogBuffer::Limits limits;
+    limits.maxBytes = 3 * (sizeof(CommandLogBuffer::Entry) + 100);
+    CommandLogBuffer log(limits);
+    std::string out(90, 'x');
+    for (int i = 0; i < 10; ++i) log.record("git log", out, "", true, 0, 0);
+
+    ASSERT_TRUE(log.bytes() <= limits.maxBytes);
+    ASSERT_EQ(log.size(), static_cast<size_t>(3));
+    ASSERT_EQ(seqs_newest_first(log)[0], static_cast<uint64_t>(10));
+}
+
+TEST(ring_order_survives_wraparound) {
+    CommandLogBuffer::Limits limits;
+    limits.maxEntries = 4;
+    limits.maxBytes = 3 * (sizeof(CommandLogBuffer::Entry) + 100);
+    CommandLogBuffer log(limits);
+    // Mix small and large entries so eviction by bytes and by count interleave
+    for (int i = 0; i < 20; ++i) {
+        log.record("git", std::string(i % 3 == 0 ? 90 : 1, 'x'), "", true, 0, 0);
+        auto seqs = seqs_newest_first(log);
+        ASSERT_EQ(seqs[0], static_cast<uint64_t>(i + 1));
+        for (size_t k = 1; k < seqs.size(); ++k) ASSERT_EQ(seqs[k], seqs[k - 1] - 1);
+    }
+}
+
+TEST(visit_stops_early) {
+    CommandLogBuffer log;
+    for (int i = 0; i < 10; ++i) log.record("git", "", "", true, 0, 0);
+    int visited = 0;
+    log.for_each_newest([&visited](size_t i, const CommandLogBuffer::Entry&) {
+        ++visited;
+        return i < 2;
+    });
+    ASSERT_EQ(visited, 3);
+}
+
+// ===========================================================================
+// Spill files
+// ===========================================================================
+
+TEST(truncated_output_spills_full_text_on_demand) {
+    CommandLogBuffer::Limits limits;
+    limits.headBytes = 4;
+    limits.tailBytes = 4;
+    limits.spillDir = test_spill_dir("fh_test_cmdlog_spill");
+    std::string spillPath;
+    {
+        CommandLogBuffer log(limits);
+        std::string out = "0123456789abcdef";
+        log.record("git diff", out, "warn", false, 0, 0);
+        log.record("git status", "short", "", true, 0, 0);
+
+        log.for_each_newest([&](size_t i, const CommandLogBuffer::Entry& e) {
+            ASSERT_TRUE(e.spillPath.empty());
+            if (i == 0) {
+                ASSERT_FALSE(e.truncated);
+                ASSERT_FALSE(e.can_spill());
+            } else {
+                ASSERT_TRUE(e.truncated);
+                ASSERT_TRUE(e.can_spill());
+                ASSERT_EQ(e.outputBytes, static_cast<size_t>(16));
+            }
+            return true;
+        });
+        // Recording writes nothing to disk
+        ASSERT_TRUE(fs::is_empty(limits.spillDir));
+        ASSERT_EQ(log.spill_bytes(), static_cast<size_t>(0));
+        ASSERT_TRUE(log.spill(2).empty());  // Not truncated
+
+        spillPath = log.spill(1);
+        ASSERT_FALSE(spillPath.empty());
+        ASSERT_EQ(log.spill(1), spillPath);  // Written once
+        ASSERT_EQ(log.held_bytes(), static_cast<size_t>(0));
+        ASSERT_EQ(read_file(spillPath),
+                  std::string("0123456789abcdef\n--- stderr ---\nwarn"));
+        ASSERT_EQ(log.spill_bytes(), static_cast<size_t>(20));
+    }
+    // Destroying the buffer deletes its spill files
+    ASSERT_FALSE(fs::exists(spillPath));
+    fs::remove_all(limits.spillDir);
+}
+
+TEST(spill_deleted_with_evicted_entry) {
+    CommandLogBuffer::Limits limits;
+    limits.maxEntries = 1;
+    limits.headBytes = 2;
+    limits.tailBytes = 2;
+    limits.spillDir = test_spill_dir("fh_test_cmdlog_evict");
+    CommandLogBuffer log(limits);
+    log.record("git log", "long output", "", true, 0, 0);
+    std::string first = log.spill(1);
+    ASSERT_TRUE(fs::exists(first));
+
+    log.record("git log", "more long output", "", true, 0, 0);
+    ASSERT_FALSE(fs::exists(first));
+    ASSERT_TRUE(log.spill(1).empty());  // Evicted
+    ASSERT_FALSE(log.spill(2).empty());
+    ASSERT_EQ(log.spill_bytes(), static_cast<size_t>(16));
+    log.clear();
+    fs::remove_all(limits.spillDir);
+}
+
+TEST(spill_budget_drops_oldest_files) {
+    CommandLogBuffer::Limits limits;
+    limits.headBytes = 2;
+    limits.tailBytes = 2;
+    limits.maxSpillBytes = 25;
+    limits.spillDir = test_spill_dir("fh_test_cmdlog_budget");
+    CommandLogBuffer log(limits);
+    for (int i = 0; i < 3; ++i) log.record("git", std::string(10, 'x'), "", true, 0, 0);
+    for (uint64_t seq = 1; seq <= 3; ++seq) ASSERT_FALSE(log.spill(seq).empty());
+
+    ASSERT_EQ(log.spill_bytes(), static_cast<size_t>(20));
+    auto paths = std::vector<std::string>{};
+    log.for_each_newest([&paths](size_t, const CommandLogBuffer::Entry& e) {
+        paths.push_back(e.spillPath);
+        return true;
+    });
+    ASSERT_FALSE(paths[0].empty());
+    ASSERT_FALSE(paths[1].empty());
+    ASSERT_TRUE(paths[2].empty());  // Oldest lost its file, kept its excerpt
+    log.clear();
+    fs::remove_all(limits.spillDir);
+}
+
+TEST(only_recent_full_outputs_are_held) {
+    CommandLogBuffer::Limits limits;
+    limits.headBytes = 2;
+    limits.tailBytes = 2;
+    limits.maxHeldOutputs = 2;
+    limits.spillDir = test_spill_dir("fh_test_cmdlog_held");
+    CommandLogBuffer log(limits);
+    for (int i = 0; i < 4; ++i) log.record("git", std::string(10, 'x'), "", true, 0, 0);
+
+    ASSERT_EQ(log.held_bytes(), static_cast<size_t>(20));
+    ASSERT_TRUE(log.spill(1).empty());  // Released; excerpt only
+    ASSERT_TRUE(log.spill(2).empty());
+    ASSERT_FALSE(log.spill(3).empty());
+    ASSERT_FALSE(log.spill(4).empty());
+    ASSERT_EQ(log.held_bytes(), static_cast<size_t>(0));
+    log.clear();
+    fs::remove_all(limits.spillDir);
+}
+
+// ===========================================================================
+// Threads
+// ===========================================================================
+
+TEST(concurrent_records_are_all_counted) {
+    CommandLogBuffer::Limits limits;
+    limits.maxEntries = 64;
+    CommandLogBuffer log(limits);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&log] {
+            for (int i = 0; i < 500; ++i) log.record("git", "out", "", true, 0, 0);
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    ASSERT_EQ(log.total_recorded(), static_cast<uint64_t>(2000));
+    ASSERT_EQ(log.size(), static_cast<size_t>(64));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== command_log_buffer tests ===\n");
+    RUN_ALL_TESTS();
+}
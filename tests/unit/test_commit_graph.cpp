@@ -0,0 +1,228 @@
+// Unit tests for the commit graph lane layout (util/commit_graph.h)
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/commit_graph.h"
+
+struct Commit {
+    const char* hash;
+    const char* parents;
+};
+
+static CommitGraph build(const std::vector<Commit>& log) {
+    CommitGraph graph;
+    for (const auto& c : log) graph.add(c.hash, c.parents);
+    return graph;
+}
+
+static bool has_edge(const CommitGraph::Window& w, uint32_t row, uint32_t from,
+                     uint32_t to) {
+    for (const auto& e : w.edges) {
+        if (e.row == row && e.from == from && e.to == to) return true;
+    }
+    return false;
+}
+
+static bool has_span(const CommitGraph::Window& w, uint32_t lane, uint32_t fromRow,
+                     uint32_t toRow) {
+    for (const auto& s : w.spans) {
+        if (s.lane == lane && s.fromRow == fromRow && s.toRow == toRow) return true;
+    }
+    return false;
+}
+
+// ===========================================================================
+// Layout
+// ===========================================================================
+
+TEST(linear_history_is_one_lane) {
+    auto graph = build({{"c", "b"}, {"b", "a"}, {"a", ""}});
+    ASSERT_EQ(graph.width(), 1u);
+    ASSERT_EQ(graph.open_lanes(), static_cast<size_t>(0));
+    CommitGraph::Window w;
+    graph.query(0, 3, w);
+    ASSERT_EQ(w.spans.size(), static_cast<size_t>(1));
+    ASSERT_TRUE(has_span(w, 0, 0, 2));
+    ASSERT_TRUE(w.edges.empty());
+    ASSERT_EQ(w.lanes, 1u);
+}
+
+TEST(merge_opens_a_lane_that_rejoins) {
+    // m merges f into the main line; f and b both come from a
+    auto graph = build({{"m", "b f"}, {"b", "a"}, {"f", "a"}, {"a", ""}});
+    ASSERT_EQ(graph.lane(0), 0u);
+    ASSERT_EQ(graph.lane(1), 0u);
+    ASSERT_EQ(graph.lane(2), 1u);
+    ASSERT_EQ(graph.lane(3), 0u);
+
+    CommitGraph::Window w;
+    graph.query(0, 4, w);
+    ASSERT_TRUE(has_edge(w, 0, 0, 1));  // m -> f's lane
+    ASSERT_TRUE(has_edge(w, 2, 1, 0));  // f's lane converges on a
+    ASSERT_TRUE(has_span(w, 0, 0, 3));
+    ASSERT_TRUE(has_span(w, 1, 1, 2));
+    ASSERT_EQ(w.lanes, 2u);
+}
+
+TEST(merge_joins_a_lane_already_waiting) {
+    // Two branch tips (x, y) both waiting for p; m merges x and p
+    auto graph = build({{"y", "p"}, {"m", "x p"}, {"x", "p"}, {"p", ""}});
+    ASSERT_EQ(graph.lane(0), 0u);
+    ASSERT_EQ(graph.lane(1), 1u);
+    CommitGraph::Window w;
+    graph.query(0, 4, w);
+    ASSERT_TRUE(has_edge(w, 1, 1, 0));  // m's second parent uses y's lane
+    ASSERT_EQ(graph.width(), 2u);
+    ASSERT_EQ(graph.lane(3), 0u);
+}
+
+TEST(octopus_and_duplicate_parents) {
+    auto graph = build({{"o", "a b c b"}, {"a", ""}, {"b", ""}, {"c", ""}});
+    ASSERT_EQ(graph.width(), 3u);
+    CommitGraph::Window w;
+    graph.query(0, 1, w);
+    ASSERT_EQ(w.edges.size(), static_cast<size_t>(2));
+    ASSERT_TRUE(has_edge(w, 0, 0, 1));
+    ASSERT_TRUE(has_edge(w, 0, 0, 2));
+}
+
+TEST(freed_lanes_are_reused_from_the_left) {
+    auto graph = build({{"t1", "r1"}, {"r1", ""}, {"t2", "r2"}, {"t3", "r3"}, {"r2", ""}});
+    ASSERT_EQ(graph.lane(2), 0u);  // t1's lane closed at r1
+    ASSERT_EQ(graph.lane(3), 1u);
+    ASSERT_EQ(graph.open_lanes(), static_cast<size_t>(1));  // Waiting for r3
+}
+
+TEST(unloaded_parents_stay_open) {
+    auto graph = build({{"c", "b"}, {"b", "a"}});
+    CommitGraph::Window w;
+    graph.query(0, 2, w);
+    ASSERT_TRUE(has_span(w, 0, 0, CommitGraph::OPEN));
+    ASSERT_EQ(graph.open_lanes(), static_cast<size_t>(1));
+}
+
+// ===========================================================================
+// Incremental
+// ===========================================================================
+
+TEST(paged_build_matches_full_build) {
+    std::vector<std::pair<std::string, std::string>> log;
+    // Main line with a side branch merged every 7 commits
+    for (int i = 0; i < 600; ++i) {
+        std::string parents = "m" + std::to_string(i + 1);
+        if (i % 7 == 0) parents += " s" + std::to_string(i);
+        log.emplace_back("m" + std::to_string(i), parents);
+        if (i % 7 == 3) log.emplace_back("s" + std::to_string(i - 3), "m" + std::to_string(i + 2));
+    }
+    CommitGraph full, paged;
+    for (const auto& [h, p] : log) full.add(h, p);
+    for (size_t i = 0; i < log.size(); ++i) {
+        paged.add(log[i].first, log[i].second);
+        if (i % 100 == 0) {
+            CommitGraph::Window w;  // Queries between pages don't disturb state
+            paged.query(0, static_cast<uint32_t>(paged.size()), w);
+        }
+    }
+    ASSERT_EQ(paged.size(), full.size());
+    CommitGraph::Window a, b;
+    for (uint32_t first : {0u, 255u, 256u, 300u, 650u}) {
+        full.query(first, first + 40, a);
+        paged.query(first, first + 40, b);
+        ASSERT_EQ(a.spans.size(), b.spans.size());
+        ASSERT_EQ(a.edges.size(), b.edges.size());
+        ASSERT_EQ(a.lanes, b.lanes);
+        ASSERT_FALSE(a.spans.empty());
+    }
+}
+
+TEST(prepended_run_matches_full_build) {
+    // Same history as paged_build_matches_full_build, with 300 more commits
+    // on top of the main line arriving in two fast-forwards
+    std::vector<std::pair<std::string, std::string>> log;
+    for (int i = 0; i < 300; ++i) {
+        log.emplace_back("n" + std::to_string(i),
+                         i + 1 < 300 ? "n" + std::to_string(i + 1) : "m0");
+    }
+    for (int i = 0; i < 600; ++i) {
+        std::string parents = "m" + std::to_string(i + 1);
+        if (i % 7 == 0) parents += " s" + std::to_string(i);
+        log.emplace_back("m" + std::to_string(i), parents);
+        if (i % 7 == 3) log.emplace_back("s" + std::to_string(i - 3), "m" + std::to_string(i + 2));
+    }
+    CommitGraph full, prepended;
+    for (const auto& [h, p] : log) full.add(h, p);
+    for (size_t i = 300; i < 500; ++i) prepended.add(log[i].first, log[i].second);
+    prepended.prepend_linear(250);
+    prepended.prepend_linear(50);
+    for (size_t i = 500; i < log.size(); ++i) prepended.add(log[i].first, log[i].second);
+
+    ASSERT_EQ(prepended.size(), full.size());
+    for (uint32_t row : {0u, 299u, 300u, 301u, 800u}) {
+        ASSERT_EQ(prepended.lane(row), full.lane(row));
+    }
+    CommitGraph::Window a, b;
+    for (uint32_t first : {0u, 40u, 290u, 300u, 301u, 555u, 556u, 600u, 950u}) {
+        full.query(first, first + 40, a);
+        prepended.query(first, first + 40, b);
+        ASSERT_EQ(a.spans.size(), b.spans.size());
+        for (const auto& s : a.spans) ASSERT_TRUE(has_span(b, s.lane, s.fromRow, s.toRow));
+        ASSERT_EQ(a.edges.size(), b.edges.size());
+        for (const auto& e : a.edges) ASSERT_TRUE(has_edge(b, e.row, e.from, e.to));
+        ASSERT_EQ(a.lanes, b.lanes);
+    }
+}
+
+TEST(window_only_holds_what_it_touches) {
+    auto graph = build({{"c", "b"}, {"b", "a"}, {"a", ""}, {"z", "y"}, {"y", ""}});
+    CommitGraph::Window w;
+    graph.query(3, 5, w);
+    ASSERT_EQ(w.spans.size(), static_cast<size_t>(1));
+    ASSERT_TRUE(has_span(w, 0, 3, 4));
+    graph.query(10, 20, w);
+    ASSERT_TRUE(w.spans.empty());
+}
+
+// ===========================================================================
+// Scale
+// ===========================================================================
+
+TEST(many_concurrent_branches_query_fast) {
+    // 2000 branches open at once: each tip waits for a fork point far below
+    constexpr int BRANCHES = 2000;
+    constexpr int DEPTH = 100;
+    CommitGraph graph;
+    std::string h, p;
+    for (int d = 0; d < DEPTH; ++d) {
+        for (int b = 0; b < BRANCHES; ++b) {
+            h = "b" + std::to_string(b) + "_" + std::to_string(d);
+            p = d + 1 < DEPTH ? "b" + std::to_string(b) + "_" + std::to_string(d + 1)
+                              : std::string("root");
+            graph.add(h, p);
+        }
+    }
+    graph.add("root", "");
+    ASSERT_EQ(graph.size(), static_cast<size_t>(BRANCHES * DEPTH + 1));
+    ASSERT_EQ(graph.width(), static_cast<uint32_t>(BRANCHES));
+    ASSERT_EQ(graph.open_lanes(), static_cast<size_t>(0));
+
+    CommitGraph::Window w;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t first = 1000; first < graph.size(); first += 9973) {
+        graph.query(first, first + 60, w);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(w.lanes, static_cast<uint32_t>(BRANCHES));
+    // 21 windows; each is ~2000 open lanes plus the window itself
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(50));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== commit_graph tests ===\n");
+    RUN_ALL_TESTS();
+}
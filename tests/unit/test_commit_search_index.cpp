@@ -0,0 +1,251 @@
+// Unit tests for the commit search index (util/commit_search_index.h)
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/commit_search_index.h"
+
+static std::string hex_hash(int n) {
+    char buf[41];
+    snprintf(buf, sizeof(buf), "%08x%032x", n, n * 2654435761u);
+    return buf;
+}
+
+static std::string record(const std::string& hash, const std::string& author,
+                          long long time, const std::string& subject,
+                          const std::string& body = "") {
+    return hash + '\x1f' + author + '\x1f' + std::to_string(time) + '\x1f' +
+           subject + '\x1f' + body + "\x1e\n";
+}
+
+// 2024-01-01, -02-01, -03-01 and -04-01 UTC
+static const long long JAN = 1704067200, FEB = 1706745600, MAR = 1709251200,
+                       APR = 1711929600;
+
+static void sample(CommitSearchIndex& index) {
+    CommitSearchIndex::Ingest ingest(index);
+    ingest.feed(record("deadbeef" + std::string(32, '0'), "Ann Lee <ann@x.org>", APR,
+                       "Fix crash in sidebar scrolling",
+                       "The scroll offset overflowed.\n\nFixes #12\n"));
+    ingest.feed(record(hex_hash(2), "Bob Stone <bob@y.org>", MAR,
+                       "Add commit search box"));
+    ingest.feed(record(hex_hash(3), "Ann Lee <ann@x.org>", FEB,
+                       "Refactor diff parser", "Crashing input now handled"));
+    ingest.feed(record(hex_hash(4), "Cy <cy@z.org>", JAN, "Initial commit"));
+    ingest.finish();
+    index.seal();
+}
+
+static std::vector<std::string> subjects(const CommitSearchIndex& index,
+                                         const std::string& query, size_t limit = 10) {
+    std::vector<std::string> out;
+    for (auto id : index.search(CommitSearchIndex::parse_query(query), limit)) {
+        out.emplace_back(index.subject(id));
+    }
+    return out;
+}
+
+// ===========================================================================
+// Query parsing
+// ===========================================================================
+
+TEST(parse_query_splits_words_and_filters) {
+    auto q = CommitSearchIndex::parse_query("Fix the-Crash a author:Ann after:2024-02 before:2024");
+    ASSERT_EQ(q.words.size(), static_cast<size_t>(3));  // "a" is dropped
+    ASSERT_STREQ(q.words[0].c_str(), "fix");
+    ASSERT_STREQ(q.words[2].c_str(), "crash");
+    ASSERT_EQ(q.authors.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(q.authors[0].c_str(), "ann");
+    ASSERT_EQ(q.after, FEB);
+    ASSERT_EQ(q.before, JAN);
+}
+
+TEST(parse_query_ignores_bad_dates_and_blank_input) {
+    auto q = CommitSearchIndex::parse_query("after:yesterday before:2024-13-01");
+    ASSERT_TRUE(q.empty());
+    ASSERT_TRUE(CommitSearchIndex::parse_query("   ").empty());
+}
+
+// ===========================================================================
+// Ingest
+// ===========================================================================
+
+TEST(ingest_handles_records_split_across_chunks) {
+    std::string stream = record(hex_hash(1), "A <a@x>", JAN, "first one") +
+                         record(hex_hash(2), "B <b@x>", FEB, "second one", "body\x1fwith sep");
+    CommitSearchIndex index;
+    CommitSearchIndex::Ingest ingest(index);
+    for (size_t i = 0; i < stream.size(); i += 7) ingest.feed(stream.substr(i, 7));
+    ingest.finish();
+    ASSERT_EQ(ingest.added(), static_cast<size_t>(2));
+    ASSERT_STREQ(std::string(index.subject(1)).c_str(), "second one");
+    ASSERT_STREQ(std::string(index.author(0)).c_str(), "A <a@x>");
+    ASSERT_STREQ(index.hash(1).c_str(), hex_hash(2).c_str());
+    ASSERT_EQ(index.author_time(1), FEB);
+}
+
+TEST(add_rejects_malformed_hashes) {
+    CommitSearchIndex index;
+    ASSERT_EQ(index.add("xyz", "a", 0, "s", ""), CommitSearchIndex::NONE);
+    ASSERT_EQ(index.add(hex_hash(1), "a", 0, "s", ""), static_cast<CommitSearchIndex::CommitId>(0));
+    ASSERT_EQ(index.add("abcd", "a", 0, "s", ""), CommitSearchIndex::NONE);
+    ASSERT_EQ(index.size(), static_cast<size_t>(1));
+}
+
+// ===========================================================================
+// Search
+// ===========================================================================
+
+TEST(search_matches_word_prefixes_newest_first) {
+    CommitSearchIndex index;
+    sample(index);
+    auto got = subjects(index, "crash");
+    ASSERT_EQ(got.size(), static_cast<size_t>(2));  // "crash" and "crashing"
+    ASSERT_STREQ(got[0].c_str(), "Fix crash in sidebar scrolling");
+    ASSERT_STREQ(got[1].c_str(), "Refactor diff parser");
+
+    ASSERT_EQ(subjects(index, "COMMIT").size(), static_cast<size_t>(2));
+    ASSERT_EQ(subjects(index, "commit search").size(), static_cast<size_t>(1));
+    ASSERT_TRUE(subjects(index, "commit parser").empty());
+    ASSERT_EQ(subjects(index, "crash", 1).size(), static_cast<size_t>(1));
+}
+
+TEST(search_matches_hash_prefixes) {
+    CommitSearchIndex index;
+    sample(index);
+    auto got = subjects(index, "DEADB");
+    ASSERT_EQ(got.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(got[0].c_str(), "Fix crash in sidebar scrolling");
+    ASSERT_TRUE(index.contains("deadbeef" + std::string(32, '0')));
+    ASSERT_FALSE(index.contains("deadbeef"));
+}
+
+TEST(search_applies_author_and_date_filters) {
+    CommitSearchIndex index;
+    sample(index);
+    ASSERT_EQ(subjects(index, "author:ann").size(), static_cast<size_t>(2));
+    ASSERT_EQ(subjects(index, "crash author:bob").size(), static_cast<size_t>(0));
+    ASSERT_EQ(subjects(index, "author:nobody").size(), static_cast<size_t>(0));
+
+    auto got = subjects(index, "after:2024-02 before:2024-04");
+    ASSERT_EQ(got.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(got[0].c_str(), "Add commit search box");
+    ASSERT_STREQ(got[1].c_str(), "Refactor diff parser");
+}
+
+TEST(unsealed_commits_are_searchable) {
+    CommitSearchIndex index;
+    sample(index);
+    index.add(hex_hash(9), "Dee <d@x>", APR + 10, "Tune sidebar cache", "");
+    ASSERT_STREQ(subjects(index, "sideb")[0].c_str(), "Tune sidebar cache");
+    ASSERT_EQ(subjects(index, hex_hash(9).substr(0, 8)).size(), static_cast<size_t>(1));
+    index.seal();
+    ASSERT_EQ(subjects(index, "sideb").size(), static_cast<size_t>(2));
+}
+
+TEST(append_merges_a_separately_built_batch) {
+    CommitSearchIndex index;
+    sample(index);
+    CommitSearchIndex batch;
+    CommitSearchIndex::Ingest ingest(batch);
+    ingest.feed(record(hex_hash(9), "Ann Lee <ann@x.org>", APR + 10, "Tune sidebar cache"));
+    ingest.feed(record(hex_hash(8), "Eve <e@x>", APR + 5, "Crash fix for search"));
+    ingest.finish();
+
+    ASSERT_TRUE(index.append(batch));
+    index.seal();
+    ASSERT_EQ(index.size(), static_cast<size_t>(6));
+    ASSERT_STREQ(std::string(index.subject(5)).c_str(), "Crash fix for search");
+    ASSERT_STREQ(std::string(index.author(4)).c_str(), "Ann Lee <ann@x.org>");
+    ASSERT_STREQ(index.hash(4).c_str(), hex_hash(9).c_str());
+    ASSERT_EQ(subjects(index, "sideb").size(), static_cast<size_t>(2));
+    ASSERT_EQ(subjects(index, "crash").size(), static_cast<size_t>(3));
+    ASSERT_EQ(subjects(index, "author:ann").size(), static_cast<size_t>(3));
+    ASSERT_EQ(subjects(index, hex_hash(8).substr(0, 8)).size(), static_cast<size_t>(1));
+
+    CommitSearchIndex shortHashes;
+    shortHashes.add("abcd", "a", 0, "other", "");
+    ASSERT_FALSE(index.append(shortHashes));
+    ASSERT_EQ(index.size(), static_cast<size_t>(6));
+}
+
+// ===========================================================================
+// Persistence
+// ===========================================================================
+
+TEST(write_read_round_trip) {
+    CommitSearchIndex index;
+    sample(index);
+    std::stringstream buf;
+    ASSERT_TRUE(index.write(buf, hex_hash(1)));
+
+    CommitSearchIndex loaded;
+    std::string tip;
+    ASSERT_TRUE(CommitSearchIndex::read(buf, loaded, tip));
+    ASSERT_STREQ(tip.c_str(), hex_hash(1).c_str());
+    ASSERT_EQ(loaded.size(), index.size());
+    ASSERT_EQ(loaded.term_count(), index.term_count());
+    ASSERT_EQ(subjects(loaded, "crash author:ann").size(), static_cast<size_t>(2));
+    ASSERT_EQ(subjects(loaded, "deadbe").size(), static_cast<size_t>(1));
+
+    // Catching up after a reload
+    loaded.add(hex_hash(5), "Ann Lee <ann@x.org>", APR + 1, "Crash fix follow-up", "");
+    ASSERT_EQ(subjects(loaded, "crash").size(), static_cast<size_t>(3));
+}
+
+TEST(read_rejects_garbage_and_truncation) {
+    CommitSearchIndex index;
+    sample(index);
+    std::stringstream buf;
+    index.write(buf, "tip");
+    std::string bytes = buf.str();
+
+    CommitSearchIndex loaded;
+    std::string tip;
+    std::stringstream garbage("not an index at all");
+    ASSERT_FALSE(CommitSearchIndex::read(garbage, loaded, tip));
+    std::stringstream cut(bytes.substr(0, bytes.size() - 5));
+    ASSERT_FALSE(CommitSearchIndex::read(cut, loaded, tip));
+    ASSERT_EQ(loaded.size(), static_cast<size_t>(0));
+}
+
+// ===========================================================================
+// Scale
+// ===========================================================================
+
+TEST(large_history_queries_stay_fast) {
+    const char* words[] = {"fix", "add", "remove", "refactor", "update", "sidebar",
+                           "diff", "parser", "cache", "render", "commit", "branch"};
+    CommitSearchIndex index;
+    std::string subject;
+    for (int i = 0; i < 300000; ++i) {
+        subject = std::string(words[i % 12]) + " " + words[(i / 12) % 12] + " item" +
+                  std::to_string(i);
+        index.add(hex_hash(i), "Dev " + std::to_string(i % 2000) + " <d@x>",
+                  JAN + 300000 - i, subject, "");
+    }
+    index.seal();
+
+    auto start = std::chrono::steady_clock::now();
+    auto broad = index.search(CommitSearchIndex::parse_query("fix sidebar"), 500);
+    auto narrow = index.search(CommitSearchIndex::parse_query("item12345"), 500);
+    auto author = index.search(CommitSearchIndex::parse_query("cache author:dev 7"), 500);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_EQ(broad.size(), static_cast<size_t>(500));
+    ASSERT_STREQ(std::string(index.subject(broad[0])).c_str(), "sidebar fix item5");  // Word order is free
+    ASSERT_EQ(narrow.size(), static_cast<size_t>(11));  // item12345, item123450..9
+    ASSERT_FALSE(author.empty());
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(100));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== commit_search_index tests ===\n");
+    RUN_ALL_TESTS();
+}
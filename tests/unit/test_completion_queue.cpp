@@ -0,0 +1,95 @@
+// Unit tests for MpscQueue (completion queue drained by the UI thread).
+
+#include <thread>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/completion_queue.h"
+
+// ===========================================================================
+// Single-threaded behaviour
+// ===========================================================================
+
+TEST(mpsc_empty_drain_is_noop) {
+    MpscQueue<int> q;
+    ASSERT_TRUE(q.empty());
+    int calls = 0;
+    ASSERT_EQ(q.drain([&](int&) { ++calls; }), static_cast<size_t>(0));
+    ASSERT_EQ(calls, 0);
+}
+
+TEST(mpsc_drain_preserves_push_order) {
+    MpscQueue<int> q;
+    for (int i = 0; i < 5; ++i) q.push(i);
+    ASSERT_FALSE(q.empty());
+
+    std::vector<int> seen;
+    ASSERT_EQ(q.drain([&](int& v) { seen.push_back(v); }), static_cast<size_t>(5));
+    ASSERT_EQ(seen.size(), static_cast<size_t>(5));
+    for (int i = 0; i < 5; ++i) ASSERT_EQ(seen[static_cast<size_t>(i)], i);
+    ASSERT_TRUE(q.empty());
+}
+
+TEST(mpsc_pushed_counter_is_monotonic) {
+    MpscQueue<int> q;
+    q.push(1);
+    q.push(2);
+    q.drain([](int&) {});
+    q.push(3);
+    ASSERT_EQ(q.pushed(), static_cast<size_t>(3));
+}
+
+TEST(mpsc_push_during_drain_lands_in_next_drain) {
+    MpscQueue<int> q;
+    q.push(1);
+    size_t first = q.drain([&](int& v) { q.push(v + 10); });
+    ASSERT_EQ(first, static_cast<size_t>(1));
+
+    std::vector<int> seen;
+    q.drain([&](int& v) { seen.push_back(v); });
+    ASSERT_EQ(seen.size(), static_cast<size_t>(1));
+    ASSERT_EQ(seen[0], 11);
+}
+
+// ===========================================================================
+// Concurrent producers
+// ===========================================================================
+
+TEST(mpsc_many_producers_deliver_everything) {
+    constexpr int PRODUCERS = 8;
+    constexpr int PER_PRODUCER = 2000;
+    MpscQueue<int> q;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&q, p] {
+            for (int i = 0; i < PER_PRODUCER; ++i) q.push(p * PER_PRODUCER + i);
+        });
+    }
+
+    // Consume concurrently with the producers, like the UI thread would.
+    std::vector<int> lastPerProducer(PRODUCERS, -1);
+    bool ordered = true;
+    size_t total = 0;
+    auto consume = [&](int& v) {
+        int p = v / PER_PRODUCER;
+        if (v <= lastPerProducer[static_cast<size_t>(p)]) ordered = false;
+        lastPerProducer[static_cast<size_t>(p)] = v;
+        ++total;
+    };
+    while (total < static_cast<size_t>(PRODUCERS * PER_PRODUCER)) {
+        q.drain(consume);
+    }
+    for (auto& t : threads) t.join();
+
+    ASSERT_EQ(total, static_cast<size_t>(PRODUCERS * PER_PRODUCER));
+    ASSERT_TRUE(ordered);  // Each producer's items arrive in its push order
+    ASSERT_TRUE(q.empty());
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== completion_queue tests ===\n");
+    RUN_ALL_TESTS();
+}
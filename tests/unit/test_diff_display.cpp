@@ -0,0 +1,303 @@
+// Unit tests for ui::build_diff_display (render-ready diff rows).
+//
+// The display model is pure data (no rendering), built from parsed FileDiffs.
+
+#include "test_framework.h"
+#include "../../src/ui/diff_display.h"
+#include "../../src/ecs/components.h"
+
+namespace {
+
+ecs::FileDiff make_file(const std::string& path,
+                        std::vector<std::string> lines,
+                        int oldStart = 10, int newStart = 20) {
+    ecs::FileDiff fd;
+    fd.filePath = path;
+    ecs::DiffHunk hunk;
+    hunk.oldStart = oldStart;
+    hunk.newStart = newStart;
+    hunk.header = "@@ -10 +20 @@";
+    hunk.lines = std::move(lines);
+    for (auto& l : hunk.lines) {
+        if (!l.empty() && l[0] == '+') fd.additions++;
+        if (!l.empty() && l[0] == '-') fd.deletions++;
+    }
+    fd.hunks.push_back(std::move(hunk));
+    return fd;
+}
+
+}  // namespace
+
+// ===========================================================================
+// Row layout
+// ===========================================================================
+
+TEST(empty_diff_has_only_stats_header) {
+    auto model = ui::build_diff_display({});
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(1));
+    ASSERT_TRUE(model.rows[0].kind == ui::DiffRowKind::StatsHeader);
+    ASSERT_EQ(model.rows[0].label, std::string("0 files changed  +0  -0"));
+}
+
+TEST(rows_are_laid_out_contiguously) {
+    std::vector<ecs::FileDiff> diffs = {
+        make_file("a.txt", {" ctx", "-old", "+new"}),
+        make_file("b.txt", {"+x"}),
+    };
+    auto model = ui::build_diff_display(diffs);
+
+    // stats, (file, hunk, 3 lines), spacer, (file, hunk, 1 line)
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(10));
+    float y = 0.0f;
+    for (auto& row : model.rows) {
+        ASSERT_TRUE(row.y == y);
+        y += row.height;
+    }
+    ASSERT_TRUE(model.totalHeight == y);
+    ASSERT_TRUE(model.rows[6].kind == ui::DiffRowKind::FileSpacer);
+    ASSERT_EQ(model.totalAdditions, 2);
+    ASSERT_EQ(model.totalDeletions, 1);
+}
+
+TEST(no_spacer_after_last_file) {
+    auto model = ui::build_diff_display({make_file("a.txt", {"+a"})});
+    ASSERT_TRUE(model.rows.back().kind == ui::DiffRowKind::Line);
+}
+
+TEST(binary_file_gets_notice_and_no_hunks) {
+    ecs::FileDiff fd;
+    fd.filePath = "img.png";
+    fd.isBinary = true;
+    auto model = ui::build_diff_display({fd});
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(3));
+    ASSERT_EQ(model.rows[1].label, std::string("img.png  (binary)"));
+    ASSERT_TRUE(model.rows[2].kind == ui::DiffRowKind::BinaryNotice);
+}
+
+TEST(renamed_file_header_label) {
+    auto fd = make_file("new.txt", {"+a", "-b"});
+    fd.oldPath = "old.txt";
+    fd.isRenamed = true;
+    auto model = ui::build_diff_display({fd});
+    ASSERT_EQ(model.rows[1].label, std::string("old.txt -> new.txt  +1 -1"));
+}
+
+// ===========================================================================
+// Line labels
+// ===========================================================================
+
+TEST(line_numbers_advance_per_side) {
+    auto model = ui::build_diff_display(
+        {make_file("a.txt", {" ctx", "-old", "+new", " end"})});
+    auto& ctx = model.rows[3];
+    auto& del = model.rows[4];
+    auto& add = model.rows[5];
+    auto& end = model.rows[6];
+    ASSERT_EQ(ctx.oldLine, 10);
+    ASSERT_EQ(ctx.newLine, 20);
+    ASSERT_EQ(del.oldLine, 11);
+    ASSERT_EQ(del.newLine, 0);
+    ASSERT_EQ(add.oldLine, 0);
+    ASSERT_EQ(add.newLine, 21);
+    ASSERT_EQ(end.oldLine, 12);
+    ASSERT_EQ(end.newLine, 22);
+    ASSERT_TRUE(del.lineClass == ui::DiffLineClass::Deletion);
+    ASSERT_TRUE(add.lineClass == ui::DiffLineClass::Addition);
+    ASSERT_TRUE(ctx.lineClass == ui::DiffLineClass::Context);
+}
+
+TEST(line_label_matches_gutter_format) {
+    auto model = ui::build_diff_display(
+        {make_file("a.txt", {" hello", "+world"}, 7, 123)});
+    ASSERT_EQ(model.rows[3].label, std::string("    7   123  hello"));
+    ASSERT_EQ(model.rows[4].label, std::string("        124  world"));
+    ASSERT_EQ(std::string(model.rows[4].content()), std::string("world"));
+}
+
+TEST(empty_line_has_empty_content) {
+    auto model = ui::build_diff_display({make_file("a.txt", {"+"})});
+    ASSERT_TRUE(model.rows[3].content().empty());
+}
+
+TEST(wide_line_numbers_are_not_truncated) {
+    auto model = ui::build_diff_display(
+        {make_file("a.txt", {" x"}, 123456, 1)});
+    ASSERT_EQ(model.rows[3].label, std::string("123456     1  x"));
+}
+
+// ===========================================================================
+// Side by side
+// ===========================================================================
+
+TEST(split_pairs_deletions_with_additions) {
+    auto model = ui::build_split_diff_display(
+        {make_file("a.txt", {" ctx", "-a", "-b", "+A", "+B", "+C", " end"})});
+    // stats, file, hunk, ctx, 3 pairs, end
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(8));
+    auto& ctx = model.rows[3];
+    ASSERT_TRUE(ctx.kind == ui::DiffRowKind::LinePair);
+    ASSERT_TRUE(ctx.lineClass == ui::DiffLineClass::Context);
+    ASSERT_TRUE(ctx.rightClass == ui::DiffLineClass::Context);
+    ASSERT_EQ(ctx.oldLine, 10);
+    ASSERT_EQ(ctx.newLine, 20);
+
+    auto& p0 = model.rows[4];
+    ASSERT_TRUE(p0.lineClass == ui::DiffLineClass::Deletion);
+    ASSERT_TRUE(p0.rightClass == ui::DiffLineClass::Addition);
+    ASSERT_EQ(std::string(p0.content()), std::string("a"));
+    ASSERT_EQ(std::string(p0.right_content()), std::string("A"));
+    ASSERT_EQ(p0.oldLine, 11);
+    ASSERT_EQ(p0.newLine, 21);
+
+    auto& p2 = model.rows[6];
+    ASSERT_TRUE(p2.lineClass == ui::DiffLineClass::Filler);
+    ASSERT_TRUE(p2.rightClass == ui::DiffLineClass::Addition);
+    ASSERT_TRUE(p2.left_label().empty());
+    ASSERT_EQ(p2.oldLine, 0);
+    ASSERT_EQ(p2.newLine, 23);
+
+    auto& end = model.rows[7];
+    ASSERT_EQ(end.oldLine, 13);
+    ASSERT_EQ(end.newLine, 24);
+}
+
+TEST(split_extra_deletions_get_filler_on_the_right) {
+    auto model = ui::build_split_diff_display(
+        {make_file("a.txt", {"-a", "-b", "+A"})});
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(5));
+    ASSERT_TRUE(model.rows[4].lineClass == ui::DiffLineClass::Deletion);
+    ASSERT_TRUE(model.rows[4].rightClass == ui::DiffLineClass::Filler);
+    ASSERT_TRUE(model.rows[4].right_label().empty());
+}
+
+TEST(split_additions_before_deletions_are_not_paired) {
+    // Pairing only looks forward from a deletion run
+    auto model = ui::build_split_diff_display(
+        {make_file("a.txt", {"+A", "-a"})});
+    ASSERT_EQ(model.rows.size(), static_cast<size_t>(5));
+    ASSERT_TRUE(model.rows[3].lineClass == ui::DiffLineClass::Filler);
+    ASSERT_TRUE(model.rows[4].rightClass == ui::DiffLineClass::Filler);
+}
+
+TEST(split_half_labels_match_gutter_format) {
+    auto model = ui::build_split_diff_display(
+        {make_file("a.txt", {"-old", "+new"}, 7, 123)});
+    auto& row = model.rows[3];
+    ASSERT_EQ(std::string(row.left_label()), std::string("    7  old"));
+    ASSERT_EQ(std::string(row.right_label()), std::string("  123  new"));
+}
+
+TEST(split_keeps_header_rows_and_height) {
+    std::vector<ecs::FileDiff> diffs = {make_file("a.txt", {" x", "-y", "+z"}),
+                                        make_file("b.txt", {"+w"})};
+    auto inlineModel = ui::build_diff_display(diffs);
+    auto split = ui::build_split_diff_display(diffs);
+    // One pair replaces the -y/+z rows
+    ASSERT_EQ(split.rows.size() + 1, inlineModel.rows.size());
+    ASSERT_TRUE(split.totalHeight < inlineModel.totalHeight);
+    ASSERT_EQ(split.totalAdditions, inlineModel.totalAdditions);
+    ASSERT_TRUE(split.rows[1].kind == ui::DiffRowKind::FileHeader);
+    ASSERT_TRUE(split.rows[5].kind == ui::DiffRowKind::FileSpacer);
+    ASSERT_EQ(split.rows.back().y + split.rows.back().height, split.totalHeight);
+}
+
+TEST(rows_know_their_source_line) {
+    std::vector<ecs::FileDiff> diffs = {make_file("a.txt", {" x", "-y", "+z"})};
+    auto inlineModel = ui::build_diff_display(diffs);
+    ASSERT_EQ(inlineModel.rows[3].lineIndex, 0);
+    ASSERT_EQ(inlineModel.rows[5].lineIndex, 2);
+    auto split = ui::build_split_diff_display(diffs);
+    ASSERT_EQ(split.rows[4].lineIndex, 1);
+    ASSERT_EQ(split.rows[4].rightLineIndex, 2);
+}
+
+// ===========================================================================
+// Word highlights
+// ===========================================================================
+
+TEST(word_highlights_follow_file_and_hunk_order) {
+    std::vector<ecs::FileDiff> diffs = {
+        make_file("a.txt", {" ctx", "-int x = 1;", "+int x = 2;"}),
+        make_file("b.txt", {"+new"})};
+    auto words = ui::build_word_highlights(diffs);
+    ASSERT_EQ(words.files.size(), static_cast<size_t>(2));
+    ASSERT_EQ(words.line(0, 0, 1).size(), static_cast<size_t>(1));
+    ASSERT_EQ(words.line(0, 0, 2)[0].begin, 8u);
+    ASSERT_TRUE(words.line(0, 0, 0).empty());
+    ASSERT_TRUE(words.line(1, 0, 0).empty());
+    ASSERT_TRUE(words.line(5, 0, 0).empty());  // Out of range is empty
+    ASSERT_TRUE(words.approx_bytes() > 0);
+}
+
+TEST(syntax_lines_map_by_side_and_number) {
+    ui::DiffSyntax syn;
+    auto image = std::make_shared<syntax::Highlighted>(
+        syntax::highlight(*syntax::grammar_for_path("a.cpp"), "int a;\nreturn b;"));
+    syn.files.push_back({nullptr, image});
+    ASSERT_EQ(syn.line(0, true, 2).size(), static_cast<size_t>(1));
+    ASSERT_TRUE(syn.line(0, true, 2)[0].kind == syntax::Kind::Keyword);
+    ASSERT_TRUE(syn.line(0, false, 1).empty());  // No pre-image
+    ASSERT_TRUE(syn.line(0, true, 0).empty());
+    ASSERT_TRUE(syn.line(0, true, 9).empty());
+    ASSERT_TRUE(syn.line(1, true, 1).empty());
+}
+
+// ===========================================================================
+// Visible range
+// ===========================================================================
+
+TEST(visible_range_selects_overlapping_rows) {
+    std::vector<std::string> lines(100, "+x");
+    auto model = ui::build_diff_display({make_file("a.txt", lines)});
+    // Row 3 is the first line and starts after stats + file + hunk headers
+    float firstLineY = model.rows[3].y;
+    auto [first, last] = model.visible_range(
+        firstLineY + ui::diff_detail::LINE_HEIGHT * 10.5f,
+        firstLineY + ui::diff_detail::LINE_HEIGHT * 20.0f);
+    ASSERT_EQ(first, static_cast<size_t>(13));
+    ASSERT_EQ(last, static_cast<size_t>(23));
+}
+
+TEST(visible_range_clamps_to_model) {
+    auto model = ui::build_diff_display({make_file("a.txt", {"+a"})});
+    auto [first, last] = model.visible_range(-100.0f, 1e9f);
+    ASSERT_EQ(first, static_cast<size_t>(0));
+    ASSERT_EQ(last, model.rows.size());
+
+    auto [f2, l2] = model.visible_range(1e9f, 2e9f);
+    ASSERT_EQ(f2, model.rows.size());
+    ASSERT_EQ(l2, model.rows.size());
+}
+
+// ===========================================================================
+// Columns
+// ===========================================================================
+
+TEST(lines_record_their_width_in_columns) {
+    std::string minified(50000, 'x');
+    auto model = ui::build_diff_display(
+        {make_file("a.js", {" short", "+" + minified, "-caf\xc3\xa9"})});
+    ASSERT_EQ(model.rows[3].columns, 5u);
+    ASSERT_EQ(model.rows[4].columns, 50000u);
+    ASSERT_EQ(model.rows[5].columns, 4u);  // Multi-byte character is one column
+    ASSERT_EQ(model.widestLine, model.rows[4].contentOffset + 50000u);
+}
+
+TEST(column_bytes_slices_by_character) {
+    std::string_view text = "a\xc3\xa9" "bc";  // a, e-acute, b, c
+    ASSERT_EQ(ui::text_columns(text), static_cast<size_t>(4));
+    auto [b1, e1] = ui::column_bytes(text, 1, 3);
+    ASSERT_EQ(std::string(text.substr(b1, e1 - b1)), std::string("\xc3\xa9" "b"));
+    auto [b2, e2] = ui::column_bytes(text, 2, 100);
+    ASSERT_EQ(std::string(text.substr(b2, e2 - b2)), std::string("bc"));
+    auto [b3, e3] = ui::column_bytes(text, 10, 20);
+    ASSERT_EQ(b3, text.size());
+    ASSERT_EQ(e3, text.size());
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== diff_display tests ===\n");
+    RUN_ALL_TESTS();
+}
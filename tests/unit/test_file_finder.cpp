@@ -0,0 +1,211 @@
+// Unit tests for the fuzzy file finder (util/file_finder.h)
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/file_finder.h"
+
+static FileFinder sample() {
+    FileFinder finder;
+    for (const char* p : {"src/main.cpp", "src/ecs/sidebar_system.h",
+                          "src/ecs/main_content_system.h", "src/ui/theme.h",
+                          "src/util/file_tree.cpp", "src/util/file_tree.h",
+                          "tests/unit/test_file_tree.cpp", "docs/sidebar.md",
+                          "sidebar/README.md", "makefile"}) {
+        finder.add(p);
+    }
+    return finder;
+}
+
+static std::vector<std::string> top(const FileFinder& finder,
+                                    const std::string& query, size_t limit = 10) {
+    std::vector<std::string> out;
+    for (const auto& m : finder.search(query, limit)) {
+        out.emplace_back(finder.path(m.id));
+    }
+    return out;
+}
+
+// ===========================================================================
+// Scoring
+// ===========================================================================
+
+TEST(score_requires_every_word_in_order) {
+    ASSERT_TRUE(FileFinder::score("src/ecs/sidebar_system.h", "sbsys") >= 0);
+    ASSERT_TRUE(FileFinder::score("src/ecs/sidebar_system.h", "ecs side") >= 0);
+    ASSERT_EQ(FileFinder::score("src/ecs/sidebar_system.h", "sidebar zzz"), -1);
+    ASSERT_EQ(FileFinder::score("src/main.cpp", "cpp.main"), -1);
+    ASSERT_EQ(FileFinder::score("src/main.cpp", "   "), -1);
+}
+
+TEST(score_is_case_insensitive) {
+    ASSERT_EQ(FileFinder::score("src/Main.CPP", "main.cpp"),
+              FileFinder::score("src/main.cpp", "MAIN.cpp"));
+}
+
+TEST(score_prefers_name_runs_and_word_starts) {
+    // Whole word in the file name beats the same letters scattered
+    ASSERT_TRUE(FileFinder::score("src/theme.h", "theme") >
+                FileFinder::score("src/the_mesh.h", "theme"));
+    ASSERT_TRUE(FileFinder::score("src/file_tree.h", "ft") >
+                FileFinder::score("src/fat.h", "ft"));
+    // File name match outranks a directory-only match
+    ASSERT_TRUE(FileFinder::score("docs/sidebar.md", "sidebar") >=
+                FileFinder::NAME_BONUS);
+    ASSERT_TRUE(FileFinder::score("sidebar/README.md", "sidebar") <
+                FileFinder::NAME_BONUS);
+}
+
+// ===========================================================================
+// Search
+// ===========================================================================
+
+TEST(search_ranks_file_names_first) {
+    auto finder = sample();
+    auto got = top(finder, "sidebar");
+    ASSERT_EQ(got.size(), static_cast<size_t>(3));
+    ASSERT_STREQ(got[0].c_str(), "docs/sidebar.md");  // Shortest name match
+    ASSERT_STREQ(got[1].c_str(), "src/ecs/sidebar_system.h");
+    ASSERT_STREQ(got[2].c_str(), "sidebar/README.md");
+}
+
+TEST(search_multiple_words_and_dirs) {
+    auto finder = sample();
+    auto got = top(finder, "util tree");
+    ASSERT_EQ(got.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(got[0].c_str(), "src/util/file_tree.h");
+
+    got = top(finder, "ecs/main");
+    ASSERT_EQ(got.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(got[0].c_str(), "src/ecs/main_content_system.h");
+}
+
+TEST(search_limit_and_empty_query) {
+    auto finder = sample();
+    ASSERT_EQ(top(finder, "tree", 2).size(), static_cast<size_t>(2));
+    ASSERT_TRUE(top(finder, "").empty());
+    ASSERT_TRUE(top(finder, "qqqq").empty());
+}
+
+TEST(search_short_query_matches_name_prefix) {
+    auto finder = sample();
+    auto got = top(finder, "ma");
+    ASSERT_EQ(got.size(), static_cast<size_t>(3));
+    ASSERT_STREQ(got[0].c_str(), "makefile");
+    ASSERT_STREQ(got[1].c_str(), "src/main.cpp");
+    ASSERT_STREQ(got[2].c_str(), "src/ecs/main_content_system.h");
+}
+
+TEST(search_falls_back_for_abbreviations) {
+    auto finder = sample();
+    auto got = top(finder, "sbsys");
+    ASSERT_EQ(got.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(got[0].c_str(), "src/ecs/sidebar_system.h");
+}
+
+// ===========================================================================
+// Incremental updates
+// ===========================================================================
+
+TEST(add_remove_and_revive) {
+    auto finder = sample();
+    ASSERT_EQ(finder.size(), static_cast<size_t>(10));
+    auto id = finder.add("src/ui/theme.h");  // Already present
+    ASSERT_EQ(finder.size(), static_cast<size_t>(10));
+
+    ASSERT_TRUE(finder.remove("src/ui/theme.h"));
+    ASSERT_FALSE(finder.remove("src/ui/theme.h"));
+    ASSERT_FALSE(finder.contains("src/ui/theme.h"));
+    ASSERT_TRUE(top(finder, "theme").empty());
+
+    ASSERT_EQ(finder.add("src/ui/theme.h"), id);
+    ASSERT_EQ(top(finder, "theme").size(), static_cast<size_t>(1));
+
+    finder.add("notes/theme_ideas.txt");
+    ASSERT_EQ(top(finder, "theme").size(), static_cast<size_t>(2));
+    ASSERT_EQ(finder.size(), static_cast<size_t>(11));
+}
+
+TEST(clear_empties_everything) {
+    auto finder = sample();
+    finder.clear();
+    ASSERT_EQ(finder.size(), static_cast<size_t>(0));
+    ASSERT_TRUE(top(finder, "main").empty());
+    finder.add("a/b.txt");
+    ASSERT_EQ(top(finder, "b.txt").size(), static_cast<size_t>(1));
+}
+
+// ===========================================================================
+// Scale
+// ===========================================================================
+
+TEST(million_paths_top_matches) {
+    FileFinder finder;
+    std::string path;
+    for (int i = 0; i < 1000000; ++i) {
+        path = "pkg" + std::to_string(i % 500) + "/src/mod" +
+               std::to_string(i % 37) + "/file" + std::to_string(i) + ".cc";
+        finder.add(path);
+    }
+    finder.add("pkg7/src/special_widget.cc");
+    finder.reorder();
+    ASSERT_EQ(finder.size(), static_cast<size_t>(1000001));
+
+    // Interactive budget is 5 ms a query; leave headroom for -O0 and slow CI
+    auto timed = [&finder](const char* query) {
+        auto start = std::chrono::steady_clock::now();
+        auto matches = finder.search(query, 20);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed >= std::chrono::milliseconds(50)) {
+            printf("    \"%s\" took %lld ms\n", query,
+                   static_cast<long long>(std::chrono::duration_cast<
+                       std::chrono::milliseconds>(elapsed).count()));
+        }
+        ASSERT_TRUE(elapsed < std::chrono::milliseconds(50));
+        return matches;
+    };
+
+    auto got = timed("widget");
+    ASSERT_EQ(got.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(std::string(finder.path(got[0].id)).c_str(),
+                 "pkg7/src/special_widget.cc");
+    auto named = timed("file12345");
+    ASSERT_EQ(named.size(), static_cast<size_t>(11));  // file12345, file123450..9
+    ASSERT_STREQ(std::string(finder.path(named[0].id)).c_str(),
+                 "pkg345/src/mod24/file12345.cc");
+
+    // Broad: every path matches, the shortest good hits come back
+    for (const char* query : {"file", "mod", "srcfile", "src", "fi"}) {
+        auto broad = timed(query);
+        ASSERT_EQ(broad.size(), static_cast<size_t>(20));
+        ASSERT_STREQ(std::string(finder.path(broad[0].id)).c_str(),
+                     "pkg0/src/mod0/file0.cc");
+    }
+
+    // No match: rejected on the character mask alone
+    ASSERT_TRUE(timed("zzz").empty());
+    ASSERT_TRUE(timed("sbsys").empty());
+}
+
+TEST(search_stops_when_cancelled) {
+    FileFinder finder;
+    for (int i = 0; i < 100000; ++i) finder.add("src/file" + std::to_string(i) + ".cc");
+    finder.reorder();
+    std::atomic<bool> cancel{true};
+    // "elif" passes every path's character mask but matches none
+    ASSERT_TRUE(finder.search("elif", 20, &cancel).empty());
+    ASSERT_EQ(finder.search("file", 20, &cancel).size(), static_cast<size_t>(0));
+    cancel = false;
+    ASSERT_EQ(finder.search("file", 20, &cancel).size(), static_cast<size_t>(20));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== file_finder tests ===\n");
+    RUN_ALL_TESTS();
+}
@@ -0,0 +1,238 @@
+// Unit tests for the sidebar Tree view model (util/file_tree.h)
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/file_tree.h"
+
+using Leaf = FileTree::Leaf;
+
+static std::vector<std::string> visible(const FileTree& tree) {
+    std::vector<std::string> out;
+    tree.for_each_visible([&](FileTree::NodeId id, const FileTree::Node& n) {
+        out.push_back(std::string(n.depth * 2, ' ') + tree.name(id) +
+                      (n.isDir ? "/" : ""));
+    });
+    return out;
+}
+
+static FileTree sample() {
+    FileTree tree;
+    tree.build({{"src/ui/a.cpp", Leaf{'M', 3, 1}},
+                {"src/main.cpp", Leaf{'M', 1, 0}},
+                {"README.md", Leaf{'A', 10, 0}},
+                {"src/ui/b.cpp", Leaf{'D', 0, 7}}});
+    return tree;
+}
+
+// ===========================================================================
+// Building and counts
+// ===========================================================================
+
+TEST(build_aggregates_counts) {
+    auto tree = sample();
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(4));
+    auto ui = tree.find("src/ui");
+    ASSERT_TRUE(ui != FileTree::NONE);
+    ASSERT_TRUE(tree.node(ui).isDir);
+    ASSERT_EQ(tree.node(ui).fileCount, 2u);
+    ASSERT_EQ(tree.node(ui).additions, 3);
+    ASSERT_EQ(tree.node(ui).deletions, 8);
+    auto src = tree.find("src");
+    ASSERT_EQ(tree.node(src).fileCount, 3u);
+    ASSERT_EQ(tree.node(src).additions, 4);
+}
+
+TEST(collapsed_by_default_dirs_first) {
+    auto tree = sample();
+    auto rows = visible(tree);
+    ASSERT_EQ(rows.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(rows[0], "src/");
+    ASSERT_STREQ(rows[1], "README.md");
+}
+
+TEST(expanded_walk_order) {
+    auto tree = sample();
+    tree.set_expanded(tree.find("src"), true);
+    tree.set_expanded(tree.find("src/ui"), true);
+    auto rows = visible(tree);
+    ASSERT_EQ(rows.size(), static_cast<size_t>(6));
+    ASSERT_STREQ(rows[0], "src/");
+    ASSERT_STREQ(rows[1], "  ui/");
+    ASSERT_STREQ(rows[2], "    a.cpp");
+    ASSERT_STREQ(rows[3], "    b.cpp");
+    ASSERT_STREQ(rows[4], "  main.cpp");
+    ASSERT_STREQ(rows[5], "README.md");
+}
+
+TEST(path_and_find_roundtrip) {
+    auto tree = sample();
+    auto id = tree.find("src/ui/b.cpp");
+    ASSERT_TRUE(id != FileTree::NONE);
+    ASSERT_STREQ(tree.path(id), "src/ui/b.cpp");
+    ASSERT_EQ(tree.node(id).leaf.status, 'D');
+    ASSERT_TRUE(tree.find("src/nope.cpp") == FileTree::NONE);
+    ASSERT_TRUE(tree.find("") == FileTree::NONE);
+}
+
+TEST(segments_are_interned) {
+    FileTree tree;
+    tree.build({{"a/x/f.txt", Leaf{}}, {"b/x/f.txt", Leaf{}}, {"c/x/f.txt", Leaf{}}});
+    // "", a, b, c, x, f.txt
+    ASSERT_EQ(tree.segment_count(), static_cast<size_t>(6));
+}
+
+// ===========================================================================
+// Incremental updates
+// ===========================================================================
+
+TEST(upsert_new_and_update) {
+    auto tree = sample();
+    tree.upsert("src/ui/c.cpp", Leaf{'A', 5, 0});
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(5));
+    ASSERT_EQ(tree.node(tree.find("src/ui")).additions, 8);
+
+    tree.upsert("src/ui/c.cpp", Leaf{'M', 2, 2});
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(5));
+    ASSERT_EQ(tree.node(tree.find("src/ui")).additions, 5);
+    ASSERT_EQ(tree.node(tree.find("src")).deletions, 10);
+}
+
+TEST(upsert_keeps_sorted_order) {
+    auto tree = sample();
+    tree.upsert("AAA.md", Leaf{});
+    tree.upsert("lib/z.c", Leaf{});
+    auto rows = visible(tree);
+    ASSERT_EQ(rows.size(), static_cast<size_t>(4));
+    ASSERT_STREQ(rows[0], "lib/");
+    ASSERT_STREQ(rows[1], "src/");
+    ASSERT_STREQ(rows[2], "AAA.md");
+    ASSERT_STREQ(rows[3], "README.md");
+}
+
+TEST(remove_prunes_empty_dirs) {
+    auto tree = sample();
+    ASSERT_TRUE(tree.remove("src/ui/a.cpp"));
+    ASSERT_TRUE(tree.find("src/ui") != FileTree::NONE);
+    ASSERT_TRUE(tree.remove("src/ui/b.cpp"));
+    ASSERT_TRUE(tree.find("src/ui") == FileTree::NONE);
+    ASSERT_TRUE(tree.find("src") != FileTree::NONE);
+    ASSERT_EQ(tree.node(tree.find("src")).fileCount, 1u);
+    ASSERT_FALSE(tree.remove("src/ui/b.cpp"));
+    ASSERT_FALSE(tree.remove("src"));
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(2));
+}
+
+TEST(node_slots_are_reused) {
+    auto tree = sample();
+    size_t before = tree.node_count();
+    tree.remove("src/ui/a.cpp");
+    tree.upsert("src/ui/a.cpp", Leaf{});
+    ASSERT_EQ(tree.node_count(), before);
+}
+
+TEST(expansion_survives_updates_and_rebuild) {
+    auto tree = sample();
+    tree.set_expanded(tree.find("src"), true);
+    tree.upsert("src/new.cpp", Leaf{});
+    ASSERT_TRUE(tree.node(tree.find("src")).expanded);
+
+    tree.build({{"src/main.cpp", Leaf{}}, {"docs/x.md", Leaf{}}});
+    ASSERT_TRUE(tree.node(tree.find("src")).expanded);
+    ASSERT_FALSE(tree.node(tree.find("docs")).expanded);
+}
+
+TEST(reveal_expands_ancestors) {
+    auto tree = sample();
+    tree.reveal(tree.find("src/ui/a.cpp"));
+    ASSERT_TRUE(tree.node(tree.find("src")).expanded);
+    ASSERT_TRUE(tree.node(tree.find("src/ui")).expanded);
+}
+
+TEST(version_moves_when_visible_rows_may_change) {
+    auto tree = sample();
+    auto v = tree.version();
+    tree.upsert("src/main.cpp", Leaf{'M', 2, 0});  // Existing file: counts only
+    ASSERT_EQ(tree.version(), v);
+    tree.set_expanded(tree.find("src"), true);
+    ASSERT_TRUE(tree.version() != v);
+    v = tree.version();
+    tree.upsert("src/new.cpp", Leaf{});
+    ASSERT_TRUE(tree.version() != v);
+    v = tree.version();
+    tree.remove("README.md");
+    ASSERT_TRUE(tree.version() != v);
+    v = tree.version();
+    tree.build({{"a.txt", Leaf{}}});
+    ASSERT_TRUE(tree.version() != v);
+}
+
+TEST(file_dir_clash_skipped) {
+    FileTree tree;
+    tree.build({{"a", Leaf{}}, {"a/b", Leaf{}}});
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(1));
+    tree.upsert("a/c", Leaf{});
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(1));
+}
+
+// ===========================================================================
+// Scale
+// ===========================================================================
+
+TEST(large_change_set_collapsed_walk_is_small) {
+    std::vector<std::string> paths;
+    for (int d = 0; d < 100; ++d) {
+        for (int f = 0; f < 1000; ++f) {
+            paths.push_back("dir" + std::to_string(d) + "/sub/file" +
+                            std::to_string(f) + ".txt");
+        }
+    }
+    std::vector<std::pair<std::string_view, Leaf>> entries;
+    entries.reserve(paths.size());
+    for (auto& p : paths) entries.emplace_back(p, Leaf{'M', 1, 1});
+
+    FileTree tree;
+    tree.build(entries);
+    ASSERT_EQ(tree.file_count(), static_cast<size_t>(100000));
+
+    size_t rows = 0;
+    tree.for_each_visible([&](FileTree::NodeId, const FileTree::Node&) { ++rows; });
+    ASSERT_EQ(rows, static_cast<size_t>(100));
+    ASSERT_EQ(tree.node(tree.find("dir7")).additions, 1000);
+}
+
+TEST(visible_walk_stops_at_limit) {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 5000; ++i) paths.push_back("gen/f" + std::to_string(i));
+    paths.push_back("zz.txt");
+    std::vector<std::pair<std::string_view, Leaf>> entries;
+    for (auto& p : paths) entries.emplace_back(p, Leaf{'A', 1, 0});
+
+    FileTree tree;
+    tree.build(entries);
+    tree.set_expanded(tree.find("gen"), true);
+
+    size_t rows = 0;
+    size_t hidden = tree.for_each_visible(
+        [&](FileTree::NodeId, const FileTree::Node&) { ++rows; }, 100);
+    ASSERT_EQ(rows, static_cast<size_t>(100));
+    // 4901 files left in gen/, plus zz.txt at the top level
+    ASSERT_EQ(hidden, static_cast<size_t>(4902));
+
+    rows = 0;
+    ASSERT_EQ(tree.for_each_visible(
+                  [&](FileTree::NodeId, const FileTree::Node&) { ++rows; }),
+              static_cast<size_t>(0));
+    ASSERT_EQ(rows, static_cast<size_t>(5002));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== file_tree tests ===\n");
+    RUN_ALL_TESTS();
+}
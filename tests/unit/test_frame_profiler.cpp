@@ -0,0 +1,151 @@
+// Unit tests for FrameProfiler (per-system timings and Chrome trace export).
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "test_framework.h"
+#include "../../src/util/frame_profiler.h"
+
+using namespace std::chrono_literals;
+using clock_type = FrameProfiler::clock;
+
+// Run one frame with sections a and b taking the given times.
+static void run_frame(FrameProfiler& p, size_t a, size_t b, clock_type::time_point t,
+                      std::chrono::microseconds aDur, std::chrono::microseconds bDur,
+                      uint64_t allocsA = 0) {
+    p.begin_frame(t);
+    p.mark(a, t, 0);
+    p.mark(b, t + aDur, allocsA);
+    p.end_frame(t + aDur + bDur, allocsA);
+}
+
+// ===========================================================================
+// Section timing
+// ===========================================================================
+
+TEST(profiler_sections_span_to_next_mark) {
+    FrameProfiler p;
+    size_t a = p.add_section("A");
+    size_t b = p.add_section("B");
+    run_frame(p, a, b, clock_type::now(), 2000us, 500us, 7);
+
+    auto stats = p.summarize();
+    ASSERT_EQ(stats.size(), static_cast<size_t>(2));
+    ASSERT_EQ(stats[0].name, std::string("A"));
+    ASSERT_TRUE(stats[0].lastMs > 1.99 && stats[0].lastMs < 2.01);
+    ASSERT_TRUE(stats[1].lastMs > 0.49 && stats[1].lastMs < 0.51);
+    ASSERT_TRUE(stats[0].meanAllocs > 6.99 && stats[0].meanAllocs < 7.01);
+    ASSERT_TRUE(stats[1].meanAllocs < 0.01);
+    ASSERT_EQ(p.frames(), static_cast<uint64_t>(1));
+}
+
+TEST(profiler_percentiles_over_window) {
+    FrameProfiler p;
+    size_t a = p.add_section("A");
+    size_t b = p.add_section("B");
+    auto t = clock_type::now();
+    // 99 fast frames and one slow one
+    for (int i = 0; i < 99; ++i) run_frame(p, a, b, t, 1000us, 0us);
+    run_frame(p, a, b, t, 50000us, 0us);
+
+    auto stats = p.summarize();
+    ASSERT_TRUE(stats[0].p50Ms > 0.99 && stats[0].p50Ms < 1.01);
+    ASSERT_TRUE(stats[0].p99Ms > 0.99 && stats[0].p99Ms < 1.01);
+    ASSERT_TRUE(stats[0].lastMs > 49.9);
+
+    // One more slow frame pushes p99 (nearest rank) onto the slow samples
+    run_frame(p, a, b, t, 50000us, 0us);
+    stats = p.summarize();
+    ASSERT_TRUE(stats[0].p99Ms > 49.9);
+}
+
+TEST(profiler_window_drops_old_frames) {
+    FrameProfiler p;
+    size_t a = p.add_section("A");
+    size_t b = p.add_section("B");
+    auto t = clock_type::now();
+    run_frame(p, a, b, t, 90000us, 0us);
+    for (size_t i = 0; i < FrameProfiler::WINDOW; ++i) run_frame(p, a, b, t, 1000us, 0us);
+
+    auto stats = p.summarize();
+    ASSERT_TRUE(stats[0].p99Ms < 1.01);
+}
+
+TEST(profiler_unmarked_section_records_zero) {
+    FrameProfiler p;
+    size_t a = p.add_section("A");
+    p.add_section("B");
+    auto t = clock_type::now();
+    p.begin_frame(t);
+    p.mark(a, t, 0);
+    p.end_frame(t + 1ms, 0);
+
+    auto stats = p.summarize();
+    ASSERT_TRUE(stats[1].lastMs == 0.0);
+}
+
+TEST(profiler_entity_counter_only_when_asked) {
+    FrameProfiler p;
+    int calls = 0;
+    p.add_section("A", [&calls] { ++calls; return static_cast<size_t>(42); });
+    p.add_section("B");
+
+    auto stats = p.summarize();
+    ASSERT_EQ(calls, 0);
+    ASSERT_EQ(stats[0].entities, -1L);
+
+    stats = p.summarize(true);
+    ASSERT_EQ(calls, 1);
+    ASSERT_EQ(stats[0].entities, 42L);
+    ASSERT_EQ(stats[1].entities, -1L);
+}
+
+// ===========================================================================
+// Chrome trace
+// ===========================================================================
+
+TEST(profiler_trace_writes_complete_events) {
+    FrameProfiler p;
+    size_t a = p.add_section("Sidebar\"System");
+    size_t b = p.add_section("B");
+    ASSERT_FALSE(p.enabled());
+    p.start_trace();
+    ASSERT_TRUE(p.enabled());
+    run_frame(p, a, b, clock_type::now(), 1000us, 1000us);
+    ASSERT_EQ(p.trace_event_count(), static_cast<size_t>(3));  // A, B, frame
+
+    std::string path = "/tmp/fh_test_profile_trace.json";
+    ASSERT_TRUE(p.write_chrome_trace(path));
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+    std::remove(path.c_str());
+
+    ASSERT_TRUE(json.starts_with("{\"traceEvents\":["));
+    ASSERT_TRUE(json.find("\"name\":\"Sidebar\\\"System\"") != std::string::npos);
+    ASSERT_TRUE(json.find("\"name\":\"frame\"") != std::string::npos);
+    ASSERT_TRUE(json.find("\"ph\":\"X\"") != std::string::npos);
+    ASSERT_TRUE(json.find("\"dur\":1000") != std::string::npos);
+}
+
+TEST(profiler_stop_trace_keeps_events) {
+    FrameProfiler p;
+    size_t a = p.add_section("A");
+    size_t b = p.add_section("B");
+    p.start_trace();
+    run_frame(p, a, b, clock_type::now(), 10us, 10us);
+    p.stop_trace();
+    run_frame(p, a, b, clock_type::now(), 10us, 10us);
+    ASSERT_EQ(p.trace_event_count(), static_cast<size_t>(3));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== frame_profiler tests ===\n");
+    RUN_ALL_TESTS();
+}
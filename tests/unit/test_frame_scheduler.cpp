@@ -0,0 +1,90 @@
+// Unit tests for FrameScheduler / WakeSignal (idle frame pacing).
+
+#include <chrono>
+#include <thread>
+
+#include "test_framework.h"
+#include "../../src/util/frame_scheduler.h"
+
+using namespace std::chrono_literals;
+using clock_type = FrameScheduler::clock;
+
+// ===========================================================================
+// FrameScheduler
+// ===========================================================================
+
+TEST(scheduler_active_after_invalidate) {
+    FrameScheduler s;
+    auto t = clock_type::now();
+    s.invalidate(t);
+    ASSERT_TRUE(s.is_active(t));
+    ASSERT_TRUE(s.idle_wait(t) == clock_type::duration::zero());
+    ASSERT_TRUE(s.is_active(t + FrameScheduler::ACTIVE_HOLD - 1ms));
+    ASSERT_FALSE(s.is_active(t + FrameScheduler::ACTIVE_HOLD));
+}
+
+TEST(scheduler_idle_wait_spaces_frames) {
+    FrameScheduler s;
+    auto t = clock_type::now();
+    s.frame_done(t);
+    ASSERT_TRUE(s.idle_wait(t) == FrameScheduler::IDLE_INTERVAL);
+    ASSERT_TRUE(s.idle_wait(t + 30ms) == FrameScheduler::IDLE_INTERVAL - 30ms);
+    ASSERT_TRUE(s.idle_wait(t + FrameScheduler::IDLE_INTERVAL + 5ms) ==
+                clock_type::duration::zero());
+}
+
+TEST(scheduler_animate_until_extends_not_shortens) {
+    FrameScheduler s;
+    auto t = clock_type::now();
+    s.animate_until(t + 2s);
+    s.invalidate(t);  // shorter hold must not cut the animation short
+    ASSERT_TRUE(s.is_active(t + 1s));
+    ASSERT_FALSE(s.is_active(t + 2s));
+}
+
+TEST(scheduler_counts_active_and_idle_frames) {
+    FrameScheduler s;
+    auto t = clock_type::now();
+    s.invalidate(t);
+    s.frame_done(t);
+    s.frame_done(t + 1s);
+    s.frame_done(t + 2s);
+    ASSERT_EQ(s.stats().activeFrames, static_cast<uint64_t>(1));
+    ASSERT_EQ(s.stats().idleFrames, static_cast<uint64_t>(2));
+}
+
+// ===========================================================================
+// WakeSignal
+// ===========================================================================
+
+TEST(wake_times_out_without_notify) {
+    WakeSignal w;
+    ASSERT_FALSE(w.wait_for(5ms));
+}
+
+TEST(wake_notify_before_wait_is_not_lost) {
+    WakeSignal w;
+    w.notify();
+    ASSERT_TRUE(w.wait_for(0ms));
+    ASSERT_FALSE(w.wait_for(0ms));  // consumed
+}
+
+TEST(wake_notify_from_other_thread_ends_wait_early) {
+    WakeSignal w;
+    auto start = std::chrono::steady_clock::now();
+    std::thread t([&w] {
+        std::this_thread::sleep_for(5ms);
+        w.notify();
+    });
+    bool woken = w.wait_for(5s);
+    t.join();
+    ASSERT_TRUE(woken);
+    ASSERT_TRUE(std::chrono::steady_clock::now() - start < 2s);
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== frame_scheduler tests ===\n");
+    RUN_ALL_TESTS();
+}
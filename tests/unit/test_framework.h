@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <source_location>
 #include <string>
 #include <vector>
 
@@ -62,6 +63,21 @@
         }                                                                      \
     } while (0)
 
+// Run a shell command in `dir` for test setup (git init, commits, ...).
+// A failing command fails the test right there, instead of surfacing later
+// as an unrelated assertion.
+inline void sh(const std::string& dir, const std::string& cmd,
+               std::source_location loc = std::source_location::current()) {
+    std::string full = "cd '" + dir + "' && " + cmd + " >/dev/null 2>&1";
+    int status = std::system(full.c_str());
+    if (status != 0) {
+        fprintf(stderr, "FAIL %s:%u: command failed (status %d): %s\n",
+                loc.file_name(), static_cast<unsigned>(loc.line()), status,
+                cmd.c_str());
+        exit(1);
+    }
+}
+
 // Simple test registration.
 struct TestCase {
     const char* name;
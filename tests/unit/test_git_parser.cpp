@@ -78,6 +78,17 @@ TEST(status_ordinary_staged_file) {
     ASSERT_EQ(r.stagedFiles[0].workTreeStatus, '.');
 }
 
+TEST(status_index_hash) {
+    std::string input =
+        "1 M. N... 100644 100644 100644 "
+        "abc1234abc1234abc1234abc1234abc1234abc1234 "
+        "def5678def5678def5678def5678def5678def5678 src/main.cpp\n";
+    auto r = git::parse_status(input);
+    ASSERT_EQ(r.stagedFiles.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(r.stagedFiles[0].indexHash,
+                 "def5678def5678def5678def5678def5678def5678");
+}
+
 TEST(status_ordinary_unstaged_file) {
     // .M = no staged change, worktree modification
     std::string input =
@@ -308,6 +319,48 @@ TEST(log_too_few_fields_skipped) {
     ASSERT_TRUE(entries.empty());
 }
 
+TEST(log_derived_fields_parsed_at_load) {
+    std::string input = make_log_line(
+        "abc123", "abc", "Subject", "Alice",
+        "2025-01-15T10:30:00-05:00",
+        "origin/main, tag: v1.0, HEAD -> main");
+    input += "\n";
+
+    auto entries = git::parse_log(input);
+    ASSERT_EQ(entries.size(), static_cast<size_t>(1));
+    // 2025-01-15T15:30:00Z
+    ASSERT_EQ(entries[0].authorTime, static_cast<std::time_t>(1736955000));
+    ASSERT_EQ(entries[0].badges.size(), static_cast<size_t>(4));
+    ASSERT_TRUE(entries[0].badges[0].type == git_helpers::DecorationType::RemoteBranch);
+    ASSERT_STREQ(entries[0].badges[1].label, "v1.0");
+    ASSERT_EQ(entries[0].bestBadge, 2);  // HEAD outranks everything else
+}
+
+TEST(log_derived_fields_without_date_or_decorations) {
+    std::string input = make_log_line("hash1", "h1", "Commit", "Dev", "2025-01-01");
+    input += "\n";
+
+    auto entries = git::parse_log(input);
+    ASSERT_EQ(entries.size(), static_cast<size_t>(1));
+    ASSERT_EQ(entries[0].authorTime, static_cast<std::time_t>(0));
+    ASSERT_TRUE(entries[0].badges.empty());
+    ASSERT_EQ(entries[0].bestBadge, -1);
+}
+
+TEST(relative_time_reports_next_change) {
+    std::time_t t = 1000000;
+    std::time_t until = 0;
+    ASSERT_STREQ(git_helpers::relative_time(t, t + 90, false, &until), "1m");
+    ASSERT_EQ(until, t + 120);
+    ASSERT_STREQ(git_helpers::relative_time(t, t + 3599, false, &until), "59m");
+    ASSERT_EQ(until, t + 3600);
+    // 4 weeks rolls over to months at 30 days, not at 5 weeks
+    ASSERT_STREQ(git_helpers::relative_time(t, t + 4 * 604800, true, &until), "4w ago");
+    ASSERT_EQ(until, t + 2592000);
+    ASSERT_STREQ(git_helpers::relative_time(t, t - 5, false, &until), "now");
+    ASSERT_EQ(until, t);
+}
+
 // ===========================================================================
 // parse_diff tests
 // ===========================================================================
@@ -380,6 +433,27 @@ TEST(diff_deleted_file) {
     ASSERT_EQ(diffs[0].deletions, 3);
 }
 
+TEST(diff_index_line_gives_blob_ids) {
+    std::string input =
+        "diff --git a/a.cpp b/a.cpp\n"
+        "index 83db48f..bf269f4 100644\n"
+        "--- a/a.cpp\n"
+        "+++ b/a.cpp\n"
+        "@@ -1 +1 @@\n"
+        "-x\n"
+        "+y\n"
+        "diff --git a/new.txt b/new.txt\n"
+        "new file mode 100644\n"
+        "index 0000000..e69de29\n";
+
+    auto diffs = git::parse_diff(input);
+    ASSERT_EQ(diffs.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(diffs[0].oldBlob, "83db48f");
+    ASSERT_STREQ(diffs[0].newBlob, "bf269f4");
+    ASSERT_TRUE(diffs[1].oldBlob.empty());
+    ASSERT_STREQ(diffs[1].newBlob, "e69de29");
+}
+
 TEST(diff_renamed_file) {
     std::string input =
         "diff --git a/old_name.cpp b/new_name.cpp\n"
@@ -494,6 +568,25 @@ TEST(diff_context_lines_preserved) {
     ASSERT_STREQ(diffs[0].hunks[0].lines[3], "+added");
 }
 
+TEST(diff_no_newline_marker_dropped) {
+    // The diff view numbers every hunk line, so the marker must not be one
+    std::string input =
+        "diff --git a/eof.txt b/eof.txt\n"
+        "--- a/eof.txt\n"
+        "+++ b/eof.txt\n"
+        "@@ -1,2 +1,2 @@\n"
+        " keep\n"
+        "-old\n"
+        "\\ No newline at end of file\n"
+        "+new\n"
+        "\\ No newline at end of file\n";
+
+    auto diffs = git::parse_diff(input);
+    ASSERT_EQ(diffs[0].hunks[0].lines.size(), static_cast<size_t>(3));
+    ASSERT_STREQ(diffs[0].hunks[0].lines[1], "-old");
+    ASSERT_STREQ(diffs[0].hunks[0].lines[2], "+new");
+}
+
 TEST(diff_windows_line_endings_stripped) {
     std::string input =
         "diff --git a/win.txt b/win.txt\r\n"
@@ -594,6 +687,50 @@ TEST(branch_blank_lines_ignored) {
     ASSERT_EQ(branches.size(), static_cast<size_t>(1));
 }
 
+// ===========================================================================
+// parse_numstat
+// ===========================================================================
+
+using namespace std::string_literals;
+
+TEST(numstat_empty) {
+    auto files = git::parse_numstat("");
+    ASSERT_TRUE(files.empty());
+}
+
+TEST(numstat_basic) {
+    auto input = "3\t1\tsrc/main.cpp\0" "10\t0\tREADME.md\0"s;
+    auto files = git::parse_numstat(input);
+    ASSERT_EQ(files.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(files[0].filePath, "src/main.cpp");
+    ASSERT_EQ(files[0].additions, 3);
+    ASSERT_EQ(files[0].deletions, 1);
+    ASSERT_STREQ(files[1].filePath, "README.md");
+    ASSERT_EQ(files[1].additions, 10);
+    ASSERT_EQ(files[1].deletions, 0);
+    ASSERT_TRUE(files[0].hunks.empty());
+}
+
+TEST(numstat_binary) {
+    auto input = "-\t-\timage.png\0"s;
+    auto files = git::parse_numstat(input);
+    ASSERT_EQ(files.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(files[0].filePath, "image.png");
+    ASSERT_TRUE(files[0].isBinary);
+    ASSERT_EQ(files[0].additions, 0);
+}
+
+TEST(numstat_rename) {
+    auto input = "2\t2\t\0old name.txt\0new name.txt\0" "1\t0\tb.txt\0"s;
+    auto files = git::parse_numstat(input);
+    ASSERT_EQ(files.size(), static_cast<size_t>(2));
+    ASSERT_TRUE(files[0].isRenamed);
+    ASSERT_STREQ(files[0].oldPath, "old name.txt");
+    ASSERT_STREQ(files[0].filePath, "new name.txt");
+    ASSERT_EQ(files[0].additions, 2);
+    ASSERT_STREQ(files[1].filePath, "b.txt");
+}
+
 // ===========================================================================
 
 int main() {
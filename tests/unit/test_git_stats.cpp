@@ -0,0 +1,127 @@
+// Unit tests for git command latency statistics (histograms, --trace-git).
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/git/git_stats.h"
+
+using git::GitInvocation;
+using git::GitStats;
+using git::LatencyHistogram;
+
+static GitInvocation make_inv(const std::string& sub, double ms, int exitCode = 0) {
+    GitInvocation inv;
+    inv.command = "git " + sub;
+    inv.subcommand = sub;
+    inv.durationMs = ms;
+    inv.bytesRead = 100;
+    inv.exitCode = exitCode;
+    return inv;
+}
+
+// ===========================================================================
+// Subcommand extraction
+// ===========================================================================
+
+TEST(subcommand_skips_global_options) {
+    ASSERT_EQ(git::git_subcommand({"-C", "/repo", "log", "--oneline"}),
+              std::string("log"));
+    ASSERT_EQ(git::git_subcommand({"-c", "core.quotepath=off", "status"}),
+              std::string("status"));
+    ASSERT_EQ(git::git_subcommand({"--no-pager", "diff", "HEAD"}),
+              std::string("diff"));
+    ASSERT_EQ(git::git_subcommand({"--version"}), std::string(""));
+    ASSERT_EQ(git::git_subcommand({}), std::string(""));
+}
+
+// ===========================================================================
+// Histogram
+// ===========================================================================
+
+TEST(histogram_bucket_bounds) {
+    ASSERT_EQ(LatencyHistogram::bucket_for(0.2), static_cast<size_t>(0));
+    ASSERT_EQ(LatencyHistogram::bucket_for(1.0), static_cast<size_t>(1));
+    ASSERT_EQ(LatencyHistogram::bucket_for(1.9), static_cast<size_t>(1));
+    ASSERT_EQ(LatencyHistogram::bucket_for(2.0), static_cast<size_t>(2));
+    ASSERT_EQ(LatencyHistogram::bucket_for(300.0), static_cast<size_t>(9));
+    ASSERT_EQ(LatencyHistogram::bucket_for(1e9), LatencyHistogram::BUCKETS - 1);
+    ASSERT_TRUE(LatencyHistogram::bucket_upper_ms(0) == 1.0);
+    ASSERT_TRUE(LatencyHistogram::bucket_upper_ms(9) == 512.0);
+}
+
+TEST(histogram_quantiles_use_bucket_upper_bounds) {
+    LatencyHistogram h;
+    for (int i = 0; i < 99; ++i) h.add(3.0, 10, false);
+    h.add(700.0, 10, true);
+
+    ASSERT_EQ(h.total, static_cast<uint64_t>(100));
+    ASSERT_EQ(h.failures, static_cast<uint64_t>(1));
+    ASSERT_EQ(h.bytesRead, static_cast<uint64_t>(1000));
+    ASSERT_TRUE(h.quantile_upper_ms(0.50) == 4.0);
+    ASSERT_TRUE(h.quantile_upper_ms(0.99) == 4.0);
+    // The top quantile is capped at the observed maximum
+    ASSERT_TRUE(h.quantile_upper_ms(1.0) == 700.0);
+}
+
+TEST(stats_group_by_subcommand) {
+    auto& stats = GitStats::get();
+    stats.reset();
+    stats.record(make_inv("log", 12.0));
+    stats.record(make_inv("log", 20.0));
+    stats.record(make_inv("status", 5.0, 128));
+
+    auto snap = stats.snapshot();
+    ASSERT_EQ(snap.size(), static_cast<size_t>(2));
+    ASSERT_EQ(snap["log"].total, static_cast<uint64_t>(2));
+    ASSERT_TRUE(snap["log"].maxMs == 20.0);
+    ASSERT_EQ(snap["status"].failures, static_cast<uint64_t>(1));
+
+    auto report = stats.format_report();
+    // Slowest subcommand (by p99) is listed first
+    ASSERT_TRUE(report.find("log") < report.find("status"));
+    stats.reset();
+}
+
+// ===========================================================================
+// Trace file
+// ===========================================================================
+
+TEST(trace_writes_valid_events) {
+    auto& stats = GitStats::get();
+    stats.reset();
+    std::string path = "/tmp/fh_test_git_trace.json";
+    ASSERT_TRUE(stats.open_trace(path));
+    auto inv = make_inv("log", 1.5);
+    inv.command = "git log --format=\"%H\"";
+    inv.startMs = 2.0;
+    stats.record(inv);
+    stats.record(make_inv("status", 0.5));
+    stats.close_trace();
+    stats.record(make_inv("diff", 1.0));  // Not traced after close
+
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+    std::remove(path.c_str());
+    stats.reset();
+
+    ASSERT_TRUE(json.starts_with("{\"traceEvents\":["));
+    ASSERT_TRUE(json.ends_with("\"displayTimeUnit\":\"ms\"}\n"));
+    ASSERT_TRUE(json.find("\"name\":\"git log\"") != std::string::npos);
+    ASSERT_TRUE(json.find("\"ts\":2000,\"dur\":1500") != std::string::npos);
+    ASSERT_TRUE(json.find("--format=\\\"%H\\\"") != std::string::npos);
+    ASSERT_TRUE(json.find("git status") != std::string::npos);
+    ASSERT_TRUE(json.find("git diff") == std::string::npos);
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== git_stats tests ===\n");
+    RUN_ALL_TESTS();
+}
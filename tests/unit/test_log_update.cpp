@@ -0,0 +1,251 @@
+// Unit tests for incremental commit log updates and pagination
+// (git/log_update.h) and the git queries behind them, run against a
+// scratch repository.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/ecs/repo_index.h"
+#include "../../src/git/git_parser.h"
+#include "../../src/git/git_runner.h"
+#include "../../src/git/log_update.h"
+
+namespace fs = std::filesystem;
+
+static ecs::CommitEntry commit(const std::string& hash,
+                               const std::string& decorations = "",
+                               const std::string& parents = "") {
+    ecs::CommitEntry c;
+    c.hash = hash;
+    c.parentHashes = parents;
+    git::set_decorations(c, decorations);
+    return c;
+}
+
+// ===========================================================================
+// Pure helpers
+// ===========================================================================
+
+TEST(prepend_keeps_order) {
+    ecs::CommitLog log = {commit("c"), commit("b")};
+    auto index = ecs::build_commit_index(log);
+    git::prepend_commits(log, index, {commit("e"), commit("d")});
+    ASSERT_EQ(log.size(), static_cast<size_t>(4));
+    ASSERT_STREQ(log[0].hash, "e");
+    ASSERT_STREQ(log[1].hash, "d");
+    ASSERT_STREQ(log[2].hash, "c");
+    ASSERT_STREQ(log[3].hash, "b");
+}
+
+TEST(prepend_and_append_keep_index_rows) {
+    ecs::CommitLog log = {commit("c", "", "b")};
+    auto index = ecs::build_commit_index(log);
+    git::prepend_commits(log, index, {commit("e", "", "d"), commit("d", "", "c")});
+    git::prepend_commits(log, index, {commit("f", "", "e")});
+    std::vector<std::string> frontier = {"b"};
+    git::append_page(log, index, frontier, {commit("b")});
+
+    ASSERT_EQ(index.size(), log.size());
+    for (size_t i = 0; i < log.size(); ++i) ASSERT_EQ(index.row(log[i].hash), i);
+    ASSERT_EQ(index.row("zzz"), SIZE_MAX);
+    ASSERT_TRUE(frontier.empty());
+}
+
+TEST(merge_detection_uses_parent_count) {
+    ASSERT_FALSE(git::has_merge_commit({commit("a", "", "p1"), commit("b")}));
+    ASSERT_TRUE(git::has_merge_commit({commit("a", "", "p1 p2")}));
+}
+
+TEST(ref_tips_move_decorations) {
+    // HEAD moved from b to the newly prepended a
+    ecs::CommitLog log = {commit("a"), commit("b", "HEAD -> main"),
+                          commit("c", "tag: v1")};
+    auto index = ecs::build_commit_index(log);
+    std::vector<ecs::CommitEntry> tips = {commit("a", "HEAD -> main"),
+                                          commit("c", "tag: v1"),
+                                          commit("zzz", "origin/old")};
+
+    size_t changed = git::apply_ref_tips(log, index, tips);
+    ASSERT_EQ(changed, static_cast<size_t>(2));
+    ASSERT_STREQ(log[0].decorations, "HEAD -> main");
+    ASSERT_EQ(log[0].bestBadge, 0);
+    ASSERT_TRUE(log[1].decorations.empty());
+    ASSERT_TRUE(log[1].badges.empty());
+    ASSERT_EQ(log[1].bestBadge, -1);
+    ASSERT_STREQ(log[2].decorations, "tag: v1");
+
+    // Tips read again later: only a (still HEAD) and c are decorated now
+    tips = {commit("c", "HEAD -> main, tag: v1")};
+    ASSERT_EQ(git::apply_ref_tips(log, index, tips), static_cast<size_t>(2));
+    ASSERT_TRUE(log[0].decorations.empty());
+    ASSERT_STREQ(log[2].decorations, "HEAD -> main, tag: v1");
+    ASSERT_EQ(index.decorated.size(), static_cast<size_t>(1));
+}
+
+TEST(ref_tips_reach_prepended_and_paged_commits) {
+    ecs::CommitLog log = {commit("b", "HEAD -> main", "a")};
+    auto index = ecs::build_commit_index(log);
+    git::prepend_commits(log, index, {commit("c", "", "b")});
+    std::vector<std::string> frontier = {"a"};
+    git::append_page(log, index, frontier, {commit("a", "tag: v0")});
+
+    std::vector<ecs::CommitEntry> tips = {commit("c", "HEAD -> main")};
+    ASSERT_EQ(git::apply_ref_tips(log, index, tips), static_cast<size_t>(3));
+    ASSERT_STREQ(log[0].decorations, "HEAD -> main");
+    ASSERT_TRUE(log[1].decorations.empty());
+    ASSERT_TRUE(log[2].decorations.empty());
+}
+
+TEST(frontier_of_linear_history_is_last_parent) {
+    ecs::CommitLog log = {commit("c", "", "b"), commit("b", "", "a")};
+    auto index = ecs::build_commit_index(log);
+    auto frontier = git::log_frontier(log, index);
+    ASSERT_EQ(frontier.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(frontier[0], "a");
+
+    // Root commit loaded: nothing left
+    ecs::CommitLog all = {commit("b", "", "a"), commit("a")};
+    ASSERT_TRUE(git::log_frontier(all, ecs::build_commit_index(all)).empty());
+}
+
+TEST(frontier_keeps_open_merge_sides) {
+    // m merges x into b; b and its side x both still unloaded
+    ecs::CommitLog log = {commit("m", "", "b x")};
+    auto index = ecs::build_commit_index(log);
+    auto frontier = git::log_frontier(log, index);
+    ASSERT_EQ(frontier.size(), static_cast<size_t>(2));
+
+    // Loading b (parent a) closes one side and opens a
+    size_t added = git::append_page(log, index, frontier, {commit("b", "", "a")});
+    ASSERT_EQ(added, static_cast<size_t>(1));
+    ASSERT_EQ(frontier.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(frontier[0], "x");
+    ASSERT_STREQ(frontier[1], "a");
+}
+
+TEST(append_page_skips_loaded_commits) {
+    ecs::CommitLog log = {commit("c", "", "b")};
+    auto index = ecs::build_commit_index(log);
+    std::vector<std::string> frontier = {"b"};
+    size_t added = git::append_page(log, index, frontier,
+                                    {commit("c", "", "b"), commit("b", "", "a")});
+    ASSERT_EQ(added, static_cast<size_t>(1));
+    ASSERT_EQ(log.size(), static_cast<size_t>(2));
+    ASSERT_EQ(index.row("b"), static_cast<size_t>(1));
+    ASSERT_EQ(frontier.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(frontier[0], "a");
+}
+
+// ===========================================================================
+// Git queries
+// ===========================================================================
+
+static std::string head_of(const std::string& dir) {
+    auto r = git::git_rev_parse_head(dir);
+    std::string h = r.stdout_str();
+    while (!h.empty() && (h.back() == '\n' || h.back() == '\r')) h.pop_back();
+    return h;
+}
+
+static std::string make_repo() {
+    auto dir = (fs::temp_directory_path() / "fh_test_log_update").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    sh(dir, "git init -q -b main && git config user.email t@t && git config user.name t");
+    sh(dir, "git commit -q --allow-empty -m one && git commit -q --allow-empty -m two");
+    return dir;
+}
+
+TEST(range_returns_only_new_commits) {
+    auto dir = make_repo();
+    std::string base = head_of(dir);
+    sh(dir, "git commit -q --allow-empty -m three && git commit -q --allow-empty -m four");
+    std::string head = head_of(dir);
+
+    ASSERT_EQ(git::git_is_ancestor(dir, base, head).exit_code(), 0);
+    auto added = git::parse_log(git::git_log_range(dir, base + ".." + head).stdout_str());
+    ASSERT_EQ(added.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(added[0].subject, "four");
+    ASSERT_STREQ(added[1].subject, "three");
+    fs::remove_all(dir);
+}
+
+TEST(amend_is_not_an_ancestor) {
+    auto dir = make_repo();
+    std::string base = head_of(dir);
+    sh(dir, "git commit -q --amend --allow-empty -m two-amended");
+    ASSERT_EQ(git::git_is_ancestor(dir, base, head_of(dir)).exit_code(), 1);
+    fs::remove_all(dir);
+}
+
+TEST(ref_tips_cover_branches_and_tags) {
+    auto dir = make_repo();
+    sh(dir, "git tag v1 HEAD~1 && git branch topic HEAD~1");
+    auto tips = git::parse_log(git::git_log_ref_tips(dir).stdout_str());
+    ASSERT_EQ(tips.size(), static_cast<size_t>(2));
+    std::unordered_map<std::string, std::string> bySubject;
+    for (const auto& t : tips) bySubject[t.subject] = t.decorations;
+    ASSERT_STREQ(bySubject["two"], "HEAD -> main");
+    ASSERT_TRUE(bySubject["one"].find("tag: v1") != std::string::npos);
+    ASSERT_TRUE(bySubject["one"].find("topic") != std::string::npos);
+    fs::remove_all(dir);
+}
+
+TEST(ref_list_marks_head_and_changes_with_refs) {
+    auto dir = make_repo();
+    auto before = git::git_ref_list(dir).stdout_str();
+    ASSERT_TRUE(before.find(" * refs/heads/main") != std::string::npos);
+    ASSERT_EQ(git::git_ref_list(dir).stdout_str(), before);  // Stable
+
+    sh(dir, "git tag v2");
+    auto tagged = git::git_ref_list(dir).stdout_str();
+    ASSERT_TRUE(tagged.find("refs/tags/v2") != std::string::npos);
+    sh(dir, "git checkout -q -b other");
+    auto switched = git::git_ref_list(dir).stdout_str();
+    ASSERT_TRUE(switched.find(" * refs/heads/other") != std::string::npos);
+    ASSERT_TRUE(switched.find("   refs/heads/main") != std::string::npos);
+    fs::remove_all(dir);
+}
+
+TEST(pages_from_frontier_match_full_log) {
+    auto dir = make_repo();
+    // Interleave a side branch with main so the walk has two open sides.
+    // Distinct commit dates keep git's date-ordered walk deterministic.
+    auto at = [](int minute) {
+        std::string d = "2030-01-01T00:" + std::to_string(10 + minute) + ":00";
+        return "GIT_COMMITTER_DATE=" + d + " GIT_AUTHOR_DATE=" + d + " ";
+    };
+    sh(dir, "git checkout -q -b side HEAD~1");
+    sh(dir, at(1) + "git commit -q --allow-empty -m s1 && git checkout -q main");
+    sh(dir, at(2) + "git commit -q --allow-empty -m m1 && git checkout -q side");
+    sh(dir, at(3) + "git commit -q --allow-empty -m s2 && git checkout -q main");
+    sh(dir, at(4) + "git merge -q --no-ff -m merge side");
+    sh(dir, at(5) + "git commit -q --allow-empty -m top");
+
+    auto full = git::parse_log(git::git_log(dir, 0).stdout_str());
+
+    auto log = git::make_commit_log(git::parse_log(git::git_log(dir, 2).stdout_str()));
+    auto index = ecs::build_commit_index(log);
+    auto frontier = git::log_frontier(log, index);
+    int pages = 0;
+    while (!frontier.empty() && pages++ < 10) {
+        auto page = git::parse_log(git::git_log_from(dir, frontier, 2).stdout_str());
+        git::append_page(log, index, frontier, std::move(page));
+    }
+
+    ASSERT_EQ(log.size(), full.size());
+    for (size_t i = 0; i < full.size(); ++i) ASSERT_STREQ(log[i].hash, full[i].hash);
+    fs::remove_all(dir);
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== log_update tests ===\n");
+    RUN_ALL_TESTS();
+}
@@ -0,0 +1,108 @@
+// Unit tests for LruCache (byte-budgeted LRU used for commit details).
+
+#include <string>
+
+#include "test_framework.h"
+#include "../../src/util/lru_cache.h"
+
+// ===========================================================================
+// Lookup and counters
+// ===========================================================================
+
+TEST(lru_get_counts_hits_and_misses) {
+    LruCache<std::string, int> cache(100);
+    cache.put("a", 1, 10);
+
+    auto* v = cache.get("a");
+    ASSERT_TRUE(v != nullptr);
+    ASSERT_EQ(*v, 1);
+    ASSERT_TRUE(cache.get("b") == nullptr);
+
+    ASSERT_EQ(cache.stats().hits, static_cast<uint64_t>(1));
+    ASSERT_EQ(cache.stats().misses, static_cast<uint64_t>(1));
+}
+
+TEST(lru_contains_does_not_count) {
+    LruCache<std::string, int> cache(100);
+    cache.put("a", 1, 10);
+    ASSERT_TRUE(cache.contains("a"));
+    ASSERT_FALSE(cache.contains("b"));
+    ASSERT_EQ(cache.stats().hits, static_cast<uint64_t>(0));
+    ASSERT_EQ(cache.stats().misses, static_cast<uint64_t>(0));
+}
+
+TEST(lru_touch_bumps_without_counting) {
+    LruCache<std::string, int> cache(20);
+    cache.put("a", 1, 10);
+    cache.put("b", 2, 10);
+    ASSERT_TRUE(cache.touch("a") != nullptr);
+    cache.put("c", 3, 10);  // evicts b, not a
+    ASSERT_TRUE(cache.contains("a"));
+    ASSERT_FALSE(cache.contains("b"));
+    ASSERT_EQ(cache.stats().hits, static_cast<uint64_t>(0));
+}
+
+// ===========================================================================
+// Budget and eviction
+// ===========================================================================
+
+TEST(lru_evicts_least_recently_used) {
+    LruCache<std::string, int> cache(30);
+    cache.put("a", 1, 10);
+    cache.put("b", 2, 10);
+    cache.put("c", 3, 10);
+    cache.get("a");          // a is now most recent; b is oldest
+    cache.put("d", 4, 10);   // over budget -> evict b
+
+    ASSERT_TRUE(cache.contains("a"));
+    ASSERT_FALSE(cache.contains("b"));
+    ASSERT_TRUE(cache.contains("c"));
+    ASSERT_TRUE(cache.contains("d"));
+    ASSERT_EQ(cache.bytes(), static_cast<size_t>(30));
+    ASSERT_EQ(cache.stats().evictions, static_cast<uint64_t>(1));
+}
+
+TEST(lru_keeps_oversized_newest_entry) {
+    LruCache<std::string, int> cache(10);
+    cache.put("a", 1, 5);
+    cache.put("big", 2, 50);
+    ASSERT_EQ(cache.size(), static_cast<size_t>(1));
+    ASSERT_TRUE(cache.contains("big"));
+}
+
+TEST(lru_replace_updates_bytes) {
+    LruCache<std::string, int> cache(100);
+    cache.put("a", 1, 10);
+    cache.put("a", 2, 25);
+    ASSERT_EQ(cache.size(), static_cast<size_t>(1));
+    ASSERT_EQ(cache.bytes(), static_cast<size_t>(25));
+    ASSERT_EQ(*cache.get("a"), 2);
+}
+
+TEST(lru_shrinking_budget_evicts) {
+    LruCache<std::string, int> cache(100);
+    cache.put("a", 1, 40);
+    cache.put("b", 2, 40);
+    cache.set_budget(50);
+    ASSERT_FALSE(cache.contains("a"));
+    ASSERT_TRUE(cache.contains("b"));
+}
+
+TEST(lru_erase_and_clear) {
+    LruCache<std::string, int> cache(100);
+    cache.put("a", 1, 10);
+    cache.put("b", 2, 10);
+    cache.erase("a");
+    ASSERT_FALSE(cache.contains("a"));
+    ASSERT_EQ(cache.bytes(), static_cast<size_t>(10));
+    cache.clear();
+    ASSERT_EQ(cache.size(), static_cast<size_t>(0));
+    ASSERT_EQ(cache.bytes(), static_cast<size_t>(0));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== lru_cache tests ===\n");
+    RUN_ALL_TESTS();
+}
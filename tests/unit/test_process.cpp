@@ -7,7 +7,10 @@
 #include "test_framework.h"
 #include "../../src/util/process.h"
 
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <thread>
 
 TEST(process_empty_args) {
     auto r = run_process("", {});
@@ -84,6 +87,85 @@ TEST(process_async_basic) {
     ASSERT_STREQ(r.stdout_str, "async_test\n");
 }
 
+TEST(process_streaming_chunks) {
+    std::string seen;
+    size_t chunks = 0;
+    auto r = run_process_streaming("", {"sh", "-c", "printf 'a\\0b\\0c'"},
+                                   [&](std::string_view chunk) {
+                                       seen.append(chunk);
+                                       ++chunks;
+                                       return true;
+                                   });
+    ASSERT_TRUE(r.success());
+    ASSERT_TRUE(r.stdout_str.empty());
+    ASSERT_EQ(seen.size(), static_cast<size_t>(5));
+    ASSERT_TRUE(chunks >= 1);
+}
+
+TEST(process_streaming_stop_early) {
+    // `yes` never ends on its own; stopping must terminate it
+    size_t bytes = 0;
+    auto r = run_process_streaming("", {"yes"}, [&](std::string_view chunk) {
+        bytes += chunk.size();
+        return bytes < 100000;
+    });
+    ASSERT_FALSE(r.success());
+    ASSERT_TRUE(bytes >= 100000);
+}
+
+TEST(process_streaming_cancel_while_quiet) {
+    // `sleep` prints nothing, so only the cancel flag can stop it early
+    std::atomic<bool> cancel{false};
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        cancel = true;
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto r = run_process_streaming("", {"sleep", "10"},
+                                   [](std::string_view) { return true; }, &cancel);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    canceller.join();
+    ASSERT_FALSE(r.success());
+    ASSERT_TRUE(elapsed < std::chrono::seconds(2));
+}
+
+TEST(process_streaming_either_flag_cancels) {
+    // A caller's own flag stays clear; the second (shutdown) one stops it
+    std::atomic<bool> cancel{false};
+    std::atomic<bool> stopping{false};
+    std::thread canceller([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        stopping = true;
+    });
+    auto start = std::chrono::steady_clock::now();
+    auto r = run_process_streaming("", {"sleep", "10"},
+                                   [](std::string_view) { return true; }, &cancel,
+                                   &stopping);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    canceller.join();
+    ASSERT_FALSE(r.success());
+    ASSERT_TRUE(elapsed < std::chrono::seconds(2));
+}
+
+TEST(process_streaming_uncancelled_runs_to_end) {
+    std::atomic<bool> cancel{false};
+    std::string seen;
+    auto r = run_process_streaming("", {"sh", "-c", "sleep 0.2; printf done"},
+                                   [&](std::string_view chunk) {
+                                       seen.append(chunk);
+                                       return true;
+                                   },
+                                   &cancel);
+    ASSERT_TRUE(r.success());
+    ASSERT_STREQ(seen.c_str(), "done");
+}
+
+TEST(process_streaming_nonexistent_command) {
+    auto r = run_process_streaming("", {"__nonexistent_command_xyz_12345__"},
+                                   [](std::string_view) { return true; });
+    ASSERT_FALSE(r.success());
+}
+
 int main() {
     printf("=== process tests ===\n");
     RUN_ALL_TESTS();
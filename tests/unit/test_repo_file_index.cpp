@@ -0,0 +1,182 @@
+// Unit tests for the full-repository file index behind the sidebar's
+// "All" view (util/repo_file_index.h), including a streamed
+// `git ls-files -z` run against a scratch repository.
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/git/git_runner.h"
+#include "../../src/util/repo_file_index.h"
+
+namespace fs = std::filesystem;
+using namespace std::string_literals;
+
+static RepoFileIndex build(std::string_view stream, size_t chunk = 0,
+                           RepoFileIndex::Limits limits = {}) {
+    RepoFileIndex::Builder builder(limits);
+    if (chunk == 0) chunk = stream.size();
+    for (size_t i = 0; i < stream.size(); i += chunk) {
+        if (!builder.feed(stream.substr(i, chunk))) break;
+    }
+    return builder.finish();
+}
+
+static std::vector<std::string> listing(const RepoFileIndex& index,
+                                        RepoFileIndex::NodeId dir) {
+    std::vector<std::string> out;
+    for (auto id : index.children(dir)) {
+        out.push_back(std::string(index.name(id)) +
+                      (index.node(id).isDir ? "/" : ""));
+    }
+    return out;
+}
+
+static const std::string SAMPLE =
+    "Makefile\0README.md\0src/app.cpp\0src/ui/a.cpp\0src/ui/b.cpp\0"
+    "src/zeta.h\0tests/t.cpp\0"s;
+
+// ===========================================================================
+// Building
+// ===========================================================================
+
+TEST(build_counts_files_and_dirs) {
+    auto index = build(SAMPLE);
+    ASSERT_EQ(index.file_count(), static_cast<size_t>(7));
+    // root + 7 files + src, src/ui, tests
+    ASSERT_EQ(index.node_count(), static_cast<size_t>(11));
+    ASSERT_FALSE(index.truncated());
+    ASSERT_EQ(index.node(index.find("src")).fileCount, static_cast<uint32_t>(4));
+    ASSERT_EQ(index.node(index.find("src/ui")).fileCount, static_cast<uint32_t>(2));
+}
+
+TEST(children_list_dirs_first_then_by_name) {
+    auto index = build(SAMPLE);
+    std::vector<std::string> top = {"src/", "tests/", "Makefile", "README.md"};
+    ASSERT_TRUE(listing(index, RepoFileIndex::ROOT) == top);
+    std::vector<std::string> src = {"ui/", "app.cpp", "zeta.h"};
+    ASSERT_TRUE(listing(index, index.find("src")) == src);
+}
+
+TEST(paths_split_across_chunks) {
+    auto whole = build(SAMPLE);
+    for (size_t chunk : {1u, 2u, 3u, 7u, 13u}) {
+        auto split = build(SAMPLE, chunk);
+        ASSERT_EQ(split.file_count(), whole.file_count());
+        ASSERT_EQ(split.node_count(), whole.node_count());
+        ASSERT_TRUE(split.find("src/ui/b.cpp") != RepoFileIndex::NONE);
+    }
+}
+
+TEST(missing_trailing_nul_keeps_last_path) {
+    auto index = build("a/x.txt\0b.txt"s, 4);
+    ASSERT_EQ(index.file_count(), static_cast<size_t>(2));
+    ASSERT_TRUE(index.find("b.txt") != RepoFileIndex::NONE);
+}
+
+TEST(reentering_a_directory_reuses_nothing_stale) {
+    // "a/b/x" then "a/c/y": a is shared, b is closed before c opens
+    auto index = build("a/b/x\0a/c/y\0a/z\0"s);
+    std::vector<std::string> a = {"b/", "c/", "z"};
+    ASSERT_TRUE(listing(index, index.find("a")) == a);
+    ASSERT_EQ(index.node(index.find("a/c/y")).depth, static_cast<uint32_t>(2));
+}
+
+// ===========================================================================
+// Lookup
+// ===========================================================================
+
+TEST(find_and_path_round_trip) {
+    auto index = build(SAMPLE);
+    for (const char* p : {"Makefile", "src", "src/ui", "src/ui/a.cpp", "tests/t.cpp"}) {
+        auto id = index.find(p);
+        ASSERT_TRUE(id != RepoFileIndex::NONE);
+        ASSERT_EQ(index.path(id), std::string(p));
+    }
+    ASSERT_TRUE(index.find("src/missing.cpp") == RepoFileIndex::NONE);
+    ASSERT_TRUE(index.find("Makefile/x") == RepoFileIndex::NONE);
+    ASSERT_TRUE(index.find("") == RepoFileIndex::NONE);
+}
+
+TEST(empty_stream_is_empty_index) {
+    auto index = build("");
+    ASSERT_EQ(index.file_count(), static_cast<size_t>(0));
+    ASSERT_EQ(index.node_count(), static_cast<size_t>(1));
+    ASSERT_TRUE(index.children(RepoFileIndex::ROOT).empty());
+}
+
+// ===========================================================================
+// Memory budget
+// ===========================================================================
+
+TEST(budget_truncates_and_stops_feed) {
+    std::string stream;
+    for (int i = 0; i < 10000; ++i) {
+        stream += "dir" + std::to_string(i / 100) + "/file" + std::to_string(i) + '\0';
+    }
+    RepoFileIndex::Limits limits;
+    limits.maxBytes = 64 * 1024;
+
+    RepoFileIndex::Builder builder(limits);
+    bool accepted = true;
+    size_t fed = 0;
+    for (size_t i = 0; i < stream.size() && accepted; i += 4096, ++fed) {
+        accepted = builder.feed(std::string_view(stream).substr(i, 4096));
+    }
+    ASSERT_FALSE(accepted);
+    ASSERT_TRUE(fed * 4096 < stream.size());
+
+    auto index = builder.finish();
+    ASSERT_TRUE(index.truncated());
+    ASSERT_TRUE(index.file_count() > 0);
+    ASSERT_TRUE(index.file_count() < 10000);
+    ASSERT_TRUE(index.bytes() <= limits.maxBytes);
+}
+
+TEST(large_listing_stays_compact) {
+    std::string stream;
+    for (int d = 0; d < 100; ++d) {
+        for (int f = 0; f < 1000; ++f) {
+            stream += "dir" + std::to_string(d) + "/f" + std::to_string(f) + ".c" + '\0';
+        }
+    }
+    auto index = build(stream, 64 * 1024);
+    ASSERT_EQ(index.file_count(), static_cast<size_t>(100000));
+    ASSERT_EQ(index.children(RepoFileIndex::ROOT).size(), static_cast<size_t>(100));
+    // Well under 64 bytes per path, names included
+    ASSERT_TRUE(index.bytes() < static_cast<size_t>(100000) * 64);
+}
+
+// ===========================================================================
+// Streaming from git
+// ===========================================================================
+
+TEST(ls_files_stream_builds_index) {
+    auto dir = (fs::temp_directory_path() / "fh_test_repo_file_index").string();
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    sh(dir, "git init -q -b main && mkdir -p src/ui docs");
+    sh(dir, "touch README.md src/main.cpp src/ui/view.cpp 'docs/a b.md' && git add -A");
+
+    RepoFileIndex::Builder builder;
+    auto result = git::git_ls_files_stream(
+        dir, [&](std::string_view chunk) { return builder.feed(chunk); });
+    ASSERT_TRUE(result.success());
+    auto index = builder.finish();
+
+    ASSERT_EQ(index.file_count(), static_cast<size_t>(4));
+    ASSERT_TRUE(index.find("docs/a b.md") != RepoFileIndex::NONE);
+    ASSERT_TRUE(index.find("src/ui/view.cpp") != RepoFileIndex::NONE);
+    fs::remove_all(dir);
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== repo_file_index tests ===\n");
+    RUN_ALL_TESTS();
+}
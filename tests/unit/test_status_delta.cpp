@@ -0,0 +1,150 @@
+// Unit tests for keyed status updates (git/status_delta.h)
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/git/status_delta.h"
+
+namespace fs = std::filesystem;
+
+static ecs::FileStatus file(const std::string& path, char index = '.',
+                            char worktree = 'M', int additions = 0) {
+    ecs::FileStatus f;
+    f.path = path;
+    f.indexStatus = index;
+    f.workTreeStatus = worktree;
+    f.additions = additions;
+    return f;
+}
+
+// ===========================================================================
+// apply_status_delta
+// ===========================================================================
+
+TEST(delta_identical_is_noop) {
+    std::vector<ecs::FileStatus> current = {file("a"), file("b")};
+    const ecs::FileStatus* before = current.data();
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(current, {file("a"), file("b")}, changes);
+    ASSERT_TRUE(changes.empty());
+    // Untouched: no reallocation
+    ASSERT_TRUE(current.data() == before);
+}
+
+TEST(delta_added_removed_changed) {
+    std::vector<ecs::FileStatus> current = {file("a"), file("b", '.', 'M', 1),
+                                            file("c")};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(
+        current, {file("b", '.', 'M', 2), file("c"), file("d")}, changes);
+
+    ASSERT_EQ(current.size(), static_cast<size_t>(3));
+    ASSERT_STREQ(current[0].path, "b");
+    ASSERT_EQ(current[0].additions, 2);
+    ASSERT_STREQ(current[2].path, "d");
+
+    ASSERT_EQ(changes.added.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(changes.added[0], "d");
+    ASSERT_EQ(changes.removed.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(changes.removed[0], "a");
+    ASSERT_EQ(changes.changed.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(changes.changed[0], "b");
+}
+
+TEST(delta_follows_new_order) {
+    std::vector<ecs::FileStatus> current = {file("a"), file("b")};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(current, {file("b"), file("a")}, changes);
+    ASSERT_TRUE(changes.empty());
+    ASSERT_STREQ(current[0].path, "b");
+    ASSERT_STREQ(current[1].path, "a");
+}
+
+TEST(delta_content_stamp_counts_as_change) {
+    auto before = file("a");
+    before.worktreeStamp = 10;
+    auto after = before;
+    after.worktreeStamp = 11;
+    std::vector<ecs::FileStatus> current = {before};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(current, {after}, changes);
+    ASSERT_EQ(changes.changed.size(), static_cast<size_t>(1));
+    ASSERT_EQ(current[0].worktreeStamp, 11);
+}
+
+TEST(delta_index_hash_counts_as_change) {
+    auto before = file("a", 'M', '.');
+    before.indexHash = "111";
+    auto after = before;
+    after.indexHash = "222";
+    std::vector<ecs::FileStatus> current = {before};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(current, {after}, changes);
+    ASSERT_EQ(changes.changed.size(), static_cast<size_t>(1));
+}
+
+TEST(delta_untracked_paths) {
+    std::vector<std::string> current = {"x", "y"};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(current, {"y", "z"}, changes);
+    ASSERT_EQ(current.size(), static_cast<size_t>(2));
+    ASSERT_STREQ(current[1], "z");
+    ASSERT_EQ(changes.added.size(), static_cast<size_t>(1));
+    ASSERT_EQ(changes.removed.size(), static_cast<size_t>(1));
+    ASSERT_TRUE(changes.changed.empty());
+}
+
+TEST(delta_affected_paths_dedup) {
+    // A file moving from unstaged to staged: removed in one section,
+    // added in the other
+    std::vector<ecs::FileStatus> staged;
+    std::vector<ecs::FileStatus> unstaged = {file("a")};
+    ecs::StatusChangeSet changes;
+    git::apply_status_delta(staged, {file("a", 'M', '.')}, changes);
+    git::apply_status_delta(unstaged, {}, changes);
+    auto paths = git::affected_paths(changes);
+    ASSERT_EQ(paths.size(), static_cast<size_t>(1));
+    ASSERT_STREQ(paths[0], "a");
+}
+
+// ===========================================================================
+// stamp_worktree
+// ===========================================================================
+
+TEST(stamp_tracks_edits) {
+    fs::path dir = fs::temp_directory_path() / "fh_status_delta_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    {
+        std::ofstream(dir / "f.txt") << "one\n";
+    }
+
+    std::vector<ecs::FileStatus> files = {file("f.txt"), file("missing.txt")};
+    git::stamp_worktree(dir.string(), files);
+    ASSERT_TRUE(files[0].worktreeStamp != 0);
+    ASSERT_EQ(files[1].worktreeStamp, static_cast<int64_t>(0));
+
+    int64_t first = files[0].worktreeStamp;
+    {
+        std::ofstream(dir / "f.txt") << "one\ntwo\n";
+    }
+    // Move the mtime explicitly in case the filesystem clock is coarse
+    fs::last_write_time(dir / "f.txt",
+                        fs::last_write_time(dir / "f.txt") + std::chrono::seconds(2));
+    git::stamp_worktree(dir.string(), files);
+    ASSERT_TRUE(files[0].worktreeStamp != first);
+
+    fs::remove_all(dir);
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== status_delta tests ===\n");
+    RUN_ALL_TESTS();
+}
@@ -0,0 +1,159 @@
+// Unit tests for the syntax highlighter (util/syntax_highlight.h)
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/syntax_highlight.h"
+
+using syntax::Kind;
+
+// "kind:text" for each span of line i, space-separated
+static std::string describe(const syntax::Highlighted& h, std::string_view text, size_t i) {
+    size_t start = 0;
+    for (size_t n = 0; n < i; ++n) start = text.find('\n', start) + 1;
+    std::string_view line = text.substr(start, text.find('\n', start) - start);
+    static const char* names[] = {"plain", "kw", "type", "str", "cmt", "num", "pp"};
+    std::string out;
+    for (const auto& s : h.line(i)) {
+        if (!out.empty()) out += ' ';
+        out += names[static_cast<int>(s.kind)];
+        out += ':';
+        out.append(line.substr(s.begin, s.end - s.begin));
+    }
+    return out;
+}
+
+static syntax::Highlighted run(std::string_view path, std::string_view text) {
+    const auto* g = syntax::grammar_for_path(path);
+    return g ? syntax::highlight(*g, text) : syntax::Highlighted{};
+}
+
+// ===========================================================================
+// Grammar lookup
+// ===========================================================================
+
+TEST(grammar_by_extension_and_name) {
+    ASSERT_TRUE(syntax::grammar_for_path("src/main.cpp") != nullptr);
+    ASSERT_EQ(syntax::grammar_name(*syntax::grammar_for_path("a/b.tsx")),
+              std::string_view("JavaScript/TypeScript"));
+    ASSERT_EQ(syntax::grammar_name(*syntax::grammar_for_path("lib.rs")),
+              std::string_view("Rust"));
+    ASSERT_TRUE(syntax::grammar_for_path("Gemfile") != nullptr);
+    ASSERT_TRUE(syntax::grammar_for_path("README") == nullptr);
+    ASSERT_TRUE(syntax::grammar_for_path("notes.txt") == nullptr);
+    ASSERT_TRUE(syntax::grammar_for_path("dir.cpp/Makefile") == nullptr);
+}
+
+// ===========================================================================
+// Tokens
+// ===========================================================================
+
+TEST(cpp_line_tokens) {
+    std::string text = "#include <vector>\nreturn count + 0x1F; // done";
+    auto h = run("a.cpp", text);
+    ASSERT_EQ(h.line_count(), static_cast<size_t>(2));
+    ASSERT_EQ(describe(h, text, 0), std::string("pp:#include"));
+    ASSERT_EQ(describe(h, text, 1), std::string("kw:return num:0x1F cmt:// done"));
+}
+
+TEST(strings_with_escapes_and_comment_markers) {
+    std::string text = "auto s = \"a \\\" // not\"; int x = 1e-5;";
+    auto h = run("a.cc", text);
+    ASSERT_EQ(describe(h, text, 0),
+              std::string("kw:auto str:\"a \\\" // not\" type:int num:1e-5"));
+}
+
+TEST(identifier_digits_are_not_numbers) {
+    std::string text = "uint32_t v2 = x1;";
+    auto h = run("a.c", text);
+    ASSERT_EQ(describe(h, text, 0), std::string("type:uint32_t"));
+}
+
+TEST(capitalized_types_where_the_grammar_says_so) {
+    std::string text = "let m: HashMap<String, u32> = HashMap::new();";
+    auto h = run("a.rs", text);
+    ASSERT_EQ(describe(h, text, 0),
+              std::string("kw:let type:HashMap type:String type:u32 type:HashMap"));
+}
+
+// ===========================================================================
+// Multi-line constructs
+// ===========================================================================
+
+TEST(block_comment_spans_lines) {
+    std::string text = "int a; /* start\nstill comment\nend */ int b;";
+    auto h = run("a.cpp", text);
+    ASSERT_EQ(describe(h, text, 0), std::string("type:int cmt:/* start"));
+    ASSERT_EQ(describe(h, text, 1), std::string("cmt:still comment"));
+    ASSERT_EQ(describe(h, text, 2), std::string("cmt:end */ type:int"));
+}
+
+TEST(python_triple_quoted_string_spans_lines) {
+    std::string text = "def f():\n    \"\"\"doc\n    if x: # not code\n    \"\"\"\n    return None";
+    auto h = run("m.py", text);
+    ASSERT_EQ(describe(h, text, 1), std::string("str:\"\"\"doc"));
+    ASSERT_EQ(describe(h, text, 2), std::string("str:    if x: # not code"));
+    ASSERT_EQ(describe(h, text, 3), std::string("str:    \"\"\""));
+    ASSERT_EQ(describe(h, text, 4), std::string("kw:return kw:None"));
+}
+
+TEST(js_template_literal_spans_lines) {
+    std::string text = "const s = `a\n${b} // x\n`; let y;";
+    auto h = run("a.js", text);
+    ASSERT_EQ(describe(h, text, 1), std::string("str:${b} // x"));
+    ASSERT_EQ(describe(h, text, 2), std::string("str:` kw:let"));
+}
+
+TEST(unterminated_single_line_string_ends_at_eol) {
+    std::string text = "x = 'abc\ny = 1";
+    auto h = run("a.py", text);
+    ASSERT_EQ(describe(h, text, 0), std::string("str:'abc"));
+    ASSERT_EQ(describe(h, text, 1), std::string("num:1"));
+}
+
+TEST(line_state_resumes_mid_file) {
+    const auto* g = syntax::grammar_for_path("a.go");
+    syntax::LineState state;
+    std::vector<syntax::Span> spans;
+    syntax::highlight_line(*g, "s := `raw", state, spans);
+    ASSERT_TRUE(state.open == syntax::LineState::String);
+    syntax::LineState saved = state;
+    spans.clear();
+    syntax::highlight_line(*g, "done` + x", saved, spans);
+    ASSERT_TRUE(saved == syntax::LineState{});
+    ASSERT_EQ(spans.size(), static_cast<size_t>(1));
+    ASSERT_EQ(spans[0].end, 5u);
+}
+
+TEST(line_count_ignores_trailing_newline) {
+    auto h = run("a.c", "a\nb\n");
+    ASSERT_EQ(h.line_count(), static_cast<size_t>(2));
+    ASSERT_EQ(run("a.c", "").line_count(), static_cast<size_t>(1));
+}
+
+// ===========================================================================
+// Scale
+// ===========================================================================
+
+TEST(large_file_highlights_quickly) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        text += "    if (value_" + std::to_string(i) + " > 42) { return \"x\"; } // c\n";
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto h = run("big.cpp", text);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(h.line_count(), static_cast<size_t>(20000));
+    ASSERT_EQ(h.line(19999).size(), static_cast<size_t>(5));
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(500));
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== syntax_highlight tests ===\n");
+    RUN_ALL_TESTS();
+}
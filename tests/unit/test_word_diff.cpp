@@ -0,0 +1,141 @@
+// Unit tests for the intra-line word diff (util/word_diff.h)
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "test_framework.h"
+#include "../../src/util/word_diff.h"
+
+using word_diff::Span;
+
+static std::string marked(std::string_view text, const std::vector<Span>& spans) {
+    std::string out;
+    size_t pos = 0;
+    for (const auto& s : spans) {
+        out.append(text.substr(pos, s.begin - pos));
+        out += '[';
+        out.append(text.substr(s.begin, s.end - s.begin));
+        out += ']';
+        pos = s.end;
+    }
+    out.append(text.substr(pos));
+    return out;
+}
+
+static std::pair<std::string, std::string> diff(std::string_view a, std::string_view b,
+                                                bool* ok = nullptr) {
+    std::vector<Span> sa, sb;
+    bool result = word_diff::diff_line_pair(a, b, sa, sb);
+    if (ok) *ok = result;
+    return {marked(a, sa), marked(b, sb)};
+}
+
+// ===========================================================================
+// Line pairs
+// ===========================================================================
+
+TEST(changed_word_is_highlighted) {
+    auto [a, b] = diff("int count = total + 1;", "int count = total + offset;");
+    ASSERT_EQ(a, std::string("int count = total + [1];"));
+    ASSERT_EQ(b, std::string("int count = total + [offset];"));
+}
+
+TEST(inserted_argument_only_marks_new_side) {
+    auto [a, b] = diff("call(a, b);", "call(a, x, b);");
+    ASSERT_EQ(a, std::string("call(a, b);"));
+    ASSERT_EQ(b, std::string("call(a, [x, ]b);"));
+}
+
+TEST(similar_word_narrows_to_characters) {
+    auto [a, b] = diff("auto value = compute();", "auto values = compute();");
+    ASSERT_EQ(a, std::string("auto value = compute();"));
+    ASSERT_EQ(b, std::string("auto value[s] = compute();"));
+}
+
+TEST(unrelated_word_stays_whole) {
+    auto [a, b] = diff("return alpha;", "return zq;");
+    ASSERT_EQ(a, std::string("return [alpha];"));
+    ASSERT_EQ(b, std::string("return [zq];"));
+}
+
+TEST(identical_lines_have_no_spans) {
+    bool ok = false;
+    auto [a, b] = diff("same", "same", &ok);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(a, std::string("same"));
+}
+
+TEST(rewritten_line_gets_no_highlights) {
+    bool ok = true;
+    auto [a, b] = diff("for (int i = 0; i < n; ++i) {", "return std::nullopt;", &ok);
+    ASSERT_FALSE(ok);
+    ASSERT_EQ(a, std::string("for (int i = 0; i < n; ++i) {"));
+}
+
+TEST(utf8_words_are_not_split) {
+    auto [a, b] = diff("name = \"caf\xc3\xa9\";", "name = \"th\xc3\xa9\";");
+    ASSERT_EQ(a, std::string("name = \"[caf\xc3\xa9]\";"));
+}
+
+// ===========================================================================
+// Limits
+// ===========================================================================
+
+TEST(long_lines_are_skipped) {
+    std::string a(2000, 'x'), b = a + "y";
+    bool ok = true;
+    diff(a, b, &ok);
+    ASSERT_FALSE(ok);
+}
+
+TEST(edit_bound_gives_up_quickly) {
+    // Every other token differs: far more edits than maxEdits
+    std::string a, b;
+    for (int i = 0; i < 150; ++i) {
+        a += "k" + std::to_string(i) + " v" + std::to_string(i) + " ";
+        b += "k" + std::to_string(i) + " w" + std::to_string(i * 7) + " ";
+    }
+    word_diff::Limits limits;
+    limits.maxLineBytes = 100000;
+    std::vector<Span> sa, sb;
+    auto start = std::chrono::steady_clock::now();
+    bool ok = word_diff::diff_line_pair(a, b, sa, sb, limits);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_FALSE(ok);
+    ASSERT_TRUE(sa.empty());
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(50));
+}
+
+// ===========================================================================
+// Hunks
+// ===========================================================================
+
+TEST(hunk_pairs_deletions_with_additions) {
+    std::vector<std::string> lines = {" ctx", "-int a = 1;", "-int b = 2;",
+                                      "+int a = 10;", "+int b = 2;", "+int c = 3;"};
+    auto h = word_diff::diff_hunk(lines);
+    ASSERT_EQ(h.lineFirst.size(), lines.size() + 1);
+    ASSERT_TRUE(h.line(0).empty());
+    // "1" -> "10" narrows to the added "0"; nothing was removed
+    ASSERT_TRUE(h.line(1).empty());
+    ASSERT_EQ(h.line(3).size(), static_cast<size_t>(1));
+    ASSERT_EQ(h.line(3)[0].begin, 9u);
+    ASSERT_EQ(h.line(3)[0].end, 10u);
+    ASSERT_TRUE(h.line(2).empty());  // Unchanged pair
+    ASSERT_TRUE(h.line(5).empty());  // No partner
+}
+
+TEST(hunk_without_pairs_is_empty) {
+    auto h = word_diff::diff_hunk({"+a", "+b", " c"});
+    ASSERT_TRUE(h.lineFirst.empty());
+    ASSERT_TRUE(h.line(0).empty());
+}
+
+// ===========================================================================
+
+int main() {
+    printf("=== word_diff tests ===\n");
+    RUN_ALL_TESTS();
+}